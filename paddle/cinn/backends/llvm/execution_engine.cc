@@ -60,6 +60,7 @@
 #include "paddle/cinn/backends/llvm/codegen_x86.h"
 #include "paddle/cinn/backends/llvm/llvm_optimizer.h"
 #include "paddle/cinn/backends/llvm/llvm_util.h"
+#include "paddle/cinn/backends/llvm/persistent_object_cache.h"
 #include "paddle/cinn/backends/llvm/runtime_symbol_registry.h"
 #include "paddle/cinn/ir/utils/ir_printer.h"
 #include "paddle/cinn/runtime/intrinsic.h"
@@ -186,7 +187,24 @@ void ExecutionEngine::Link(const ir::Module &module) {
   auto machine = std::move(llvm::cantFail(
       llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost())
           .createTargetMachine()));
-  LLVMModuleOptimizer optimize(machine.get(), 3, {}, true);
+  constexpr int kOptLevel = 3;
+  m->setDataLayout(jit_->getDataLayout());
+
+  // With the object cache, the object emitted below is what the jit links,
+  // so a module compiled by a previous process can be linked as is.
+  auto *object_cache = PersistentObjectCache::Global();
+  std::string cache_key;
+  if (object_cache != nullptr) {
+    cache_key = PersistentObjectCache::Key(*m, *machine, kOptLevel);
+    if (auto object = object_cache->Load(cache_key)) {
+      VLOG(3) << "Load object " << cache_key << " from cache";
+      buffer_.assign(object->getBufferStart(), object->getBufferEnd());
+      CHECK(AddObject(std::move(object)));
+      return;
+    }
+  }
+
+  LLVMModuleOptimizer optimize(machine.get(), kOptLevel, {}, true);
   optimize(m.get());
   CHECK(!llvm::verifyModule(*m, &llvm::errs()))
       << "Invalid optimized module detected";
@@ -194,13 +212,20 @@ void ExecutionEngine::Link(const ir::Module &module) {
     VLOG(5) << "function: " << DumpToString(f);
   }
 
+  buffer_.clear();
   llvm::raw_svector_ostream rawstream(buffer_);
   llvm::legacy::PassManager pass_manager;
   machine->addPassesToEmitFile(
       pass_manager, rawstream, nullptr, llvm::CGFT_ObjectFile);
   pass_manager.run(*m);
 
-  CHECK(AddModule(std::move(m), std::move(ctx)));
+  if (object_cache != nullptr) {
+    object_cache->Store(cache_key, buffer_.str());
+    CHECK(AddObject(
+        llvm::MemoryBuffer::getMemBufferCopy(buffer_.str(), cache_key)));
+  } else {
+    CHECK(AddModule(std::move(m), std::move(ctx)));
+  }
 
   if (VLOG_IS_ON(5)) {
     VLOG(5) << "======= dump jit execution session ======";
@@ -232,6 +257,12 @@ bool ExecutionEngine::AddModule(std::unique_ptr<llvm::Module> module,
   return true;
 }
 
+bool ExecutionEngine::AddObject(std::unique_ptr<llvm::MemoryBuffer> object) {
+  utils::RecordEvent("ExecutionEngine AddObject", utils::EventType::kOrdinary);
+  llvm::cantFail(jit_->addObjectFile(std::move(object)));
+  return true;
+}
+
 void ExecutionEngine::ExportObject(const std::string &path) {
   FILE *of = fopen(path.c_str(), "w");
   fwrite(buffer_.data(), 1, buffer_.size(), of);
@@ -86,6 +86,8 @@ class ExecutionEngine {
   bool AddModule(std::unique_ptr<llvm::Module> module,
                  std::unique_ptr<llvm::LLVMContext> context);
 
+  bool AddObject(std::unique_ptr<llvm::MemoryBuffer> object);
+
  protected:
   explicit ExecutionEngine(bool enable_object_cache,
                            RuntimeSymbols &&module_symbols)
@@ -0,0 +1,158 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/backends/llvm/persistent_object_cache.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <mutex>  // NOLINT
+
+DECLARE_string(cinn_object_cache_dir);
+
+namespace cinn::backends {
+namespace {
+// file: magic, key, uint64 object size, object
+constexpr char kMagic[] = "CINNOBJ1";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+// hex of the SHA1
+constexpr size_t kKeySize = 40;
+constexpr size_t kHeaderSize = kMagicSize + kKeySize + sizeof(uint64_t);
+}  // namespace
+
+PersistentObjectCache::PersistentObjectCache(const std::string &dir)
+    : dir_(dir) {
+  if (auto err = llvm::sys::fs::create_directories(dir_)) {
+    LOG(WARNING) << "Failed to create the object cache directory " << dir_
+                 << ": " << err.message();
+  }
+}
+
+/*static*/ PersistentObjectCache *PersistentObjectCache::Global() {
+  static std::mutex mu;
+  static std::unique_ptr<PersistentObjectCache> cache;
+  std::lock_guard<std::mutex> lock(mu);
+  if (FLAGS_cinn_object_cache_dir.empty()) {
+    return nullptr;
+  }
+  if (cache == nullptr || cache->dir() != FLAGS_cinn_object_cache_dir) {
+    VLOG(1) << "Use the object cache in " << FLAGS_cinn_object_cache_dir;
+    cache = std::make_unique<PersistentObjectCache>(
+        FLAGS_cinn_object_cache_dir);
+  }
+  return cache.get();
+}
+
+/*static*/ std::string PersistentObjectCache::Key(
+    const llvm::Module &module,
+    const llvm::TargetMachine &machine,
+    int opt_level) {
+  std::string content;
+  llvm::raw_string_ostream os(content);
+  os << LLVM_VERSION_STRING << '\n'
+     << machine.getTargetTriple().str() << '\n'
+     << machine.getTargetCPU() << '\n'
+     << machine.getTargetFeatureString() << '\n'
+     << opt_level << '\n';
+  module.print(os, nullptr);
+  os.flush();
+  auto hash = llvm::SHA1::hash(llvm::arrayRefFromStringRef(content));
+  return llvm::toHex(hash, /*LowerCase=*/true);
+}
+
+std::string PersistentObjectCache::Path(const std::string &key) const {
+  return dir_ + "/" + key + ".o";
+}
+
+std::unique_ptr<llvm::MemoryBuffer> PersistentObjectCache::Load(
+    const std::string &key) {
+  auto file = llvm::MemoryBuffer::getFile(Path(key));
+  if (!file) {
+    misses_++;
+    return nullptr;
+  }
+  llvm::StringRef data = (*file)->getBuffer();
+  uint64_t size = 0;
+  if (data.size() >= kHeaderSize) {
+    memcpy(&size, data.data() + kMagicSize + kKeySize, sizeof(size));
+  }
+  // a file being replaced by another process is never seen half written,
+  // so a mismatch here is a broken file
+  if (data.size() < kHeaderSize || !data.startswith(kMagic) ||
+      data.substr(kMagicSize, kKeySize) != key ||
+      data.size() - kHeaderSize != size) {
+    LOG(WARNING) << "Ignore the broken object cache file " << Path(key);
+    errors_++;
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  return llvm::MemoryBuffer::getMemBufferCopy(data.substr(kHeaderSize), key);
+}
+
+void PersistentObjectCache::Store(const std::string &key,
+                                  llvm::StringRef object) {
+  CHECK_EQ(key.size(), kKeySize) << "Invalid object cache key " << key;
+  // write a temporary file and rename it, so the readers see either no
+  // file or the whole object
+  int fd = -1;
+  llvm::SmallString<128> tmp_path;
+  if (auto err = llvm::sys::fs::createUniqueFile(
+          dir_ + "/" + key + ".%%%%%%.tmp", fd, tmp_path)) {
+    LOG(WARNING) << "Failed to create a file in the object cache " << dir_
+                 << ": " << err.message();
+    errors_++;
+    return;
+  }
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    uint64_t size = object.size();
+    os << llvm::StringRef(kMagic, kMagicSize) << key;
+    os.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    os << object;
+    os.close();
+    if (os.has_error()) {
+      LOG(WARNING) << "Failed to write " << tmp_path.str().str() << ": "
+                   << os.error().message();
+      os.clear_error();
+      llvm::sys::fs::remove(tmp_path);
+      errors_++;
+      return;
+    }
+  }
+  if (auto err = llvm::sys::fs::rename(tmp_path, Path(key))) {
+    LOG(WARNING) << "Failed to rename " << tmp_path.str().str() << ": "
+                 << err.message();
+    llvm::sys::fs::remove(tmp_path);
+    errors_++;
+    return;
+  }
+  stores_++;
+}
+
+PersistentObjectCache::Stats PersistentObjectCache::GetStats() const {
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.stores = stores_;
+  stats.errors = errors_;
+  return stats;
+}
+
+}  // namespace cinn::backends
@@ -0,0 +1,71 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace cinn::backends {
+
+// Object files of the linked LLVM modules kept on disk across processes.
+// An object is addressed by the SHA1 of the module IR, the target machine,
+// the optimization level and the LLVM version, and is stored in one file
+// named by the key, so the cache can be shared by concurrent processes.
+class PersistentObjectCache {
+ public:
+  struct Stats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t stores{0};
+    // unreadable or corrupted files and failed writes
+    uint64_t errors{0};
+  };
+
+  explicit PersistentObjectCache(const std::string &dir);
+
+  // The cache in FLAGS_cinn_object_cache_dir, nullptr if the flag is empty.
+  static PersistentObjectCache *Global();
+
+  static std::string Key(const llvm::Module &module,
+                         const llvm::TargetMachine &machine,
+                         int opt_level);
+
+  // nullptr on a miss
+  std::unique_ptr<llvm::MemoryBuffer> Load(const std::string &key);
+
+  void Store(const std::string &key, llvm::StringRef object);
+
+  Stats GetStats() const;
+
+  const std::string &dir() const { return dir_; }
+
+ private:
+  std::string Path(const std::string &key) const;
+
+  std::string dir_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> stores_{0};
+  std::atomic<uint64_t> errors_{0};
+};
+
+}  // namespace cinn::backends
@@ -0,0 +1,129 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/backends/llvm/persistent_object_cache.h"
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/TargetSelect.h>
+
+#include <fstream>
+#include <string>
+
+#include "paddle/cinn/backends/llvm/codegen_x86.h"
+#include "paddle/cinn/backends/llvm/execution_engine.h"
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/common/test_helper.h"
+#include "paddle/cinn/runtime/cpu/use_extern_funcs.h"
+
+DECLARE_string(cinn_object_cache_dir);
+
+namespace cinn {
+namespace backends {
+
+TEST(PersistentObjectCache, store_and_load) {
+  const std::string dir = "persistent_object_cache_test_0";
+  llvm::sys::fs::remove_directories(dir);
+  PersistentObjectCache cache(dir);
+  const std::string key(40, 'a');
+  EXPECT_EQ(cache.Load(key), nullptr);
+
+  cache.Store(key, "object content");
+  auto object = cache.Load(key);
+  ASSERT_NE(object, nullptr);
+  EXPECT_EQ(object->getBuffer(), "object content");
+
+  // a truncated file is a miss
+  std::ofstream(dir + "/" + key + ".o") << "CINNOBJ1";
+  EXPECT_EQ(cache.Load(key), nullptr);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1UL);
+  EXPECT_EQ(stats.misses, 2UL);
+  EXPECT_EQ(stats.stores, 1UL);
+  EXPECT_EQ(stats.errors, 1UL);
+}
+
+TEST(PersistentObjectCache, key) {
+  llvm::InitializeNativeTarget();
+  auto machine = llvm::cantFail(
+      llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost())
+          .createTargetMachine());
+  auto key_of = [&](const char *ir) {
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic error;
+    auto m = llvm::parseAssemblyString(ir, error, ctx);
+    CHECK(m) << error.getMessage().str();
+    return PersistentObjectCache::Key(*m, *machine, 3);
+  };
+  const char *add = "define i32 @f(i32 %a) {\n  %b = add i32 %a, 1\n"
+                    "  ret i32 %b\n}\n";
+  const char *sub = "define i32 @f(i32 %a) {\n  %b = sub i32 %a, 1\n"
+                    "  ret i32 %b\n}\n";
+  EXPECT_EQ(key_of(add).size(), 40UL);
+  EXPECT_EQ(key_of(add), key_of(add));
+  EXPECT_NE(key_of(add), key_of(sub));
+}
+
+TEST(PersistentObjectCache, execution_engine) {
+  const std::string dir = "persistent_object_cache_test_1";
+  llvm::sys::fs::remove_directories(dir);
+  FLAGS_cinn_object_cache_dir = dir;
+
+  Expr M(64), N(32);
+  Placeholder<float> A("A", {M, N});
+  Placeholder<float> B("B", {M, N});
+  auto C = Compute(
+      {M, N}, [&](Expr i, Expr j) { return A(i, j) + B(i, j); }, "C");
+  auto stages = CreateStages({C});
+  auto func = Lower("fn", stages, {A, B, C});
+  Module::Builder builder("module0", common::DefaultHostTarget());
+  builder.AddFunction(func);
+  auto module = builder.Build();
+
+  auto *A_buf =
+      common::BufferBuilder(Float(32), {64, 32}).set_random().Build();
+  auto *B_buf =
+      common::BufferBuilder(Float(32), {64, 32}).set_random().Build();
+  auto *C_buf = common::BufferBuilder(Float(32), {64, 32}).set_zero().Build();
+  cinn_pod_value_t a_arg(A_buf), b_arg(B_buf), c_arg(C_buf);
+  cinn_pod_value_t args[] = {a_arg, b_arg, c_arg};
+
+  // the second engine links the object stored by the first one
+  for (int i = 0; i < 2; ++i) {
+    auto jit = ExecutionEngine::Create({});
+    jit->Link<CodeGenX86>(module);
+    auto fn = reinterpret_cast<void (*)(void *, int32_t)>(jit->Lookup("fn"));
+    ASSERT_NE(fn, nullptr);
+    fn(args, 3);
+    auto *ad = reinterpret_cast<float *>(A_buf->memory);
+    auto *bd = reinterpret_cast<float *>(B_buf->memory);
+    auto *cd = reinterpret_cast<float *>(C_buf->memory);
+    for (int j = 0; j < C_buf->num_elements(); ++j) {
+      ASSERT_NEAR(cd[j], ad[j] + bd[j], 1e-5);
+    }
+  }
+  auto stats = PersistentObjectCache::Global()->GetStats();
+  EXPECT_EQ(stats.misses, 1UL);
+  EXPECT_EQ(stats.stores, 1UL);
+  EXPECT_EQ(stats.hits, 1UL);
+  FLAGS_cinn_object_cache_dir = "";
+}
+
+}  // namespace backends
+}  // namespace cinn
@@ -0,0 +1,218 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/runtime/cpu/parallel_thread_pool.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+DECLARE_string(cinn_thread_pool_affinity);
+
+namespace cinn {
+namespace runtime {
+namespace cpu {
+namespace {
+// the waits of a launch pause a few times and then yield the cpu, so a
+// pool of more threads than cpus still makes progress
+constexpr int kPauseCount = 64;
+// spins of an idle worker before it sleeps
+constexpr int kSpinCount = 1 << 14;
+
+// whether the thread is running a task of a pool
+thread_local bool in_parallel_task = false;
+// the worker threads are not copied to a forked child
+std::atomic<bool> in_forked_child{false};
+
+inline void Spin(int spins) {
+  if (spins < kPauseCount) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  } else {
+    std::this_thread::yield();
+  }
+}
+
+void BindToCpu(int cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (ret != 0) {
+    LOG(WARNING) << "Failed to bind the CINN worker thread to cpu " << cpu
+                 << ", error " << ret;
+  }
+#else
+  VLOG(3) << "The thread affinity is not supported on this platform";
+#endif  // __linux__
+}
+}  // namespace
+
+ParallelThreadPool::ParallelThreadPool(int num_threads,
+                                       const std::vector<int>& cpus,
+                                       int spin_count)
+    : num_threads_(std::max(num_threads, 1)),
+      spin_count_(spin_count),
+      workers_(new Worker[std::max(num_threads, 1)]) {
+  // the caller is the thread of the task 0
+  for (int i = 1; i < num_threads_; ++i) {
+    int cpu = cpus.empty() ? -1 : cpus[(i - 1) % cpus.size()];
+    threads_.emplace_back([this, i, cpu] { WorkerLoop(i, cpu); });
+  }
+  VLOG(3) << "Create a CINN parallel thread pool of " << num_threads_
+          << " threads";
+}
+
+ParallelThreadPool::~ParallelThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+/*static*/ ParallelThreadPool* ParallelThreadPool::Global() {
+  static ParallelThreadPool pool(
+      max_concurrency(),
+      ParseAffinity(FLAGS_cinn_thread_pool_affinity, max_concurrency()),
+      kSpinCount);
+#ifdef __linux__
+  static int atfork_ret = pthread_atfork(
+      nullptr, nullptr, [] { in_forked_child = true; });
+  (void)atfork_ret;
+#endif  // __linux__
+  return &pool;
+}
+
+/*static*/ std::vector<int> ParallelThreadPool::ParseAffinity(
+    const std::string& affinity, int num_threads) {
+  std::vector<int> cpus;
+  if (affinity.empty()) {
+    return cpus;
+  }
+  if (affinity == "compact") {
+    // the caller keeps its own cpu, the worker i is on the cpu i
+    int num_cpus = std::max<int>(std::thread::hardware_concurrency(), 1);
+    for (int i = 1; i < num_threads; ++i) {
+      cpus.push_back(i % num_cpus);
+    }
+    return cpus;
+  }
+  std::stringstream ss(affinity);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    char* end = nullptr;
+    long first = std::strtol(item.c_str(), &end, 10);  // NOLINT
+    long last = first;                                   // NOLINT
+    if (*end == '-') {
+      last = std::strtol(end + 1, &end, 10);
+    }
+    CHECK(!item.empty() && *end == '\0' && first >= 0 && first <= last)
+        << "Invalid cpu list of the CINN thread pool affinity: " << affinity;
+    for (long cpu = first; cpu <= last; ++cpu) {  // NOLINT
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+void ParallelThreadPool::Launch(FCINNParallelLambda flambda,
+                                void* datas,
+                                int num_task) {
+  if (num_task <= 1 || num_threads_ == 1 || in_parallel_task ||
+      in_forked_child) {
+    for (int i = 0; i < num_task; ++i) {
+      (*flambda)(i, num_task, datas);
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> launch_lock(launch_mu_);
+  int num_workers = std::min(num_task, num_threads_);
+  flambda_ = flambda;
+  datas_ = datas;
+  num_task_ = num_task;
+  num_workers_ = num_workers;
+  pending_.store(num_workers - 1, std::memory_order_relaxed);
+  ++generation_;
+  for (int i = 1; i < num_workers; ++i) {
+    workers_[i].generation.store(generation_, std::memory_order_seq_cst);
+  }
+  // pairs with the check of the generation by a worker going to sleep
+  if (sleeping_.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard<std::mutex> lock(mu_);
+    cv_.notify_all();
+  }
+
+  RunTasks(0);
+
+  for (int spins = 0; pending_.load(std::memory_order_acquire) != 0;
+       ++spins) {
+    Spin(spins);
+  }
+}
+
+void ParallelThreadPool::RunTasks(int worker_id) {
+  in_parallel_task = true;
+  for (int i = worker_id; i < num_task_; i += num_workers_) {
+    (*flambda_)(i, num_task_, datas_);
+  }
+  in_parallel_task = false;
+}
+
+void ParallelThreadPool::WorkerLoop(int worker_id, int cpu) {
+  if (cpu >= 0) {
+    BindToCpu(cpu);
+  }
+  std::atomic<uint64_t>& generation = workers_[worker_id].generation;
+  uint64_t seen = 0;
+  for (;;) {
+    int spins = 0;
+    while (generation.load(std::memory_order_acquire) == seen) {
+      if (stop_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      if (++spins < spin_count_) {
+        Spin(spins);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mu_);
+      sleeping_.fetch_add(1, std::memory_order_seq_cst);
+      cv_.wait(lock, [&] {
+        return generation.load(std::memory_order_seq_cst) != seen || stop_;
+      });
+      sleeping_.fetch_sub(1, std::memory_order_relaxed);
+      spins = 0;
+    }
+    seen = generation.load(std::memory_order_acquire);
+    RunTasks(worker_id);
+    pending_.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+}  // namespace cpu
+}  // namespace runtime
+}  // namespace cinn
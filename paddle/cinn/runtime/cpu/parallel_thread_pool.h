@@ -0,0 +1,96 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/cinn/runtime/cpu/thread_backend.h"
+
+namespace cinn {
+namespace runtime {
+namespace cpu {
+
+// The worker threads running the parallel lambdas of the host kernels.
+// A launch is a fork-join: the caller runs the task 0 and waits for the
+// others, so the threads live across the launches and spin for a while
+// after one, the next launch of a chain of small kernels does not pay the
+// start of a parallel region.
+class ParallelThreadPool {
+ public:
+  // The pool runs num_threads tasks at the same time, the caller included.
+  // The worker threads are bound to the cpus in turn if cpus is not empty.
+  ParallelThreadPool(int num_threads,
+                     const std::vector<int>& cpus,
+                     int spin_count);
+  ~ParallelThreadPool();
+
+  ParallelThreadPool(const ParallelThreadPool&) = delete;
+  ParallelThreadPool& operator=(const ParallelThreadPool&) = delete;
+
+  // The pool of max_concurrency() threads with the affinity of
+  // FLAGS_cinn_thread_pool_affinity.
+  static ParallelThreadPool* Global();
+
+  // Parses the affinity, empty for no binding, "compact" for the cpus in
+  // order, or a list of cpus like "0,2,4-7".
+  static std::vector<int> ParseAffinity(const std::string& affinity,
+                                        int num_threads);
+
+  // Runs flambda(task_id, num_task, datas) for all the task_id in
+  // [0, num_task) and returns when all of them are done. A launch from a
+  // task of the pool runs its tasks in the calling thread.
+  void Launch(FCINNParallelLambda flambda, void* datas, int num_task);
+
+  int num_threads() const { return num_threads_; }
+
+ private:
+  struct alignas(64) Worker {
+    // the launch to run, set by the caller
+    std::atomic<uint64_t> generation{0};
+  };
+
+  void WorkerLoop(int worker_id, int cpu);
+  void RunTasks(int worker_id);
+
+  const int num_threads_;
+  const int spin_count_;
+  // serializes the launches from different threads
+  std::mutex launch_mu_;
+  uint64_t generation_{0};
+  // the current launch, written before the workers are released
+  FCINNParallelLambda flambda_{nullptr};
+  void* datas_{nullptr};
+  int num_task_{0};
+  int num_workers_{0};
+  alignas(64) std::atomic<int> pending_{0};
+
+  std::unique_ptr<Worker[]> workers_;
+  std::vector<std::thread> threads_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::atomic<int> sleeping_{0};
+  std::atomic<bool> stop_{false};
+};
+
+}  // namespace cpu
+}  // namespace runtime
+}  // namespace cinn
@@ -0,0 +1,137 @@
+// Copyright (c) 2023 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/runtime/cpu/parallel_thread_pool.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <string>
+#include <vector>
+
+DECLARE_string(cinn_host_parallel_backend);
+
+namespace cinn {
+namespace runtime {
+namespace cpu {
+
+struct Counters {
+  std::vector<std::atomic<int>> counts;
+  explicit Counters(int n) : counts(n) {}
+};
+
+int CountTask(int task_id, int num_task, void* datas) {
+  auto* counters = reinterpret_cast<Counters*>(datas);
+  counters->counts[task_id]++;
+  return 0;
+}
+
+int NestedLaunch(int task_id, int num_task, void* datas) {
+  cinn_backend_parallel_launch(&CountTask, datas, num_task);
+  return 0;
+}
+
+int EmptyTask(int task_id, int num_task, void* datas) { return 0; }
+
+TEST(ParallelThreadPool, launch) {
+  ParallelThreadPool pool(4, {}, 1000);
+  for (int num_task : {1, 2, 4, 7, 100}) {
+    Counters counters(num_task);
+    for (int i = 0; i < 100; ++i) {
+      pool.Launch(&CountTask, &counters, num_task);
+    }
+    for (int i = 0; i < num_task; ++i) {
+      ASSERT_EQ(counters.counts[i], 100) << num_task << " tasks";
+    }
+  }
+
+  // the workers fall asleep between the launches
+  Counters counters(4);
+  for (int i = 0; i < 3; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pool.Launch(&CountTask, &counters, 4);
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(counters.counts[i], 3);
+  }
+}
+
+TEST(ParallelThreadPool, concurrent_and_nested) {
+  ParallelThreadPool pool(3, {}, 1000);
+  Counters counters(5);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 200; ++j) {
+        pool.Launch(&CountTask, &counters, 5);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(counters.counts[i], 800);
+  }
+
+  // the inner launch runs in the task of the outer one
+  FLAGS_cinn_host_parallel_backend = "thread_pool";
+  Counters nested(3);
+  cinn_backend_parallel_launch(&NestedLaunch, &nested, 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(nested.counts[i], 3);
+  }
+}
+
+TEST(ParallelThreadPool, parse_affinity) {
+  EXPECT_TRUE(ParallelThreadPool::ParseAffinity("", 4).empty());
+  EXPECT_EQ(ParallelThreadPool::ParseAffinity("compact", 4).size(), 3UL);
+  EXPECT_EQ(ParallelThreadPool::ParseAffinity("0,2,4-6", 4),
+            std::vector<int>({0, 2, 4, 5, 6}));
+  ParallelThreadPool pool(2, {0}, 1000);
+  Counters counters(2);
+  pool.Launch(&CountTask, &counters, 2);
+  EXPECT_EQ(counters.counts[1], 1);
+}
+
+// The latency of launching empty tasks, the cost paid by each parallel loop
+// of a small kernel.
+TEST(ParallelThreadPool, launch_latency_benchmark) {
+  const int repeat = 20000;
+  std::vector<std::string> backends = {"thread_pool"};
+#ifdef CINN_USE_OPENMP
+  backends.push_back("openmp");
+#endif  // CINN_USE_OPENMP
+  for (const auto& backend : backends) {
+    FLAGS_cinn_host_parallel_backend = backend;
+    cinn_backend_parallel_launch(&EmptyTask, nullptr, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+      cinn_backend_parallel_launch(&EmptyTask, nullptr, 0);
+    }
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    LOG(INFO) << backend << " launch of " << max_concurrency()
+              << " tasks: " << seconds / repeat * 1e6 << " us";
+  }
+  FLAGS_cinn_host_parallel_backend = "thread_pool";
+}
+
+}  // namespace cpu
+}  // namespace runtime
+}  // namespace cinn
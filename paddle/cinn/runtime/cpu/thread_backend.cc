@@ -14,6 +14,8 @@
 
 #include "paddle/cinn/runtime/cpu/thread_backend.h"
 
+#include <gflags/gflags.h>
+
 #include <algorithm>
 #include <vector>
 
@@ -24,8 +26,11 @@
 #include "paddle/cinn/backends/extern_func_jit_register.h"
 #include "paddle/cinn/backends/llvm/runtime_symbol_registry.h"
 #include "paddle/cinn/common/cas.h"
+#include "paddle/cinn/runtime/cpu/parallel_thread_pool.h"
 #include "paddle/cinn/runtime/intrinsic.h"
 
+DECLARE_string(cinn_host_parallel_backend);
+
 int max_concurrency() {
   int max_concurrency = 1;
   const char* val = getenv("CINN_NUM_THREADS");
@@ -48,6 +53,13 @@ int cinn_backend_parallel_launch(FCINNParallelLambda flambda,
                                  int num_task) {
   int num_workers = max_concurrency();
   if (num_task == 0) num_task = num_workers;
+  if (FLAGS_cinn_host_parallel_backend == "thread_pool") {
+    cinn::runtime::cpu::ParallelThreadPool::Global()->Launch(
+        flambda, datas, num_task);
+    return 0;
+  }
+  CHECK_EQ(FLAGS_cinn_host_parallel_backend, "openmp")
+      << "Unknown CINN host parallel backend, should be thread_pool or openmp";
 #ifdef CINN_USE_OPENMP
   omp_set_num_threads(num_task);
 #pragma omp parallel num_threads(num_task)
@@ -131,6 +131,24 @@ DEFINE_string(cinn_source_code_save_path,
               "Specify the directory path of generated source code, which is "
               "used for debug.");
 
+DEFINE_string(cinn_object_cache_dir,
+              StringFromEnv("FLAGS_cinn_object_cache_dir", ""),
+              "Specify the directory to keep the object files compiled by the "
+              "LLVM execution engine across processes, empty to disable.");
+
+DEFINE_string(
+    cinn_host_parallel_backend,
+    StringFromEnv("FLAGS_cinn_host_parallel_backend", "thread_pool"),
+    "Specify how the parallel loops of the host kernels run, thread_pool for "
+    "the persistent worker threads of CINN, openmp for an OpenMP parallel "
+    "region per launch.");
+
+DEFINE_string(cinn_thread_pool_affinity,
+              StringFromEnv("FLAGS_cinn_thread_pool_affinity", ""),
+              "Specify the cpus to bind the worker threads of the CINN host "
+              "thread pool to, compact for the cpus in order or a list like "
+              "0,2,4-7, empty for no binding.");
+
 DEFINE_string(cinn_pass_visualize_dir,
               StringFromEnv("FLAGS_cinn_pass_visualize_dir", ""),
               "Specify the directory path of pass visualize file of graph, "
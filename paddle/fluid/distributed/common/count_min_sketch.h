@@ -0,0 +1,86 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace paddle {
+namespace distributed {
+
+// Counts the keys in a fixed memory, the estimate of a key is never below
+// its count. All counters are halved every sample_size adds, so the counts
+// of the keys which are not accessed any more decay.
+class CountMinSketch {
+ public:
+  CountMinSketch(size_t width, size_t depth)
+      : _width(width),
+        _depth(depth),
+        _sample_size(width * 10),
+        _counters(width * depth, 0) {
+    CHECK_GT(width, 0);
+    CHECK_GT(depth, 0);
+  }
+
+  void Add(uint64_t key) {
+    for (size_t row = 0; row < _depth; ++row) {
+      uint16_t& counter = _counters[Index(key, row)];
+      if (counter < std::numeric_limits<uint16_t>::max()) {
+        ++counter;
+      }
+    }
+    if (++_adds >= _sample_size) {
+      for (auto& counter : _counters) {
+        counter >>= 1;
+      }
+      _adds = 0;
+    }
+  }
+
+  uint32_t Estimate(uint64_t key) const {
+    uint32_t estimate = std::numeric_limits<uint16_t>::max();
+    for (size_t row = 0; row < _depth; ++row) {
+      estimate = std::min<uint32_t>(estimate, _counters[Index(key, row)]);
+    }
+    return estimate;
+  }
+
+ private:
+  static uint64_t MixKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  size_t Index(uint64_t key, size_t row) const {
+    return row * _width + MixKey(key + row * 0x9e3779b97f4a7c15ULL) % _width;
+  }
+
+  size_t _width;
+  size_t _depth;
+  size_t _sample_size;
+  size_t _adds{0};
+  std::vector<uint16_t> _counters;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -74,6 +74,18 @@ DEFINE_int32(pserver_connect_timeout_ms,
 
 DEFINE_int32(pserver_sparse_merge_thread, 1, "pserver sparse merge thread num");
 
+DEFINE_int32(pserver_pull_cache_capacity,
+             0,
+             "keys of a sparse table cached by PullSparse, 0 to disable");
+
+DEFINE_int32(pserver_pull_cache_max_staleness,
+             10,
+             "pulls of a sparse table a cached value is served for");
+
+DEFINE_int32(pserver_pull_cache_admit_count,
+             2,
+             "a key is cached once pulled this many times recently");
+
 DEFINE_int32(pserver_sparse_table_shard_num,
              1000,
              "sparse table shard for save & load");
@@ -561,11 +573,13 @@ std::future<int32_t> BrpcPsClient::Shrink(uint32_t table_id,
 
 std::future<int32_t> BrpcPsClient::Load(const std::string &epoch,
                                         const std::string &mode) {
+  ClearSparsePullCache();
   return SendCmd(-1, PS_LOAD_ALL_TABLE, {epoch, mode});
 }
 std::future<int32_t> BrpcPsClient::Load(uint32_t table_id,
                                         const std::string &epoch,
                                         const std::string &mode) {
+  ClearSparsePullCache();
   return SendCmd(table_id, PS_LOAD_ONE_TABLE, {epoch, mode});
 }
 
@@ -663,13 +677,16 @@ std::future<int32_t> BrpcPsClient::GetCacheThreshold(uint32_t table_id,
 }
 
 std::future<int32_t> BrpcPsClient::Clear() {
+  ClearSparsePullCache();
   return SendCmd(-1, PS_CLEAR_ALL_TABLE, {});
 }
 std::future<int32_t> BrpcPsClient::Clear(uint32_t table_id) {
+  ClearSparsePullCache();
   return SendCmd(table_id, PS_CLEAR_ONE_TABLE, {});
 }
 
 std::future<int32_t> BrpcPsClient::Revert() {
+  ClearSparsePullCache();
   return SendCmd(-1, PS_REVERT, {});
 }
 
@@ -1000,6 +1017,19 @@ std::future<int32_t> BrpcPsClient::PushDenseParam(const Region *regions,
   return fut;
 }
 
+SparseValueCodec BrpcPsClient::GetSparseValueCodec(size_t table_id,
+                                                  size_t dim) {
+  const auto &server_param = _config.server_param().downpour_server_param();
+  for (int i = 0; i < server_param.downpour_table_param_size(); ++i) {
+    const auto &table_param = server_param.downpour_table_param(i);
+    if (table_param.table_id() == table_id) {
+      return SparseValueCodec(
+          table_param.value_codec(), dim, table_param.accessor().embedx_dim());
+    }
+  }
+  return SparseValueCodec(VALUE_CODEC_NONE, dim, 0);
+}
+
 std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     size_t table_id,
     const uint64_t *keys,
@@ -1035,12 +1065,14 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     value_ptrs[pserver_idx].push_back(update_values[i]);
   }
 
+  auto codec =
+      GetSparseValueCodec(table_id, accessor->GetAccessorInfo().update_dim);
   for (size_t shard_idx = 0; shard_idx < request_call_num; ++shard_idx) {
     auto kvs = ids[shard_idx];
     auto value_ptr = value_ptrs[shard_idx];
 
     size_t kv_size = kvs.size();
-    uint32_t value_size = accessor->GetAccessorInfo().update_size;
+    uint32_t value_size = codec.EncodedSize();
 
     // 发送RPC请求
     auto *push_request = closure->request(shard_idx);
@@ -1048,6 +1080,9 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     push_request->set_table_id(table_id);
     push_request->set_client_id(_client_id);
     push_request->add_params((char *)&kv_size, sizeof(uint32_t));  // NOLINT
+    if (codec.Encoded()) {
+      codec.AddToRequest(push_request);
+    }
     auto *push_data = push_request->mutable_data();
     push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
     char *push_data_ptr = const_cast<char *>(push_data->data());
@@ -1055,7 +1090,7 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     push_data_ptr += kv_size * sizeof(uint64_t);
 
     for (size_t i = 0; i < kv_size; ++i) {
-      memcpy(push_data_ptr, value_ptr[i], value_size);
+      codec.Encode(value_ptr[i], push_data_ptr);
       push_data_ptr += value_size;
     }
     PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
@@ -1132,11 +1167,106 @@ std::future<int32_t> BrpcPsClient::PushGlobalStep(int table_id,
   return fut;
 }
 
+std::shared_ptr<SparsePullCache> BrpcPsClient::GetSparsePullCache(
+    size_t table_id, size_t value_dim) {
+  if (FLAGS_pserver_pull_cache_capacity <= 0) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(_pull_cache_mutex);
+  auto &cache = _pull_caches[table_id];
+  if (cache == nullptr) {
+    cache = std::make_shared<SparsePullCache>(
+        FLAGS_pserver_pull_cache_capacity,
+        value_dim,
+        FLAGS_pserver_pull_cache_max_staleness,
+        FLAGS_pserver_pull_cache_admit_count);
+  }
+  return cache;
+}
+
+void BrpcPsClient::ClearSparsePullCache() {
+  std::lock_guard<std::mutex> lock(_pull_cache_mutex);
+  for (auto &cache : _pull_caches) {
+    cache.second->Clear();
+  }
+}
+
+SparsePullCacheStat BrpcPsClient::GetSparsePullCacheStat(size_t table_id) {
+  std::lock_guard<std::mutex> lock(_pull_cache_mutex);
+  auto it = _pull_caches.find(table_id);
+  if (it == _pull_caches.end()) {
+    return SparsePullCacheStat{0, 0, 0};
+  }
+  return it->second->GetStat();
+}
+
 std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
                                               size_t table_id,
                                               const uint64_t *keys,
                                               size_t num,
                                               bool is_training) {
+  auto *accessor = GetTableAccessor(table_id);
+  size_t value_dim = accessor->GetAccessorInfo().select_dim;
+  auto cache = GetSparsePullCache(table_id, value_dim);
+  if (cache == nullptr) {
+    return PullSparseFromServer(
+        select_values, table_id, keys, num, is_training, nullptr, 0, nullptr);
+  }
+
+  uint64_t step = cache->NextStep();
+  std::vector<uint64_t> miss_keys;
+  std::vector<float *> miss_values;
+  std::vector<uint64_t> refresh_keys;
+  for (size_t i = 0; i < num; ++i) {
+    bool need_refresh = false;
+    if (!cache->Get(keys[i], step, select_values[i], &need_refresh)) {
+      miss_keys.push_back(keys[i]);
+      miss_values.push_back(select_values[i]);
+    } else if (need_refresh) {
+      refresh_keys.push_back(keys[i]);
+    }
+  }
+  if (!refresh_keys.empty()) {
+    // nobody waits for the refresh, its values only go into the cache
+    auto buffer =
+        std::make_shared<std::vector<float>>(refresh_keys.size() * value_dim);
+    std::vector<float *> refresh_values(refresh_keys.size());
+    for (size_t i = 0; i < refresh_keys.size(); ++i) {
+      refresh_values[i] = buffer->data() + i * value_dim;
+    }
+    PullSparseFromServer(refresh_values.data(),
+                         table_id,
+                         refresh_keys.data(),
+                         refresh_keys.size(),
+                         is_training,
+                         cache,
+                         step,
+                         buffer);
+  }
+  if (miss_keys.empty()) {
+    std::promise<int32_t> promise;
+    promise.set_value(0);
+    return promise.get_future();
+  }
+  return PullSparseFromServer(miss_values.data(),
+                              table_id,
+                              miss_keys.data(),
+                              miss_keys.size(),
+                              is_training,
+                              cache,
+                              step,
+                              nullptr);
+}
+
+std::future<int32_t> BrpcPsClient::PullSparseFromServer(
+    float **select_values,
+    size_t table_id,
+    const uint64_t *keys,
+    size_t num,
+    bool is_training,
+    std::shared_ptr<SparsePullCache> cache,
+    uint64_t step,
+    std::shared_ptr<std::vector<float>> buffer) {
   auto timer = std::make_shared<CostTimer>("pserver_client_pull_sparse");
   auto local_timer =
       std::make_shared<CostTimer>("pserver_client_pull_sparse_local");
@@ -1165,8 +1295,11 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
 
   size_t value_size = accessor->GetAccessorInfo().select_size;
 
+  auto codec = GetSparseValueCodec(table_id,
+                                   accessor->GetAccessorInfo().select_dim);
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
+      request_call_num,
+      [shard_sorted_kvs, value_size, codec, cache, step, buffer](void *done) {
         int ret = 0;
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
         for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
@@ -1180,6 +1313,7 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
           butil::IOBufBytesIterator io_buffer_itr(res_io_buffer);
           uint64_t last_key = UINT64_MAX;
           float *last_value_data = NULL;
+          std::string encoded_value(codec.EncodedSize(), '\0');
 
           for (size_t kv_idx = 0; kv_idx < request_kvs.size(); ++kv_idx) {
             auto *kv_pair = &(request_kvs[kv_idx]);
@@ -1190,9 +1324,19 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
             } else {
               last_key = kv_pair->first;
               last_value_data = kv_pair->second;
-              if (value_size !=
-                  io_buffer_itr.copy_and_forward(
-                      reinterpret_cast<void *>(last_value_data), value_size)) {
+              if (codec.Encoded()) {
+                if (encoded_value.size() !=
+                    io_buffer_itr.copy_and_forward(&encoded_value[0],
+                                                   encoded_value.size())) {
+                  LOG(WARNING) << "res data is lack or not in format";
+                  ret = -1;
+                  break;
+                }
+                codec.Decode(encoded_value.data(), last_value_data);
+              } else if (value_size !=
+                         io_buffer_itr.copy_and_forward(
+                             reinterpret_cast<void *>(last_value_data),
+                             value_size)) {
                 LOG(WARNING) << "res data is lack or not in format";
                 ret = -1;
                 break;
@@ -1200,6 +1344,18 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
             }
           }
         }
+        if (cache != nullptr) {
+          for (auto &request_kvs : *shard_sorted_kvs) {
+            for (auto &kv_pair : request_kvs) {
+              if (ret == 0) {
+                cache->Put(kv_pair.first, step, kv_pair.second);
+              } else if (buffer != nullptr) {
+                // a failed refresh is retried by the next hit of the key
+                cache->CancelRefresh(kv_pair.first);
+              }
+            }
+          }
+        }
         closure->set_promise_value(ret);
       });
   closure->add_timer(timer);
@@ -1250,6 +1406,9 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
       closure->request(i)->set_client_id(_client_id);
       closure->request(i)->add_params((char *)&kv_request_count,  // NOLINT
                                       sizeof(uint32_t));
+      if (codec.Encoded()) {
+        codec.AddToRequest(closure->request(i));
+      }
       PsService_Stub rpc_stub(GetCmdChannel(i));
       closure->cntl(i)->set_log_id(butil::gettimeofday_ms());
       rpc_stub.service(
@@ -1279,8 +1438,10 @@ std::future<int32_t> BrpcPsClient::PullSparseParam(float **select_values,
 
   auto *accessor = GetTableAccessor(table_id);
   size_t value_size = accessor->GetAccessorInfo().select_size;
+  auto codec = GetSparseValueCodec(table_id,
+                                   accessor->GetAccessorInfo().select_dim);
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
+      request_call_num, [shard_sorted_kvs, value_size, codec](void *done) {
         int ret = 0;
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
         for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
@@ -1294,6 +1455,7 @@ std::future<int32_t> BrpcPsClient::PullSparseParam(float **select_values,
           butil::IOBufBytesIterator io_buffer_itr(res_io_buffer);
           uint64_t last_key = UINT64_MAX;
           float *last_value_data = NULL;
+          std::string encoded_value(codec.EncodedSize(), '\0');
 
           // can remove sort&unique
           for (size_t kv_idx = 0; kv_idx < request_kvs.size(); ++kv_idx) {
@@ -1305,9 +1467,19 @@ std::future<int32_t> BrpcPsClient::PullSparseParam(float **select_values,
             } else {
               last_key = kv_pair->first;
               last_value_data = kv_pair->second;
-              if (value_size !=
-                  io_buffer_itr.copy_and_forward(
-                      reinterpret_cast<void *>(last_value_data), value_size)) {
+              if (codec.Encoded()) {
+                if (encoded_value.size() !=
+                    io_buffer_itr.copy_and_forward(&encoded_value[0],
+                                                   encoded_value.size())) {
+                  LOG(WARNING) << "res data is lack or not in format";
+                  ret = -1;
+                  break;
+                }
+                codec.Decode(encoded_value.data(), last_value_data);
+              } else if (value_size !=
+                         io_buffer_itr.copy_and_forward(
+                             reinterpret_cast<void *>(last_value_data),
+                             value_size)) {
                 LOG(WARNING) << "res data is lack or not in format";
                 ret = -1;
                 break;
@@ -1366,6 +1538,9 @@ std::future<int32_t> BrpcPsClient::PullSparseParam(float **select_values,
       closure->request(i)->set_client_id(_client_id);
       closure->request(i)->add_params((char *)&kv_request_count,  // NOLINT
                                       sizeof(uint32_t));
+      if (codec.Encoded()) {
+        codec.AddToRequest(closure->request(i));
+      }
       PsService_Stub rpc_stub(GetCmdChannel(i));
       closure->cntl(i)->set_log_id(butil::gettimeofday_ms());
       rpc_stub.service(
@@ -1409,7 +1584,9 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradientPartial(
     void *done,
     int pserver_idx) {
   auto *accessor = GetTableAccessor(table_id);
-  size_t value_size = accessor->GetAccessorInfo().update_size;
+  auto codec =
+      GetSparseValueCodec(table_id, accessor->GetAccessorInfo().update_dim);
+  size_t value_size = codec.EncodedSize();
   DownpourBrpcClosure *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
   auto promise = std::make_shared<std::promise<int32_t>>();
   closure->add_promise(promise);
@@ -1421,13 +1598,16 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradientPartial(
   push_request->set_table_id(table_id);
   push_request->set_client_id(_client_id);
   push_request->add_params((char *)&num, sizeof(uint32_t));  // NOLINT
+  if (codec.Encoded()) {
+    codec.AddToRequest(push_request);
+  }
   auto *push_data = push_request->mutable_data();
   push_data->resize(num * (sizeof(uint64_t) + value_size));
   char *push_data_ptr = const_cast<char *>(push_data->data());
   memcpy(push_data_ptr, keys, num * sizeof(uint64_t));
   push_data_ptr += num * sizeof(uint64_t);
   for (uint32_t i = 0; i < num; ++i) {
-    memcpy(push_data_ptr, update_values[i], value_size);
+    codec.Encode(update_values[i], push_data_ptr);
     push_data_ptr += value_size;
   }
   PsService_Stub rpc_stub(GetSparseChannel(pserver_idx));
@@ -1857,8 +2037,13 @@ int BrpcPsClient::PushSparseAsyncShardPush(
   push_request->set_client_id(_client_id);
   push_request->add_params(reinterpret_cast<char *>(&merged_kv_count),
                            sizeof(uint32_t));  // NOLINT
+  auto codec =
+      GetSparseValueCodec(table_id, accessor->GetAccessorInfo().update_dim);
+  if (codec.Encoded()) {
+    codec.AddToRequest(push_request);
+  }
   auto *push_data = push_request->mutable_data();
-  int update_size = accessor->GetAccessorInfo().update_size;
+  int update_size = codec.EncodedSize();
   push_data->resize(merged_kv_count * (sizeof(uint64_t) + update_size));
   char *push_data_ptr = const_cast<char *>(push_data->data());
   memcpy(push_data_ptr,
@@ -1868,9 +2053,8 @@ int BrpcPsClient::PushSparseAsyncShardPush(
   for (size_t i = 0; i < merged_kv_count; ++i) {
     const char *task_data_ptr = merged_value_list[i].data();
 
-    memcpy(push_data_ptr,
-           (float *)(task_data_ptr),  // NOLINT
-           update_size);
+    codec.Encode(reinterpret_cast<const float *>(task_data_ptr),
+                 push_data_ptr);
     push_data_ptr += update_size;
   }
   PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
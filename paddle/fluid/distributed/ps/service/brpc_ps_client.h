@@ -26,6 +26,8 @@
 #include "paddle/fluid/distributed/ps/service/brpc_utils.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+#include "paddle/fluid/distributed/ps/service/sparse_value_codec.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
@@ -266,6 +268,9 @@ class BrpcPsClient : public PSClient {
                                                const uint64_t *keys,
                                                size_t num,
                                                bool is_training);
+  // the counters of the pull cache of table_id, all zero when
+  // FLAGS_pserver_pull_cache_capacity is 0
+  SparsePullCacheStat GetSparsePullCacheStat(size_t table_id);
 
   virtual std::future<int32_t> PrintTableStat(uint32_t table_id);
 
@@ -341,6 +346,27 @@ class BrpcPsClient : public PSClient {
                                int cmd_id,
                                const std::vector<std::string> &param);
 
+  // the codec of the sparse values of dim floats sent for table_id, set by
+  // TableParameter.value_codec
+  SparseValueCodec GetSparseValueCodec(size_t table_id, size_t dim);
+
+  // Pulls keys from the servers. The pulled values are put into cache at
+  // step if cache is set, buffer is kept until they are received.
+  std::future<int32_t> PullSparseFromServer(
+      float **select_values,
+      size_t table_id,
+      const uint64_t *keys,
+      size_t num,
+      bool is_training,
+      std::shared_ptr<SparsePullCache> cache,
+      uint64_t step,
+      std::shared_ptr<std::vector<float>> buffer);
+  // nullptr when FLAGS_pserver_pull_cache_capacity is 0
+  std::shared_ptr<SparsePullCache> GetSparsePullCache(size_t table_id,
+                                                      size_t value_dim);
+  // the cached values are dropped when the tables are loaded or cleared
+  void ClearSparsePullCache();
+
   std::future<int32_t> SendSaveCmd(uint32_t table_id,
                                    int cmd_id,
                                    const std::vector<std::string> &param);
@@ -360,6 +386,9 @@ class BrpcPsClient : public PSClient {
   std::unordered_map<uint32_t, paddle::framework::Channel<SparseAsyncTask *>>
       _push_sparse_task_queue_map;
   std::unordered_map<uint32_t, uint32_t> _push_sparse_merge_count_map;
+  // worker side cache of the hot keys of PullSparse
+  std::mutex _pull_cache_mutex;
+  std::unordered_map<size_t, std::shared_ptr<SparsePullCache>> _pull_caches;
 
   std::thread _print_thread;
 
@@ -18,6 +18,7 @@
 
 #include "butil/object_pool.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
+#include "paddle/fluid/distributed/ps/service/sparse_value_codec.h"
 #include "paddle/fluid/distributed/ps/table/depends/sparse_utils.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/framework/archive.h"
@@ -543,8 +544,20 @@ int32_t BrpcPsService::PullSparse(Table *table,
   table->Pull(table_context);
   // table->PullSparse(res_data->data(), value);
 
-  cntl->response_attachment().append(reinterpret_cast<char *>(res_data->data()),
-                                     res_data->size() * sizeof(float));
+  auto codec = SparseValueCodec::FromRequest(request, 1, dim);
+  if (codec.Encoded()) {
+    thread_local std::string res_buffer;
+    size_t encoded_size = codec.EncodedSize();
+    res_buffer.resize(num * encoded_size);
+    for (uint32_t i = 0; i < num; ++i) {
+      codec.Encode(res_data->data() + i * dim, &res_buffer[i * encoded_size]);
+    }
+    cntl->response_attachment().append(res_buffer.data(), res_buffer.size());
+  } else {
+    cntl->response_attachment().append(
+        reinterpret_cast<char *>(res_data->data()),
+        res_data->size() * sizeof(float));
+  }
   butil::return_object(res_data);
   return 0;
 }
@@ -582,6 +595,23 @@ int32_t BrpcPsService::PushSparse(Table *table,
   table_context.push_context.values =
       (const float *)(push_data.data() + sizeof(uint64_t) * num);
   table_context.num = num;
+  auto dim = table->ValueAccesor()->GetAccessorInfo().update_dim;
+  auto codec = SparseValueCodec::FromRequest(request, 1, dim);
+  thread_local std::vector<float> push_values;
+  if (codec.Encoded()) {
+    size_t encoded_size = codec.EncodedSize();
+    if (push_data.size() != num * (sizeof(uint64_t) + encoded_size)) {
+      set_response_code(response, -1, "PushSparse data is not in format");
+      return 0;
+    }
+    const char *encoded_values = push_data.data() + sizeof(uint64_t) * num;
+    push_values.resize(num * dim);
+    for (uint32_t i = 0; i < num; ++i) {
+      codec.Decode(encoded_values + i * encoded_size,
+                   push_values.data() + i * dim);
+    }
+    table_context.push_context.values = push_values.data();
+  }
   // const uint64_t *keys = (const uint64_t *)push_data.data();
   // const float *values = (const float *)(push_data.data() + sizeof(uint64_t) *
   // num);
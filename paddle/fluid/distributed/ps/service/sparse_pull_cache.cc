@@ -0,0 +1,162 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace paddle {
+namespace distributed {
+
+SparsePullCache::SparsePullCache(size_t capacity,
+                                 size_t value_dim,
+                                 uint32_t max_staleness,
+                                 uint32_t admit_count)
+    : _set_num(std::max<size_t>(capacity / kWays, 1)),
+      _value_dim(value_dim),
+      _max_staleness(max_staleness),
+      _admit_count(admit_count),
+      _entries(_set_num * kWays, Entry{0, 0, false, false}),
+      _values(_set_num * kWays * value_dim),
+      _stripes(kStripes) {
+  // the sketches count several times more keys than the cache holds
+  size_t sketch_width = std::max<size_t>(capacity * 4 / kStripes, 1024);
+  for (auto& stripe : _stripes) {
+    stripe.sketch.reset(new CountMinSketch(sketch_width, 4));
+  }
+}
+
+size_t SparsePullCache::SetIndex(uint64_t key) const {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return key % _set_num;
+}
+
+bool SparsePullCache::Get(uint64_t key,
+                          uint64_t step,
+                          float* value,
+                          bool* need_refresh) {
+  size_t set = SetIndex(key);
+  auto& stripe = GetStripe(set);
+  std::lock_guard<std::mutex> lock(stripe.mutex);
+  stripe.sketch->Add(key);
+  for (size_t idx = set * kWays; idx < (set + 1) * kWays; ++idx) {
+    auto& entry = _entries[idx];
+    if (!entry.valid || entry.key != key) {
+      continue;
+    }
+    // a concurrent pull may have put a value of a later step
+    uint64_t age = step > entry.step ? step - entry.step : 0;
+    if (age > _max_staleness) {
+      break;
+    }
+    memcpy(value, &_values[idx * _value_dim], _value_dim * sizeof(float));
+    *need_refresh = false;
+    if (age * 2 >= _max_staleness && !entry.refreshing) {
+      entry.refreshing = true;
+      *need_refresh = true;
+      ++_refresh_keys;
+    }
+    ++_hit_keys;
+    return true;
+  }
+  ++_miss_keys;
+  return false;
+}
+
+void SparsePullCache::Put(uint64_t key, uint64_t step, const float* value) {
+  size_t set = SetIndex(key);
+  auto& stripe = GetStripe(set);
+  std::lock_guard<std::mutex> lock(stripe.mutex);
+  Entry* target = nullptr;
+  for (size_t idx = set * kWays; idx < (set + 1) * kWays; ++idx) {
+    if (_entries[idx].valid && _entries[idx].key == key) {
+      target = &_entries[idx];
+      break;
+    }
+  }
+  if (target != nullptr) {
+    if (step < target->step) {
+      return;
+    }
+  } else {
+    uint32_t freq = stripe.sketch->Estimate(key);
+    if (freq < _admit_count) {
+      return;
+    }
+    // an empty or expired way, else the least frequent key if it is less
+    // frequent than key
+    uint32_t min_freq = std::numeric_limits<uint32_t>::max();
+    for (size_t idx = set * kWays; idx < (set + 1) * kWays; ++idx) {
+      auto& entry = _entries[idx];
+      if (!entry.valid || step > entry.step + _max_staleness) {
+        target = &entry;
+        min_freq = 0;
+        break;
+      }
+      uint32_t entry_freq = stripe.sketch->Estimate(entry.key);
+      if (entry_freq < min_freq) {
+        min_freq = entry_freq;
+        target = &entry;
+      }
+    }
+    if (min_freq >= freq) {
+      return;
+    }
+  }
+  target->key = key;
+  target->step = step;
+  target->valid = true;
+  target->refreshing = false;
+  memcpy(&_values[(target - _entries.data()) * _value_dim],
+         value,
+         _value_dim * sizeof(float));
+}
+
+void SparsePullCache::CancelRefresh(uint64_t key) {
+  size_t set = SetIndex(key);
+  auto& stripe = GetStripe(set);
+  std::lock_guard<std::mutex> lock(stripe.mutex);
+  for (size_t idx = set * kWays; idx < (set + 1) * kWays; ++idx) {
+    if (_entries[idx].valid && _entries[idx].key == key) {
+      _entries[idx].refreshing = false;
+      break;
+    }
+  }
+}
+
+void SparsePullCache::Clear() {
+  for (size_t s = 0; s < kStripes; ++s) {
+    std::lock_guard<std::mutex> lock(_stripes[s].mutex);
+    for (size_t set = s; set < _set_num; set += kStripes) {
+      for (size_t idx = set * kWays; idx < (set + 1) * kWays; ++idx) {
+        _entries[idx].valid = false;
+      }
+    }
+  }
+}
+
+SparsePullCacheStat SparsePullCache::GetStat() {
+  SparsePullCacheStat stat;
+  stat.hit_keys = _hit_keys;
+  stat.miss_keys = _miss_keys;
+  stat.refresh_keys = _refresh_keys;
+  return stat;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,92 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/distributed/common/count_min_sketch.h"
+
+namespace paddle {
+namespace distributed {
+
+struct SparsePullCacheStat {
+  uint64_t hit_keys;
+  uint64_t miss_keys;
+  // the hit keys which were pulled again in background
+  uint64_t refresh_keys;
+};
+
+// The pulled values of the hot keys of a sparse table on a worker. A step is
+// a pull of the table, a value is served for max_staleness steps after it
+// was pulled from the server and is pulled again in background from half of
+// them on. A key is cached once it is pulled admit_count times recently,
+// the cache is set associative and a full set keeps its most frequent keys.
+class SparsePullCache {
+ public:
+  SparsePullCache(size_t capacity,
+                  size_t value_dim,
+                  uint32_t max_staleness,
+                  uint32_t admit_count);
+
+  // Called once at the beginning of each pull of the table.
+  uint64_t NextStep() { return ++_step; }
+  // Copies the value of key into value if it is cached and fresh. Sets
+  // need_refresh if the caller should pull it again in background.
+  bool Get(uint64_t key, uint64_t step, float* value, bool* need_refresh);
+  // Caches the value of key pulled from the server at step.
+  void Put(uint64_t key, uint64_t step, const float* value);
+  // Called when the background pull of key failed, so that the next Get
+  // asks for a refresh again.
+  void CancelRefresh(uint64_t key);
+  void Clear();
+  SparsePullCacheStat GetStat();
+
+ private:
+  static constexpr size_t kWays = 4;
+  static constexpr size_t kStripes = 64;
+
+  struct Entry {
+    uint64_t key;
+    uint64_t step;
+    bool valid;
+    bool refreshing;
+  };
+  struct Stripe {
+    std::mutex mutex;
+    std::unique_ptr<CountMinSketch> sketch;
+  };
+
+  size_t SetIndex(uint64_t key) const;
+  Stripe& GetStripe(size_t set) { return _stripes[set % kStripes]; }
+
+  size_t _set_num;
+  size_t _value_dim;
+  uint32_t _max_staleness;
+  uint32_t _admit_count;
+  std::atomic<uint64_t> _step{0};
+  std::vector<Entry> _entries;
+  std::vector<float> _values;
+  std::vector<Stripe> _stripes;
+  std::atomic<uint64_t> _hit_keys{0};
+  std::atomic<uint64_t> _miss_keys{0};
+  std::atomic<uint64_t> _refresh_keys{0};
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,164 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_value_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+// rounds to the nearest even, phi::dtype::bfloat16 truncates on cpu which
+// biases the pushed gradients
+inline uint16_t FloatToBF16(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(float));
+  if (std::isnan(value)) {
+    return static_cast<uint16_t>((bits >> 16) | 0x40);
+  }
+  bits += 0x7fff + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+inline float BF16ToFloat(uint16_t value) {
+  uint32_t bits = static_cast<uint32_t>(value) << 16;
+  float ret;
+  memcpy(&ret, &bits, sizeof(float));
+  return ret;
+}
+}  // namespace
+
+SparseValueCodec::SparseValueCodec(ValueCodec codec,
+                                   size_t dim,
+                                   size_t tail_dim)
+    : _codec(codec), _dim(dim), _tail_dim(std::min(tail_dim, dim)) {
+  if (_tail_dim == 0) {
+    _codec = VALUE_CODEC_NONE;
+  }
+}
+
+SparseValueCodec SparseValueCodec::FromRequest(const PsRequestMessage& request,
+                                               int param_idx,
+                                               size_t dim) {
+  uint32_t codec[2] = {VALUE_CODEC_NONE, 0};
+  if (request.params_size() > param_idx &&
+      request.params(param_idx).size() == sizeof(codec)) {
+    memcpy(codec, request.params(param_idx).data(), sizeof(codec));
+  }
+  if (!ValueCodec_IsValid(codec[0])) {
+    codec[0] = VALUE_CODEC_NONE;
+  }
+  return SparseValueCodec(static_cast<ValueCodec>(codec[0]), dim, codec[1]);
+}
+
+void SparseValueCodec::AddToRequest(PsRequestMessage* request) const {
+  uint32_t codec[2] = {static_cast<uint32_t>(_codec),
+                       static_cast<uint32_t>(_tail_dim)};
+  request->add_params(reinterpret_cast<char*>(codec), sizeof(codec));
+}
+
+size_t SparseValueCodec::EncodedSize() const {
+  size_t head_size = (_dim - _tail_dim) * sizeof(float);
+  switch (_codec) {
+    case VALUE_CODEC_FP16:
+    case VALUE_CODEC_BF16:
+      return head_size + _tail_dim * sizeof(uint16_t);
+    case VALUE_CODEC_INT8:
+      return head_size + sizeof(float) + _tail_dim * sizeof(int8_t);
+    default:
+      return _dim * sizeof(float);
+  }
+}
+
+void SparseValueCodec::Encode(const float* value, char* out) const {
+  size_t head_dim = _dim - _tail_dim;
+  memcpy(out, value, head_dim * sizeof(float));
+  out += head_dim * sizeof(float);
+  const float* tail = value + head_dim;
+  switch (_codec) {
+    case VALUE_CODEC_FP16:
+      for (size_t i = 0; i < _tail_dim; ++i) {
+        uint16_t half = phi::dtype::float16(tail[i]).x;
+        memcpy(out + i * sizeof(uint16_t), &half, sizeof(uint16_t));
+      }
+      break;
+    case VALUE_CODEC_BF16:
+      for (size_t i = 0; i < _tail_dim; ++i) {
+        uint16_t half = FloatToBF16(tail[i]);
+        memcpy(out + i * sizeof(uint16_t), &half, sizeof(uint16_t));
+      }
+      break;
+    case VALUE_CODEC_INT8: {
+      float max_abs = 0.0;
+      for (size_t i = 0; i < _tail_dim; ++i) {
+        max_abs = std::max(max_abs, std::fabs(tail[i]));
+      }
+      float scale = max_abs / 127;
+      memcpy(out, &scale, sizeof(float));
+      int8_t* quant = reinterpret_cast<int8_t*>(out + sizeof(float));
+      for (size_t i = 0; i < _tail_dim; ++i) {
+        float q = scale > 0 ? std::nearbyint(tail[i] / scale) : 0;
+        quant[i] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, q)));
+      }
+      break;
+    }
+    default:
+      memcpy(out, tail, _tail_dim * sizeof(float));
+      break;
+  }
+}
+
+void SparseValueCodec::Decode(const char* in, float* value) const {
+  size_t head_dim = _dim - _tail_dim;
+  memcpy(value, in, head_dim * sizeof(float));
+  in += head_dim * sizeof(float);
+  float* tail = value + head_dim;
+  switch (_codec) {
+    case VALUE_CODEC_FP16:
+      for (size_t i = 0; i < _tail_dim; ++i) {
+        phi::dtype::float16 half;
+        memcpy(&half.x, in + i * sizeof(uint16_t), sizeof(uint16_t));
+        tail[i] = static_cast<float>(half);
+      }
+      break;
+    case VALUE_CODEC_BF16:
+      for (size_t i = 0; i < _tail_dim; ++i) {
+        uint16_t half;
+        memcpy(&half, in + i * sizeof(uint16_t), sizeof(uint16_t));
+        tail[i] = BF16ToFloat(half);
+      }
+      break;
+    case VALUE_CODEC_INT8: {
+      float scale;
+      memcpy(&scale, in, sizeof(float));
+      const int8_t* quant = reinterpret_cast<const int8_t*>(in + sizeof(float));
+      for (size_t i = 0; i < _tail_dim; ++i) {
+        tail[i] = quant[i] * scale;
+      }
+      break;
+    }
+    default:
+      memcpy(tail, in, _tail_dim * sizeof(float));
+      break;
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,55 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+
+#include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+// Encodes the sparse values of the pull and push requests of a table. The
+// last tail_dim floats of a value of dim floats, the embedx of the
+// accessors, are encoded with the ValueCodec of the table and the others
+// are sent as they are.
+// The codec is sent in the params of a request, so the server decodes a
+// request with the codec of its client.
+class SparseValueCodec {
+ public:
+  SparseValueCodec(ValueCodec codec, size_t dim, size_t tail_dim);
+
+  // Reads the codec from params(param_idx) of the request, a request
+  // without it is not encoded.
+  static SparseValueCodec FromRequest(const PsRequestMessage& request,
+                                      int param_idx,
+                                      size_t dim);
+  void AddToRequest(PsRequestMessage* request) const;
+
+  bool Encoded() const { return _codec != VALUE_CODEC_NONE; }
+  // bytes of an encoded value
+  size_t EncodedSize() const;
+  void Encode(const float* value, char* out) const;
+  void Decode(const char* in, float* value) const;
+
+ private:
+  ValueCodec _codec;
+  size_t _dim;
+  size_t _tail_dim;
+};
+
+}  // namespace distributed
+}  // namespace paddle
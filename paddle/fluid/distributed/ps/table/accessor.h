@@ -15,6 +15,7 @@
 #pragma once
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <unordered_map>
 #include <vector>
@@ -138,6 +139,27 @@ class ValueAccessor {
   virtual int32_t Select(float** select_values,
                          const float** values,
                          size_t num) = 0;
+  // Select from values kept in table storage, which may be shorter than
+  // GetAccessorInfo().size (mf not extended yet) or null with size 0 (key
+  // missing), the absent fields are selected as 0.
+  virtual int32_t SelectFromStorage(float** select_values,
+                                    const float** values,
+                                    const size_t* value_sizes,
+                                    size_t num) {
+    size_t value_dim = GetAccessorInfo().size / sizeof(float);
+    std::vector<float> buffer(value_dim);
+    for (size_t i = 0; i < num; ++i) {
+      if (value_sizes[i] > 0) {
+        memcpy(buffer.data(), values[i], value_sizes[i] * sizeof(float));
+      }
+      memset(buffer.data() + value_sizes[i],
+             0,
+             (value_dim - value_sizes[i]) * sizeof(float));
+      const float* buffer_ptr = buffer.data();
+      Select(select_values + i, &buffer_ptr, 1);
+    }
+    return 0;
+  }
   // 将update_values聚合到一起
   virtual int32_t Merge(float** update_values,
                         const float** other_update_values,
@@ -1145,9 +1145,12 @@ int32_t GraphTable::remove_graph_node(int idx, std::vector<uint64_t> &id_list) {
 }
 
 void GraphShard::clear() {
-  for (size_t i = 0; i < bucket.size(); i++) {
-    delete bucket[i];
+  if (csr == nullptr) {
+    for (size_t i = 0; i < bucket.size(); i++) {
+      delete bucket[i];
+    }
   }
+  csr.reset();
   bucket.clear();
   node_location.clear();
 }
@@ -1155,6 +1158,7 @@ void GraphShard::clear() {
 GraphShard::~GraphShard() { clear(); }
 
 void GraphShard::delete_node(uint64_t id) {
+  thaw_csr();
   auto iter = node_location.find(id);
   if (iter == node_location.end()) return;
   int pos = iter->second;
@@ -1167,6 +1171,7 @@ void GraphShard::delete_node(uint64_t id) {
   bucket.pop_back();
 }
 GraphNode *GraphShard::add_graph_node(uint64_t id) {
+  thaw_csr();
   if (node_location.find(id) == node_location.end()) {
     node_location[id] = bucket.size();
     bucket.push_back(new GraphNode(id));
@@ -1175,6 +1180,7 @@ GraphNode *GraphShard::add_graph_node(uint64_t id) {
 }
 
 GraphNode *GraphShard::add_graph_node(Node *node) {
+  thaw_csr();
   auto id = node->get_id();
   if (node_location.find(id) == node_location.end()) {
     node_location[id] = bucket.size();
@@ -1197,9 +1203,54 @@ FeatureNode *GraphShard::add_feature_node(uint64_t id, bool is_overlap) {
 }
 
 void GraphShard::add_neighbor(uint64_t id, uint64_t dst_id, float weight) {
+  thaw_csr();
   find_node(id)->add_edge(dst_id, weight);
 }
 
+void GraphShard::build_csr() {
+  if (csr != nullptr) {
+    return;
+  }
+  std::unique_ptr<GraphCSR> new_csr(new GraphCSR());
+  new_csr->build(bucket);
+  auto &nodes = new_csr->nodes();
+  for (size_t i = 0; i < bucket.size(); i++) {
+    delete bucket[i];
+    bucket[i] = &nodes[i];
+  }
+  csr = std::move(new_csr);
+}
+
+void GraphShard::thaw_csr() {
+  if (csr == nullptr) {
+    return;
+  }
+  std::string sample_type = csr->sample_type();
+  for (size_t i = 0; i < bucket.size(); i++) {
+    GraphNode *node = new GraphNode(bucket[i]->get_id());
+    node->build_edges(csr->is_weighted());
+    size_t neighbor_size = bucket[i]->get_neighbor_size();
+    for (size_t j = 0; j < neighbor_size; j++) {
+      node->add_edge(bucket[i]->get_neighbor_id(j),
+                     bucket[i]->get_neighbor_weight(j));
+    }
+    // WeightedSampler can not be built on no edges
+    node->build_sampler(neighbor_size > 0 ? sample_type : "random");
+    bucket[i] = node;
+  }
+  csr.reset();
+}
+
+void GraphShard::build_sampler(const std::string &sample_type) {
+  if (csr != nullptr) {
+    csr->build_sampler(sample_type);
+    return;
+  }
+  for (size_t i = 0; i < bucket.size(); i++) {
+    bucket[i]->build_sampler(sample_type);
+  }
+}
+
 Node *GraphShard::find_node(uint64_t id) {
   auto iter = node_location.find(id);
   return iter == node_location.end() ? nullptr : bucket[iter->second];
@@ -1707,11 +1758,20 @@ int32_t GraphTable::load_nodes(const std::string &path, std::string node_type) {
 
 int32_t GraphTable::build_sampler(int idx, std::string sample_type) {
   for (auto &shard : edge_shards[idx]) {
-    auto bucket = shard->get_bucket();
-    for (size_t i = 0; i < bucket.size(); i++) {
-      bucket[i]->build_sampler(sample_type);
-    }
+    shard->build_sampler(sample_type);
+  }
+  return 0;
+}
+
+int32_t GraphTable::build_csr(int idx) {
+  std::vector<std::future<int>> tasks;
+  for (auto &shard : edge_shards[idx]) {
+    tasks.push_back(load_node_edge_task_pool->enqueue([&shard]() -> int {
+      shard->build_csr();
+      return 0;
+    }));
   }
+  for (size_t i = 0; i < tasks.size(); i++) tasks[i].get();
   return 0;
 }
 
@@ -1835,6 +1895,11 @@ int32_t GraphTable::load_edges(const std::string &path,
   }
 #endif
 
+  if (use_csr_storage) {
+    VLOG(0) << "build csr ... ";
+    build_csr(idx);
+  }
+
   if (!build_sampler_on_cpu) {
     // To reduce memory overhead, CPU samplers won't be created in gpugraph.
     // In order not to affect the sampler function of other scenario,
@@ -1844,10 +1909,7 @@ int32_t GraphTable::load_edges(const std::string &path,
     std::string sample_type = "random";
     VLOG(0) << "build sampler ... ";
     for (auto &shard : edge_shards[idx]) {
-      auto bucket = shard->get_bucket();
-      for (size_t i = 0; i < bucket.size(); i++) {
-        bucket[i]->build_sampler(sample_type);
-      }
+      shard->build_sampler(sample_type);
     }
   }
 
@@ -2542,6 +2604,7 @@ void GraphTable::load_node_weight(int type_id, int idx, std::string path) {
 int32_t GraphTable::Initialize(const GraphParameter &graph) {
   task_pool_size_ = graph.task_pool_size();
   build_sampler_on_cpu = graph.build_sampler_on_cpu();
+  use_csr_storage = graph.use_csr_storage();
 
 #ifdef PADDLE_WITH_HETERPS
   _db = NULL;
@@ -41,6 +41,7 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/graph/class_macro.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 #include "paddle/fluid/string/string_helper.h"
 #include "paddle/phi/core/utils/rw_lock.h"
@@ -126,6 +127,12 @@ class GraphShard {
   void delete_node(uint64_t id);
   void clear();
   void add_neighbor(uint64_t id, uint64_t dst_id, float weight);
+  // Moves the edges of the nodes into a GraphCSR, the nodes are turned back
+  // into GraphNodes by thaw_csr before the shard is changed.
+  void build_csr();
+  void thaw_csr();
+  GraphCSR *get_csr() { return csr.get(); }
+  void build_sampler(const std::string &sample_type);
   std::unordered_map<uint64_t, int> &get_node_location() {
     return node_location;
   }
@@ -155,6 +162,8 @@ class GraphShard {
  public:
   std::unordered_map<uint64_t, int> node_location;
   std::vector<Node *> bucket;
+  // owns the nodes of bucket once built
+  std::unique_ptr<GraphCSR> csr;
 };
 
 enum LRUResponse { ok = 0, blocked = 1, err = 2 };
@@ -742,6 +751,7 @@ class GraphTable : public Table {
 #endif
   virtual int32_t add_comm_edge(int idx, uint64_t src_id, uint64_t dst_id);
   virtual int32_t build_sampler(int idx, std::string sample_type = "random");
+  virtual int32_t build_csr(int idx);
   void set_slot_feature_separator(const std::string &ch);
   void set_feature_separator(const std::string &ch);
 
@@ -782,6 +792,7 @@ class GraphTable : public Table {
   int cache_ttl;
   mutable std::mutex mutex_;
   bool build_sampler_on_cpu;
+  bool use_csr_storage = false;
   bool is_load_reverse_edge = false;
   std::shared_ptr<pthread_rwlock_t> rw_lock;
 #ifdef PADDLE_WITH_HETERPS
@@ -16,6 +16,8 @@
 
 #include <gflags/gflags.h>
 
+#include <algorithm>
+
 #include "glog/logging.h"
 #include "paddle/fluid/string/string_helper.h"
 
@@ -221,6 +223,42 @@ int32_t CtrCommonAccessor::Select(float** select_values,
   return 0;
 }
 
+// from CommonFeatureValue in table storage to CtrCommonPullValue
+int32_t CtrCommonAccessor::SelectFromStorage(float** select_values,
+                                             const float** values,
+                                             const size_t* value_sizes,
+                                             size_t num) {
+  size_t embedx_dim = _config.embedx_dim();
+  size_t embedx_w_index = common_feature_value.EmbedxWIndex();
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    float* select_value = select_values[value_item];
+    const float* value = values[value_item];
+    size_t value_size = value_sizes[value_item];
+    if (value_size == 0) {
+      memset(select_value,
+             0,
+             CtrCommonPullValue::Dim(embedx_dim) * sizeof(float));
+      continue;
+    }
+    select_value[CtrCommonPullValue::ShowIndex()] =
+        value[common_feature_value.ShowIndex()];
+    select_value[CtrCommonPullValue::ClickIndex()] =
+        value[common_feature_value.ClickIndex()];
+    select_value[CtrCommonPullValue::EmbedWIndex()] =
+        value[common_feature_value.EmbedWIndex()];
+    size_t embedx_num =
+        value_size > embedx_w_index
+            ? std::min(embedx_dim, value_size - embedx_w_index)
+            : 0;
+    float* select_embedx = select_value + CtrCommonPullValue::EmbedxWIndex();
+    memcpy(select_embedx, value + embedx_w_index, embedx_num * sizeof(float));
+    memset(select_embedx + embedx_num,
+           0,
+           (embedx_dim - embedx_num) * sizeof(float));
+  }
+  return 0;
+}
+
 // from CtrCommonPushValue to CtrCommonPushValue
 // first dim: item
 // second dim: field num
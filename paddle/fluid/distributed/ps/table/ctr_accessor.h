@@ -163,6 +163,10 @@ class CtrCommonAccessor : public ValueAccessor {
   virtual int32_t Select(float** select_values,
                          const float** values,
                          size_t num);
+  int32_t SelectFromStorage(float** select_values,
+                            const float** values,
+                            const size_t* value_sizes,
+                            size_t num) override;
   // 将update_values聚合到一起
   virtual int32_t Merge(float** update_values,
                         const float** other_update_values,
@@ -178,12 +182,15 @@ class CtrCommonAccessor : public ValueAccessor {
   int32_t ParseFromString(const std::string& str, float* v) override;
   virtual bool CreateValue(int type, const float* value);
 
-  // 这个接口目前只用来取show
+  // 这个接口目前只用来取show和click
   float GetField(float* value, const std::string& name) override {
     // CHECK(name == "show");
     if (name == "show") {
       return common_feature_value.Show(value);
     }
+    if (name == "click") {
+      return common_feature_value.Click(value);
+    }
     return 0.0;
   }
 
@@ -200,12 +200,15 @@ class CtrDoubleAccessor : public ValueAccessor {
   std::string ParseToString(const float* value, int param) override;
   int32_t ParseFromString(const std::string& str, float* v) override;
   virtual bool CreateValue(int type, const float* value);
-  // 这个接口目前只用来取show
+  // 这个接口目前只用来取show和click
   float GetField(float* value, const std::string& name) override {
-    CHECK_EQ(name, "show");
+    CHECK(name == "show" || name == "click") << "unknown field: " << name;
     if (name == "show") {
       return static_cast<float>(CtrDoubleFeatureValue::Show(value));
     }
+    if (name == "click") {
+      return static_cast<float>(CtrDoubleFeatureValue::Click(value));
+    }
     return 0.0;
   }
   // DEFINE_GET_INDEX(CtrDoubleFeatureValue, show)
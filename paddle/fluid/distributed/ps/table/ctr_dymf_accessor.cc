@@ -16,6 +16,8 @@
 
 #include <gflags/gflags.h>
 
+#include <algorithm>
+
 #include "glog/logging.h"
 #include "paddle/fluid/string/string_helper.h"
 
@@ -243,6 +245,44 @@ int32_t CtrDymfAccessor::Select(float** select_values,
   return 0;
 }
 
+// from CtrDymfFeatureValue in table storage to CtrDymfPullValue, MfDim is
+// left untouched as in Select
+int32_t CtrDymfAccessor::SelectFromStorage(float** select_values,
+                                           const float** values,
+                                           const size_t* value_sizes,
+                                           size_t num) {
+  size_t embedx_dim = _config.embedx_dim();
+  size_t embedx_w_index = common_feature_value.EmbedxWIndex();
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    float* select_value = select_values[value_item];
+    const float* value = values[value_item];
+    size_t value_size = value_sizes[value_item];
+    float* select_embedx = select_value + CtrDymfPullValue::EmbedxWIndex();
+    if (value_size == 0) {
+      select_value[CtrDymfPullValue::ShowIndex()] = 0;
+      select_value[CtrDymfPullValue::ClickIndex()] = 0;
+      select_value[CtrDymfPullValue::EmbedWIndex()] = 0;
+      memset(select_embedx, 0, embedx_dim * sizeof(float));
+      continue;
+    }
+    select_value[CtrDymfPullValue::ShowIndex()] =
+        value[common_feature_value.ShowIndex()];
+    select_value[CtrDymfPullValue::ClickIndex()] =
+        value[common_feature_value.ClickIndex()];
+    select_value[CtrDymfPullValue::EmbedWIndex()] =
+        value[common_feature_value.EmbedWIndex()];
+    size_t embedx_num =
+        value_size > embedx_w_index
+            ? std::min(embedx_dim, value_size - embedx_w_index)
+            : 0;
+    memcpy(select_embedx, value + embedx_w_index, embedx_num * sizeof(float));
+    memset(select_embedx + embedx_num,
+           0,
+           (embedx_dim - embedx_num) * sizeof(float));
+  }
+  return 0;
+}
+
 // from CtrDymfPushValue to CtrDymfPushValue
 // first dim: item
 // second dim: field num
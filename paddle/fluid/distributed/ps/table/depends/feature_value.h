@@ -15,6 +15,9 @@
 #pragma once
 
 #include <mct/hash-map.hpp>
+#include <algorithm>
+#include <cstring>
+#include <utility>
 #include <vector>
 
 #include "gflags/gflags.h"
@@ -26,20 +29,235 @@ namespace distributed {
 static const int CTR_SPARSE_SHARD_BUCKET_NUM_BITS = 6;
 static const size_t CTR_SPARSE_SHARD_BUCKET_NUM =
     static_cast<size_t>(1) << CTR_SPARSE_SHARD_BUCKET_NUM_BITS;
+// number of keys hashed and probed together by find_batch/emplace_batch
+static const size_t CTR_SPARSE_SHARD_BATCH_BLOCK = 64;
 
+// The floats of a feature. A value created by a SparseTableShard keeps up
+// to capacity() floats inline right after the object, so a lookup reaches
+// the payload without another pointer chase. A value resized beyond its
+// capacity moves the payload to the heap but stays at the same address, as
+// callers of PullSparsePtr keep pointers to it.
 class FixedFeatureValue {
  public:
   FixedFeatureValue() {}
-  ~FixedFeatureValue() {}
-  float* data() { return _data.data(); }
-  size_t size() { return _data.size(); }
-  void resize(size_t size) { _data.resize(size); }
-  void shrink_to_fit() { _data.shrink_to_fit(); }
+  FixedFeatureValue(const FixedFeatureValue& other) { *this = other; }
+  FixedFeatureValue& operator=(const FixedFeatureValue& other) {
+    if (this != &other) {
+      resize(other._size);
+      if (_size > 0) {
+        memcpy(_data, other._data, _size * sizeof(float));
+      }
+      _save_epoch = other._save_epoch;
+    }
+    return *this;
+  }
+  ~FixedFeatureValue() {
+    if (_data != inline_data()) {
+      free(_data);
+    }
+  }
+
+  float* data() { return _data; }
+  size_t size() { return _size; }
+  size_t capacity() const { return _capacity; }
+  // keep the existing data and fill the extended part with zero, the same as
+  // std::vector::resize
+  void resize(size_t size) {
+    if (size == _size) {
+      return;
+    }
+    float* data = inline_data();
+    if (size > _capacity) {
+      data = reinterpret_cast<float*>(malloc(size * sizeof(float)));
+    }
+    size_t keep_size = std::min(size, static_cast<size_t>(_size));
+    if (data != _data) {
+      if (keep_size > 0) {
+        memcpy(data, _data, keep_size * sizeof(float));
+      }
+      if (_data != inline_data()) {
+        free(_data);
+      }
+    }
+    if (size > keep_size) {
+      memset(data + keep_size, 0, (size - keep_size) * sizeof(float));
+    }
+    _data = size > 0 ? data : inline_data();
+    _size = static_cast<uint32_t>(size);
+  }
+  // heap payloads are always allocated with the exact size
+  void shrink_to_fit() {}
+
+  // The save epoch of its shard in which the key of the value was last
+  // marked dirty, see MemorySparseTable::DirtyKeys.
+  uint32_t save_epoch() const { return _save_epoch; }
+  void set_save_epoch(uint32_t save_epoch) { _save_epoch = save_epoch; }
 
  private:
-  std::vector<float> _data;
+  friend class FeatureValueArena;
+  explicit FixedFeatureValue(uint32_t capacity) : _capacity(capacity) {}
+
+  float* inline_data() { return reinterpret_cast<float*>(this + 1); }
+
+  float* _data = inline_data();
+  uint32_t _size = 0;
+  uint32_t _save_epoch = 0;
+  uint32_t _capacity = 0;
 };
 
+// Allocates the FixedFeatureValues of one SparseTableShard together with
+// their inline floats. Blocks of the same capacity are carved out of the
+// same slabs and recycled by a free list, so values with and without
+// embedx live in separate slabs. Like the hash map of the shard, it is only
+// used by the thread that inserts into or erases from the shard, and so
+// takes no lock.
+class FeatureValueArena {
+ public:
+  explicit FeatureValueArena(size_t slab_bytes = 1 << 20)
+      : _slab_bytes(slab_bytes) {}
+  FeatureValueArena(const FeatureValueArena&) = delete;
+  ~FeatureValueArena() {
+    for (char* slab : _slabs) {
+      free(slab);
+    }
+  }
+
+  FixedFeatureValue* acquire(size_t capacity) {
+    SizeClass& size_class = get_size_class(capacity);
+    Node* node = size_class.free_nodes;
+    if (node != NULL) {
+      size_class.free_nodes = node->next;
+    } else {
+      if (size_class.cur + size_class.block_bytes > size_class.end) {
+        create_new_slab(&size_class);
+      }
+      node = reinterpret_cast<Node*>(size_class.cur);
+      size_class.cur += size_class.block_bytes;
+    }
+    size_class.used_blocks++;
+    _size++;
+    return new (node) FixedFeatureValue(static_cast<uint32_t>(capacity));
+  }
+
+  void release(FixedFeatureValue* value) {
+    SizeClass& size_class = get_size_class(value->capacity());
+    value->~FixedFeatureValue();
+    Node* node = reinterpret_cast<Node*>(value);
+    node->next = size_class.free_nodes;
+    size_class.free_nodes = node;
+    size_class.used_blocks--;
+    _size--;
+  }
+
+  size_t size() const { return _size; }
+
+  // bytes of all slabs, including free blocks
+  size_t reserved_bytes() const { return _reserved_bytes; }
+
+  // bytes of the values in use with their inline floats
+  size_t used_bytes() const {
+    size_t bytes = 0;
+    for (auto& size_class : _size_classes) {
+      bytes += size_class.used_blocks * size_class.block_bytes;
+    }
+    return bytes;
+  }
+
+ private:
+  struct Node {
+    Node* next;
+  };
+  struct SizeClass {
+    size_t capacity;
+    size_t block_bytes;
+    char* cur;
+    char* end;
+    Node* free_nodes;
+    size_t used_blocks;
+  };
+
+  SizeClass& get_size_class(size_t capacity) {
+    // only a few capacities (with or without embedx) are used by one table
+    for (auto& size_class : _size_classes) {
+      if (size_class.capacity == capacity) {
+        return size_class;
+      }
+    }
+    size_t block_bytes = sizeof(FixedFeatureValue) + capacity * sizeof(float);
+    block_bytes = (block_bytes + alignof(FixedFeatureValue) - 1) /
+                  alignof(FixedFeatureValue) * alignof(FixedFeatureValue);
+    _size_classes.push_back({capacity, block_bytes, NULL, NULL, NULL, 0});
+    return _size_classes.back();
+  }
+
+  void create_new_slab(SizeClass* size_class) {
+    size_t slab_bytes = std::max(_slab_bytes, size_class->block_bytes);
+    char* slab = NULL;
+    posix_memalign(reinterpret_cast<void**>(&slab), 64, slab_bytes);
+    CHECK(slab != NULL) << "failed to allocate " << slab_bytes
+                        << " bytes for feature values";
+    _slabs.push_back(slab);
+    _reserved_bytes += slab_bytes;
+    size_class->cur = slab;
+    size_class->end = slab + slab_bytes;
+  }
+
+  size_t _slab_bytes;
+  size_t _reserved_bytes = 0;
+  size_t _size = 0;
+  std::vector<char*> _slabs;
+  std::vector<SizeClass> _size_classes;
+};
+
+// Allocates the values of a SparseTableShard. The capacity passed by the
+// shard is the number of floats a FixedFeatureValue keeps inline, other
+// values ignore it.
+template <class VALUE>
+class ShardValueAllocator {
+ public:
+  template <class... ARGS>
+  VALUE* acquire(size_t capacity, ARGS&&... args) {
+    return _alloc.acquire(std::forward<ARGS>(args)...);
+  }
+  void release(VALUE* value) { _alloc.release(value); }
+  size_t size() const { return _alloc.size(); }
+
+ private:
+  ChunkAllocator<VALUE> _alloc;
+};
+
+template <>
+class ShardValueAllocator<FixedFeatureValue> {
+ public:
+  FixedFeatureValue* acquire(size_t capacity) {
+    return _arena.acquire(capacity);
+  }
+  FixedFeatureValue* acquire(size_t capacity, const FixedFeatureValue& other) {
+    FixedFeatureValue* value = _arena.acquire(capacity);
+    *value = other;
+    return value;
+  }
+  void release(FixedFeatureValue* value) { _arena.release(value); }
+  size_t size() const { return _arena.size(); }
+  size_t reserved_bytes() const { return _arena.reserved_bytes(); }
+  size_t used_bytes() const { return _arena.used_bytes(); }
+
+ private:
+  FeatureValueArena _arena;
+};
+
+// Prefetch the value found by SparseTableShard::find_batch, the inline
+// floats of a FixedFeatureValue may reach into the next cache line.
+template <class VALUE>
+inline void PrefetchValue(VALUE* value) {
+  __builtin_prefetch(value);
+}
+
+inline void PrefetchValue(FixedFeatureValue* value) {
+  __builtin_prefetch(value);
+  __builtin_prefetch(reinterpret_cast<char*>(value) + 64);
+}
+
 template <class KEY, class VALUE>
 struct alignas(64) SparseTableShard {
  public:
@@ -135,7 +353,66 @@ struct alignas(64) SparseTableShard {
     }
     return {it, bucket, _buckets};
   }
+  // Look up keys[0, num) and set values[i] to NULL if keys[i] is missing.
+  // Keys are hashed and probed block by block, the probes of a block do not
+  // depend on each other so their cache misses overlap, and the payloads are
+  // prefetched for the caller.
+  void find_batch(const KEY* keys, size_t num, VALUE** values) {
+    size_t hashes[CTR_SPARSE_SHARD_BATCH_BLOCK];
+    for (size_t begin = 0; begin < num;
+         begin += CTR_SPARSE_SHARD_BATCH_BLOCK) {
+      size_t block = std::min(num - begin, CTR_SPARSE_SHARD_BATCH_BLOCK);
+      for (size_t i = 0; i < block; ++i) {
+        hashes[i] = _hasher(keys[begin + i]);
+      }
+      for (size_t i = 0; i < block; ++i) {
+        map_type& data = _buckets[compute_bucket(hashes[i])];
+        auto it = data.find_with_hash(keys[begin + i], hashes[i]);
+        values[begin + i] =
+            it == data.end() ? NULL : (VALUE*)(void*)it->second;  // NOLINT
+      }
+      for (size_t i = 0; i < block; ++i) {
+        if (values[begin + i] != NULL) {
+          PrefetchValue(values[begin + i]);
+        }
+      }
+    }
+  }
+  // Same as find_batch, but the missing keys are inserted with VALUE() and
+  // created[i] is set to true for them. A FixedFeatureValue created here
+  // keeps up to capacity floats inline.
+  void emplace_batch(const KEY* keys,
+                     size_t num,
+                     VALUE** values,
+                     bool* created,
+                     size_t capacity = 0) {
+    size_t hashes[CTR_SPARSE_SHARD_BATCH_BLOCK];
+    for (size_t begin = 0; begin < num;
+         begin += CTR_SPARSE_SHARD_BATCH_BLOCK) {
+      size_t block = std::min(num - begin, CTR_SPARSE_SHARD_BATCH_BLOCK);
+      for (size_t i = 0; i < block; ++i) {
+        hashes[i] = _hasher(keys[begin + i]);
+      }
+      for (size_t i = 0; i < block; ++i) {
+        map_type& data = _buckets[compute_bucket(hashes[i])];
+        auto res = data.insert_with_hash({keys[begin + i], NULL}, hashes[i]);
+        if (res.second) {
+          res.first->second = _alloc.acquire(capacity);
+        }
+        values[begin + i] = (VALUE*)(void*)res.first->second;  // NOLINT
+        created[begin + i] = res.second;
+      }
+      for (size_t i = 0; i < block; ++i) {
+        PrefetchValue(values[begin + i]);
+      }
+    }
+  }
   VALUE& operator[](const KEY& key) { return emplace(key).first.value(); }
+  // Same as operator[], but a FixedFeatureValue created for the key keeps up
+  // to capacity floats inline, so it is the size the caller resizes it to.
+  VALUE& get_or_create(const KEY& key, size_t capacity) {
+    return emplace_with_capacity(key, capacity).first.value();
+  }
   std::pair<iterator, bool> insert(const KEY& key, const VALUE& val) {
     return emplace(key, val);
   }
@@ -144,12 +421,19 @@ struct alignas(64) SparseTableShard {
   }
   template <class... ARGS>
   std::pair<iterator, bool> emplace(const KEY& key, ARGS&&... args) {
+    return emplace_with_capacity(key, 0, std::forward<ARGS>(args)...);
+  }
+  template <class... ARGS>
+  std::pair<iterator, bool> emplace_with_capacity(const KEY& key,
+                                                  size_t capacity,
+                                                  ARGS&&... args) {
     size_t hash = _hasher(key);
     size_t bucket = compute_bucket(hash);
     auto res = _buckets[bucket].insert_with_hash({key, NULL}, hash);
 
     if (res.second) {
-      res.first->second = _alloc.acquire(std::forward<ARGS>(args)...);
+      res.first->second =
+          _alloc.acquire(capacity, std::forward<ARGS>(args)...);
     }
 
     return {{res.first, bucket, _buckets}, res.second};
@@ -184,6 +468,9 @@ struct alignas(64) SparseTableShard {
     quick_erase(it);
     return 1;
   }
+  // memory of the values in slabs, see FeatureValueArena
+  size_t value_reserved_bytes() const { return _alloc.reserved_bytes(); }
+  size_t value_used_bytes() const { return _alloc.used_bytes(); }
   size_t compute_bucket(size_t hash) {
     if (CTR_SPARSE_SHARD_BUCKET_NUM == 1) {
       return 0;
@@ -194,7 +481,7 @@ struct alignas(64) SparseTableShard {
 
  private:
   map_type _buckets[CTR_SPARSE_SHARD_BUCKET_NUM];
-  ChunkAllocator<VALUE> _alloc;
+  ShardValueAllocator<VALUE> _alloc;
   std::hash<KEY> _hasher;
 };
 
@@ -184,6 +184,14 @@ class RocksDBHandler {
     return 0;
   }
 
+  int write(int id, rocksdb::WriteBatch* batch) {
+    rocksdb::WriteOptions options;
+    options.disableWAL = true;
+    rocksdb::Status s = _dbs[id]->Write(options, batch);
+    assert(s.ok());
+    return 0;
+  }
+
   int get(int id, const char* key, int key_len, std::string& value) {  // NOLINT
     rocksdb::Status s = _dbs[id]->Get(
         rocksdb::ReadOptions(), rocksdb::Slice(key, key_len), &value);
@@ -0,0 +1,427 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+#include <utility>
+
+#include "glog/logging.h"
+namespace paddle {
+namespace distributed {
+
+namespace {
+const uint64_t kGraphCSRMagic = 0x3152534370617247ULL;  // "GrapCSR1"
+// duplicates of fewer samples are looked up linearly
+const int kLinearDedupSize = 16;
+}  // namespace
+
+std::vector<int> CSRGraphNode::sample_k(
+    int k, const std::shared_ptr<std::mt19937_64> rng) {
+  return csr->sample_k(row, k, rng);
+}
+
+uint64_t CSRGraphNode::get_neighbor_id(int idx) {
+  return csr->neighbor_id(row, idx);
+}
+
+float CSRGraphNode::get_neighbor_weight(int idx) {
+  return csr->neighbor_weight(row, idx);
+}
+
+size_t CSRGraphNode::get_neighbor_size() { return csr->neighbor_size(row); }
+
+GraphCSR::~GraphCSR() { release(); }
+
+size_t GraphCSR::region_size(const Header &header) {
+  size_t size = sizeof(Header);
+  size += header.node_num * sizeof(uint64_t);
+  size += (header.node_num + 1) * sizeof(uint64_t);
+  size += header.edge_num * sizeof(uint64_t);
+  if (header.is_weighted) {
+    size += header.edge_num * sizeof(float);
+  }
+  if (header.has_alias) {
+    size += header.edge_num * (sizeof(float) + sizeof(uint32_t));
+  }
+  return size;
+}
+
+bool GraphCSR::check_region(const char *region, size_t size) {
+  if (size < sizeof(Header)) return false;
+  Header header;
+  memcpy(&header, region, sizeof(Header));
+  // each node and edge takes at least a uint64, so the counts bounded by the
+  // size keep region_size from overflowing
+  size_t max_num = size / sizeof(uint64_t);
+  if (header.magic != kGraphCSRMagic || header.node_num >= max_num ||
+      header.edge_num >= max_num || region_size(header) > size) {
+    return false;
+  }
+  const char *offsets_begin =
+      region + sizeof(Header) + header.node_num * sizeof(uint64_t);
+  const auto *offsets = reinterpret_cast<const uint64_t *>(offsets_begin);
+  if (offsets[0] != 0 || offsets[header.node_num] != header.edge_num) {
+    return false;
+  }
+  for (uint64_t row = 0; row < header.node_num; row++) {
+    if (offsets[row] > offsets[row + 1]) return false;
+  }
+  if (header.has_alias) {
+    // an alias is an index in the row of its edge
+    const char *alias_begin = offsets_begin +
+                              (header.node_num + 1) * sizeof(uint64_t) +
+                              header.edge_num * sizeof(uint64_t) +
+                              header.edge_num * sizeof(float);
+    if (header.is_weighted) {
+      alias_begin += header.edge_num * sizeof(float);
+    }
+    const auto *alias = reinterpret_cast<const uint32_t *>(alias_begin);
+    for (uint64_t row = 0; row < header.node_num; row++) {
+      for (uint64_t j = offsets[row]; j < offsets[row + 1]; j++) {
+        if (alias[j] >= offsets[row + 1] - offsets[row]) return false;
+      }
+    }
+  }
+  return true;
+}
+
+char *GraphCSR::allocate(const Header &header,
+                         std::vector<uint64_t> *storage) {
+  size_t size = region_size(header);
+  storage->assign((size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+  char *region = reinterpret_cast<char *>(storage->data());
+  memcpy(region, &header, sizeof(Header));
+  return region;
+}
+
+void GraphCSR::attach(const char *region) {
+  Header header;
+  memcpy(&header, region, sizeof(Header));
+  _node_num = header.node_num;
+  _edge_num = header.edge_num;
+  region += sizeof(Header);
+  _node_ids = reinterpret_cast<const uint64_t *>(region);
+  region += _node_num * sizeof(uint64_t);
+  _offsets = reinterpret_cast<const uint64_t *>(region);
+  region += (_node_num + 1) * sizeof(uint64_t);
+  _neighbor_ids = reinterpret_cast<const uint64_t *>(region);
+  region += _edge_num * sizeof(uint64_t);
+  _weights = nullptr;
+  if (header.is_weighted) {
+    _weights = reinterpret_cast<const float *>(region);
+    region += _edge_num * sizeof(float);
+  }
+  _alias_prob = nullptr;
+  _alias_idx = nullptr;
+  if (header.has_alias) {
+    _alias_prob = reinterpret_cast<const float *>(region);
+    region += _edge_num * sizeof(float);
+    _alias_idx = reinterpret_cast<const uint32_t *>(region);
+  }
+}
+
+void GraphCSR::release() {
+  if (_mapped != nullptr) {
+    munmap(_mapped, _mapped_size);
+    _mapped = nullptr;
+    _mapped_size = 0;
+  }
+  std::vector<uint64_t>().swap(_storage);
+  _node_num = _edge_num = 0;
+  _node_ids = _offsets = _neighbor_ids = nullptr;
+  _weights = _alias_prob = nullptr;
+  _alias_idx = nullptr;
+}
+
+void GraphCSR::build_nodes() {
+  _nodes.clear();
+  _nodes.reserve(_node_num);
+  for (size_t i = 0; i < _node_num; i++) {
+    _nodes.emplace_back(_node_ids[i], this, i);
+  }
+}
+
+void GraphCSR::build(const std::vector<Node *> &nodes) {
+  Header header = {kGraphCSRMagic, nodes.size(), 0, 0, 0};
+  for (auto *node : nodes) {
+    size_t size = node->get_neighbor_size();
+    header.edge_num += size;
+    for (size_t j = 0; j < size && !header.is_weighted; j++) {
+      header.is_weighted = node->get_neighbor_weight(j) != 1;
+    }
+  }
+  std::vector<uint64_t> storage;
+  char *region = allocate(header, &storage);
+  release();
+  _storage.swap(storage);
+  attach(region);
+
+  auto *node_ids = const_cast<uint64_t *>(_node_ids);
+  auto *offsets = const_cast<uint64_t *>(_offsets);
+  auto *neighbor_ids = const_cast<uint64_t *>(_neighbor_ids);
+  auto *weights = const_cast<float *>(_weights);
+  offsets[0] = 0;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    node_ids[i] = nodes[i]->get_id();
+    size_t size = nodes[i]->get_neighbor_size();
+    for (size_t j = 0; j < size; j++) {
+      neighbor_ids[offsets[i] + j] = nodes[i]->get_neighbor_id(j);
+      if (weights != nullptr) {
+        weights[offsets[i] + j] = nodes[i]->get_neighbor_weight(j);
+      }
+    }
+    offsets[i + 1] = offsets[i] + size;
+  }
+  _weighted_sample = false;
+  build_nodes();
+}
+
+void GraphCSR::build_sampler(const std::string &sample_type) {
+  _weighted_sample = sample_type == "weighted";
+  if (!_weighted_sample || _weights == nullptr || _alias_prob != nullptr) {
+    return;
+  }
+  const char *old_region =
+      _mapped != nullptr ? reinterpret_cast<const char *>(_mapped)
+                         : reinterpret_cast<const char *>(_storage.data());
+  Header header;
+  memcpy(&header, old_region, sizeof(Header));
+  size_t old_size = region_size(header);
+  header.has_alias = 1;
+  std::vector<uint64_t> storage;
+  char *region = allocate(header, &storage);
+  memcpy(region + sizeof(Header),
+         old_region + sizeof(Header),
+         old_size - sizeof(Header));
+  // the nodes keep pointing at this object, only the arrays move
+  release();
+  _storage.swap(storage);
+  attach(region);
+
+  auto *prob = const_cast<float *>(_alias_prob);
+  auto *alias = const_cast<uint32_t *>(_alias_idx);
+  std::vector<double> scaled;
+  std::vector<uint32_t> small, large;
+  for (size_t row = 0; row < _node_num; row++) {
+    size_t start = _offsets[row];
+    size_t size = neighbor_size(row);
+    double sum = 0;
+    for (size_t j = 0; j < size; j++) {
+      sum += std::max(_weights[start + j], 0.0f);
+    }
+    scaled.resize(size);
+    small.clear();
+    large.clear();
+    for (size_t j = 0; j < size; j++) {
+      prob[start + j] = 1;
+      alias[start + j] = j;
+      scaled[j] =
+          sum > 0 ? std::max(_weights[start + j], 0.0f) * size / sum : 1;
+      if (scaled[j] < 1) {
+        small.push_back(j);
+      } else {
+        large.push_back(j);
+      }
+    }
+    while (!small.empty() && !large.empty()) {
+      uint32_t s = small.back();
+      uint32_t l = large.back();
+      small.pop_back();
+      prob[start + s] = scaled[s];
+      alias[start + s] = l;
+      scaled[l] += scaled[s] - 1;
+      if (scaled[l] < 1) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+  }
+}
+
+int32_t GraphCSR::save(const std::string &path) const {
+  const char *region =
+      _mapped != nullptr ? reinterpret_cast<const char *>(_mapped)
+                         : reinterpret_cast<const char *>(_storage.data());
+  if (region == nullptr) {
+    VLOG(0) << "GraphCSR is not built, nothing is saved to " << path;
+    return -1;
+  }
+  Header header;
+  memcpy(&header, region, sizeof(Header));
+  size_t size = region_size(header);
+  FILE *fp = fopen(path.c_str(), "wb");
+  if (fp == nullptr) {
+    VLOG(0) << "fail to open " << path;
+    return -1;
+  }
+  size_t written = fwrite(region, 1, size, fp);
+  if (fclose(fp) != 0 || written != size) {
+    VLOG(0) << "fail to write GraphCSR to " << path;
+    return -1;
+  }
+  return 0;
+}
+
+int32_t GraphCSR::load(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    VLOG(0) << "fail to open " << path;
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    VLOG(0) << path << " is not a GraphCSR file";
+    close(fd);
+    return -1;
+  }
+  size_t size = st.st_size;
+  void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    VLOG(0) << "fail to mmap " << path;
+    return -1;
+  }
+  if (!check_region(reinterpret_cast<const char *>(mapped), size)) {
+    VLOG(0) << path << " is not a GraphCSR file";
+    munmap(mapped, size);
+    return -1;
+  }
+  release();
+  _mapped = mapped;
+  _mapped_size = size;
+  attach(reinterpret_cast<const char *>(mapped));
+  _weighted_sample = false;
+  build_nodes();
+  return 0;
+}
+
+int GraphCSR::uniform_index(size_t size, std::mt19937_64 *rng) const {
+  std::uniform_int_distribution<int> distrib(0, size - 1);
+  return distrib(*rng);
+}
+
+int GraphCSR::alias_index(size_t row, std::mt19937_64 *rng) const {
+  size_t start = _offsets[row];
+  int idx = uniform_index(neighbor_size(row), rng);
+  std::uniform_real_distribution<float> distrib(0, 1.0);
+  return distrib(*rng) < _alias_prob[start + idx] ? idx
+                                                   : _alias_idx[start + idx];
+}
+
+void GraphCSR::weighted_sample_rest(size_t row,
+                                    int k,
+                                    std::mt19937_64 *rng,
+                                    std::vector<int> *res) const {
+  // the largest log(u) / weight among the neighbors not sampled yet, which
+  // draws them with the same probabilities as the rejected alias draws
+  size_t start = _offsets[row];
+  size_t size = neighbor_size(row);
+  std::vector<char> sampled(size, 0);
+  for (int idx : *res) {
+    sampled[idx] = 1;
+  }
+  std::uniform_real_distribution<double> distrib(0, 1.0);
+  std::vector<std::pair<double, int>> keys;
+  keys.reserve(size - res->size());
+  for (size_t j = 0; j < size; j++) {
+    if (sampled[j]) {
+      continue;
+    }
+    double weight = _weights[start + j];
+    double key = weight > 0 ? std::log(1.0 - distrib(*rng)) / weight
+                            : -std::numeric_limits<double>::infinity();
+    keys.emplace_back(key, j);
+  }
+  size_t rest = k - res->size();
+  std::partial_sort(keys.begin(),
+                    keys.begin() + rest,
+                    keys.end(),
+                    std::greater<std::pair<double, int>>());
+  for (size_t i = 0; i < rest; i++) {
+    res->push_back(keys[i].second);
+  }
+}
+
+std::vector<int> GraphCSR::sample_k(
+    size_t row, int k, const std::shared_ptr<std::mt19937_64> rng) const {
+  size_t size = neighbor_size(row);
+  std::vector<int> sample_result;
+  if (k <= 0) {
+    return sample_result;
+  }
+  if (static_cast<size_t>(k) >= size) {
+    sample_result.resize(size);
+    std::iota(sample_result.begin(), sample_result.end(), 0);
+    return sample_result;
+  }
+  bool weighted = _weighted_sample && _alias_prob != nullptr;
+  sample_result.reserve(k);
+  if (static_cast<size_t>(k) * 2 <= size) {
+    // draws with replacement and rejects the duplicates, heavy neighbors may
+    // be rejected too often, the rest is then sampled in O(size)
+    std::unordered_set<int> drawn;
+    int attempts = k * 4 + 16;
+    while (static_cast<int>(sample_result.size()) < k && attempts-- > 0) {
+      int idx = weighted ? alias_index(row, rng.get())
+                         : uniform_index(size, rng.get());
+      if (k <= kLinearDedupSize) {
+        if (std::find(sample_result.begin(), sample_result.end(), idx) !=
+            sample_result.end()) {
+          continue;
+        }
+      } else if (!drawn.insert(idx).second) {
+        continue;
+      }
+      sample_result.push_back(idx);
+    }
+  }
+  if (static_cast<int>(sample_result.size()) == k) {
+    return sample_result;
+  }
+  if (weighted) {
+    weighted_sample_rest(row, k, rng.get(), &sample_result);
+    return sample_result;
+  }
+  std::vector<char> sampled(size, 0);
+  for (int idx : sample_result) {
+    sampled[idx] = 1;
+  }
+  std::vector<int> rest;
+  rest.reserve(size - sample_result.size());
+  for (size_t j = 0; j < size; j++) {
+    if (!sampled[j]) {
+      rest.push_back(j);
+    }
+  }
+  for (size_t i = 0; static_cast<int>(sample_result.size()) < k; i++) {
+    std::uniform_int_distribution<size_t> distrib(i, rest.size() - 1);
+    std::swap(rest[i], rest[distrib(*rng)]);
+    sample_result.push_back(rest[i]);
+  }
+  return sample_result;
+}
+}  // namespace distributed
+}  // namespace paddle
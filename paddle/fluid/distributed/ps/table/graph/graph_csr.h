@@ -0,0 +1,130 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+namespace paddle {
+namespace distributed {
+
+class GraphCSR;
+
+// A node whose edges are the row of a GraphCSR, it owns nothing.
+class CSRGraphNode : public Node {
+ public:
+  CSRGraphNode(uint64_t id, const GraphCSR *csr, size_t row)
+      : Node(id), csr(csr), row(row) {}
+  virtual ~CSRGraphNode() {}
+  virtual std::vector<int> sample_k(
+      int k, const std::shared_ptr<std::mt19937_64> rng);
+  virtual uint64_t get_neighbor_id(int idx);
+  virtual float get_neighbor_weight(int idx);
+  virtual size_t get_neighbor_size();
+
+ protected:
+  const GraphCSR *csr;
+  size_t row;
+};
+
+// The edges of a shard in compressed sparse rows, the neighbors of row i are
+// neighbor_ids[offsets[i], offsets[i + 1]). All arrays live in one region
+// which is either owned or mapped from a file written by save, and are not
+// changed once built. The "weighted" sampler draws a neighbor from the alias
+// table of its row in O(1).
+class GraphCSR {
+ public:
+  GraphCSR() {}
+  ~GraphCSR();
+  GraphCSR(const GraphCSR &) = delete;
+  GraphCSR &operator=(const GraphCSR &) = delete;
+
+  // Row i holds the edges of nodes[i]. The weights are kept only if some
+  // edge is not of weight 1.
+  void build(const std::vector<Node *> &nodes);
+  // "random" samples uniformly, "weighted" builds the alias tables.
+  void build_sampler(const std::string &sample_type);
+  int32_t save(const std::string &path) const;
+  // Maps a file written by save.
+  int32_t load(const std::string &path);
+
+  size_t node_num() const { return _node_num; }
+  size_t edge_num() const { return _edge_num; }
+  bool is_weighted() const { return _weights != nullptr; }
+  std::string sample_type() const {
+    return _weighted_sample ? "weighted" : "random";
+  }
+  // The nodes of the rows, in the order of build.
+  std::vector<CSRGraphNode> &nodes() { return _nodes; }
+
+  size_t neighbor_size(size_t row) const {
+    return _offsets[row + 1] - _offsets[row];
+  }
+  uint64_t neighbor_id(size_t row, size_t idx) const {
+    return _neighbor_ids[_offsets[row] + idx];
+  }
+  float neighbor_weight(size_t row, size_t idx) const {
+    return _weights == nullptr ? 1 : _weights[_offsets[row] + idx];
+  }
+  // k distinct neighbors of row, all of them if it has no more than k.
+  std::vector<int> sample_k(size_t row,
+                            int k,
+                            const std::shared_ptr<std::mt19937_64> rng) const;
+
+ private:
+  struct Header {
+    uint64_t magic;
+    uint64_t node_num;
+    uint64_t edge_num;
+    uint32_t is_weighted;
+    uint32_t has_alias;
+  };
+
+  static size_t region_size(const Header &header);
+  // Whether a region of size bytes read from a file can be attached.
+  static bool check_region(const char *region, size_t size);
+  static char *allocate(const Header &header,
+                        std::vector<uint64_t> *storage);
+  void attach(const char *region);
+  void build_nodes();
+  void release();
+  int uniform_index(size_t size, std::mt19937_64 *rng) const;
+  int alias_index(size_t row, std::mt19937_64 *rng) const;
+  void weighted_sample_rest(size_t row,
+                            int k,
+                            std::mt19937_64 *rng,
+                            std::vector<int> *res) const;
+
+  size_t _node_num = 0;
+  size_t _edge_num = 0;
+  const uint64_t *_node_ids = nullptr;
+  const uint64_t *_offsets = nullptr;
+  const uint64_t *_neighbor_ids = nullptr;
+  const float *_weights = nullptr;
+  const float *_alias_prob = nullptr;
+  const uint32_t *_alias_idx = nullptr;
+  bool _weighted_sample = false;
+  // the owned region, or the mapping of _mapped_size bytes
+  std::vector<uint64_t> _storage;
+  void *_mapped = nullptr;
+  size_t _mapped_size = 0;
+  std::vector<CSRGraphNode> _nodes;
+};
+}  // namespace distributed
+}  // namespace paddle
@@ -70,7 +70,7 @@ int32_t MemorySparseGeoTable::PushSparseParam(const uint64_t* keys,
           for (size_t i = 0; i < offsets.size(); ++i) {
             auto offset = offsets[i];
             auto id = keys[offset];
-            auto& feature_value = local_shard[id];
+            auto& feature_value = local_shard.get_or_create(id, _dim);
             feature_value.resize(_dim);
             std::copy_n(values + _dim * offset, _dim, feature_value.data());
             if (i < 10) {
@@ -168,7 +168,7 @@ int32_t MemorySparseGeoTable::PullSparse(float* pull_values,
             auto itr = local_shard.find(key);
             if (itr == local_shard.end()) {
               // ++missed_keys;
-              auto& feature_value = local_shard[key];
+              auto& feature_value = local_shard.get_or_create(key, _dim);
               feature_value.resize(_dim);
               memset(feature_value.data(), 0, sizeof(float) * _dim);
               VLOG(0) << "MemorySparseGeoTable PullSparse key not found!!! "
@@ -217,7 +217,7 @@ int32_t MemorySparseGeoTable::_PushSparse(const uint64_t* keys,
             auto itr = local_shard.find(key);
             if (itr == local_shard.end()) {
               VLOG(0) << "sparse geo table push not found key!!! " << key;
-              auto& feature_value = local_shard[key];
+              auto& feature_value = local_shard.get_or_create(key, _dim);
               feature_value.resize(_dim);
               memset(feature_value.data(), 0, sizeof(float) * _dim);
               itr = local_shard.find(key);
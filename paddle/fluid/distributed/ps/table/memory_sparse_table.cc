@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <omp.h>
+#include <atomic>
 #include <sstream>
 
 #include "glog/logging.h"
@@ -20,6 +21,7 @@
 #include "paddle/fluid/distributed/common/local_random.h"
 #include "paddle/fluid/distributed/common/topk_calculator.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/sparse_binary_shard.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/fluid/framework/io/fs.h"
 
@@ -74,6 +76,7 @@ int32_t MemorySparseTable::InitializeValue() {
           << " _task_pool_size:" << _task_pool_size;
 
   _local_shards.reset(new shard_type[_real_local_shard_num]);
+  _dirty_keys.reset(new DirtyKeys[_real_local_shard_num]);
 
   if (_config.enable_revert()) {
     // calculate merged shard number based on config param;
@@ -99,6 +102,9 @@ int32_t MemorySparseTable::InitializeValue() {
               << "]";
     _local_shards_new.reset(new shard_type[_real_local_shard_num]);
   }
+
+  _dirty_tracking = _config.enable_dirty_tracking();
+  _save_epoch_valid = false;
   return 0;
 }
 
@@ -127,6 +133,8 @@ int32_t MemorySparseTable::Load(const std::string &path,
   if (load_param == 5) {
     return LoadPatch(file_list, load_param);
   }
+  // loaded features are not tracked, the next delta save scans all of them
+  _save_epoch_valid = false;
 
   size_t file_start_idx = _shard_idx * _avg_local_shard_num;
 
@@ -143,6 +151,7 @@ int32_t MemorySparseTable::Load(const std::string &path,
   int thread_num = _real_local_shard_num < 15 ? _real_local_shard_num : 15;
 #endif
 
+  std::atomic<int32_t> load_ret(0);
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _real_local_shard_num; ++i) {
@@ -153,6 +162,12 @@ int32_t MemorySparseTable::Load(const std::string &path,
     channel_config.converter = _value_accesor->Converter(load_param).converter;
     channel_config.deconverter =
         _value_accesor->Converter(load_param).deconverter;
+    if (IsSparseBinaryShard(channel_config.path)) {
+      if (LoadBinaryShard(channel_config, i) != 0) {
+        load_ret = -1;
+      }
+      continue;
+    }
 
     bool is_read_failed = false;
     int retry_num = 0;
@@ -163,15 +178,18 @@ int32_t MemorySparseTable::Load(const std::string &path,
       std::string line_data;
       auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
       char *end = NULL;
+      std::vector<float> parse_buffer(feature_value_size);
       auto &shard = _local_shards[i];
       try {
         while (read_channel->read_line(line_data) == 0 &&
                line_data.size() > 1) {
           uint64_t key = std::strtoul(line_data.data(), &end, 10);
-          auto &value = shard[key];
-          value.resize(feature_value_size);
-          int parse_size = _value_accesor->ParseFromString(++end, value.data());
+          int parse_size =
+              _value_accesor->ParseFromString(++end, parse_buffer.data());
+          auto &value = shard.get_or_create(key, parse_size);
           value.resize(parse_size);
+          memcpy(
+              value.data(), parse_buffer.data(), parse_size * sizeof(float));
         }
         read_channel->close();
         if (err_no == -1) {
@@ -193,12 +211,51 @@ int32_t MemorySparseTable::Load(const std::string &path,
       }
     } while (is_read_failed);
   }
+  if (load_ret != 0) {
+    return -1;
+  }
   LOG(INFO) << "MemorySparseTable load success, path from "
             << file_list[file_start_idx] << " to "
             << file_list[file_start_idx + _real_local_shard_num - 1];
   return 0;
 }
 
+int32_t MemorySparseTable::LoadBinaryShard(
+    const FsChannelConfig &channel_config, int shard_id) {
+  const std::string &path = channel_config.path;
+  int retry_num = 0;
+  while (true) {
+    SparseBinaryShardReader reader;
+    auto &shard = _local_shards[shard_id];
+    if (reader.Open(channel_config, &_afs_client) == 0) {
+      if (reader.Header().value_dim !=
+          _value_accesor->GetAccessorInfo().size / sizeof(float)) {
+        LOG(ERROR) << "MemorySparseTable binary shard value_dim "
+                   << reader.Header().value_dim
+                   << " mismatches the accessor, path:" << path;
+        return -1;
+      }
+      int ret = reader.ForEach([&shard](uint64_t key,
+                                        const float *data,
+                                        size_t size) {
+        auto &value = shard.get_or_create(key, size);
+        value.resize(size);
+        memcpy(value.data(), data, size * sizeof(float));
+      });
+      if (ret == 0) {
+        return 0;
+      }
+    }
+    ++retry_num;
+    LOG(ERROR) << "MemorySparseTable load binary failed, retry it! path:"
+               << path << " , retry_num=" << retry_num;
+    if (retry_num > FLAGS_pserver_table_save_max_retry) {
+      LOG(ERROR) << "MemorySparseTable load failed reach max limit!";
+      return -1;
+    }
+  }
+}
+
 int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
                                      int load_param) {
   if (!_config.enable_revert()) {
@@ -239,6 +296,7 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
       std::string line_data;
       auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
       char *end = NULL;
+      std::vector<float> parse_buffer(feature_value_size);
       int m_local_shard_id = i % _m_avg_local_shard_num;
       std::unordered_set<size_t> global_shard_idx;
       std::string global_shard_idx_str;
@@ -268,10 +326,12 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
           size_t local_shard_idx = *index_iter % _avg_local_shard_num;
           auto &shard = _local_shards[local_shard_idx];
 
-          auto &value = shard[key];
-          value.resize(feature_value_size);
-          int parse_size = _value_accesor->ParseFromString(++end, value.data());
+          int parse_size =
+              _value_accesor->ParseFromString(++end, parse_buffer.data());
+          auto &value = shard.get_or_create(key, parse_size);
           value.resize(parse_size);
+          memcpy(
+              value.data(), parse_buffer.data(), parse_size * sizeof(float));
         }
         read_channel->close();
         if (err_no == -1) {
@@ -332,6 +392,10 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   int64_t tk_size = LocalSize() * _config.sparse_table_cache_rate();
   TopkCalculator tk(_real_local_shard_num, tk_size);
 
+  // xbox delta only saves the features stamped since the last delta or base
+  // save, other features can not reach delta_threshold without being pushed.
+  bool dirty_only = _dirty_tracking && _save_epoch_valid && save_param == 1;
+
   std::string table_path = TableDir(dirname);
   _afs_client.remove(paddle::string::format_string(
       "%s/part-%03d-*", table_path.c_str(), _shard_idx));
@@ -348,7 +412,17 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _real_local_shard_num; ++i) {
     FsChannelConfig channel_config;
-    if (_config.compress_in_save() && (save_param == 0 || save_param == 3)) {
+    // only checkpoints are saved in binary, xbox models are kept in text
+    bool binary_save =
+        _config.binary_in_save() && (save_param == 0 || save_param == 3);
+    if (binary_save) {
+      channel_config.path = paddle::string::format_string(
+          "%s/part-%03d-%05d" PSERVER_BINARY_SAVE_SUFFIX,
+          table_path.c_str(),
+          _shard_idx,
+          file_start_idx + i);
+    } else if (_config.compress_in_save() &&
+               (save_param == 0 || save_param == 3)) {
       channel_config.path =
           paddle::string::format_string("%s/part-%03d-%05d.gz",
                                         table_path.c_str(),
@@ -360,42 +434,92 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
                                                           _shard_idx,
                                                           file_start_idx + i);
     }
-    channel_config.converter = _value_accesor->Converter(save_param).converter;
-    channel_config.deconverter =
-        _value_accesor->Converter(save_param).deconverter;
+    if (!binary_save) {
+      channel_config.converter =
+          _value_accesor->Converter(save_param).converter;
+      channel_config.deconverter =
+          _value_accesor->Converter(save_param).deconverter;
+    }
     bool is_write_failed = false;
     int feasign_size = 0;
     int retry_num = 0;
     int err_no = 0;
     auto &shard = _local_shards[i];
+    std::vector<std::pair<uint64_t, FixedFeatureValue *>> dirty_values;
+    if (_dirty_tracking && (save_param == 1 || save_param == 2)) {
+      // keys pushed from now on belong to the next delta
+      std::vector<uint64_t> dirty_keys;
+      {
+        std::lock_guard<std::mutex> lock(_dirty_keys[i].mutex);
+        dirty_keys.swap(_dirty_keys[i].keys);
+        ++_dirty_keys[i].save_epoch;
+      }
+      if (dirty_only) {
+        // a key erased by Shrink and created again is added twice
+        std::sort(dirty_keys.begin(), dirty_keys.end());
+        dirty_keys.erase(std::unique(dirty_keys.begin(), dirty_keys.end()),
+                         dirty_keys.end());
+        for (uint64_t key : dirty_keys) {
+          auto it = shard.find(key);
+          if (it != shard.end()) {
+            dirty_values.emplace_back(key, it.value_ptr());
+          }
+        }
+      }
+    }
     do {
       err_no = 0;
       feasign_size = 0;
       is_write_failed = false;
       auto write_channel =
           _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
-      for (auto it = shard.begin(); it != shard.end(); ++it) {
+      std::unique_ptr<SparseBinaryShardWriter> binary_writer;
+      if (binary_save) {
+        binary_writer.reset(new SparseBinaryShardWriter(
+            write_channel,
+            _value_accesor->GetAccessorInfo().size / sizeof(float),
+            _value_accesor->GetAccessorInfo().mf_size / sizeof(float)));
+        is_write_failed = binary_writer->WriteHeader() != 0;
+      }
+      auto save_feature = [&](uint64_t key, FixedFeatureValue &value) {
         if (_config.enable_sparse_table_cache() &&
             (save_param == 1 || save_param == 2) &&
-            _value_accesor->Save(it.value().data(), 4)) {
+            _value_accesor->Save(value.data(), 4)) {
           CostTimer timer10("sprase table top push");
-          tk.push(i, _value_accesor->GetField(it.value().data(), "show"));
+          tk.push(i, _value_accesor->GetField(value.data(), "show"));
         }
 
-        if (_value_accesor->Save(it.value().data(), save_param)) {
-          std::string format_value = _value_accesor->ParseToString(
-              it.value().data(), it.value().size());
-          if (0 != write_channel->write_line(paddle::string::format_string(
-                       "%lu %s", it.key(), format_value.c_str()))) {
-            ++retry_num;
-            is_write_failed = true;
-            LOG(ERROR)
-                << "MemorySparseTable save prefix failed, retry it! path:"
-                << channel_config.path << " , retry_num=" << retry_num;
-            break;
+        if (_value_accesor->Save(value.data(), save_param)) {
+          if (binary_save) {
+            is_write_failed =
+                binary_writer->Append(key, value.data(), value.size()) != 0;
+          } else {
+            std::string format_value =
+                _value_accesor->ParseToString(value.data(), value.size());
+            is_write_failed =
+                write_channel->write_line(paddle::string::format_string(
+                    "%lu %s", key, format_value.c_str())) != 0;
           }
           ++feasign_size;
         }
+      };
+      if (dirty_only) {
+        for (size_t j = 0; !is_write_failed && j < dirty_values.size(); ++j) {
+          save_feature(dirty_values[j].first, *dirty_values[j].second);
+        }
+      } else {
+        for (auto it = shard.begin(); !is_write_failed && it != shard.end();
+             ++it) {
+          save_feature(it.key(), it.value());
+        }
+      }
+      if (binary_save && !is_write_failed) {
+        is_write_failed = binary_writer->Finish() != 0;
+      }
+      if (is_write_failed) {
+        ++retry_num;
+        LOG(ERROR) << "MemorySparseTable save prefix failed, retry it! path:"
+                   << channel_config.path << " , retry_num=" << retry_num;
       }
       write_channel->close();
       if (err_no == -1) {
@@ -414,13 +538,28 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
       }
     } while (is_write_failed);
     feasign_size_all += feasign_size;
-    for (auto it = shard.begin(); it != shard.end(); ++it) {
-      _value_accesor->UpdateStatAfterSave(it.value().data(), save_param);
+    if (dirty_only) {
+      for (auto &dirty_value : dirty_values) {
+        _value_accesor->UpdateStatAfterSave(dirty_value.second->data(),
+                                            save_param);
+      }
+    } else {
+      for (auto it = shard.begin(); it != shard.end(); ++it) {
+        _value_accesor->UpdateStatAfterSave(it.value().data(), save_param);
+      }
     }
     LOG(INFO) << "MemorySparseTable save prefix success, path: "
-              << channel_config.path << " feasign_size: " << feasign_size;
+              << channel_config.path << " feasign_size: " << feasign_size
+              << " dirty_only: " << dirty_only;
+  }
+  if (_dirty_tracking && (save_param == 1 || save_param == 2)) {
+    _save_epoch_valid = true;
+  }
+  // the top k of dirty features is not the top k of the table, keep the
+  // threshold of the last full scan
+  if (!dirty_only) {
+    _local_show_threshold = tk.top();
   }
-  _local_show_threshold = tk.top();
   // int32 may overflow need to change return value
   return 0;
 }
@@ -743,6 +882,27 @@ int32_t MemorySparseTable::Push(TableContext &context) {
   }
 }
 
+void MemorySparseTable::PartitionKeysByShard(
+    const uint64_t *keys,
+    size_t num,
+    std::vector<std::pair<uint64_t, int>> *sorted_keys,
+    std::vector<size_t> *shard_offsets) {
+  std::vector<int> shard_ids(num);
+  shard_offsets->assign(_real_local_shard_num + 1, 0);
+  for (size_t i = 0; i < num; ++i) {
+    shard_ids[i] = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    ++(*shard_offsets)[shard_ids[i] + 1];
+  }
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    (*shard_offsets)[shard_id + 1] += (*shard_offsets)[shard_id];
+  }
+  sorted_keys->resize(num);
+  std::vector<size_t> cursors(shard_offsets->begin(), shard_offsets->end() - 1);
+  for (size_t i = 0; i < num; ++i) {
+    (*sorted_keys)[cursors[shard_ids[i]]++] = {keys[i], static_cast<int>(i)};
+  }
+}
+
 int32_t MemorySparseTable::PullSparse(float *pull_values,
                                       const PullSparseValue &pull_value) {
   CostTimer timer("pserver_sparse_select_all");
@@ -756,66 +916,86 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
       _value_accesor->GetAccessorInfo().select_size / sizeof(float);
   // std::atomic<uint32_t> missed_keys{0};
 
-  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-      _real_local_shard_num);
-  size_t num = pull_value.numel_;
-  for (size_t i = 0; i < num; ++i) {
-    int shard_id = (pull_value.feasigns_[i] % _sparse_table_shard_num) %
-                   _avg_local_shard_num;
-    task_keys[shard_id].push_back({pull_value.feasigns_[i], i});
-  }
+  std::vector<std::pair<uint64_t, int>> sorted_keys;
+  std::vector<size_t> shard_offsets;
+  PartitionKeysByShard(
+      pull_value.feasigns_, pull_value.numel_, &sorted_keys, &shard_offsets);
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    if (shard_offsets[shard_id] == shard_offsets[shard_id + 1]) {
+      continue;
+    }
     tasks[shard_id] =
         _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
             [this,
              shard_id,
-             &task_keys,
+             &sorted_keys,
+             &shard_offsets,
              value_size,
              pull_values,
              mf_value_size,
              select_value_size]() -> int {
               auto &local_shard = _local_shards[shard_id];
+              // select straight from the values in shard, data_buffer is
+              // only used to create the missing ones
               float data_buffer[value_size];  // NOLINT
               float *data_buffer_ptr = data_buffer;
-
-              auto &keys = task_keys[shard_id];
-              for (size_t i = 0; i < keys.size(); i++) {
-                uint64_t key = keys[i].first;
-                auto itr = local_shard.find(key);
-                size_t data_size = value_size - mf_value_size;
-                if (itr == local_shard.end()) {
-                  // ++missed_keys;
-                  if (FLAGS_pserver_create_value_when_push) {
-                    memset(data_buffer, 0, sizeof(float) * data_size);
+              const size_t data_size = value_size - mf_value_size;
+
+              uint64_t block_keys[CTR_SPARSE_SHARD_BATCH_BLOCK];
+              FixedFeatureValue *block_values[CTR_SPARSE_SHARD_BATCH_BLOCK];
+              float *select_data[CTR_SPARSE_SHARD_BATCH_BLOCK];
+              const float *select_from[CTR_SPARSE_SHARD_BATCH_BLOCK];
+              size_t select_size[CTR_SPARSE_SHARD_BATCH_BLOCK];
+              size_t shard_end = shard_offsets[shard_id + 1];
+              for (size_t begin = shard_offsets[shard_id]; begin < shard_end;
+                   begin += CTR_SPARSE_SHARD_BATCH_BLOCK) {
+                size_t block =
+                    std::min(shard_end - begin, CTR_SPARSE_SHARD_BATCH_BLOCK);
+                for (size_t i = 0; i < block; ++i) {
+                  block_keys[i] = sorted_keys[begin + i].first;
+                }
+                local_shard.find_batch(block_keys, block, block_values);
+                for (size_t i = 0; i < block; ++i) {
+                  uint64_t key = block_keys[i];
+                  int pull_data_idx = sorted_keys[begin + i].second;
+                  select_data[i] =
+                      pull_values + select_value_size * pull_data_idx;
+                  FixedFeatureValue *feature_value = block_values[i];
+                  if (feature_value == NULL) {
+                    // ++missed_keys;
+                    // the key may be created by a duplicate in this block
+                    auto itr = local_shard.find(key);
+                    if (itr != local_shard.end()) {
+                      feature_value = itr.value_ptr();
+                    } else if (!FLAGS_pserver_create_value_when_push) {
+                      feature_value =
+                          &local_shard.get_or_create(key, data_size);
+                      feature_value->resize(data_size);
+                      _value_accesor->Create(&data_buffer_ptr, 1);
+                      memcpy(feature_value->data(),
+                             data_buffer_ptr,
+                             data_size * sizeof(float));
+                    }
+                  }
+                  if (feature_value == NULL) {
+                    select_from[i] = nullptr;
+                    select_size[i] = 0;
                   } else {
-                    auto &feature_value = local_shard[key];
-                    feature_value.resize(data_size);
-                    float *data_ptr = feature_value.data();
-                    _value_accesor->Create(&data_buffer_ptr, 1);
-                    memcpy(
-                        data_ptr, data_buffer_ptr, data_size * sizeof(float));
+                    select_from[i] = feature_value->data();
+                    select_size[i] = feature_value->size();
                   }
-                } else {
-                  data_size = itr.value().size();
-                  memcpy(data_buffer_ptr,
-                         itr.value().data(),
-                         data_size * sizeof(float));
-                }
-                for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
-                  data_buffer[mf_idx] = 0.0;
                 }
-                auto offset = keys[i].second;
-                float *select_data = pull_values + select_value_size * offset;
-                _value_accesor->Select(
-                    &select_data, (const float **)&data_buffer_ptr, 1);
+                _value_accesor->SelectFromStorage(
+                    select_data, select_from, select_size, block);
               }
-
               return 0;
             });
   }
 
   for (size_t shard_id = 0; shard_id < tasks.size(); ++shard_id) {
-    tasks[shard_id].wait();
+    if (tasks[shard_id].valid()) {
+      tasks[shard_id].wait();
+    }
   }
   return 0;
 }
@@ -831,50 +1011,72 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
       _value_accesor->GetAccessorInfo().mf_size / sizeof(float);
 
   std::vector<std::future<int>> tasks(_real_local_shard_num);
-  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-      _real_local_shard_num);
-  for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
-    task_keys[shard_id].push_back({keys[i], i});
-  }
+  std::vector<std::pair<uint64_t, int>> sorted_keys;
+  std::vector<size_t> shard_offsets;
+  PartitionKeysByShard(keys, num, &sorted_keys, &shard_offsets);
   // std::atomic<uint32_t> missed_keys{0};
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    if (shard_offsets[shard_id] == shard_offsets[shard_id + 1]) {
+      continue;
+    }
     tasks[shard_id] =
         _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
             [this,
              shard_id,
-             &task_keys,
+             &sorted_keys,
+             &shard_offsets,
              pull_values,
              value_size,
              mf_value_size]() -> int {
-              auto &keys = task_keys[shard_id];
               auto &local_shard = _local_shards[shard_id];
+              auto *dirty = &_dirty_keys[shard_id];
+              std::unique_lock<std::mutex> dirty_lock(dirty->mutex,
+                                                      std::defer_lock);
+              if (_dirty_tracking) {
+                dirty_lock.lock();
+              }
               float data_buffer[value_size];  // NOLINT
               float *data_buffer_ptr = data_buffer;
-              for (size_t i = 0; i < keys.size(); ++i) {
-                uint64_t key = keys[i].first;
-                auto itr = local_shard.find(key);
-                size_t data_size = value_size - mf_value_size;
-                FixedFeatureValue *ret = NULL;
-                if (itr == local_shard.end()) {
-                  // ++missed_keys;
-                  auto &feature_value = local_shard[key];
-                  feature_value.resize(data_size);
-                  float *data_ptr = feature_value.data();
-                  _value_accesor->Create(&data_buffer_ptr, 1);
-                  memcpy(data_ptr, data_buffer_ptr, data_size * sizeof(float));
-                  ret = &feature_value;
-                } else {
-                  ret = itr.value_ptr();
+              size_t data_size = value_size - mf_value_size;
+
+              uint64_t block_keys[CTR_SPARSE_SHARD_BATCH_BLOCK];
+              FixedFeatureValue *block_values[CTR_SPARSE_SHARD_BATCH_BLOCK];
+              bool created[CTR_SPARSE_SHARD_BATCH_BLOCK];
+              size_t shard_end = shard_offsets[shard_id + 1];
+              for (size_t begin = shard_offsets[shard_id]; begin < shard_end;
+                   begin += CTR_SPARSE_SHARD_BATCH_BLOCK) {
+                size_t block =
+                    std::min(shard_end - begin, CTR_SPARSE_SHARD_BATCH_BLOCK);
+                for (size_t i = 0; i < block; ++i) {
+                  block_keys[i] = sorted_keys[begin + i].first;
+                }
+                local_shard.emplace_batch(
+                    block_keys, block, block_values, created, data_size);
+                for (size_t i = 0; i < block; ++i) {
+                  if (created[i]) {
+                    // ++missed_keys;
+                    block_values[i]->resize(data_size);
+                    _value_accesor->Create(&data_buffer_ptr, 1);
+                    memcpy(block_values[i]->data(),
+                           data_buffer_ptr,
+                           data_size * sizeof(float));
+                  }
+                  // the caller may change the value through the pointer
+                  if (_dirty_tracking) {
+                    MarkDirty(dirty, block_keys[i], block_values[i]);
+                  }
+                  int pull_data_idx = sorted_keys[begin + i].second;
+                  pull_values[pull_data_idx] =
+                      reinterpret_cast<char *>(block_values[i]);
                 }
-                int pull_data_idx = keys[i].second;
-                pull_values[pull_data_idx] = reinterpret_cast<char *>(ret);
               }
               return 0;
             });
   }
   for (size_t shard_id = 0; shard_id < tasks.size(); ++shard_id) {
-    tasks[shard_id].wait();
+    if (tasks[shard_id].valid()) {
+      tasks[shard_id].wait();
+    }
   }
   return 0;
 }
@@ -884,12 +1086,9 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
                                       size_t num) {
   CostTimer timer("pserver_sparse_update_all");
   std::vector<std::future<int>> tasks(_real_local_shard_num);
-  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-      _real_local_shard_num);
-  for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
-    task_keys[shard_id].push_back({keys[i], i});
-  }
+  std::vector<std::pair<uint64_t, int>> sorted_keys;
+  std::vector<size_t> shard_offsets;
+  PartitionKeysByShard(keys, num, &sorted_keys, &shard_offsets);
 
   const size_t value_col =
       _value_accesor->GetAccessorInfo().size / sizeof(float);
@@ -899,6 +1098,9 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
       _value_accesor->GetAccessorInfo().update_size / sizeof(float);
 
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    if (shard_offsets[shard_id] == shard_offsets[shard_id + 1]) {
+      continue;
+    }
     tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
         [this,
          shard_id,
@@ -906,34 +1108,59 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
          mf_value_col,
          update_value_col,
          values,
-         &task_keys]() -> int {
-          auto &keys = task_keys[shard_id];
+         &sorted_keys,
+         &shard_offsets]() -> int {
           auto &local_shard = _local_shards[shard_id];
           auto &local_shard_new = _local_shards_new[shard_id];
+          auto *dirty = &_dirty_keys[shard_id];
+          std::unique_lock<std::mutex> dirty_lock(dirty->mutex,
+                                                  std::defer_lock);
+          if (_dirty_tracking) {
+            dirty_lock.lock();
+          }
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
-          for (size_t i = 0; i < keys.size(); ++i) {
-            uint64_t key = keys[i].first;
-            uint64_t push_data_idx = keys[i].second;
+          uint64_t block_keys[CTR_SPARSE_SHARD_BATCH_BLOCK];
+          FixedFeatureValue *block_values[CTR_SPARSE_SHARD_BATCH_BLOCK];
+          size_t shard_end = shard_offsets[shard_id + 1];
+          for (size_t i = shard_offsets[shard_id]; i < shard_end; ++i) {
+            size_t block_idx = (i - shard_offsets[shard_id]) %
+                               CTR_SPARSE_SHARD_BATCH_BLOCK;
+            if (block_idx == 0) {
+              size_t block =
+                  std::min(shard_end - i, CTR_SPARSE_SHARD_BATCH_BLOCK);
+              for (size_t j = 0; j < block; ++j) {
+                block_keys[j] = sorted_keys[i + j].first;
+              }
+              local_shard.find_batch(block_keys, block, block_values);
+            }
+            uint64_t key = sorted_keys[i].first;
+            uint64_t push_data_idx = sorted_keys[i].second;
             const float *update_data =
                 values + push_data_idx * update_value_col;
-            auto itr = local_shard.find(key);
-            if (itr == local_shard.end()) {
+            FixedFeatureValue *value_ptr = block_values[block_idx];
+            if (value_ptr == NULL) {
+              // the key may be created by a duplicate in this block
+              auto itr = local_shard.find(key);
+              if (itr != local_shard.end()) {
+                value_ptr = itr.value_ptr();
+              }
+            }
+            if (value_ptr == NULL) {
               if (FLAGS_pserver_enable_create_feasign_randomly &&
                   !_value_accesor->CreateValue(1, update_data)) {
                 continue;
               }
               auto value_size = value_col - mf_value_col;
-              auto &feature_value = local_shard[key];
-              feature_value.resize(value_size);
+              value_ptr = &local_shard.get_or_create(key, value_size);
+              value_ptr->resize(value_size);
               _value_accesor->Create(&data_buffer_ptr, 1);
-              memcpy(feature_value.data(),
+              memcpy(value_ptr->data(),
                      data_buffer_ptr,
                      value_size * sizeof(float));
-              itr = local_shard.find(key);
             }
 
-            auto &feature_value = itr.value();
+            auto &feature_value = *value_ptr;
             float *value_data = feature_value.data();
             size_t value_size = feature_value.size();
 
@@ -959,13 +1186,18 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
                      value_data,
                      new_size * sizeof(float));
             }
+            if (_dirty_tracking) {
+              MarkDirty(dirty, key, &feature_value);
+            }
           }
           return 0;
         });
   }
 
   for (size_t shard_id = 0; shard_id < tasks.size(); ++shard_id) {
-    tasks[shard_id].wait();
+    if (tasks[shard_id].valid()) {
+      tasks[shard_id].wait();
+    }
   }
   return 0;
 }
@@ -974,12 +1206,9 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
                                       const float **values,
                                       size_t num) {
   std::vector<std::future<int>> tasks(_real_local_shard_num);
-  std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
-      _real_local_shard_num);
-  for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
-    task_keys[shard_id].push_back({keys[i], i});
-  }
+  std::vector<std::pair<uint64_t, int>> sorted_keys;
+  std::vector<size_t> shard_offsets;
+  PartitionKeysByShard(keys, num, &sorted_keys, &shard_offsets);
 
   size_t value_col = _value_accesor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_col =
@@ -988,6 +1217,9 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
       _value_accesor->GetAccessorInfo().update_size / sizeof(float);
 
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    if (shard_offsets[shard_id] == shard_offsets[shard_id + 1]) {
+      continue;
+    }
     tasks[shard_id] = _shards_task_pool[shard_id % _task_pool_size]->enqueue(
         [this,
          shard_id,
@@ -995,31 +1227,56 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
          mf_value_col,
          update_value_col,
          values,
-         &task_keys]() -> int {
-          auto &keys = task_keys[shard_id];
+         &sorted_keys,
+         &shard_offsets]() -> int {
           auto &local_shard = _local_shards[shard_id];
+          auto *dirty = &_dirty_keys[shard_id];
+          std::unique_lock<std::mutex> dirty_lock(dirty->mutex,
+                                                  std::defer_lock);
+          if (_dirty_tracking) {
+            dirty_lock.lock();
+          }
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
-          for (size_t i = 0; i < keys.size(); ++i) {
-            uint64_t key = keys[i].first;
-            uint64_t push_data_idx = keys[i].second;
+          uint64_t block_keys[CTR_SPARSE_SHARD_BATCH_BLOCK];
+          FixedFeatureValue *block_values[CTR_SPARSE_SHARD_BATCH_BLOCK];
+          size_t shard_end = shard_offsets[shard_id + 1];
+          for (size_t i = shard_offsets[shard_id]; i < shard_end; ++i) {
+            size_t block_idx = (i - shard_offsets[shard_id]) %
+                               CTR_SPARSE_SHARD_BATCH_BLOCK;
+            if (block_idx == 0) {
+              size_t block =
+                  std::min(shard_end - i, CTR_SPARSE_SHARD_BATCH_BLOCK);
+              for (size_t j = 0; j < block; ++j) {
+                block_keys[j] = sorted_keys[i + j].first;
+              }
+              local_shard.find_batch(block_keys, block, block_values);
+            }
+            uint64_t key = sorted_keys[i].first;
+            uint64_t push_data_idx = sorted_keys[i].second;
             const float *update_data = values[push_data_idx];
-            auto itr = local_shard.find(key);
-            if (itr == local_shard.end()) {
+            FixedFeatureValue *value_ptr = block_values[block_idx];
+            if (value_ptr == NULL) {
+              // the key may be created by a duplicate in this block
+              auto itr = local_shard.find(key);
+              if (itr != local_shard.end()) {
+                value_ptr = itr.value_ptr();
+              }
+            }
+            if (value_ptr == NULL) {
               if (FLAGS_pserver_enable_create_feasign_randomly &&
                   !_value_accesor->CreateValue(1, update_data)) {
                 continue;
               }
               auto value_size = value_col - mf_value_col;
-              auto &feature_value = local_shard[key];
-              feature_value.resize(value_size);
+              value_ptr = &local_shard.get_or_create(key, value_size);
+              value_ptr->resize(value_size);
               _value_accesor->Create(&data_buffer_ptr, 1);
-              memcpy(feature_value.data(),
+              memcpy(value_ptr->data(),
                      data_buffer_ptr,
                      value_size * sizeof(float));
-              itr = local_shard.find(key);
             }
-            auto &feature_value = itr.value();
+            auto &feature_value = *value_ptr;
             float *value_data = feature_value.data();
             size_t value_size = feature_value.size();
             if (value_size == value_col) {  // 已拓展到最大size, 则就地update
@@ -1035,13 +1292,18 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
               }
               memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
             }
+            if (_dirty_tracking) {
+              MarkDirty(dirty, key, &feature_value);
+            }
           }
           return 0;
         });
   }
 
   for (size_t shard_id = 0; shard_id < tasks.size(); ++shard_id) {
-    tasks[shard_id].wait();
+    if (tasks[shard_id].valid()) {
+      tasks[shard_id].wait();
+    }
   }
   return 0;
 }
@@ -115,6 +115,17 @@ class MemorySparseTable : public Table {
   virtual int32_t SavePatch(const std::string& path, int save_param);
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
+  // Group the keys by local shard with a counting sort, keys of local shard
+  // i are sorted_keys[shard_offsets[i], shard_offsets[i + 1]) with their
+  // original index.
+  void PartitionKeysByShard(const uint64_t* keys,
+                            size_t num,
+                            std::vector<std::pair<uint64_t, int>>* sorted_keys,
+                            std::vector<size_t>* shard_offsets);
+  // load a shard saved with binary_in_save, retry on read failure, return 0
+  // on success
+  int32_t LoadBinaryShard(const FsChannelConfig& channel_config,
+                          int shard_id);
 
   int _task_pool_size = 24;
   int _avg_local_shard_num;
@@ -133,6 +144,28 @@ class MemorySparseTable : public Table {
   std::unique_ptr<shard_type[]> _local_shards_new;
   std::unique_ptr<shard_type[]> _local_shards_patch_model;
   std::thread _save_patch_model_thread;
+
+  // for xbox delta, the keys of a shard pushed or pulled by PullSparsePtr
+  // since the last delta or base save. A value is stamped with save_epoch
+  // when its key is added, so that each key is added once an epoch.
+  struct DirtyKeys {
+    std::mutex mutex;
+    uint32_t save_epoch{1};
+    std::vector<uint64_t> keys;
+  };
+  // called by the task of the shard, with the lock of dirty held
+  static void MarkDirty(DirtyKeys* dirty,
+                        uint64_t key,
+                        FixedFeatureValue* value) {
+    if (value->save_epoch() != dirty->save_epoch) {
+      value->set_save_epoch(dirty->save_epoch);
+      dirty->keys.push_back(key);
+    }
+  }
+  bool _dirty_tracking{false};
+  std::unique_ptr<DirtyKeys[]> _dirty_keys;
+  // false until a full delta or base save, e.g. after Load
+  bool _save_epoch_valid{false};
 };
 
 }  // namespace distributed
@@ -16,6 +16,8 @@
 
 #include <gflags/gflags.h>
 
+#include <algorithm>
+
 #include "glog/logging.h"
 #include "paddle/fluid/string/string_helper.h"
 
@@ -190,6 +192,37 @@ int32_t SparseAccessor::Select(float** select_values,
   return 0;
 }
 
+// from SparseFeatureValue in table storage to SparsePullValue
+int32_t SparseAccessor::SelectFromStorage(float** select_values,
+                                          const float** values,
+                                          const size_t* value_sizes,
+                                          size_t num) {
+  size_t embedx_dim = _config.embedx_dim();
+  size_t embedx_w_index = sparse_feature_value.EmbedxWIndex();
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    float* select_value = select_values[value_item];
+    const float* value = values[value_item];
+    size_t value_size = value_sizes[value_item];
+    if (value_size == 0) {
+      memset(
+          select_value, 0, SparsePullValue::Dim(embedx_dim) * sizeof(float));
+      continue;
+    }
+    select_value[SparsePullValue::EmbedWIndex()] =
+        value[sparse_feature_value.EmbedWIndex()];
+    size_t embedx_num =
+        value_size > embedx_w_index
+            ? std::min(embedx_dim, value_size - embedx_w_index)
+            : 0;
+    float* select_embedx = select_value + SparsePullValue::EmbedxWIndex();
+    memcpy(select_embedx, value + embedx_w_index, embedx_num * sizeof(float));
+    memset(select_embedx + embedx_num,
+           0,
+           (embedx_dim - embedx_num) * sizeof(float));
+  }
+  return 0;
+}
+
 // from SparsePushValue to SparsePushValue
 // first dim: item
 // second dim: field num
@@ -151,6 +151,10 @@ class SparseAccessor : public ValueAccessor {
   virtual int32_t Select(float** select_values,
                          const float** values,
                          size_t num);
+  int32_t SelectFromStorage(float** select_values,
+                            const float** values,
+                            const size_t* value_sizes,
+                            size_t num) override;
   // 将update_values聚合到一起
   virtual int32_t Merge(float** update_values,
                         const float** other_update_values,
@@ -166,12 +170,15 @@ class SparseAccessor : public ValueAccessor {
   int32_t ParseFromString(const std::string& str, float* v) override;
   virtual bool CreateValue(int type, const float* value);
 
-  // 这个接口目前只用来取show
+  // 这个接口目前只用来取show和click
   float GetField(float* value, const std::string& name) override {
     // CHECK(name == "show");
     if (name == "show") {
       return sparse_feature_value.Show(value);
     }
+    if (name == "click") {
+      return sparse_feature_value.Click(value);
+    }
     return 0.0;
   }
 
@@ -0,0 +1,349 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/sparse_binary_shard.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/string/string_helper.h"
+
+namespace paddle {
+namespace distributed {
+
+static const char kSparseBinaryShardMagic[8] = {
+    'P', 'D', 'S', 'P', 'B', 'I', 'N', '\0'};
+static const uint32_t kSparseBinaryShardVersion = 1;
+// a block of the header is at most 1GB, which also bounds the buffers of
+// the blocks read through channels
+static const uint64_t kSparseBinaryShardMaxBlockBytes = 1ULL << 30;
+
+bool IsSparseBinaryShard(const std::string& path) {
+  return paddle::string::ends_with(path, PSERVER_BINARY_SAVE_SUFFIX);
+}
+
+SparseBinaryShardWriter::SparseBinaryShardWriter(
+    std::shared_ptr<FsWriteChannel> channel,
+    uint32_t value_dim,
+    uint32_t mf_dim,
+    uint32_t block_key_num)
+    : _channel(channel) {
+  memcpy(_header.magic, kSparseBinaryShardMagic, sizeof(_header.magic));
+  _header.version = kSparseBinaryShardVersion;
+  _header.value_dim = value_dim;
+  _header.mf_dim = mf_dim;
+  _header.block_key_num = block_key_num;
+  _keys.reserve(block_key_num);
+  _sizes.reserve(block_key_num);
+  _values.reserve(static_cast<size_t>(block_key_num) * value_dim);
+}
+
+int32_t SparseBinaryShardWriter::WriteHeader() {
+  return _channel->write(reinterpret_cast<const char*>(&_header),
+                         sizeof(_header)) == 0
+             ? 0
+             : -1;
+}
+
+int32_t SparseBinaryShardWriter::Append(uint64_t key,
+                                        const float* value,
+                                        size_t size) {
+  CHECK(size <= _header.value_dim)
+      << "value size " << size << " exceeds value_dim " << _header.value_dim;
+  _keys.push_back(key);
+  _sizes.push_back(static_cast<uint32_t>(size));
+  _values.insert(_values.end(), value, value + size);
+  _values.resize(_keys.size() * _header.value_dim, 0.0f);
+  if (_keys.size() >= _header.block_key_num) {
+    return FlushBlock();
+  }
+  return 0;
+}
+
+int32_t SparseBinaryShardWriter::Finish() {
+  return _keys.empty() ? 0 : FlushBlock();
+}
+
+int32_t SparseBinaryShardWriter::FlushBlock() {
+  uint64_t key_num = _keys.size();
+  int32_t ret = 0;
+  if (_channel->write(reinterpret_cast<const char*>(&key_num),
+                      sizeof(key_num)) != 0 ||
+      _channel->write(reinterpret_cast<const char*>(_keys.data()),
+                      key_num * sizeof(uint64_t)) != 0 ||
+      _channel->write(reinterpret_cast<const char*>(_sizes.data()),
+                      key_num * sizeof(uint32_t)) != 0 ||
+      _channel->write(reinterpret_cast<const char*>(_values.data()),
+                      _values.size() * sizeof(float)) != 0) {
+    ret = -1;
+  }
+  _keys.clear();
+  _sizes.clear();
+  _values.clear();
+  return ret;
+}
+
+SparseBinaryShardReader::~SparseBinaryShardReader() { Close(); }
+
+int32_t SparseBinaryShardReader::Open(const std::string& path,
+                                      AfsClient* afs_client) {
+  FsChannelConfig channel_config;
+  channel_config.path = path;
+  return Open(channel_config, afs_client);
+}
+
+int32_t SparseBinaryShardReader::Open(const FsChannelConfig& config,
+                                      AfsClient* afs_client) {
+  Close();
+  const std::string& path = config.path;
+  if (paddle::framework::fs_select_internal(path) == 0 &&
+      config.deconverter.empty()) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      LOG(ERROR) << "SparseBinaryShardReader open failed, path:" << path;
+      return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(_header)) {
+      LOG(ERROR) << "SparseBinaryShardReader invalid file, path:" << path;
+      close(fd);
+      return -1;
+    }
+    _mapped_size = st.st_size;
+    void* data = mmap(NULL, _mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      LOG(ERROR) << "SparseBinaryShardReader mmap failed, path:" << path;
+      _mapped_size = 0;
+      return -1;
+    }
+    madvise(data, _mapped_size, MADV_SEQUENTIAL | MADV_WILLNEED);
+    _mapped_data = reinterpret_cast<char*>(data);
+    memcpy(&_header, _mapped_data, sizeof(_header));
+  } else {
+    int err_no = 0;
+    _channel = afs_client->open_r(config, 0, &err_no);
+    if (err_no == -1 ||
+        ReadFromChannel(reinterpret_cast<char*>(&_header), sizeof(_header)) !=
+            0) {
+      LOG(ERROR) << "SparseBinaryShardReader read header failed, path:"
+                 << path;
+      Close();
+      return -1;
+    }
+  }
+  if (memcmp(_header.magic, kSparseBinaryShardMagic, sizeof(_header.magic)) !=
+          0 ||
+      _header.version != kSparseBinaryShardVersion) {
+    LOG(ERROR) << "SparseBinaryShardReader bad magic or version, path:"
+               << path;
+    Close();
+    return -1;
+  }
+  size_t block_bytes = 0;
+  if (_header.value_dim == 0 || _header.mf_dim > _header.value_dim ||
+      _header.block_key_num == 0 ||
+      !BlockBytes(_header.block_key_num, &block_bytes)) {
+    LOG(ERROR) << "SparseBinaryShardReader bad header, path:" << path
+               << " value_dim:" << _header.value_dim
+               << " mf_dim:" << _header.mf_dim
+               << " block_key_num:" << _header.block_key_num;
+    Close();
+    return -1;
+  }
+  return 0;
+}
+
+bool SparseBinaryShardReader::BlockBytes(uint64_t key_num,
+                                         size_t* block_bytes) const {
+  uint64_t key_bytes = sizeof(uint64_t) + sizeof(uint32_t) +
+                       static_cast<uint64_t>(_header.value_dim) * sizeof(float);
+  if (key_num > _header.block_key_num ||
+      key_num > kSparseBinaryShardMaxBlockBytes / key_bytes) {
+    return false;
+  }
+  *block_bytes = key_num * key_bytes;
+  return true;
+}
+
+int32_t SparseBinaryShardReader::ReadFromChannel(char* data, size_t size) {
+  size_t read_size = 0;
+  while (read_size < size) {
+    int ret = _channel->read(data + read_size, size - read_size);
+    if (ret <= 0) {
+      return -1;
+    }
+    read_size += ret;
+  }
+  return 0;
+}
+
+int32_t SparseBinaryShardReader::ForEach(
+    const std::function<void(uint64_t key, const float* value, size_t size)>&
+        visitor) {
+  const size_t value_dim = _header.value_dim;
+  if (_mapped_data != nullptr) {
+    size_t offset = sizeof(_header);
+    while (offset < _mapped_size) {
+      uint64_t key_num = 0;
+      if (offset + sizeof(key_num) > _mapped_size) {
+        return -1;
+      }
+      memcpy(&key_num, _mapped_data + offset, sizeof(key_num));
+      offset += sizeof(key_num);
+      size_t block_bytes = 0;
+      if (!BlockBytes(key_num, &block_bytes) ||
+          block_bytes > _mapped_size - offset) {
+        return -1;
+      }
+      // keys and values are aligned to 4 bytes in the block, which is
+      // enough for uint32 and float, keys are copied out for uint64.
+      const char* keys = _mapped_data + offset;
+      const uint32_t* sizes = reinterpret_cast<const uint32_t*>(
+          keys + key_num * sizeof(uint64_t));
+      const float* values =
+          reinterpret_cast<const float*>(sizes + key_num);
+      if (!std::all_of(sizes, sizes + key_num, [&](uint32_t size) {
+            return size <= value_dim;
+          })) {
+        return -1;
+      }
+      for (uint64_t i = 0; i < key_num; ++i) {
+        uint64_t key;
+        memcpy(&key, keys + i * sizeof(uint64_t), sizeof(key));
+        visitor(key, values + i * value_dim, sizes[i]);
+      }
+      offset += block_bytes;
+    }
+    return 0;
+  }
+
+  std::vector<uint64_t> keys;
+  std::vector<uint32_t> sizes;
+  std::vector<float> values;
+  uint64_t key_num = 0;
+  size_t block_bytes = 0;
+  while (ReadFromChannel(reinterpret_cast<char*>(&key_num), sizeof(key_num)) ==
+         0) {
+    if (!BlockBytes(key_num, &block_bytes)) {
+      return -1;
+    }
+    keys.resize(key_num);
+    sizes.resize(key_num);
+    values.resize(key_num * value_dim);
+    if (ReadFromChannel(reinterpret_cast<char*>(keys.data()),
+                        key_num * sizeof(uint64_t)) != 0 ||
+        ReadFromChannel(reinterpret_cast<char*>(sizes.data()),
+                        key_num * sizeof(uint32_t)) != 0 ||
+        ReadFromChannel(reinterpret_cast<char*>(values.data()),
+                        values.size() * sizeof(float)) != 0) {
+      return -1;
+    }
+    if (!std::all_of(sizes.begin(), sizes.end(), [&](uint32_t size) {
+          return size <= value_dim;
+        })) {
+      return -1;
+    }
+    for (uint64_t i = 0; i < key_num; ++i) {
+      visitor(keys[i], values.data() + i * value_dim, sizes[i]);
+    }
+  }
+  return 0;
+}
+
+void SparseBinaryShardReader::Close() {
+  if (_mapped_data != nullptr) {
+    munmap(_mapped_data, _mapped_size);
+    _mapped_data = nullptr;
+    _mapped_size = 0;
+  }
+  if (_channel != nullptr) {
+    _channel->close();
+    _channel.reset();
+  }
+}
+
+int32_t ConvertSparseTextShardToBinary(AfsClient* afs_client,
+                                       ValueAccessor* accessor,
+                                       const FsChannelConfig& text_config,
+                                       const std::string& binary_path) {
+  size_t value_dim = accessor->GetAccessorInfo().size / sizeof(float);
+  size_t mf_dim = accessor->GetAccessorInfo().mf_size / sizeof(float);
+  int err_no = 0;
+  auto read_channel = afs_client->open_r(text_config, 0, &err_no);
+  FsChannelConfig binary_config;
+  binary_config.path = binary_path;
+  auto write_channel =
+      afs_client->open_w(binary_config, 1024 * 1024 * 40, &err_no);
+  SparseBinaryShardWriter writer(write_channel, value_dim, mf_dim);
+  if (writer.WriteHeader() != 0) {
+    return -1;
+  }
+
+  std::string line_data;
+  std::vector<float> value(value_dim);
+  char* end = NULL;
+  while (read_channel->read_line(line_data) == 0 && line_data.size() > 1) {
+    uint64_t key = std::strtoul(line_data.data(), &end, 10);
+    int parse_size = accessor->ParseFromString(++end, value.data());
+    if (writer.Append(key, value.data(), parse_size) != 0) {
+      return -1;
+    }
+  }
+  int32_t ret = writer.Finish();
+  read_channel->close();
+  write_channel->close();
+  return err_no == -1 ? -1 : ret;
+}
+
+int32_t ConvertSparseBinaryShardToText(AfsClient* afs_client,
+                                       ValueAccessor* accessor,
+                                       const std::string& binary_path,
+                                       const FsChannelConfig& text_config) {
+  SparseBinaryShardReader reader;
+  if (reader.Open(binary_path, afs_client) != 0) {
+    return -1;
+  }
+  int err_no = 0;
+  auto write_channel =
+      afs_client->open_w(text_config, 1024 * 1024 * 40, &err_no);
+  int32_t ret = 0;
+  std::vector<float> value(reader.Header().value_dim);
+  int32_t read_ret =
+      reader.ForEach([&](uint64_t key, const float* data, size_t size) {
+        if (ret != 0) {
+          return;
+        }
+        memcpy(value.data(), data, size * sizeof(float));
+        std::string format_value =
+            accessor->ParseToString(value.data(), static_cast<int>(size));
+        if (0 != write_channel->write_line(paddle::string::format_string(
+                     "%lu %s", key, format_value.c_str()))) {
+          ret = -1;
+        }
+      });
+  write_channel->close();
+  return (read_ret != 0 || err_no == -1) ? -1 : ret;
+}
+
+}  // namespace distributed
+}  // namespace paddle
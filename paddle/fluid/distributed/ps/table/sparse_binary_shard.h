@@ -0,0 +1,126 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/common/afs_warpper.h"
+#include "paddle/fluid/distributed/ps/table/accessor.h"
+
+#define PSERVER_BINARY_SAVE_SUFFIX ".bin"
+
+namespace paddle {
+namespace distributed {
+
+/*
+  Binary shard file of sparse tables, which is written by large sequential
+  writes and loaded by mmap (local fs) or bulk reads instead of text parsing.
+
+  |---SparseBinaryShardHeader---|---block 0---|---block 1---|...
+
+  Each block holds at most header.block_key_num features:
+
+  |---8B(key_num)---|---8*{key_num}B(keys)---|---4*{key_num}B(sizes)---|
+  |---4*{key_num}*{value_dim}B(values)---|
+
+  Values are stored with the fixed width value_dim of the accessor, and the
+  real size of each value (e.g. without embedx) is kept in sizes.
+*/
+struct SparseBinaryShardHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t value_dim;      // GetAccessorInfo().size / sizeof(float)
+  uint32_t mf_dim;         // GetAccessorInfo().mf_size / sizeof(float)
+  uint32_t block_key_num;  // max number of features in one block
+};
+
+bool IsSparseBinaryShard(const std::string& path);
+
+class SparseBinaryShardWriter {
+ public:
+  SparseBinaryShardWriter(std::shared_ptr<FsWriteChannel> channel,
+                          uint32_t value_dim,
+                          uint32_t mf_dim,
+                          uint32_t block_key_num = 64 * 1024);
+
+  // return 0 on success, -1 on write failure
+  int32_t WriteHeader();
+  int32_t Append(uint64_t key, const float* value, size_t size);
+  // flush the last block
+  int32_t Finish();
+
+ private:
+  int32_t FlushBlock();
+
+  std::shared_ptr<FsWriteChannel> _channel;
+  SparseBinaryShardHeader _header;
+  std::vector<uint64_t> _keys;
+  std::vector<uint32_t> _sizes;
+  std::vector<float> _values;
+};
+
+class SparseBinaryShardReader {
+ public:
+  SparseBinaryShardReader() {}
+  ~SparseBinaryShardReader();
+  SparseBinaryShardReader(const SparseBinaryShardReader&) = delete;
+
+  // Local files are mapped into memory, others and files with a deconverter
+  // are read block by block through afs_client. Return 0 on success.
+  int32_t Open(const std::string& path, AfsClient* afs_client);
+  int32_t Open(const FsChannelConfig& config, AfsClient* afs_client);
+
+  const SparseBinaryShardHeader& Header() const { return _header; }
+
+  // Visit all the features, return 0 on success, -1 if the file is broken,
+  // e.g. a block has more keys than block_key_num or a value is longer than
+  // value_dim.
+  int32_t ForEach(
+      const std::function<void(uint64_t key, const float* value, size_t size)>&
+          visitor);
+
+  void Close();
+
+ private:
+  int32_t ReadFromChannel(char* data, size_t size);
+  // check key_num and compute the bytes of the block after key_num
+  bool BlockBytes(uint64_t key_num, size_t* block_bytes) const;
+
+  SparseBinaryShardHeader _header;
+  // mmap
+  char* _mapped_data = nullptr;
+  size_t _mapped_size = 0;
+  // channel
+  std::shared_ptr<FsReadChannel> _channel;
+};
+
+// Convert a text shard saved by ParseToString to a binary shard, and the
+// values are parsed by ParseFromString, the same as loading the text shard.
+int32_t ConvertSparseTextShardToBinary(AfsClient* afs_client,
+                                       ValueAccessor* accessor,
+                                       const FsChannelConfig& text_config,
+                                       const std::string& binary_path);
+
+// Convert a binary shard to the text shard written by ParseToString.
+int32_t ConvertSparseBinaryShardToText(AfsClient* afs_client,
+                                       ValueAccessor* accessor,
+                                       const std::string& binary_path,
+                                       const FsChannelConfig& text_config);
+
+}  // namespace distributed
+}  // namespace paddle
@@ -45,10 +45,8 @@ void SparseNaiveSGDRule::UpdateValueWork(float *w,
                                          float *sgd,
                                          const float *push_value,
                                          float scale) {
-  for (size_t i = 0; i < _embedding_dim; ++i) {
-    w[i] -= learning_rate_ * push_value[i];
-    BoundValue(w[i]);
-  }
+  Kernels().naive(
+      w, push_value, _embedding_dim, learning_rate_, _min_bound, _max_bound);
 }
 
 void SparseNaiveSGDRule::InitValueWork(float *value,
@@ -93,15 +91,15 @@ void SparseAdaGradSGDRule::UpdateValueWork(float *w,
                                            const float *grad,
                                            float scale) {
   float &g2sum = sgd[G2SumIndex()];
-  double add_g2sum = 0;
-
-  for (size_t i = 0; i < _embedding_dim; i++) {
-    double scaled_grad = grad[i] / scale;
-    w[i] -= learning_rate_ * scaled_grad *
-            sqrt(_initial_g2sum / (_initial_g2sum + g2sum));
-    BoundValue(w[i]);
-    add_g2sum += scaled_grad * scaled_grad;
-  }
+  double add_g2sum =
+      Kernels().adagrad(w,
+                        grad,
+                        _embedding_dim,
+                        learning_rate_,
+                        sqrt(_initial_g2sum / (_initial_g2sum + g2sum)),
+                        scale,
+                        _min_bound,
+                        _max_bound);
 
   g2sum += add_g2sum / _embedding_dim;
 }
@@ -149,14 +147,15 @@ void StdAdaGradSGDRule::UpdateValueWork(float *w,
                                         float *sgd,
                                         const float *grad,
                                         float scale) {
-  for (size_t i = 0; i < _embedding_dim; i++) {
-    float &g2sum = sgd[G2SumIndex() + i];
-    double scaled_grad = grad[i] / scale;
-    w[i] -= learning_rate_ * scaled_grad *
-            sqrt(_initial_g2sum / (_initial_g2sum + g2sum));
-    BoundValue(w[i]);
-    g2sum += scaled_grad * scaled_grad;
-  }
+  Kernels().std_adagrad(w,
+                        sgd + G2SumIndex(),
+                        grad,
+                        _embedding_dim,
+                        learning_rate_,
+                        _initial_g2sum,
+                        scale,
+                        _min_bound,
+                        _max_bound);
 }
 
 void StdAdaGradSGDRule::InitValueWork(float *value,
@@ -214,14 +213,17 @@ void SparseAdamSGDRule::UpdateValueWork(float *w,
   float beta2_pow_ = *beta2_pow;
 
   lr *= sqrt(1 - beta2_pow_) / (1 - beta1_pow_);
-  for (size_t i = 0; i < _embedding_dim; i++) {
-    // Calculation
-    gsum[i] = _beta1_decay_rate * gsum[i] + (1 - _beta1_decay_rate) * g[i];
-    g2sum[i] =
-        _beta2_decay_rate * g2sum[i] + (1 - _beta2_decay_rate) * g[i] * g[i];
-    w[i] = w[i] - lr * (gsum[i] / (sqrt(g2sum[i]) + _ada_epsilon));
-    BoundValue(w[i]);
-  }
+  Kernels().adam(w,
+                 gsum,
+                 g2sum,
+                 g,
+                 _embedding_dim,
+                 lr,
+                 _beta1_decay_rate,
+                 _beta2_decay_rate,
+                 _ada_epsilon,
+                 _min_bound,
+                 _max_bound);
   // update beta_pow_decay
   (*beta1_pow) *= _beta1_decay_rate;
   (*beta2_pow) *= _beta2_decay_rate;
@@ -292,17 +294,19 @@ void SparseSharedAdamSGDRule::UpdateValueWork(float *w,
   lr *= sqrt(1 - beta2_pow_) / (1 - beta1_pow_);
   double sum_gsum = 0.0;
   double sum_g2sum = 0.0;
-  for (size_t i = 0; i < _embedding_dim; i++) {
-    // Calculation
-    double new_gsum =
-        _beta1_decay_rate * gsum_ + (1 - _beta1_decay_rate) * g[i];
-    double new_g2sum =
-        _beta2_decay_rate * g2sum_ + (1 - _beta2_decay_rate) * g[i] * g[i];
-    w[i] = w[i] - lr * (new_gsum / (sqrt(new_g2sum) + _ada_epsilon));
-    BoundValue(w[i]);
-    sum_gsum += new_gsum;
-    sum_g2sum += new_g2sum;
-  }
+  Kernels().shared_adam(w,
+                        g,
+                        _embedding_dim,
+                        lr,
+                        gsum_,
+                        g2sum_,
+                        _beta1_decay_rate,
+                        _beta2_decay_rate,
+                        _ada_epsilon,
+                        _min_bound,
+                        _max_bound,
+                        &sum_gsum,
+                        &sum_g2sum);
   // update beta_pow_decay
   (*gsum) = sum_gsum / _embedding_dim;
   (*g2sum) = sum_g2sum / _embedding_dim;
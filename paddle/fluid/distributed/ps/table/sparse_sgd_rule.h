@@ -21,6 +21,7 @@
 #include "glog/logging.h"                                  // for CHECK
 #include "paddle/fluid/distributed/common/local_random.h"  // for local_uniform_real_distribution
 #include "paddle/fluid/distributed/common/registerer.h"
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule_kernel.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
 
 namespace paddle {
@@ -67,6 +68,10 @@ class SparseValueSGDRule {
   float _max_bound;
   float _initial_range;
   size_t _embedding_dim;
+  // loops over the embedding, see sparse_sgd_rule_kernel.h
+  const SparseSGDKernels& Kernels() const {
+    return GetSparseSGDKernels(_embedding_dim);
+  }
 
  private:
   std::string _name;
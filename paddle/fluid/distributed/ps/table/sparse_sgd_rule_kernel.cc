@@ -0,0 +1,194 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule_kernel.h"
+
+#include <gflags/gflags.h>
+#include <math.h>
+
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_info.h"
+
+DEFINE_bool(pserver_sparse_sgd_simd,
+            true,
+            "use the avx2/avx512f kernels of sparse sgd rules if supported");
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+template <class T>
+inline void BoundWeight(T& w, float min_bound, float max_bound) {  // NOLINT
+  if (!(w >= min_bound)) {
+    w = (T)min_bound;
+  } else if (!(w <= max_bound)) {
+    w = (T)max_bound;
+  }
+}
+
+void NaiveRef(float* w,
+              const float* grad,
+              size_t dim,
+              float lr,
+              float min_bound,
+              float max_bound) {
+  for (size_t i = 0; i < dim; ++i) {
+    w[i] -= lr * grad[i];
+    BoundWeight(w[i], min_bound, max_bound);
+  }
+}
+
+double AdaGradRef(float* w,
+                  const float* grad,
+                  size_t dim,
+                  float lr,
+                  double ratio,
+                  float scale,
+                  float min_bound,
+                  float max_bound) {
+  double add_g2sum = 0;
+  for (size_t i = 0; i < dim; i++) {
+    double scaled_grad = grad[i] / scale;
+    w[i] -= lr * scaled_grad * ratio;
+    BoundWeight(w[i], min_bound, max_bound);
+    add_g2sum += scaled_grad * scaled_grad;
+  }
+  return add_g2sum;
+}
+
+void StdAdaGradRef(float* w,
+                   float* g2sum,
+                   const float* grad,
+                   size_t dim,
+                   float lr,
+                   float initial_g2sum,
+                   float scale,
+                   float min_bound,
+                   float max_bound) {
+  for (size_t i = 0; i < dim; i++) {
+    double scaled_grad = grad[i] / scale;
+    w[i] -= lr * scaled_grad * sqrt(initial_g2sum / (initial_g2sum + g2sum[i]));
+    BoundWeight(w[i], min_bound, max_bound);
+    g2sum[i] += scaled_grad * scaled_grad;
+  }
+}
+
+void AdamRef(float* w,
+             float* gsum,
+             float* g2sum,
+             const float* g,
+             size_t dim,
+             float lr,
+             float beta1,
+             float beta2,
+             float epsilon,
+             float min_bound,
+             float max_bound) {
+  for (size_t i = 0; i < dim; i++) {
+    gsum[i] = beta1 * gsum[i] + (1 - beta1) * g[i];
+    g2sum[i] = beta2 * g2sum[i] + (1 - beta2) * g[i] * g[i];
+    w[i] = w[i] - lr * (gsum[i] / (sqrt(g2sum[i]) + epsilon));
+    BoundWeight(w[i], min_bound, max_bound);
+  }
+}
+
+void SharedAdamRef(float* w,
+                   const float* g,
+                   size_t dim,
+                   float lr,
+                   float gsum,
+                   float g2sum,
+                   float beta1,
+                   float beta2,
+                   float epsilon,
+                   float min_bound,
+                   float max_bound,
+                   double* sum_gsum,
+                   double* sum_g2sum) {
+  *sum_gsum = 0.0;
+  *sum_g2sum = 0.0;
+  for (size_t i = 0; i < dim; i++) {
+    double new_gsum = beta1 * gsum + (1 - beta1) * g[i];
+    double new_g2sum = beta2 * g2sum + (1 - beta2) * g[i] * g[i];
+    w[i] = w[i] - lr * (new_gsum / (sqrt(new_g2sum) + epsilon));
+    BoundWeight(w[i], min_bound, max_bound);
+    *sum_gsum += new_gsum;
+    *sum_g2sum += new_g2sum;
+  }
+}
+
+const SparseSGDKernels kRefKernels = {
+    "ref", 1, NaiveRef, AdaGradRef, StdAdaGradRef, AdamRef, SharedAdamRef};
+
+// the supported kernels from the widest to the reference ones
+std::vector<const SparseSGDKernels*> SupportedSparseSGDKernels() {
+  std::vector<const SparseSGDKernels*> kernels;
+  if (FLAGS_pserver_sparse_sgd_simd) {
+    for (auto* simd_kernels :
+         {GetSparseSGDAVX512Kernels(), GetSparseSGDAVX2Kernels()}) {
+      if (simd_kernels != nullptr) {
+        VLOG(3) << "sparse sgd rule kernels: " << simd_kernels->name;
+        kernels.push_back(simd_kernels);
+      }
+    }
+  }
+  kernels.push_back(&kRefKernels);
+  return kernels;
+}
+
+}  // namespace
+
+#ifdef PADDLE_WITH_SPARSE_SGD_AVX2
+extern const SparseSGDKernels kAVX2Kernels;
+#endif
+#ifdef PADDLE_WITH_SPARSE_SGD_AVX512
+extern const SparseSGDKernels kAVX512Kernels;
+#endif
+
+const SparseSGDKernels& GetSparseSGDRefKernels() { return kRefKernels; }
+
+const SparseSGDKernels* GetSparseSGDAVX2Kernels() {
+#ifdef PADDLE_WITH_SPARSE_SGD_AVX2
+  if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx2)) {
+    return &kAVX2Kernels;
+  }
+#endif
+  return nullptr;
+}
+
+const SparseSGDKernels* GetSparseSGDAVX512Kernels() {
+#ifdef PADDLE_WITH_SPARSE_SGD_AVX512
+  if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f)) {
+    return &kAVX512Kernels;
+  }
+#endif
+  return nullptr;
+}
+
+const SparseSGDKernels& GetSparseSGDKernels(size_t dim) {
+  static const std::vector<const SparseSGDKernels*> kernels =
+      SupportedSparseSGDKernels();
+  for (auto* dim_kernels : kernels) {
+    if (dim_kernels->width <= dim) {
+      return *dim_kernels;
+    }
+  }
+  return kRefKernels;
+}
+
+}  // namespace distributed
+}  // namespace paddle
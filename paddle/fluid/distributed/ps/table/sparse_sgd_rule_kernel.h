@@ -0,0 +1,97 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stddef.h>
+
+namespace paddle {
+namespace distributed {
+
+// Inner loops of the SparseValueSGDRule updates over one embedding. The
+// reference kernels keep the arithmetic of the original rules, the simd
+// kernels (avx2, avx512f) do the same arithmetic in float and double lanes,
+// and GetSparseSGDKernels selects the best one supported by the cpu at
+// runtime.
+struct SparseSGDKernels {
+  const char* name;
+  // floats per vector, shorter embeddings are all computed by the tail
+  size_t width;
+  // SparseNaiveSGDRule: w -= lr * grad
+  void (*naive)(float* w,
+                const float* grad,
+                size_t dim,
+                float lr,
+                float min_bound,
+                float max_bound);
+  // SparseAdaGradSGDRule: w -= lr * grad / scale * ratio, where ratio is
+  // sqrt(initial_g2sum / (initial_g2sum + g2sum)). Return the sum of the
+  // squared scaled gradients.
+  double (*adagrad)(float* w,
+                    const float* grad,
+                    size_t dim,
+                    float lr,
+                    double ratio,
+                    float scale,
+                    float min_bound,
+                    float max_bound);
+  // StdAdaGradSGDRule with g2sum of each dim
+  void (*std_adagrad)(float* w,
+                      float* g2sum,
+                      const float* grad,
+                      size_t dim,
+                      float lr,
+                      float initial_g2sum,
+                      float scale,
+                      float min_bound,
+                      float max_bound);
+  // SparseAdamSGDRule, lr is already corrected by beta1_pow and beta2_pow
+  void (*adam)(float* w,
+               float* gsum,
+               float* g2sum,
+               const float* grad,
+               size_t dim,
+               float lr,
+               float beta1,
+               float beta2,
+               float epsilon,
+               float min_bound,
+               float max_bound);
+  // SparseSharedAdamSGDRule, return the sums of the new gsum and g2sum of
+  // all dims.
+  void (*shared_adam)(float* w,
+                      const float* grad,
+                      size_t dim,
+                      float lr,
+                      float gsum,
+                      float g2sum,
+                      float beta1,
+                      float beta2,
+                      float epsilon,
+                      float min_bound,
+                      float max_bound,
+                      double* sum_gsum,
+                      double* sum_g2sum);
+};
+
+const SparseSGDKernels& GetSparseSGDRefKernels();
+// nullptr if not compiled in or not supported by the cpu
+const SparseSGDKernels* GetSparseSGDAVX2Kernels();
+const SparseSGDKernels* GetSparseSGDAVX512Kernels();
+// FLAGS_pserver_sparse_sgd_simd selects the simd kernels, the widest ones
+// whose vector fits in an embedding of dim
+const SparseSGDKernels& GetSparseSGDKernels(size_t dim);
+
+}  // namespace distributed
+}  // namespace paddle
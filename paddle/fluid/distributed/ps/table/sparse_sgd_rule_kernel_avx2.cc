@@ -0,0 +1,68 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule_kernel_simd.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+struct AVX2Vec {
+  typedef __m256 Reg;
+  static const size_t kWidth = 8;
+  static Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+  static void Store(float* p, Reg v) { _mm256_storeu_ps(p, v); }
+  static Reg Set1(float v) { return _mm256_set1_ps(v); }
+  static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+  static Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+  static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+  static Reg Div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+  static Reg Sqrt(Reg a) { return _mm256_sqrt_ps(a); }
+  static Reg Min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+  static Reg Max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+
+  typedef __m256d DReg;
+  static DReg Lo(Reg a) { return _mm256_cvtps_pd(_mm256_castps256_ps128(a)); }
+  static DReg Hi(Reg a) { return _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1)); }
+  static Reg FromDouble(DReg lo, DReg hi) {
+    return _mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+  }
+  static DReg DSet1(double v) { return _mm256_set1_pd(v); }
+  static DReg DAdd(DReg a, DReg b) { return _mm256_add_pd(a, b); }
+  static DReg DSub(DReg a, DReg b) { return _mm256_sub_pd(a, b); }
+  static DReg DMul(DReg a, DReg b) { return _mm256_mul_pd(a, b); }
+  static DReg DDiv(DReg a, DReg b) { return _mm256_div_pd(a, b); }
+  static DReg DSqrt(DReg a) { return _mm256_sqrt_pd(a); }
+  static double ReduceAdd(DReg a) {
+    alignas(32) double lanes[kWidth / 2];
+    _mm256_store_pd(lanes, a);
+    double sum = 0;
+    for (size_t i = 0; i < kWidth / 2; ++i) {
+      sum += lanes[i];
+    }
+    return sum;
+  }
+};
+
+}  // namespace
+
+extern const SparseSGDKernels kAVX2Kernels =
+    simd::MakeSparseSGDKernels<AVX2Vec>("avx2");
+
+}  // namespace distributed
+}  // namespace paddle
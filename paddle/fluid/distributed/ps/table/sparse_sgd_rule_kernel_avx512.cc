@@ -0,0 +1,73 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <immintrin.h>
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule_kernel_simd.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+struct AVX512Vec {
+  typedef __m512 Reg;
+  static const size_t kWidth = 16;
+  static Reg Load(const float* p) { return _mm512_loadu_ps(p); }
+  static void Store(float* p, Reg v) { _mm512_storeu_ps(p, v); }
+  static Reg Set1(float v) { return _mm512_set1_ps(v); }
+  static Reg Add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+  static Reg Sub(Reg a, Reg b) { return _mm512_sub_ps(a, b); }
+  static Reg Mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+  static Reg Div(Reg a, Reg b) { return _mm512_div_ps(a, b); }
+  static Reg Sqrt(Reg a) { return _mm512_sqrt_ps(a); }
+  static Reg Min(Reg a, Reg b) { return _mm512_min_ps(a, b); }
+  static Reg Max(Reg a, Reg b) { return _mm512_max_ps(a, b); }
+
+  typedef __m512d DReg;
+  static DReg Lo(Reg a) { return _mm512_cvtps_pd(_mm512_castps512_ps256(a)); }
+  static DReg Hi(Reg a) {
+    return _mm512_cvtps_pd(_mm256_castpd_ps(
+        _mm512_extractf64x4_pd(_mm512_castps_pd(a), 1)));
+  }
+  static Reg FromDouble(DReg lo, DReg hi) {
+    __m512d lo_v =
+        _mm512_castpd256_pd512(_mm256_castps_pd(_mm512_cvtpd_ps(lo)));
+    return _mm512_castpd_ps(_mm512_insertf64x4(
+        lo_v, _mm256_castps_pd(_mm512_cvtpd_ps(hi)), 1));
+  }
+  static DReg DSet1(double v) { return _mm512_set1_pd(v); }
+  static DReg DAdd(DReg a, DReg b) { return _mm512_add_pd(a, b); }
+  static DReg DSub(DReg a, DReg b) { return _mm512_sub_pd(a, b); }
+  static DReg DMul(DReg a, DReg b) { return _mm512_mul_pd(a, b); }
+  static DReg DDiv(DReg a, DReg b) { return _mm512_div_pd(a, b); }
+  static DReg DSqrt(DReg a) { return _mm512_sqrt_pd(a); }
+  static double ReduceAdd(DReg a) {
+    alignas(64) double lanes[kWidth / 2];
+    _mm512_store_pd(lanes, a);
+    double sum = 0;
+    for (size_t i = 0; i < kWidth / 2; ++i) {
+      sum += lanes[i];
+    }
+    return sum;
+  }
+};
+
+}  // namespace
+
+extern const SparseSGDKernels kAVX512Kernels =
+    simd::MakeSparseSGDKernels<AVX512Vec>("avx512f");
+
+}  // namespace distributed
+}  // namespace paddle
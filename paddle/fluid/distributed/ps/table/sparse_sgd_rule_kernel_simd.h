@@ -0,0 +1,292 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+// Only included by sparse_sgd_rule_kernel_avx2.cc and
+// sparse_sgd_rule_kernel_avx512.cc, which are compiled with the matching
+// instruction set flags. VEC provides the float vector operations:
+//   Reg, kWidth, Load, Store, Set1, Add, Sub, Mul, Div, Sqrt, Min and Max,
+// and the double vector operations on the halves of a float vector:
+//   DReg, Lo, Hi, FromDouble, DSet1, DAdd, DSub, DMul, DDiv, DSqrt and
+//   ReduceAdd.
+// Each kernel computes in double where the reference kernel does, and the
+// tails shorter than kWidth are computed by the reference kernels.
+
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule_kernel.h"
+
+namespace paddle {
+namespace distributed {
+namespace simd {
+
+// same as BoundValue, NaN is bounded to min_bound: Max returns its second
+// operand if either one is NaN
+template <class VEC>
+inline typename VEC::Reg Bound(typename VEC::Reg w,
+                               typename VEC::Reg min_bound,
+                               typename VEC::Reg max_bound) {
+  return VEC::Min(VEC::Max(w, min_bound), max_bound);
+}
+
+template <class VEC>
+void Naive(float* w,
+           const float* grad,
+           size_t dim,
+           float lr,
+           float min_bound,
+           float max_bound) {
+  auto lr_v = VEC::Set1(lr);
+  auto min_v = VEC::Set1(min_bound);
+  auto max_v = VEC::Set1(max_bound);
+  size_t i = 0;
+  for (; i + VEC::kWidth <= dim; i += VEC::kWidth) {
+    auto w_v = VEC::Sub(VEC::Load(w + i), VEC::Mul(lr_v, VEC::Load(grad + i)));
+    VEC::Store(w + i, Bound<VEC>(w_v, min_v, max_v));
+  }
+  if (i < dim) {
+    GetSparseSGDRefKernels().naive(
+        w + i, grad + i, dim - i, lr, min_bound, max_bound);
+  }
+}
+
+template <class VEC>
+double AdaGrad(float* w,
+               const float* grad,
+               size_t dim,
+               float lr,
+               double ratio,
+               float scale,
+               float min_bound,
+               float max_bound) {
+  auto lr_v = VEC::DSet1(lr);
+  auto ratio_v = VEC::DSet1(ratio);
+  auto scale_v = VEC::Set1(scale);
+  auto min_v = VEC::Set1(min_bound);
+  auto max_v = VEC::Set1(max_bound);
+  auto add_g2sum_v = VEC::DSet1(0);
+  size_t i = 0;
+  for (; i + VEC::kWidth <= dim; i += VEC::kWidth) {
+    auto scaled_grad = VEC::Div(VEC::Load(grad + i), scale_v);
+    auto w_v = VEC::Load(w + i);
+    auto scaled_grad_lo = VEC::Lo(scaled_grad);
+    auto scaled_grad_hi = VEC::Hi(scaled_grad);
+    auto w_lo = VEC::DSub(
+        VEC::Lo(w_v), VEC::DMul(VEC::DMul(lr_v, scaled_grad_lo), ratio_v));
+    auto w_hi = VEC::DSub(
+        VEC::Hi(w_v), VEC::DMul(VEC::DMul(lr_v, scaled_grad_hi), ratio_v));
+    VEC::Store(w + i, Bound<VEC>(VEC::FromDouble(w_lo, w_hi), min_v, max_v));
+    add_g2sum_v =
+        VEC::DAdd(add_g2sum_v, VEC::DMul(scaled_grad_lo, scaled_grad_lo));
+    add_g2sum_v =
+        VEC::DAdd(add_g2sum_v, VEC::DMul(scaled_grad_hi, scaled_grad_hi));
+  }
+  double add_g2sum = VEC::ReduceAdd(add_g2sum_v);
+  if (i < dim) {
+    add_g2sum += GetSparseSGDRefKernels().adagrad(
+        w + i, grad + i, dim - i, lr, ratio, scale, min_bound, max_bound);
+  }
+  return add_g2sum;
+}
+
+template <class VEC>
+void StdAdaGrad(float* w,
+                float* g2sum,
+                const float* grad,
+                size_t dim,
+                float lr,
+                float initial_g2sum,
+                float scale,
+                float min_bound,
+                float max_bound) {
+  auto lr_v = VEC::DSet1(lr);
+  auto initial_g2sum_v = VEC::Set1(initial_g2sum);
+  auto scale_v = VEC::Set1(scale);
+  auto min_v = VEC::Set1(min_bound);
+  auto max_v = VEC::Set1(max_bound);
+  size_t i = 0;
+  for (; i + VEC::kWidth <= dim; i += VEC::kWidth) {
+    auto scaled_grad = VEC::Div(VEC::Load(grad + i), scale_v);
+    auto g2sum_v = VEC::Load(g2sum + i);
+    auto ratio = VEC::Sqrt(
+        VEC::Div(initial_g2sum_v, VEC::Add(initial_g2sum_v, g2sum_v)));
+    auto w_v = VEC::Load(w + i);
+    auto scaled_grad_lo = VEC::Lo(scaled_grad);
+    auto scaled_grad_hi = VEC::Hi(scaled_grad);
+    auto w_lo = VEC::DSub(
+        VEC::Lo(w_v),
+        VEC::DMul(VEC::DMul(lr_v, scaled_grad_lo), VEC::Lo(ratio)));
+    auto w_hi = VEC::DSub(
+        VEC::Hi(w_v),
+        VEC::DMul(VEC::DMul(lr_v, scaled_grad_hi), VEC::Hi(ratio)));
+    VEC::Store(w + i, Bound<VEC>(VEC::FromDouble(w_lo, w_hi), min_v, max_v));
+    VEC::Store(
+        g2sum + i,
+        VEC::FromDouble(
+            VEC::DAdd(VEC::Lo(g2sum_v),
+                      VEC::DMul(scaled_grad_lo, scaled_grad_lo)),
+            VEC::DAdd(VEC::Hi(g2sum_v),
+                      VEC::DMul(scaled_grad_hi, scaled_grad_hi))));
+  }
+  if (i < dim) {
+    GetSparseSGDRefKernels().std_adagrad(w + i,
+                                         g2sum + i,
+                                         grad + i,
+                                         dim - i,
+                                         lr,
+                                         initial_g2sum,
+                                         scale,
+                                         min_bound,
+                                         max_bound);
+  }
+}
+
+template <class VEC>
+void Adam(float* w,
+          float* gsum,
+          float* g2sum,
+          const float* g,
+          size_t dim,
+          float lr,
+          float beta1,
+          float beta2,
+          float epsilon,
+          float min_bound,
+          float max_bound) {
+  auto lr_v = VEC::Set1(lr);
+  auto beta1_v = VEC::Set1(beta1);
+  auto beta2_v = VEC::Set1(beta2);
+  auto one_minus_beta1_v = VEC::Set1(1 - beta1);
+  auto one_minus_beta2_v = VEC::Set1(1 - beta2);
+  auto epsilon_v = VEC::Set1(epsilon);
+  auto min_v = VEC::Set1(min_bound);
+  auto max_v = VEC::Set1(max_bound);
+  size_t i = 0;
+  for (; i + VEC::kWidth <= dim; i += VEC::kWidth) {
+    auto g_v = VEC::Load(g + i);
+    auto gsum_v = VEC::Add(VEC::Mul(beta1_v, VEC::Load(gsum + i)),
+                           VEC::Mul(one_minus_beta1_v, g_v));
+    auto g2sum_v =
+        VEC::Add(VEC::Mul(beta2_v, VEC::Load(g2sum + i)),
+                 VEC::Mul(VEC::Mul(one_minus_beta2_v, g_v), g_v));
+    auto w_v = VEC::Sub(
+        VEC::Load(w + i),
+        VEC::Mul(lr_v,
+                 VEC::Div(gsum_v, VEC::Add(VEC::Sqrt(g2sum_v), epsilon_v))));
+    VEC::Store(gsum + i, gsum_v);
+    VEC::Store(g2sum + i, g2sum_v);
+    VEC::Store(w + i, Bound<VEC>(w_v, min_v, max_v));
+  }
+  if (i < dim) {
+    GetSparseSGDRefKernels().adam(w + i,
+                                  gsum + i,
+                                  g2sum + i,
+                                  g + i,
+                                  dim - i,
+                                  lr,
+                                  beta1,
+                                  beta2,
+                                  epsilon,
+                                  min_bound,
+                                  max_bound);
+  }
+}
+
+template <class VEC>
+void SharedAdam(float* w,
+                const float* g,
+                size_t dim,
+                float lr,
+                float gsum,
+                float g2sum,
+                float beta1,
+                float beta2,
+                float epsilon,
+                float min_bound,
+                float max_bound,
+                double* sum_gsum,
+                double* sum_g2sum) {
+  // beta * gsum is the same for all dims, the new gsum and g2sum are
+  // computed in float and the update of w in double
+  auto lr_v = VEC::DSet1(lr);
+  auto decayed_gsum_v = VEC::Set1(beta1 * gsum);
+  auto decayed_g2sum_v = VEC::Set1(beta2 * g2sum);
+  auto one_minus_beta1_v = VEC::Set1(1 - beta1);
+  auto one_minus_beta2_v = VEC::Set1(1 - beta2);
+  auto epsilon_v = VEC::DSet1(epsilon);
+  auto min_v = VEC::Set1(min_bound);
+  auto max_v = VEC::Set1(max_bound);
+  auto sum_gsum_v = VEC::DSet1(0);
+  auto sum_g2sum_v = VEC::DSet1(0);
+  size_t i = 0;
+  for (; i + VEC::kWidth <= dim; i += VEC::kWidth) {
+    auto g_v = VEC::Load(g + i);
+    auto new_gsum = VEC::Add(decayed_gsum_v, VEC::Mul(one_minus_beta1_v, g_v));
+    auto new_g2sum = VEC::Add(decayed_g2sum_v,
+                              VEC::Mul(VEC::Mul(one_minus_beta2_v, g_v), g_v));
+    auto w_v = VEC::Load(w + i);
+    auto new_gsum_lo = VEC::Lo(new_gsum);
+    auto new_gsum_hi = VEC::Hi(new_gsum);
+    auto new_g2sum_lo = VEC::Lo(new_g2sum);
+    auto new_g2sum_hi = VEC::Hi(new_g2sum);
+    auto w_lo = VEC::DSub(
+        VEC::Lo(w_v),
+        VEC::DMul(lr_v,
+                  VEC::DDiv(new_gsum_lo,
+                            VEC::DAdd(VEC::DSqrt(new_g2sum_lo), epsilon_v))));
+    auto w_hi = VEC::DSub(
+        VEC::Hi(w_v),
+        VEC::DMul(lr_v,
+                  VEC::DDiv(new_gsum_hi,
+                            VEC::DAdd(VEC::DSqrt(new_g2sum_hi), epsilon_v))));
+    VEC::Store(w + i, Bound<VEC>(VEC::FromDouble(w_lo, w_hi), min_v, max_v));
+    sum_gsum_v = VEC::DAdd(VEC::DAdd(sum_gsum_v, new_gsum_lo), new_gsum_hi);
+    sum_g2sum_v =
+        VEC::DAdd(VEC::DAdd(sum_g2sum_v, new_g2sum_lo), new_g2sum_hi);
+  }
+  *sum_gsum = VEC::ReduceAdd(sum_gsum_v);
+  *sum_g2sum = VEC::ReduceAdd(sum_g2sum_v);
+  if (i < dim) {
+    double tail_gsum, tail_g2sum;
+    GetSparseSGDRefKernels().shared_adam(w + i,
+                                         g + i,
+                                         dim - i,
+                                         lr,
+                                         gsum,
+                                         g2sum,
+                                         beta1,
+                                         beta2,
+                                         epsilon,
+                                         min_bound,
+                                         max_bound,
+                                         &tail_gsum,
+                                         &tail_g2sum);
+    *sum_gsum += tail_gsum;
+    *sum_g2sum += tail_g2sum;
+  }
+}
+
+template <class VEC>
+constexpr SparseSGDKernels MakeSparseSGDKernels(const char* name) {
+  return {name,
+          VEC::kWidth,
+          Naive<VEC>,
+          AdaGrad<VEC>,
+          StdAdaGrad<VEC>,
+          Adam<VEC>,
+          SharedAdam<VEC>};
+}
+
+}  // namespace simd
+}  // namespace distributed
+}  // namespace paddle
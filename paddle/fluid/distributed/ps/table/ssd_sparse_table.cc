@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
 #include "paddle/fluid/distributed/common/topk_calculator.h"
@@ -28,6 +31,15 @@ DEFINE_int32(pserver_load_batch_size, 5000, "load batch size for ssd");
 PADDLE_DEFINE_EXPORTED_string(rocksdb_path,
                               "database",
                               "path of sparse table rocksdb file");
+DEFINE_string(pserver_ssd_tiering_policy,
+              "",
+              "SSDTieringPolicy of SSDSparseTable, empty to disable tiering");
+DEFINE_int64(pserver_ssd_mem_limit_mb,
+             0,
+             "memory of the values of a SSDSparseTable, 0 for no limit");
+DEFINE_int32(pserver_ssd_tiering_interval_ms,
+             1000,
+             "interval of the tiering rounds of SSDSparseTable");
 
 namespace paddle {
 namespace distributed {
@@ -36,12 +48,44 @@ int32_t SSDSparseTable::Initialize() {
   MemorySparseTable::Initialize();
   _db = paddle::distributed::RocksDBHandler::GetInstance();
   _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num);
+  if (!FLAGS_pserver_ssd_tiering_policy.empty()) {
+    _tiering_policy.reset(CREATE_PSCORE_CLASS(
+        SSDTieringPolicy, FLAGS_pserver_ssd_tiering_policy));
+    CHECK(_tiering_policy != nullptr)
+        << "unknown ssd tiering policy: " << FLAGS_pserver_ssd_tiering_policy;
+    _tiering_policy->Initialize(_value_accesor.get(), _real_local_shard_num);
+    _tiering_thread = std::thread([this]() {
+      std::unique_lock<std::mutex> lock(_tiering_mutex);
+      while (!_tiering_cv.wait_for(
+          lock,
+          std::chrono::milliseconds(FLAGS_pserver_ssd_tiering_interval_ms),
+          [this] { return _tiering_stop; })) {
+        lock.unlock();
+        RunTiering();
+        lock.lock();
+      }
+    });
+    VLOG(0) << "SSDSparseTable tiering policy: "
+            << FLAGS_pserver_ssd_tiering_policy
+            << " mem limit: " << FLAGS_pserver_ssd_mem_limit_mb << "MB";
+  }
   VLOG(0) << "initalize SSDSparseTable succ";
   VLOG(0) << "SSD FLAGS_pserver_print_missed_key_num_every_push:"
           << FLAGS_pserver_print_missed_key_num_every_push;
   return 0;
 }
 
+SSDSparseTable::~SSDSparseTable() {
+  if (_tiering_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(_tiering_mutex);
+      _tiering_stop = true;
+    }
+    _tiering_cv.notify_all();
+    _tiering_thread.join();
+  }
+}
+
 int32_t SSDSparseTable::InitializeShard() { return 0; }
 
 int32_t SSDSparseTable::Pull(TableContext& context) {
@@ -108,60 +152,56 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_size];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
-                for (size_t i = 0; i < keys.size(); ++i) {
-                  uint64_t key = keys[i].first;
-                  auto itr = local_shard.find(key);
+                // value is NULL for a key neither in memory nor in rocksdb
+                auto select = [&](const FixedFeatureValue* value,
+                                  int pull_data_idx) {
                   size_t data_size = value_size - mf_value_size;
-                  if (itr == local_shard.end()) {
-                    // pull rocksdb
-                    std::string tmp_string("");
-                    if (_db->get(shard_id,
-                                 reinterpret_cast<char*>(&key),
-                                 sizeof(uint64_t),
-                                 tmp_string) > 0) {
-                      ++missed_keys;
-                      if (FLAGS_pserver_create_value_when_push) {
-                        memset(data_buffer, 0, sizeof(float) * data_size);
-                      } else {
-                        auto& feature_value = local_shard[key];
-                        feature_value.resize(data_size);
-                        float* data_ptr =
-                            const_cast<float*>(feature_value.data());
-                        _value_accesor->Create(&data_buffer_ptr, 1);
-                        memcpy(data_ptr,
-                               data_buffer_ptr,
-                               data_size * sizeof(float));
-                      }
-                    } else {
-                      data_size = tmp_string.size() / sizeof(float);
-                      memcpy(data_buffer_ptr,
-                             paddle::string::str_to_float(tmp_string),
-                             data_size * sizeof(float));
-                      // from rocksdb to mem
-                      auto& feature_value = local_shard[key];
-                      feature_value.resize(data_size);
-                      memcpy(const_cast<float*>(feature_value.data()),
-                             data_buffer_ptr,
-                             data_size * sizeof(float));
-                      _db->del_data(shard_id,
-                                    reinterpret_cast<char*>(&key),
-                                    sizeof(uint64_t));
-                    }
+                  if (value == NULL) {
+                    memset(data_buffer, 0, sizeof(float) * data_size);
                   } else {
-                    data_size = itr.value().size();
+                    data_size = value->size();
                     memcpy(data_buffer_ptr,
-                           itr.value().data(),
+                           value->data(),
                            data_size * sizeof(float));
                   }
                   for (size_t mf_idx = data_size; mf_idx < value_size;
                        ++mf_idx) {
                     data_buffer[mf_idx] = 0.0;
                   }
-                  int pull_data_idx = keys[i].second;
                   float* select_data =
                       pull_values + pull_data_idx * select_value_size;
                   _value_accesor->Select(
                       &select_data, (const float**)&data_buffer_ptr, 1);
+                };
+
+                // the keys missing in memory are read from rocksdb at once
+                std::vector<std::pair<uint64_t, int>> db_pull_keys;
+                for (size_t i = 0; i < keys.size(); ++i) {
+                  if (_tiering_policy) {
+                    _tiering_policy->RecordAccess(shard_id, keys[i].first);
+                  }
+                  auto itr = local_shard.find(keys[i].first);
+                  if (itr == local_shard.end()) {
+                    db_pull_keys.push_back(keys[i]);
+                  } else {
+                    select(&itr.value(), keys[i].second);
+                  }
+                }
+                _pull_keys += keys.size();
+                _mem_hit_keys += keys.size() - db_pull_keys.size();
+                if (db_pull_keys.empty()) {
+                  return 0;
+                }
+                std::vector<uint64_t> db_keys(db_pull_keys.size());
+                for (size_t i = 0; i < db_pull_keys.size(); ++i) {
+                  db_keys[i] = db_pull_keys[i].first;
+                }
+                missed_keys += LoadFromRocksDB(
+                    shard_id, &db_keys, !FLAGS_pserver_create_value_when_push);
+                for (auto& pull_key : db_pull_keys) {
+                  auto itr = local_shard.find(pull_key.first);
+                  select(itr == local_shard.end() ? NULL : &itr.value(),
+                         pull_key.second);
                 }
                 return 0;
               });
@@ -177,12 +217,109 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
   return 0;
 }
 
+size_t SSDSparseTable::LoadFromRocksDB(int shard_id,
+                                       std::vector<uint64_t>* keys,
+                                       bool create) {
+  size_t value_size = _value_accesor->GetAccessorInfo().size / sizeof(float);
+  size_t mf_value_size =
+      _value_accesor->GetAccessorInfo().mf_size / sizeof(float);
+  auto& local_shard = _local_shards[shard_id];
+  // MultiGet takes the keys in the order of Uint64Comparator
+  std::sort(keys->begin(), keys->end());
+  keys->erase(std::unique(keys->begin(), keys->end()), keys->end());
+
+  size_t num = keys->size();
+  std::vector<rocksdb::Slice> db_keys;
+  db_keys.reserve(num);
+  for (auto& key : *keys) {
+    db_keys.emplace_back(reinterpret_cast<const char*>(&key),
+                         sizeof(uint64_t));
+  }
+  std::vector<rocksdb::PinnableSlice> db_values(num);
+  std::vector<rocksdb::Status> status(num);
+  _db->multi_get(
+      shard_id, num, db_keys.data(), db_values.data(), status.data());
+
+  size_t missed_keys = 0;
+  rocksdb::WriteBatch deleted_keys;
+  float data_buffer[value_size];  // NOLINT
+  float* data_buffer_ptr = data_buffer;
+  for (size_t i = 0; i < num; ++i) {
+    if (status[i].IsNotFound()) {
+      ++missed_keys;
+      if (create) {
+        size_t data_size = value_size - mf_value_size;
+        auto& feature_value = local_shard.get_or_create((*keys)[i], data_size);
+        feature_value.resize(data_size);
+        _value_accesor->Create(&data_buffer_ptr, 1);
+        memcpy(const_cast<float*>(feature_value.data()),
+               data_buffer_ptr,
+               data_size * sizeof(float));
+      }
+      continue;
+    }
+    CHECK(status[i].ok()) << "rocksdb get failed: " << status[i].ToString();
+    // from rocksdb to mem
+    size_t data_size = db_values[i].size() / sizeof(float);
+    auto& feature_value = local_shard.get_or_create((*keys)[i], data_size);
+    feature_value.resize(data_size);
+    memcpy(const_cast<float*>(feature_value.data()),
+           db_values[i].data(),
+           data_size * sizeof(float));
+    deleted_keys.Delete(db_keys[i]);
+  }
+  if (deleted_keys.Count() > 0) {
+    _db->write(shard_id, &deleted_keys);
+  }
+  _loaded_values += num - missed_keys;
+  return missed_keys;
+}
+
+std::vector<std::future<int>> SSDSparseTable::PrefetchSparse(
+    const uint64_t* keys, size_t num) {
+  std::vector<std::vector<uint64_t>> task_keys(_real_local_shard_num);
+  std::vector<std::future<int>> tasks;
+  for (size_t i = 0; i < num; ++i) {
+    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    task_keys[shard_id].push_back(keys[i]);
+  }
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    if (task_keys[shard_id].empty()) {
+      continue;
+    }
+    // the tasks of a shard run in order, so a later pull of the shard
+    // waits for its prefetch
+    auto& task_pool = _shards_task_pool[shard_id % _shards_task_pool.size()];
+    tasks.push_back(task_pool->enqueue(
+        [this, shard_id, keys = std::move(task_keys[shard_id])]() -> int {
+          auto& local_shard = _local_shards[shard_id];
+          std::vector<uint64_t> db_keys;
+          for (uint64_t key : keys) {
+            if (local_shard.find(key) == local_shard.end()) {
+              db_keys.push_back(key);
+            }
+          }
+          if (!db_keys.empty()) {
+            LoadFromRocksDB(shard_id, &db_keys, /*create=*/false);
+          }
+          return 0;
+        }));
+  }
+  return tasks;
+}
+
 int32_t SSDSparseTable::PullSparsePtr(int shard_id,
                                       char** pull_values,
                                       const uint64_t* pull_keys,
                                       size_t num,
                                       uint16_t pass_id) {
   CostTimer timer("pserver_ssd_sparse_select_all");
+  if (!_pulled_by_ptr) {
+    // waits for a running tiering round, which may erase values of this
+    // shard, no round starts once the flag is set
+    std::lock_guard<std::mutex> guard(_table_mutex);
+    _pulled_by_ptr = true;
+  }
   size_t value_size = _value_accesor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
       _value_accesor->GetAccessorInfo().mf_size / sizeof(float);
@@ -190,6 +327,8 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
   {  // 从table取值 or create
     RocksDBCtx context;
     std::vector<std::future<int>> tasks;
+    // the keys moved into memory are deleted from rocksdb at once
+    rocksdb::WriteBatch deleted_keys;
     RocksDBItem* cur_ctx = context.switch_item();
     cur_ctx->reset();
     FixedFeatureValue* ret = NULL;
@@ -224,8 +363,9 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
               uint64_t cur_key = *(reinterpret_cast<uint64_t*>(
                   const_cast<char*>(cur_ctx->batch_keys[idx].data())));
               if (cur_ctx->status[idx].IsNotFound()) {
-                auto& feature_value = local_shard[cur_key];
                 int init_size = value_size - mf_value_size;
+                auto& feature_value =
+                    local_shard.get_or_create(cur_key, init_size);
                 feature_value.resize(init_size);
                 _value_accesor->Create(&data_buffer_ptr, 1);
                 memcpy(const_cast<float*>(feature_value.data()),
@@ -236,15 +376,14 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
                 int data_size =
                     cur_ctx->batch_values[idx].size() / sizeof(float);
                 // from rocksdb to mem
-                auto& feature_value = local_shard[cur_key];
+                auto& feature_value =
+                    local_shard.get_or_create(cur_key, data_size);
                 feature_value.resize(data_size);
                 memcpy(const_cast<float*>(feature_value.data()),
                        paddle::string::str_to_float(
                            cur_ctx->batch_values[idx].data()),
                        data_size * sizeof(float));
-                _db->del_data(shard_id,
-                              reinterpret_cast<char*>(&cur_key),
-                              sizeof(uint64_t));
+                deleted_keys.Delete(cur_ctx->batch_keys[idx]);
                 ret = &feature_value;
               }
               _value_accesor->UpdatePassId(ret->data(), pass_id);
@@ -287,8 +426,8 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
         uint64_t cur_key = *(reinterpret_cast<uint64_t*>(
             const_cast<char*>(cur_ctx->batch_keys[idx].data())));
         if (cur_ctx->status[idx].IsNotFound()) {
-          auto& feature_value = local_shard[cur_key];
           int init_size = value_size - mf_value_size;
+          auto& feature_value = local_shard.get_or_create(cur_key, init_size);
           feature_value.resize(init_size);
           _value_accesor->Create(&data_buffer_ptr, 1);
           memcpy(const_cast<float*>(feature_value.data()),
@@ -298,14 +437,13 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
         } else {
           int data_size = cur_ctx->batch_values[idx].size() / sizeof(float);
           // from rocksdb to mem
-          auto& feature_value = local_shard[cur_key];
+          auto& feature_value = local_shard.get_or_create(cur_key, data_size);
           feature_value.resize(data_size);
           memcpy(
               const_cast<float*>(feature_value.data()),
               paddle::string::str_to_float(cur_ctx->batch_values[idx].data()),
               data_size * sizeof(float));
-          _db->del_data(
-              shard_id, reinterpret_cast<char*>(&cur_key), sizeof(uint64_t));
+          deleted_keys.Delete(cur_ctx->batch_keys[idx]);
           ret = &feature_value;
         }
         _value_accesor->UpdatePassId(ret->data(), pass_id);
@@ -314,6 +452,9 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
       }
       cur_ctx->reset();
     }
+    if (deleted_keys.Count() > 0) {
+      _db->write(shard_id, &deleted_keys);
+    }
   }
   return 0;
 }
@@ -350,6 +491,18 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
+                if (_tiering_policy) {
+                  // a value demoted after its pull is updated in memory
+                  std::vector<uint64_t> db_keys;
+                  for (auto& key : keys) {
+                    if (local_shard.find(key.first) == local_shard.end()) {
+                      db_keys.push_back(key.first);
+                    }
+                  }
+                  if (!db_keys.empty()) {
+                    LoadFromRocksDB(shard_id, &db_keys, /*create=*/false);
+                  }
+                }
                 for (size_t i = 0; i < keys.size(); ++i) {
                   uint64_t key = keys[i].first;
                   uint64_t push_data_idx = keys[i].second;
@@ -362,7 +515,8 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                       continue;
                     }
                     auto value_size = value_col - mf_value_col;
-                    auto& feature_value = local_shard[key];
+                    auto& feature_value =
+                        local_shard.get_or_create(key, value_size);
                     feature_value.resize(value_size);
                     _value_accesor->Create(&data_buffer_ptr, 1);
                     memcpy(const_cast<float*>(feature_value.data()),
@@ -467,7 +621,8 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                       continue;
                     }
                     auto value_size = value_col - mf_value_col;
-                    auto& feature_value = local_shard[key];
+                    auto& feature_value =
+                        local_shard.get_or_create(key, value_size);
                     feature_value.resize(value_size);
                     _value_accesor->Create(&data_buffer_ptr, 1);
                     memcpy(const_cast<float*>(feature_value.data()),
@@ -509,6 +664,7 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
 }
 
 int32_t SSDSparseTable::Shrink(const std::string& param) {
+  std::lock_guard<std::mutex> guard(_table_mutex);
   int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
@@ -549,29 +705,152 @@ int32_t SSDSparseTable::Shrink(const std::string& param) {
 }
 
 int32_t SSDSparseTable::UpdateTable() {
+  std::lock_guard<std::mutex> guard(_table_mutex);
   int count = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
     auto& shard = _local_shards[i];
-    // from mem to ssd
+    // from mem to ssd, the values are copied into the batch
+    rocksdb::WriteBatch batch;
     for (auto it = shard.begin(); it != shard.end();) {
       if (_value_accesor->SaveSSD(it.value().data())) {
-        _db->put(i,
-                 reinterpret_cast<const char*>(&it.key()),
-                 sizeof(uint64_t),
-                 reinterpret_cast<const char*>(it.value().data()),
-                 it.value().size() * sizeof(float));
+        batch.Put(
+            rocksdb::Slice(reinterpret_cast<const char*>(&it.key()),
+                           sizeof(uint64_t)),
+            rocksdb::Slice(reinterpret_cast<const char*>(it.value().data()),
+                           it.value().size() * sizeof(float)));
         count++;
         it = shard.erase(it);
+        if (static_cast<int>(batch.Count()) >= FLAGS_pserver_load_batch_size) {
+          _db->write(i, &batch);
+          batch.Clear();
+        }
       } else {
         ++it;
       }
     }
+    if (batch.Count() > 0) {
+      _db->write(i, &batch);
+    }
     _db->flush(i);
   }
   LOG(INFO) << "Table>> update count: " << count;
   return 0;
 }
 
+int32_t SSDSparseTable::RunTiering() {
+  if (_tiering_policy == nullptr || FLAGS_pserver_ssd_mem_limit_mb <= 0) {
+    return 0;
+  }
+  // a round is skipped while the table is saved, loaded or shrunk
+  std::unique_lock<std::mutex> guard(_table_mutex, std::try_to_lock);
+  if (!guard.owns_lock()) {
+    return 0;
+  }
+  // checked under _table_mutex, which the first PullSparsePtr takes to set it
+  if (_pulled_by_ptr) {
+    LOG_FIRST_N(WARNING, 1)
+        << "SSDSparseTable tiering is off since PullSparsePtr is used";
+    return 0;
+  }
+  size_t shard_mem_limit =
+      FLAGS_pserver_ssd_mem_limit_mb * 1024 * 1024 / _real_local_shard_num;
+  std::vector<std::future<size_t>> tasks(_real_local_shard_num);
+  for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
+    tasks[shard_id] =
+        _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+            [this, shard_id, shard_mem_limit]() -> size_t {
+              return DemoteColdValues(shard_id, shard_mem_limit);
+            });
+  }
+  uint64_t mem_bytes = 0;
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    mem_bytes += tasks[i].get();
+  }
+  _mem_bytes = mem_bytes;
+  SSDTieringStat stat = GetTieringStat();
+  VLOG(1) << "SSDSparseTable tiering: pull_keys[" << stat.pull_keys
+          << "] mem_hit_keys[" << stat.mem_hit_keys << "] loaded_values["
+          << stat.loaded_values << "] demoted_values[" << stat.demoted_values
+          << "] mem_bytes[" << stat.mem_bytes << "]";
+  return 0;
+}
+
+size_t SSDSparseTable::DemoteColdValues(int shard_id, size_t mem_limit) {
+  // the key, the FixedFeatureValue and the bucket of the hash map
+  const size_t kValueOverhead =
+      sizeof(uint64_t) + sizeof(FixedFeatureValue) + 16;
+  auto& shard = _local_shards[shard_id];
+  size_t mem_bytes = 0;
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    mem_bytes += it.value().size() * sizeof(float) + kValueOverhead;
+  }
+  if (mem_bytes <= mem_limit) {
+    return mem_bytes;
+  }
+
+  struct Candidate {
+    bool admitted;
+    float score;
+    uint64_t key;
+  };
+  std::vector<Candidate> candidates;
+  candidates.reserve(shard.size());
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    float* value = it.value().data();
+    candidates.push_back(
+        {_tiering_policy->AdmitToSSD(shard_id, it.key(), value),
+         _tiering_policy->Score(shard_id, it.key(), value),
+         it.key()});
+  }
+  // the admitted values first, each group from the lowest score
+  std::sort(candidates.begin(),
+            candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              if (a.admitted != b.admitted) {
+                return a.admitted;
+              }
+              return a.score < b.score;
+            });
+
+  // demote down to 90% of the limit, so the next round has some room
+  size_t target_bytes = mem_limit / 10 * 9;
+  uint64_t demoted = 0;
+  rocksdb::WriteBatch batch;
+  for (auto& candidate : candidates) {
+    if (mem_bytes <= target_bytes) {
+      break;
+    }
+    auto it = shard.find(candidate.key);
+    auto& value = it.value();
+    batch.Put(rocksdb::Slice(reinterpret_cast<const char*>(&candidate.key),
+                             sizeof(uint64_t)),
+              rocksdb::Slice(reinterpret_cast<const char*>(value.data()),
+                             value.size() * sizeof(float)));
+    mem_bytes -= value.size() * sizeof(float) + kValueOverhead;
+    shard.erase(it);
+    ++demoted;
+    if (static_cast<int>(batch.Count()) >= FLAGS_pserver_load_batch_size) {
+      _db->write(shard_id, &batch);
+      batch.Clear();
+    }
+  }
+  if (batch.Count() > 0) {
+    _db->write(shard_id, &batch);
+  }
+  _demoted_values += demoted;
+  return mem_bytes;
+}
+
+SSDTieringStat SSDSparseTable::GetTieringStat() {
+  SSDTieringStat stat;
+  stat.pull_keys = _pull_keys;
+  stat.mem_hit_keys = _mem_hit_keys;
+  stat.loaded_values = _loaded_values;
+  stat.demoted_values = _demoted_values;
+  stat.mem_bytes = _mem_bytes;
+  return stat;
+}
+
 int64_t SSDSparseTable::LocalSize() {
   int64_t local_size = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
@@ -1525,6 +1804,7 @@ int32_t SSDSparseTable::SaveCache(
 
 int32_t SSDSparseTable::Load(const std::string& path,
                              const std::string& param) {
+  std::lock_guard<std::mutex> guard(_table_mutex);
   VLOG(0) << "LOAD FLAGS_rocksdb_path:" << FLAGS_rocksdb_path;
   std::string table_path = TableDir(path);
   auto file_list = _afs_client.list(table_path);
@@ -1678,7 +1958,7 @@ int32_t SSDSparseTable::LoadWithString(
             ssd_mf_count++;
           }
         } else {
-          auto& value = shard[key];
+          auto& value = shard.get_or_create(key, value_size);
           value.resize(value_size);
           _value_accesor->ParseFromString(end, value.data());
           mem_count++;
@@ -1874,7 +2154,7 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
                     ssd_mf_count++;
                   }
                 } else {
-                  auto& feature_value = shard[k];
+                  auto& feature_value = shard.get_or_create(k, dim);
                   _value_accesor->UpdatePassId(convert_value, 0);
                   feature_value.resize(dim);
                   memcpy(const_cast<float*>(feature_value.data()),
@@ -14,9 +14,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <thread>              // NOLINT
+
 #include "gflags/gflags.h"
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/ssd_tiering_policy.h"
 
 namespace paddle {
 namespace distributed {
@@ -56,11 +62,23 @@ class MemRegion {
   char* _buf;
 };
 
+struct SSDTieringStat {
+  uint64_t pull_keys;
+  // the pulled keys found in memory
+  uint64_t mem_hit_keys;
+  // the values moved from rocksdb into memory
+  uint64_t loaded_values;
+  // the values moved from memory to rocksdb by the tiering policy
+  uint64_t demoted_values;
+  // estimated memory of the values after the last tiering round
+  uint64_t mem_bytes;
+};
+
 class SSDSparseTable : public MemorySparseTable {
  public:
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
   SSDSparseTable() {}
-  virtual ~SSDSparseTable() {}
+  virtual ~SSDSparseTable();
 
   int32_t Initialize() override;
   int32_t InitializeShard() override;
@@ -80,10 +98,18 @@ class SSDSparseTable : public MemorySparseTable {
                         uint16_t pass_id);
   int32_t PushSparse(const uint64_t* keys, const float* values, size_t num);
   int32_t PushSparse(const uint64_t* keys, const float** values, size_t num);
+  // Moves the values of keys which are only in rocksdb into memory on the
+  // shard task pools and returns without waiting, a PullSparse of the same
+  // keys issued later finds them in memory. The tasks take no table lock:
+  // the caller must wait for the returned futures before UpdateTable,
+  // Save, Shrink, Load, Clear or PullSparsePtr.
+  std::vector<std::future<int>> PrefetchSparse(const uint64_t* keys,
+                                               size_t num);
 
   int32_t Flush() override { return 0; }
   int32_t Shrink(const std::string& param) override;
   void Clear() override {
+    std::lock_guard<std::mutex> guard(_table_mutex);
     for (int i = 0; i < _real_local_shard_num; ++i) {
       _local_shards[i].clear();
     }
@@ -122,12 +148,44 @@ class SSDSparseTable : public MemorySparseTable {
 
   int32_t CacheTable(uint16_t pass_id) override;
 
+  // One round of the tiering policy: the shards whose values take more
+  // memory than FLAGS_pserver_ssd_mem_limit_mb / shard_num move their
+  // lowest scored values to rocksdb. Runs every
+  // FLAGS_pserver_ssd_tiering_interval_ms in background when
+  // FLAGS_pserver_ssd_tiering_policy is set. Once PullSparsePtr is used
+  // nothing is demoted any more, its caller keeps pointers to the values.
+  // The first PullSparsePtr waits for a running round under _table_mutex.
+  int32_t RunTiering();
+  SSDTieringStat GetTieringStat();
+
  private:
+  // Moves the values of keys from rocksdb into the memory shard with one
+  // MultiGet and one WriteBatch of deletes, the keys not in rocksdb are
+  // created if create is true. keys are sorted and deduplicated in place.
+  // Returns the number of keys not in rocksdb.
+  size_t LoadFromRocksDB(int shard_id,
+                         std::vector<uint64_t>* keys,
+                         bool create);
+  // Returns the memory of the values of the shard after the demotion.
+  size_t DemoteColdValues(int shard_id, size_t mem_limit);
+
   RocksDBHandler* _db;
   int64_t _cache_tk_size;
   double _local_show_threshold{0.0};
   std::vector<paddle::framework::Channel<std::string>> _fs_channel;
   std::mutex _table_mutex;
+
+  std::unique_ptr<SSDTieringPolicy> _tiering_policy;
+  std::thread _tiering_thread;
+  std::mutex _tiering_mutex;
+  std::condition_variable _tiering_cv;
+  bool _tiering_stop{false};
+  std::atomic<bool> _pulled_by_ptr{false};
+  std::atomic<uint64_t> _pull_keys{0};
+  std::atomic<uint64_t> _mem_hit_keys{0};
+  std::atomic<uint64_t> _loaded_values{0};
+  std::atomic<uint64_t> _demoted_values{0};
+  std::atomic<uint64_t> _mem_bytes{0};
 };
 
 }  // namespace distributed
@@ -0,0 +1,63 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/ssd_tiering_policy.h"
+
+#include "gflags/gflags.h"
+
+DEFINE_double(pserver_ssd_tiering_click_coeff,
+              1.0,
+              "weight of click in the score of ShowClickLfuTieringPolicy");
+DEFINE_int32(pserver_ssd_tiering_admit_count,
+             4,
+             "a key pulled this many times recently stays in memory");
+DEFINE_int32(pserver_ssd_tiering_sketch_width,
+             65536,
+             "counters per row of the access sketch of a shard");
+
+namespace paddle {
+namespace distributed {
+
+int ShowClickLfuTieringPolicy::Initialize(ValueAccessor* accessor,
+                                          int shard_num) {
+  SSDTieringPolicy::Initialize(accessor, shard_num);
+  _click_coeff = FLAGS_pserver_ssd_tiering_click_coeff;
+  _admit_count = FLAGS_pserver_ssd_tiering_admit_count;
+  _sketches.clear();
+  for (int i = 0; i < shard_num; ++i) {
+    _sketches.emplace_back(
+        new CountMinSketch(FLAGS_pserver_ssd_tiering_sketch_width, 4));
+  }
+  return 0;
+}
+
+void ShowClickLfuTieringPolicy::RecordAccess(int shard_id, uint64_t key) {
+  _sketches[shard_id]->Add(key);
+}
+
+float ShowClickLfuTieringPolicy::Score(int shard_id UNUSED,
+                                       uint64_t key UNUSED,
+                                       float* value) {
+  return _accessor->GetField(value, "show") +
+         _click_coeff * _accessor->GetField(value, "click");
+}
+
+bool ShowClickLfuTieringPolicy::AdmitToSSD(int shard_id,
+                                           uint64_t key,
+                                           float* value UNUSED) {
+  return _sketches[shard_id]->Estimate(key) < _admit_count;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,78 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "paddle/fluid/distributed/common/count_min_sketch.h"
+#include "paddle/fluid/distributed/common/registerer.h"
+#include "paddle/fluid/distributed/ps/table/accessor.h"
+
+namespace paddle {
+namespace distributed {
+
+// Chooses the values of a SSDSparseTable which stay in memory when the
+// memory of the table is over its limit, the values with the lowest
+// scores are moved to rocksdb first.
+// All methods of a shard are called on the task thread of the shard.
+class SSDTieringPolicy {
+ public:
+  SSDTieringPolicy() {}
+  virtual ~SSDTieringPolicy() {}
+  virtual int Initialize(ValueAccessor* accessor, int shard_num) {
+    _accessor = accessor;
+    _shard_num = shard_num;
+    return 0;
+  }
+  // called for every key pulled from the shard
+  virtual void RecordAccess(int shard_id, uint64_t key) = 0;
+  virtual float Score(int shard_id, uint64_t key, float* value) = 0;
+  // whether the value may be moved to rocksdb, the values which are not
+  // admitted are only moved when the others are not enough
+  virtual bool AdmitToSSD(int shard_id UNUSED,
+                          uint64_t key UNUSED,
+                          float* value UNUSED) {
+    return true;
+  }
+
+ protected:
+  ValueAccessor* _accessor{nullptr};
+  int _shard_num{0};
+};
+
+REGISTER_PSCORE_REGISTERER(SSDTieringPolicy);
+
+// score = show + FLAGS_pserver_ssd_tiering_click_coeff * click, the show
+// and click of a value decay with its days, so a long unseen value scores
+// low. A key pulled FLAGS_pserver_ssd_tiering_admit_count times recently
+// is not admitted to rocksdb, which keeps a key whose counters are still
+// small from going back and forth between memory and rocksdb.
+class ShowClickLfuTieringPolicy : public SSDTieringPolicy {
+ public:
+  int Initialize(ValueAccessor* accessor, int shard_num) override;
+  void RecordAccess(int shard_id, uint64_t key) override;
+  float Score(int shard_id, uint64_t key, float* value) override;
+  bool AdmitToSSD(int shard_id, uint64_t key, float* value) override;
+
+ private:
+  float _click_coeff;
+  uint32_t _admit_count;
+  std::vector<std::unique_ptr<CountMinSketch>> _sketches;
+};
+
+}  // namespace distributed
+}  // namespace paddle
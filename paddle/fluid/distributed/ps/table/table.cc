@@ -25,6 +25,7 @@
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
 #include "paddle/fluid/distributed/ps/table/sparse_accessor.h"
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/ssd_tiering_policy.h"
 #include "paddle/fluid/distributed/ps/table/tensor_accessor.h"
 
 namespace paddle {
@@ -49,6 +50,7 @@ REGISTER_PSCORE_CLASS(SparseValueSGDRule, SparseAdamSGDRule);
 REGISTER_PSCORE_CLASS(SparseValueSGDRule, SparseNaiveSGDRule);
 REGISTER_PSCORE_CLASS(SparseValueSGDRule, SparseAdaGradSGDRule);
 REGISTER_PSCORE_CLASS(SparseValueSGDRule, SparseSharedAdamSGDRule);
+REGISTER_PSCORE_CLASS(SSDTieringPolicy, ShowClickLfuTieringPolicy);
 
 int32_t TableManager::Initialize() {
   static bool initialized = false;
@@ -73,10 +73,12 @@ void InitTensorsOnClient(framework::Scope* scope,
 }
 
 void GetDownpourSparseTableProto(
-    ::paddle::distributed::TableParameter* sparse_table_proto) {
+    ::paddle::distributed::TableParameter* sparse_table_proto,
+    ::paddle::distributed::ValueCodec value_codec) {
   sparse_table_proto->set_table_id(0);
   sparse_table_proto->set_table_class("MemorySparseTable");
   sparse_table_proto->set_shard_num(10);
+  sparse_table_proto->set_value_codec(value_codec);
   ::paddle::distributed::TableAccessorParameter* accessor_config =
       sparse_table_proto->mutable_accessor();
 
@@ -108,7 +110,8 @@ void GetDownpourSparseTableProto(
   naive_param->add_weight_bounds(10.0);
 }
 
-::paddle::distributed::PSParameter GetServerProto() {
+::paddle::distributed::PSParameter GetServerProto(
+    ::paddle::distributed::ValueCodec value_codec) {
   // Generate server proto desc
   ::paddle::distributed::PSParameter server_fleet_desc;
   ::paddle::distributed::ServerParameter* server_proto =
@@ -125,11 +128,12 @@ void GetDownpourSparseTableProto(
 
   ::paddle::distributed::TableParameter* sparse_table_proto =
       downpour_server_proto->add_downpour_table_param();
-  GetDownpourSparseTableProto(sparse_table_proto);
+  GetDownpourSparseTableProto(sparse_table_proto, value_codec);
   return server_fleet_desc;
 }
 
-::paddle::distributed::PSParameter GetWorkerProto() {
+::paddle::distributed::PSParameter GetWorkerProto(
+    ::paddle::distributed::ValueCodec value_codec) {
   ::paddle::distributed::PSParameter worker_fleet_desc;
   ::paddle::distributed::WorkerParameter* worker_proto =
       worker_fleet_desc.mutable_worker_param();
@@ -139,7 +143,7 @@ void GetDownpourSparseTableProto(
 
   ::paddle::distributed::TableParameter* worker_sparse_table_proto =
       downpour_worker_proto->add_downpour_table_param();
-  GetDownpourSparseTableProto(worker_sparse_table_proto);
+  GetDownpourSparseTableProto(worker_sparse_table_proto, value_codec);
 
   ::paddle::distributed::ServerParameter* server_proto =
       worker_fleet_desc.mutable_server_param();
@@ -155,7 +159,7 @@ void GetDownpourSparseTableProto(
 
   ::paddle::distributed::TableParameter* server_sparse_table_proto =
       downpour_server_proto->add_downpour_table_param();
-  GetDownpourSparseTableProto(server_sparse_table_proto);
+  GetDownpourSparseTableProto(server_sparse_table_proto, value_codec);
 
   return worker_fleet_desc;
 }
@@ -171,8 +175,9 @@ std::shared_ptr<paddle::distributed::PSServer> pserver_ptr_;
 
 std::shared_ptr<paddle::distributed::PSClient> worker_ptr_;
 
-void RunServer() {
-  ::paddle::distributed::PSParameter server_proto = GetServerProto();
+void RunServer(::paddle::distributed::ValueCodec value_codec) {
+  ::paddle::distributed::PSParameter server_proto =
+      GetServerProto(value_codec);
 
   auto _ps_env = paddle::distributed::PaddlePSEnvironment();
   _ps_env.SetPsServers(&host_sign_list_, 1);
@@ -186,8 +191,10 @@ void RunServer() {
 }
 
 void RunClient(std::map<uint64_t, std::vector<paddle::distributed::Region>>&
-                   dense_regions) {
-  ::paddle::distributed::PSParameter worker_proto = GetWorkerProto();
+                   dense_regions,
+               ::paddle::distributed::ValueCodec value_codec) {
+  ::paddle::distributed::PSParameter worker_proto =
+      GetWorkerProto(value_codec);
   paddle::distributed::PaddlePSEnvironment _ps_env;
   auto servers_ = host_sign_list_.size();
   _ps_env = paddle::distributed::PaddlePSEnvironment();
@@ -197,14 +204,19 @@ void RunClient(std::map<uint64_t, std::vector<paddle::distributed::Region>>&
   worker_ptr_->Configure(worker_proto, dense_regions, _ps_env, 0);
 }
 
-void RunBrpcPushSparse() {
+// abs_error is the error of the embedx pulled with value_codec
+void RunBrpcPushSparse(::paddle::distributed::ValueCodec value_codec,
+                       uint32_t port,
+                       float abs_error) {
   setenv("http_proxy", "", 1);
   setenv("https_proxy", "", 1);
+  port_ = port;
+  host_sign_list_.clear();
   auto ph_host = paddle::distributed::PSHost(ip_, port_, 0);
   host_sign_list_.push_back(ph_host.SerializeToString());
 
   // Srart Server
-  std::thread server_thread(RunServer);
+  std::thread server_thread(RunServer, value_codec);
   sleep(1);
 
   // Start Client
@@ -218,7 +230,7 @@ void RunBrpcPushSparse() {
   framework::Variable* var = client_scope.FindVar("x");
   phi::DenseTensor* tensor = var->GetMutable<phi::DenseTensor>();
 
-  RunClient(dense_regions);
+  RunClient(dense_regions, value_codec);
   std::vector<uint64_t> fea_keys(10);
   std::vector<float> fea_values(100);
   std::vector<float> fea_temp_values(100);
@@ -303,7 +315,11 @@ void RunBrpcPushSparse() {
   pull_update_status.wait();
 
   for (int64_t idx = 0; idx < tensor->numel(); ++idx) {
-    EXPECT_FLOAT_EQ(fea_temp_values[idx], fea_values[idx] - 1.0);
+    if (abs_error == 0) {
+      EXPECT_FLOAT_EQ(fea_temp_values[idx], fea_values[idx] - 1.0);
+    } else {
+      EXPECT_NEAR(fea_temp_values[idx], fea_values[idx] - 1.0, abs_error);
+    }
   }
 
   LOG(INFO) << "Run stop_server";
@@ -313,4 +329,12 @@ void RunBrpcPushSparse() {
   server_thread.join();
 }
 
-TEST(RunBrpcPushSparse, Run) { RunBrpcPushSparse(); }
+TEST(RunBrpcPushSparse, Run) {
+  RunBrpcPushSparse(paddle::distributed::VALUE_CODEC_NONE, 4209, 0);
+}
+
+TEST(RunBrpcPushSparse, ValueCodec) {
+  RunBrpcPushSparse(paddle::distributed::VALUE_CODEC_FP16, 4210, 2e-3);
+  RunBrpcPushSparse(paddle::distributed::VALUE_CODEC_BF16, 4211, 2e-2);
+  RunBrpcPushSparse(paddle::distributed::VALUE_CODEC_INT8, 4212, 2e-2);
+}
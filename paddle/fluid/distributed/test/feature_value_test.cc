@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
 
+#include <memory>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -46,5 +47,79 @@ TEST(BENCHMARK, LargeScaleKV) {
   ASSERT_FLOAT_EQ(value_data[3], 0.3);
 }
 
+TEST(SparseTableShard, FindAndEmplaceBatch) {
+  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  shard_type shard;
+  size_t key_num = 1000;
+  std::vector<uint64_t> keys(key_num);
+  for (size_t i = 0; i < key_num; ++i) {
+    keys[i] = i * 7919 + (static_cast<uint64_t>(i % 64) << 58);
+  }
+  std::vector<FixedFeatureValue*> values(key_num);
+  std::unique_ptr<bool[]> created(new bool[key_num]);
+
+  // insert the first half
+  shard.emplace_batch(keys.data(), key_num / 2, values.data(), created.get());
+  for (size_t i = 0; i < key_num / 2; ++i) {
+    ASSERT_TRUE(created[i]);
+    values[i]->resize(1);
+    values[i]->data()[0] = static_cast<float>(i);
+  }
+
+  shard.find_batch(keys.data(), key_num, values.data());
+  for (size_t i = 0; i < key_num; ++i) {
+    if (i < key_num / 2) {
+      ASSERT_TRUE(values[i] != NULL);
+      ASSERT_FLOAT_EQ(values[i]->data()[0], static_cast<float>(i));
+    } else {
+      ASSERT_TRUE(values[i] == NULL);
+    }
+  }
+
+  shard.emplace_batch(keys.data(), key_num, values.data(), created.get());
+  for (size_t i = 0; i < key_num; ++i) {
+    ASSERT_EQ(created[i], i >= key_num / 2);
+    ASSERT_TRUE(shard.find(keys[i]).value_ptr() == values[i]);
+  }
+  ASSERT_EQ(shard.size(), key_num);
+}
+
+TEST(SparseTableShard, InlineValue) {
+  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  shard_type shard;
+  FixedFeatureValue& value = shard.get_or_create(1, 4);
+  ASSERT_EQ(value.capacity(), 4);
+  value.resize(4);
+  float* inline_data = value.data();
+  ASSERT_EQ(reinterpret_cast<char*>(inline_data),
+            reinterpret_cast<char*>(&value) + sizeof(FixedFeatureValue));
+  for (int i = 0; i < 4; ++i) {
+    inline_data[i] = static_cast<float>(i);
+  }
+
+  // growing past the capacity moves the floats to the heap
+  value.resize(6);
+  ASSERT_TRUE(value.data() != inline_data);
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_FLOAT_EQ(value.data()[i], i < 4 ? static_cast<float>(i) : 0.0);
+  }
+  ASSERT_TRUE(&shard.find(1).value() == &value);
+
+  // and shrinking back to the capacity moves them inline again
+  value.resize(3);
+  ASSERT_TRUE(value.data() == inline_data);
+  ASSERT_FLOAT_EQ(inline_data[2], 2.0);
+
+  // an erased value is reused by the next value of the same capacity
+  size_t used_bytes = shard.value_used_bytes();
+  size_t reserved_bytes = shard.value_reserved_bytes();
+  shard.erase(1);
+  ASSERT_EQ(shard.value_used_bytes(), 0);
+  ASSERT_TRUE(&shard.get_or_create(2, 4) == &value);
+  ASSERT_EQ(value.size(), 0);
+  ASSERT_EQ(shard.value_used_bytes(), used_bytes);
+  ASSERT_EQ(shard.value_reserved_bytes(), reserved_bytes);
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,107 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Neighbor sampling of GraphNodes against a GraphCSR of the same edges. It
+// is built as a binary and not run as a test.
+
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+
+DEFINE_int32(node_num, 20000, "The number of nodes of the graph.");
+DEFINE_int32(max_degree, 100, "The max number of edges of a node.");
+DEFINE_int32(sample_size, 10, "The k of sample_k.");
+DEFINE_int32(rounds, 5, "The number of samples of each node.");
+
+namespace paddle {
+namespace distributed {
+
+// node i has (i % max_degree) + 1 edges of weight j + 1
+static std::vector<Node *> MakeNodes(size_t node_num, size_t max_degree) {
+  std::vector<Node *> nodes;
+  for (size_t i = 0; i < node_num; i++) {
+    GraphNode *node = new GraphNode(i);
+    node->build_edges(true);
+    for (size_t j = 0; j <= i % max_degree; j++) {
+      node->add_edge(i * 1000 + j, j + 1);
+    }
+    nodes.push_back(node);
+  }
+  return nodes;
+}
+
+static void RunBenchmark(const std::string &sample_type) {
+  size_t node_num = FLAGS_node_num;
+  int sample_size = FLAGS_sample_size;
+  auto rng = std::make_shared<std::mt19937_64>(0);
+  auto nodes = MakeNodes(node_num, FLAGS_max_degree);
+  for (auto *node : nodes) {
+    node->build_sampler(sample_type);
+  }
+  GraphCSR csr;
+  csr.build(nodes);
+  csr.build_sampler(sample_type);
+
+  uint64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < FLAGS_rounds; r++) {
+    for (size_t i = 0; i < node_num; i++) {
+      for (int idx : nodes[i]->sample_k(sample_size, rng)) {
+        checksum += nodes[i]->get_neighbor_id(idx);
+      }
+    }
+  }
+  double node_sec = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < FLAGS_rounds; r++) {
+    for (size_t i = 0; i < node_num; i++) {
+      for (int idx : csr.sample_k(i, sample_size, rng)) {
+        checksum += csr.neighbor_id(i, idx);
+      }
+    }
+  }
+  double csr_sec = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  double samples = static_cast<double>(node_num) * FLAGS_rounds;
+  std::cout << sample_type << " sample_k(" << sample_size
+            << "): GraphNode " << samples / node_sec << " nodes/s, GraphCSR "
+            << samples / csr_sec << " nodes/s, checksum " << checksum
+            << std::endl;
+  for (auto *node : nodes) {
+    delete node;
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
+
+int main(int argc, char *argv[]) {
+  ::GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  for (std::string sample_type : {"random", "weighted"}) {
+    paddle::distributed::RunBenchmark(sample_type);
+  }
+  return 0;
+}
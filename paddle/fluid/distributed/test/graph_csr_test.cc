@@ -0,0 +1,241 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
+
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/common_graph_table.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+// node i has (i % max_degree) + 1 edges, of weight j + 1 if is_weighted
+std::vector<Node *> MakeNodes(size_t node_num,
+                              size_t max_degree,
+                              bool is_weighted) {
+  std::vector<Node *> nodes;
+  for (size_t i = 0; i < node_num; i++) {
+    GraphNode *node = new GraphNode(i);
+    node->build_edges(is_weighted);
+    for (size_t j = 0; j <= i % max_degree; j++) {
+      node->add_edge(i * 1000 + j, is_weighted ? j + 1 : 1);
+    }
+    nodes.push_back(node);
+  }
+  return nodes;
+}
+
+void DeleteNodes(std::vector<Node *> *nodes) {
+  for (auto *node : *nodes) {
+    delete node;
+  }
+  nodes->clear();
+}
+
+void CheckEdges(const std::vector<Node *> &nodes, GraphCSR *csr) {
+  ASSERT_EQ(csr->node_num(), nodes.size());
+  for (size_t i = 0; i < nodes.size(); i++) {
+    Node *node = &csr->nodes()[i];
+    ASSERT_EQ(node->get_id(), nodes[i]->get_id());
+    ASSERT_EQ(node->get_neighbor_size(), nodes[i]->get_neighbor_size());
+    for (size_t j = 0; j < node->get_neighbor_size(); j++) {
+      ASSERT_EQ(node->get_neighbor_id(j), nodes[i]->get_neighbor_id(j));
+      ASSERT_EQ(node->get_neighbor_weight(j),
+                nodes[i]->get_neighbor_weight(j));
+    }
+  }
+}
+}  // namespace
+
+TEST(GraphCSR, Build) {
+  auto nodes = MakeNodes(100, 7, true);
+  GraphCSR csr;
+  csr.build(nodes);
+  ASSERT_TRUE(csr.is_weighted());
+  CheckEdges(nodes, &csr);
+  DeleteNodes(&nodes);
+
+  nodes = MakeNodes(100, 7, false);
+  csr.build(nodes);
+  ASSERT_FALSE(csr.is_weighted());
+  CheckEdges(nodes, &csr);
+  DeleteNodes(&nodes);
+}
+
+TEST(GraphCSR, SampleK) {
+  auto nodes = MakeNodes(64, 32, true);
+  auto rng = std::make_shared<std::mt19937_64>(0);
+  GraphCSR csr;
+  csr.build(nodes);
+  for (std::string sample_type : {"random", "weighted"}) {
+    csr.build_sampler(sample_type);
+    for (size_t row = 0; row < csr.node_num(); row++) {
+      int size = csr.neighbor_size(row);
+      for (int k : {1, 3, size / 2, size - 1, size, size + 1}) {
+        auto res = csr.sample_k(row, k, rng);
+        ASSERT_EQ(static_cast<int>(res.size()),
+                  std::max(std::min(k, size), 0));
+        std::set<int> distinct(res.begin(), res.end());
+        ASSERT_EQ(distinct.size(), res.size());
+        for (int idx : res) {
+          ASSERT_GE(idx, 0);
+          ASSERT_LT(idx, size);
+        }
+      }
+    }
+  }
+  DeleteNodes(&nodes);
+}
+
+TEST(GraphCSR, WeightedSample) {
+  // the weights of node 3 are 1, 2, 3, 4
+  auto nodes = MakeNodes(4, 4, true);
+  auto rng = std::make_shared<std::mt19937_64>(0);
+  GraphCSR csr;
+  csr.build(nodes);
+  csr.build_sampler("weighted");
+  WeightedGraphEdgeBlob edges;
+  for (int j = 0; j < 4; j++) {
+    edges.add_edge(nodes[3]->get_neighbor_id(j), j + 1);
+  }
+  WeightedSampler tree;
+  tree.build(&edges);
+
+  int times = 100000;
+  std::vector<double> freq(4, 0), pair_freq(4, 0), tree_pair_freq(4, 0);
+  for (int i = 0; i < times; i++) {
+    freq[csr.sample_k(3, 1, rng)[0]] += 1.0 / times;
+    for (int idx : csr.sample_k(3, 2, rng)) {
+      pair_freq[idx] += 1.0 / times;
+    }
+    for (int idx : tree.sample_k(2, rng)) {
+      tree_pair_freq[idx] += 1.0 / times;
+    }
+  }
+  for (int j = 0; j < 4; j++) {
+    ASSERT_NEAR(freq[j], (j + 1) / 10.0, 0.01);
+    // both sample without replacement in proportion to the weights
+    ASSERT_NEAR(pair_freq[j], tree_pair_freq[j], 0.02);
+  }
+  DeleteNodes(&nodes);
+}
+
+TEST(GraphCSR, SaveLoad) {
+  auto nodes = MakeNodes(100, 7, true);
+  auto rng = std::make_shared<std::mt19937_64>(0);
+  std::string path = "graph_csr_test.bin";
+  {
+    GraphCSR csr;
+    csr.build(nodes);
+    csr.build_sampler("weighted");
+    ASSERT_EQ(csr.save(path), 0);
+  }
+  GraphCSR csr;
+  ASSERT_EQ(csr.load(path), 0);
+  CheckEdges(nodes, &csr);
+  csr.build_sampler("weighted");
+  ASSERT_EQ(csr.sample_k(6, 3, rng).size(), 3UL);
+  unlink(path.c_str());
+  ASSERT_NE(csr.load(path), 0);
+  DeleteNodes(&nodes);
+}
+
+TEST(GraphCSR, LoadCorrupt) {
+  auto nodes = MakeNodes(10, 3, true);
+  std::string path = "graph_csr_corrupt_test.bin";
+  std::string region;
+  {
+    GraphCSR csr;
+    csr.build(nodes);
+    csr.build_sampler("weighted");
+    ASSERT_EQ(csr.save(path), 0);
+    std::ifstream in(path, std::ios::binary);
+    region.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+  }
+  // the header is magic, node_num, edge_num, is_weighted and has_alias,
+  // followed by the node ids and the node_num + 1 offsets
+  size_t node_num_pos = sizeof(uint64_t);
+  size_t edge_num_pos = 2 * sizeof(uint64_t);
+  size_t offsets_pos = 4 * sizeof(uint64_t) + 10 * sizeof(uint64_t);
+  auto corrupt = [&](size_t pos, uint64_t value) {
+    std::string bad = region;
+    memcpy(&bad[pos], &value, sizeof(value));
+    // a new file, the loaded graph maps the old one
+    unlink(path.c_str());
+    std::ofstream out(path, std::ios::binary);
+    out.write(bad.data(), bad.size());
+  };
+
+  GraphCSR csr;
+  corrupt(node_num_pos, 10);
+  ASSERT_EQ(csr.load(path), 0);
+  CheckEdges(nodes, &csr);
+  // counts that would overflow the region size
+  corrupt(node_num_pos, ~0ULL / 8);
+  ASSERT_NE(csr.load(path), 0);
+  corrupt(edge_num_pos, ~0ULL / 4);
+  ASSERT_NE(csr.load(path), 0);
+  // offsets that do not start at 0, decrease or do not end at edge_num
+  corrupt(offsets_pos, 1);
+  ASSERT_NE(csr.load(path), 0);
+  corrupt(offsets_pos + 2 * sizeof(uint64_t), 0);
+  ASSERT_NE(csr.load(path), 0);
+  corrupt(offsets_pos + 10 * sizeof(uint64_t), 1000);
+  ASSERT_NE(csr.load(path), 0);
+  // a failed load keeps the loaded graph
+  CheckEdges(nodes, &csr);
+  unlink(path.c_str());
+  DeleteNodes(&nodes);
+}
+
+TEST(GraphCSR, GraphShard) {
+  GraphShard shard;
+  for (uint64_t id = 0; id < 10; id++) {
+    shard.add_graph_node(id)->build_edges(false);
+    shard.add_neighbor(id, id + 100, 1);
+  }
+  shard.build_sampler("random");
+  shard.build_csr();
+  ASSERT_NE(shard.get_csr(), nullptr);
+  ASSERT_EQ(shard.find_node(3)->get_neighbor_id(0), 103UL);
+
+  // a change of the shard turns the nodes back into GraphNodes
+  shard.add_neighbor(3, 200, 1);
+  ASSERT_EQ(shard.get_csr(), nullptr);
+  ASSERT_EQ(shard.find_node(3)->get_neighbor_size(), 2UL);
+  ASSERT_EQ(shard.find_node(3)->get_neighbor_id(1), 200UL);
+  shard.build_csr();
+  shard.delete_node(5);
+  ASSERT_EQ(shard.get_size(), 9UL);
+  ASSERT_EQ(shard.find_node(5), nullptr);
+  auto rng = std::make_shared<std::mt19937_64>(0);
+  ASSERT_EQ(shard.find_node(3)->sample_k(2, rng).size(), 2UL);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,201 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Memory per feature and pull throughput of a MemorySparseTable. It is
+// built as a binary and not run as a test.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+DEFINE_int32(key_num, 2000000, "The number of features of the table.");
+DEFINE_int32(pull_times, 5, "The number of pulls of each key order.");
+DEFINE_int32(emb_dim, 8, "The embedx_dim of the accessor.");
+DEFINE_double(extend_rate,
+              0.2,
+              "The rate of the features pushed until they have embedx.");
+
+DECLARE_bool(pserver_create_value_when_push);
+
+namespace paddle {
+namespace distributed {
+
+static const int kShardNum = 10;
+
+static std::unique_ptr<Table> CreateTable(int emb_dim) {
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(kShardNum);
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(emb_dim);
+  accessor_config->set_embedx_threshold(5);
+  auto *ctr_param = accessor_config->mutable_ctr_accessor_param();
+  ctr_param->set_nonclk_coeff(0.2);
+  ctr_param->set_click_coeff(1);
+  ctr_param->set_base_threshold(0.5);
+  ctr_param->set_delta_threshold(0.2);
+  ctr_param->set_delta_keep_days(16);
+  ctr_param->set_show_click_decay_rate(0.99);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  table->SetShard(0, 1);
+  CHECK_EQ(table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+static void PullTable(Table *table,
+                      std::vector<uint64_t> *keys,
+                      int emb_dim,
+                      std::vector<float> *pull_values) {
+  std::vector<uint32_t> fres(keys->size(), 1);
+  auto value = PullSparseValue(*keys, fres, emb_dim);
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = value;
+  table_context.pull_context.values = pull_values->data();
+  table->Pull(table_context);
+}
+
+// slot, show, click, embed_g, embedx_g, a click of each key gives it embedx
+static void PushTable(Table *table,
+                      const std::vector<uint64_t> &keys,
+                      int emb_dim) {
+  std::vector<float> grads(keys.size() * (emb_dim + 4), 0.1);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    grads[i * (emb_dim + 4) + 1] = 10.0;
+    grads[i * (emb_dim + 4) + 2] = 10.0;
+  }
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.push_context.keys = keys.data();
+  table_context.push_context.values = grads.data();
+  table_context.num = keys.size();
+  table->Push(table_context);
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+static void BenchmarkPull() {
+  int emb_dim = FLAGS_emb_dim;
+  size_t key_num = FLAGS_key_num;
+  auto table = CreateTable(emb_dim);
+
+  std::vector<uint64_t> keys(key_num);
+  for (size_t i = 0; i < key_num; ++i) {
+    keys[i] = i * 7919;
+  }
+  std::vector<float> pull_values(key_num * (emb_dim + 3));
+  // the first pull creates the values without embedx
+  FLAGS_pserver_create_value_when_push = false;
+  PullTable(table.get(), &keys, emb_dim, &pull_values);
+  FLAGS_pserver_create_value_when_push = true;
+  std::vector<uint64_t> extend_keys(
+      keys.begin(), keys.begin() + key_num * FLAGS_extend_rate);
+  PushTable(table.get(), extend_keys, emb_dim);
+
+  // values which grow past their inline floats keep them on the heap
+  size_t used_bytes = 0;
+  size_t heap_bytes = 0;
+  for (int i = 0; i < kShardNum; ++i) {
+    auto *shard =
+        reinterpret_cast<MemorySparseTable::shard_type *>(table->GetShard(i));
+    used_bytes += shard->value_used_bytes();
+    for (auto it = shard->begin(); it != shard->end(); ++it) {
+      if (it.value().size() > it.value().capacity()) {
+        heap_bytes += it.value().size() * sizeof(float);
+      }
+    }
+  }
+  std::cout << "features: " << key_num << ", with embedx: "
+            << extend_keys.size() << ", value bytes per feature: "
+            << static_cast<double>(used_bytes + heap_bytes) / key_num
+            << " (heap " << static_cast<double>(heap_bytes) / key_num << ")"
+            << std::endl;
+
+  // find the values in their shards and read their floats, which is where
+  // the layout of the values matters
+  std::vector<std::pair<MemorySparseTable::shard_type *, uint64_t>> lookups;
+  for (int i = 0; i < kShardNum; ++i) {
+    auto *shard =
+        reinterpret_cast<MemorySparseTable::shard_type *>(table->GetShard(i));
+    for (auto it = shard->begin(); it != shard->end(); ++it) {
+      lookups.emplace_back(shard, it.key());
+    }
+  }
+  std::mt19937_64 rng(0);
+  std::shuffle(lookups.begin(), lookups.end(), rng);
+  float sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_pull_times; ++i) {
+    for (auto &lookup : lookups) {
+      auto &value = lookup.first->find(lookup.second).value();
+      for (size_t k = 0; k < value.size(); ++k) {
+        sum += value.data()[k];
+      }
+    }
+  }
+  std::cout << "shuffled find throughput: "
+            << key_num * FLAGS_pull_times / Seconds(start) << " keys/s"
+            << " (checksum " << sum << ")" << std::endl;
+
+  for (bool shuffled : {false, true}) {
+    if (shuffled) {
+      std::shuffle(keys.begin(), keys.end(), rng);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FLAGS_pull_times; ++i) {
+      PullTable(table.get(), &keys, emb_dim, &pull_values);
+    }
+    std::cout << (shuffled ? "shuffled" : "sequential")
+              << " pull throughput: "
+              << key_num * FLAGS_pull_times / Seconds(start) << " keys/s"
+              << std::endl;
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
+
+int main(int argc, char *argv[]) {
+  ::GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  paddle::distributed::BenchmarkPull();
+  return 0;
+}
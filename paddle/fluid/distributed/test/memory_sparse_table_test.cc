@@ -17,13 +17,23 @@ limitations under the License. */
 #include <ThreadPool.h>
 #include <unistd.h>
 
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <map>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/ctr_accessor.h"
+#include "paddle/fluid/distributed/ps/table/sparse_binary_shard.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/io/fs.h"
+
+DECLARE_bool(pserver_create_value_when_push);
 
 namespace paddle {
 namespace distributed {
@@ -152,5 +162,352 @@ TEST(MemorySparseTable, SGD) {
   }
 }
 
+static void SetCtrCommonAccessorConfig(TableAccessorParameter *accessor_config,
+                                       int emb_dim) {
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(emb_dim);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+}
+
+TEST(MemorySparseTable, BinarySaveLoad) {
+  int emb_dim = 8;
+  int shard_num = 4;
+  size_t key_num = 1000;
+  std::string model_dir = "./memory_sparse_table_binary_test";
+  paddle::framework::localfs_remove(model_dir);
+
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(shard_num);
+  table_config.set_binary_in_save(true);
+  SetCtrCommonAccessorConfig(table_config.mutable_accessor(), emb_dim);
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  table->SetShard(0, 1);
+  ASSERT_EQ(table->Initialize(table_config, fs_config), 0);
+
+  std::vector<uint64_t> keys(key_num);
+  for (size_t i = 0; i < key_num; ++i) {
+    keys[i] = i * 131;
+  }
+  std::vector<uint32_t> fres(key_num, 1);
+  auto value = PullSparseValue(keys, fres, emb_dim);
+  std::vector<float> pull_values(key_num * (emb_dim + 3));
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = value;
+  table_context.pull_context.values = pull_values.data();
+  FLAGS_pserver_create_value_when_push = false;
+  table->Pull(table_context);
+  FLAGS_pserver_create_value_when_push = true;
+
+  ASSERT_EQ(table->Save(model_dir, "0"), 0);
+  auto file_list = paddle::framework::localfs_list(model_dir + "/000");
+  ASSERT_EQ(file_list.size(), static_cast<size_t>(shard_num));
+  for (auto &file : file_list) {
+    ASSERT_TRUE(IsSparseBinaryShard(file));
+  }
+
+  // load the binary checkpoint into a text configured table
+  table_config.set_binary_in_save(false);
+  std::unique_ptr<Table> load_table(new MemorySparseTable());
+  load_table->SetShard(0, 1);
+  ASSERT_EQ(load_table->Initialize(table_config, fs_config), 0);
+  ASSERT_EQ(load_table->Load(model_dir, "0"), 0);
+  std::vector<float> load_values(key_num * (emb_dim + 3));
+  table_context.pull_context.values = load_values.data();
+  load_table->Pull(table_context);
+  for (size_t i = 0; i < pull_values.size(); ++i) {
+    ASSERT_EQ(pull_values[i], load_values[i]);
+  }
+
+  // binary -> text -> binary keeps the features
+  AfsClient afs_client;
+  afs_client.initialize(fs_config);
+  auto *accessor = load_table->ValueAccesor().get();
+  std::string text_path = model_dir + "/shard.txt";
+  std::string binary_path = model_dir + "/shard" PSERVER_BINARY_SAVE_SUFFIX;
+  FsChannelConfig text_config;
+  text_config.path = text_path;
+  ASSERT_EQ(ConvertSparseBinaryShardToText(
+                &afs_client, accessor, file_list[0], text_config),
+            0);
+  ASSERT_EQ(ConvertSparseTextShardToBinary(
+                &afs_client, accessor, text_config, binary_path),
+            0);
+  std::map<uint64_t, std::vector<float>> features;
+  SparseBinaryShardReader reader;
+  ASSERT_EQ(reader.Open(file_list[0], &afs_client), 0);
+  ASSERT_EQ(
+      reader.ForEach([&](uint64_t key, const float *data, size_t size) {
+        features[key].assign(data, data + size);
+      }),
+      0);
+  SparseBinaryShardReader convert_reader;
+  ASSERT_EQ(convert_reader.Open(binary_path, &afs_client), 0);
+  size_t convert_num = 0;
+  ASSERT_EQ(
+      convert_reader.ForEach([&](uint64_t key, const float *data, size_t size) {
+        ASSERT_EQ(features.count(key), 1UL);
+        ASSERT_EQ(features[key].size(), size);
+        for (size_t i = 0; i < size; ++i) {
+          ASSERT_NEAR(features[key][i], data[i], 1e-5);
+        }
+        ++convert_num;
+      }),
+      0);
+  ASSERT_EQ(convert_num, features.size());
+
+  // a table of another value_dim fails to load the shards
+  SetCtrCommonAccessorConfig(table_config.mutable_accessor(), emb_dim / 2);
+  std::unique_ptr<Table> mismatch_table(new MemorySparseTable());
+  mismatch_table->SetShard(0, 1);
+  ASSERT_EQ(mismatch_table->Initialize(table_config, fs_config), 0);
+  ASSERT_EQ(mismatch_table->Load(model_dir, "0"), -1);
+  paddle::framework::localfs_remove(model_dir);
+}
+
+// broken shards are rejected by the reader, both mapped and read through a
+// channel, instead of being read out of bounds
+TEST(MemorySparseTable, BinaryShardCorrupt) {
+  std::string model_dir = "./memory_sparse_table_corrupt_test";
+  paddle::framework::localfs_remove(model_dir);
+  paddle::framework::localfs_mkdir(model_dir);
+  FsClientParameter fs_config;
+  AfsClient afs_client;
+  afs_client.initialize(fs_config);
+  FsChannelConfig channel_config;
+  channel_config.path = model_dir + "/shard" PSERVER_BINARY_SAVE_SUFFIX;
+  int err_no = 0;
+  auto write_channel = afs_client.open_w(channel_config, 0, &err_no);
+  SparseBinaryShardWriter writer(write_channel, 4, 2, 2);
+  std::vector<float> value = {1.0, 2.0, 3.0, 4.0};
+  ASSERT_EQ(writer.WriteHeader(), 0);
+  ASSERT_EQ(writer.Append(1, value.data(), 4), 0);
+  ASSERT_EQ(writer.Append(2, value.data(), 2), 0);
+  ASSERT_EQ(writer.Finish(), 0);
+  write_channel->close();
+  std::ifstream fin(channel_config.path, std::ios::binary);
+  std::string shard((std::istreambuf_iterator<char>(fin)),
+                    std::istreambuf_iterator<char>());
+
+  // -2 if the header is rejected, -1 if a block is rejected
+  auto read_shard = [&](const std::string &data, bool with_deconverter) {
+    std::ofstream(channel_config.path, std::ios::binary) << data;
+    FsChannelConfig read_config;
+    read_config.path = channel_config.path;
+    if (with_deconverter) {
+      read_config.deconverter = "cat";
+    }
+    SparseBinaryShardReader reader;
+    if (reader.Open(read_config, &afs_client) != 0) {
+      return -2;
+    }
+    int feature_num = 0;
+    if (reader.ForEach([&](uint64_t key, const float *data, size_t size) {
+          ++feature_num;
+        }) != 0) {
+      return -1;
+    }
+    return feature_num;
+  };
+  size_t block = sizeof(SparseBinaryShardHeader);
+  for (bool with_deconverter : {false, true}) {
+    ASSERT_EQ(read_shard(shard, with_deconverter), 2);
+    // a value longer than value_dim
+    std::string broken = shard;
+    uint32_t size = 5;
+    memcpy(&broken[block + 3 * sizeof(uint64_t)], &size, sizeof(size));
+    ASSERT_EQ(read_shard(broken, with_deconverter), -1);
+    // more keys than block_key_num, and so many that the block bytes
+    // overflow
+    for (uint64_t key_num : {3ULL, 1ULL << 62}) {
+      broken = shard;
+      memcpy(&broken[block], &key_num, sizeof(key_num));
+      ASSERT_EQ(read_shard(broken, with_deconverter), -1);
+    }
+    // a header without values
+    broken = shard;
+    uint32_t value_dim = 0;
+    memcpy(&broken[offsetof(SparseBinaryShardHeader, value_dim)],
+           &value_dim,
+           sizeof(value_dim));
+    ASSERT_EQ(read_shard(broken, with_deconverter), -2);
+  }
+  paddle::framework::localfs_remove(model_dir);
+}
+
+static size_t CountSavedFeatures(const std::string &table_dir) {
+  size_t line_num = 0;
+  for (auto &file : paddle::framework::localfs_list(table_dir)) {
+    std::ifstream fin(file);
+    std::string line;
+    while (std::getline(fin, line)) {
+      ++line_num;
+    }
+  }
+  return line_num;
+}
+
+TEST(MemorySparseTable, DirtyTrackingDeltaSave) {
+  int emb_dim = 8;
+  size_t key_num = 1000;
+  size_t dirty_num = 100;
+  std::string model_dir = "./memory_sparse_table_dirty_test";
+  paddle::framework::localfs_remove(model_dir);
+
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(4);
+  table_config.set_enable_sparse_table_cache(false);
+  table_config.set_enable_dirty_tracking(true);
+  SetCtrCommonAccessorConfig(table_config.mutable_accessor(), emb_dim);
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  table->SetShard(0, 1);
+  ASSERT_EQ(table->Initialize(table_config, fs_config), 0);
+
+  // slot, show, click, embed_g, embedx_g
+  auto push = [&](size_t num) {
+    std::vector<uint64_t> keys(num);
+    std::vector<float> grads(num * (emb_dim + 4), 0.1);
+    for (size_t i = 0; i < num; ++i) {
+      keys[i] = i * 131;
+      grads[i * (emb_dim + 4) + 1] = 1.0;
+      grads[i * (emb_dim + 4) + 2] = 1.0;
+    }
+    TableContext table_context;
+    table_context.value_type = Sparse;
+    table_context.push_context.keys = keys.data();
+    table_context.push_context.values = grads.data();
+    table_context.num = num;
+    table->Push(table_context);
+  };
+
+  // the first delta save scans the whole table
+  push(key_num);
+  ASSERT_EQ(table->Save(model_dir, "1"), 0);
+  ASSERT_EQ(CountSavedFeatures(model_dir + "/000"), key_num);
+
+  // later ones only visit the pushed features, each of them once
+  push(dirty_num);
+  push(dirty_num);
+  ASSERT_EQ(table->Save(model_dir, "1"), 0);
+  ASSERT_EQ(CountSavedFeatures(model_dir + "/000"), dirty_num);
+
+  // a checkpoint keeps the dirty features for the next delta
+  push(dirty_num);
+  ASSERT_EQ(table->Save(model_dir + "_checkpoint", "0"), 0);
+  ASSERT_EQ(table->Save(model_dir, "1"), 0);
+  ASSERT_EQ(CountSavedFeatures(model_dir + "/000"), dirty_num);
+  paddle::framework::localfs_remove(model_dir + "_checkpoint");
+
+  ASSERT_EQ(table->Save(model_dir, "1"), 0);
+  ASSERT_EQ(CountSavedFeatures(model_dir + "/000"), 0UL);
+
+  // so do the features changed through the pointers of PullSparsePtr
+  size_t ptr_num = 10;
+  std::vector<uint64_t> ptr_keys(ptr_num);
+  for (size_t i = 0; i < ptr_num; ++i) {
+    ptr_keys[i] = (key_num - 1 - i) * 131;
+  }
+  std::vector<char *> ptr_values(ptr_num);
+  auto *sparse_table = dynamic_cast<MemorySparseTable *>(table.get());
+  ASSERT_EQ(sparse_table->PullSparsePtr(
+                0, ptr_values.data(), ptr_keys.data(), ptr_num, 0),
+            0);
+  auto *accessor =
+      dynamic_cast<CtrCommonAccessor *>(table->ValueAccesor().get());
+  for (char *ptr : ptr_values) {
+    auto *value = reinterpret_cast<FixedFeatureValue *>(ptr);
+    accessor->common_feature_value.DeltaScore(value->data()) = 100;
+  }
+  ASSERT_EQ(table->Save(model_dir, "1"), 0);
+  ASSERT_EQ(CountSavedFeatures(model_dir + "/000"), ptr_num);
+  paddle::framework::localfs_remove(model_dir);
+}
+
+TEST(MemorySparseTable, PullSelectFromStorage) {
+  int emb_dim = 8;
+  int shard_num = 4;
+  size_t key_num = 1000;
+
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(shard_num);
+  SetCtrCommonAccessorConfig(table_config.mutable_accessor(), emb_dim);
+  FsClientParameter fs_config;
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  table->SetShard(0, 1);
+  ASSERT_EQ(table->Initialize(table_config, fs_config), 0);
+
+  // half of the features are pushed enough times to extend the embedx
+  std::vector<uint64_t> keys(key_num);
+  std::vector<float> grads(key_num * (emb_dim + 4), 0.1);
+  for (size_t i = 0; i < key_num; ++i) {
+    keys[i] = i * 131;
+    grads[i * (emb_dim + 4) + 1] = i % 2 ? 10.0 : 1.0;
+    grads[i * (emb_dim + 4) + 2] = i % 2 ? 10.0 : 0.0;
+  }
+  TableContext push_context;
+  push_context.value_type = Sparse;
+  push_context.push_context.keys = keys.data();
+  push_context.push_context.values = grads.data();
+  push_context.num = key_num;
+  table->Push(push_context);
+
+  // the missing keys are pulled as zero
+  keys.push_back(1);
+  std::vector<uint32_t> fres(keys.size(), 1);
+  auto value = PullSparseValue(keys, fres, emb_dim);
+  std::vector<float> pull_values(keys.size() * (emb_dim + 3), -1.0);
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = value;
+  table_context.pull_context.values = pull_values.data();
+  table->Pull(table_context);
+
+  auto *accessor = table->ValueAccesor().get();
+  size_t value_dim = accessor->GetAccessorInfo().size / sizeof(float);
+  size_t extended_num = 0;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto *shard = reinterpret_cast<MemorySparseTable::shard_type *>(
+        table->GetShard(keys[i] % shard_num));
+    std::vector<float> buffer(value_dim, 0.0);
+    auto itr = shard->find(keys[i]);
+    if (itr != shard->end()) {
+      memcpy(buffer.data(),
+             itr.value().data(),
+             itr.value().size() * sizeof(float));
+      extended_num += itr.value().size() == value_dim;
+    }
+    std::vector<float> expected(emb_dim + 3);
+    float *expected_ptr = expected.data();
+    const float *buffer_ptr = buffer.data();
+    accessor->Select(&expected_ptr, &buffer_ptr, 1);
+    for (int j = 0; j < emb_dim + 3; ++j) {
+      ASSERT_EQ(expected[j], pull_values[i * (emb_dim + 3) + j]);
+    }
+  }
+  ASSERT_EQ(extended_num, key_num / 2);
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,151 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(SparsePullCache, Staleness) {
+  size_t dim = 4;
+  SparsePullCache cache(64, dim, /*max_staleness=*/4, /*admit_count=*/2);
+  std::vector<float> value = {1, 2, 3, 4};
+  std::vector<float> pulled(dim);
+  bool need_refresh = false;
+
+  // a key is cached from its second pull on
+  uint64_t step = cache.NextStep();
+  ASSERT_FALSE(cache.Get(7, step, pulled.data(), &need_refresh));
+  cache.Put(7, step, value.data());
+  step = cache.NextStep();
+  ASSERT_FALSE(cache.Get(7, step, pulled.data(), &need_refresh));
+  cache.Put(7, step, value.data());
+  uint64_t put_step = step;
+
+  // fresh, then refreshed once from half of max_staleness on
+  std::vector<bool> refreshes;
+  for (int i = 0; i < 4; ++i) {
+    step = cache.NextStep();
+    ASSERT_TRUE(cache.Get(7, step, pulled.data(), &need_refresh));
+    ASSERT_EQ(pulled, value);
+    refreshes.push_back(need_refresh);
+  }
+  EXPECT_EQ(refreshes, std::vector<bool>({false, true, false, false}));
+  // too stale
+  step = cache.NextStep();
+  ASSERT_EQ(step - put_step, 5u);
+  ASSERT_FALSE(cache.Get(7, step, pulled.data(), &need_refresh));
+
+  // the value pulled again is served again
+  value[0] = 10;
+  cache.Put(7, step, value.data());
+  step = cache.NextStep();
+  ASSERT_TRUE(cache.Get(7, step, pulled.data(), &need_refresh));
+  ASSERT_EQ(pulled[0], 10);
+
+  SparsePullCacheStat stat = cache.GetStat();
+  EXPECT_EQ(stat.hit_keys, 5u);
+  EXPECT_EQ(stat.miss_keys, 3u);
+  EXPECT_EQ(stat.refresh_keys, 1u);
+
+  cache.Clear();
+  ASSERT_FALSE(cache.Get(7, step, pulled.data(), &need_refresh));
+}
+
+TEST(SparsePullCache, CancelRefresh) {
+  size_t dim = 4;
+  SparsePullCache cache(64, dim, /*max_staleness=*/4, /*admit_count=*/1);
+  std::vector<float> value = {1, 2, 3, 4};
+  std::vector<float> pulled(dim);
+  bool need_refresh = false;
+
+  uint64_t step = cache.NextStep();
+  ASSERT_FALSE(cache.Get(7, step, pulled.data(), &need_refresh));
+  cache.Put(7, step, value.data());
+  cache.NextStep();
+  step = cache.NextStep();
+  ASSERT_TRUE(cache.Get(7, step, pulled.data(), &need_refresh));
+  ASSERT_TRUE(need_refresh);
+  step = cache.NextStep();
+  ASSERT_TRUE(cache.Get(7, step, pulled.data(), &need_refresh));
+  ASSERT_FALSE(need_refresh);
+
+  // the refresh failed, the next hit asks for it again
+  cache.CancelRefresh(7);
+  ASSERT_TRUE(cache.Get(7, step, pulled.data(), &need_refresh));
+  ASSERT_TRUE(need_refresh);
+}
+
+TEST(SparsePullCache, KeepsHotKeys) {
+  size_t dim = 2;
+  SparsePullCache cache(256, dim, 1000, 2);
+  std::vector<float> value = {1, 2};
+  std::vector<float> pulled(dim);
+  bool need_refresh = false;
+  // 32 hot keys pulled every step, 10000 cold keys pulled twice each
+  for (int round = 0; round < 2; ++round) {
+    for (uint64_t key = 1000; key < 11000; ++key) {
+      uint64_t step = cache.NextStep();
+      for (uint64_t hot = 0; hot < 32; ++hot) {
+        if (!cache.Get(hot, step, pulled.data(), &need_refresh)) {
+          cache.Put(hot, step, value.data());
+        }
+      }
+      if (!cache.Get(key, step, pulled.data(), &need_refresh)) {
+        cache.Put(key, step, value.data());
+      }
+    }
+  }
+  SparsePullCacheStat stat = cache.GetStat();
+  // almost every pull of a hot key hits
+  EXPECT_GT(stat.hit_keys, 32u * 20000 * 99 / 100);
+}
+
+TEST(SparsePullCache, MultiThread) {
+  size_t dim = 8;
+  SparsePullCache cache(1024, dim, 8, 1);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&cache, dim, t]() {
+      std::vector<float> pulled(dim);
+      bool need_refresh = false;
+      for (int i = 0; i < 10000; ++i) {
+        uint64_t key = (i * 7 + t) % 2048;
+        uint64_t step = cache.NextStep();
+        if (cache.Get(key, step, pulled.data(), &need_refresh)) {
+          // a value is never torn
+          for (size_t j = 0; j < dim; ++j) {
+            ASSERT_EQ(pulled[j], static_cast<float>(key));
+          }
+        } else {
+          std::vector<float> value(dim, static_cast<float>(key));
+          cache.Put(key, step, value.data());
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  SparsePullCacheStat stat = cache.GetStat();
+  EXPECT_EQ(stat.hit_keys + stat.miss_keys, 40000u);
+}
+
+}  // namespace distributed
+}  // namespace paddle
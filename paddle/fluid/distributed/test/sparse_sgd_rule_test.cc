@@ -14,8 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
 
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <random>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
@@ -205,5 +208,145 @@ TEST(downpour_sparse_adam_test, test_init_and_update) {
     ASSERT_FLOAT_EQ(value[i], label[i]) << "i is " << i;
   }
 }
+
+// the simd kernels do the arithmetic of the reference ones, they are checked
+// on dims with and without a tail
+TEST(sparse_sgd_rule_kernel_test, simd_matches_ref) {
+  std::vector<const SparseSGDKernels*> simd_kernels = {
+      GetSparseSGDAVX2Kernels(), GetSparseSGDAVX512Kernels()};
+  const SparseSGDKernels& ref = GetSparseSGDRefKernels();
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.0, 1.0);
+  for (auto* kernels : simd_kernels) {
+    if (kernels == nullptr) {
+      continue;
+    }
+    for (size_t dim : {1, 7, 8, 9, 16, 17, 64, 67}) {
+      std::vector<float> w(dim), g(dim), gsum(dim), g2sum(dim);
+      for (size_t i = 0; i < dim; ++i) {
+        w[i] = dist(rng);
+        g[i] = dist(rng) * 4;
+        gsum[i] = dist(rng) * 0.1;
+        g2sum[i] = std::fabs(dist(rng));
+      }
+      // large weights to check the bounds
+      w[0] = 9.9;
+      g[0] = -2.0;
+      auto w_ref = w, gsum_ref = gsum, g2sum_ref = g2sum;
+
+      ref.naive(w_ref.data(), g.data(), dim, 0.1, -10, 10);
+      kernels->naive(w.data(), g.data(), dim, 0.1, -10, 10);
+      double add_ref =
+          ref.adagrad(w_ref.data(), g.data(), dim, 0.05, 0.7, 2.0, -10, 10);
+      double add =
+          kernels->adagrad(w.data(), g.data(), dim, 0.05, 0.7, 2.0, -10, 10);
+      ASSERT_NEAR(add, add_ref, 1e-12 * dim);
+      ref.std_adagrad(
+          w_ref.data(), g2sum_ref.data(), g.data(), dim, 0.05, 3, 2, -10, 10);
+      kernels->std_adagrad(
+          w.data(), g2sum.data(), g.data(), dim, 0.05, 3, 2, -10, 10);
+      ref.adam(w_ref.data(),
+               gsum_ref.data(),
+               g2sum_ref.data(),
+               g.data(),
+               dim,
+               0.01,
+               0.9,
+               0.999,
+               1e-8,
+               -10,
+               10);
+      kernels->adam(w.data(),
+                    gsum.data(),
+                    g2sum.data(),
+                    g.data(),
+                    dim,
+                    0.01,
+                    0.9,
+                    0.999,
+                    1e-8,
+                    -10,
+                    10);
+      double sum_gsum_ref, sum_g2sum_ref, sum_gsum, sum_g2sum;
+      ref.shared_adam(w_ref.data(),
+                      g.data(),
+                      dim,
+                      0.01,
+                      0.2,
+                      0.5,
+                      0.9,
+                      0.999,
+                      1e-8,
+                      -10,
+                      10,
+                      &sum_gsum_ref,
+                      &sum_g2sum_ref);
+      kernels->shared_adam(w.data(),
+                           g.data(),
+                           dim,
+                           0.01,
+                           0.2,
+                           0.5,
+                           0.9,
+                           0.999,
+                           1e-8,
+                           -10,
+                           10,
+                           &sum_gsum,
+                           &sum_g2sum);
+      ASSERT_NEAR(sum_gsum, sum_gsum_ref, 1e-12 * dim);
+      ASSERT_NEAR(sum_g2sum, sum_g2sum_ref, 1e-12 * dim);
+      ASSERT_FLOAT_EQ(w[0], 10);
+      for (size_t i = 0; i < dim; ++i) {
+        ASSERT_FLOAT_EQ(w[i], w_ref[i]) << kernels->name << " dim " << dim;
+        ASSERT_FLOAT_EQ(gsum[i], gsum_ref[i]);
+        ASSERT_FLOAT_EQ(g2sum[i], g2sum_ref[i]);
+      }
+    }
+  }
+}
+
+// an embedding shorter than the avx512f vector, e.g. embedx of 8 dims, is
+// updated by the avx2 kernels
+TEST(sparse_sgd_rule_kernel_test, select_by_dim) {
+  const SparseSGDKernels* avx2 = GetSparseSGDAVX2Kernels();
+  const SparseSGDKernels* avx512 = GetSparseSGDAVX512Kernels();
+  ASSERT_STREQ(GetSparseSGDKernels(1).name, "ref");
+  if (avx2 != nullptr) {
+    ASSERT_EQ(&GetSparseSGDKernels(8), avx2);
+    ASSERT_EQ(&GetSparseSGDKernels(15), avx2);
+  }
+  if (avx512 != nullptr) {
+    ASSERT_EQ(&GetSparseSGDKernels(16), avx512);
+    ASSERT_EQ(&GetSparseSGDKernels(64), avx512);
+  }
+}
+
+TEST(sparse_sgd_rule_kernel_test, adagrad_benchmark) {
+  const size_t kDim = 64;
+  const int kRounds = 100000;
+  std::vector<float> w(kDim, 0.1), g(kDim, 0.01);
+  std::vector<const SparseSGDKernels*> all_kernels = {
+      &GetSparseSGDRefKernels(),
+      GetSparseSGDAVX2Kernels(),
+      GetSparseSGDAVX512Kernels()};
+  for (auto* kernels : all_kernels) {
+    if (kernels == nullptr) {
+      continue;
+    }
+    auto start = std::chrono::steady_clock::now();
+    double add_g2sum = 0;
+    for (int i = 0; i < kRounds; ++i) {
+      add_g2sum +=
+          kernels->adagrad(w.data(), g.data(), kDim, 0.05, 0.7, 1, -10, 10);
+    }
+    auto cost = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    LOG(INFO) << kernels->name << " adagrad dim " << kDim << ": "
+              << cost * 1000.0 / kRounds << " ns/update, " << add_g2sum;
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
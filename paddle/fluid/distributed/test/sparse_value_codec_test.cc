@@ -0,0 +1,72 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_value_codec.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace distributed {
+
+TEST(SparseValueCodec, EncodeDecode) {
+  // slot, show, click, embed_g and 64 embedx_g
+  size_t dim = 68;
+  std::vector<float> value(dim);
+  value[0] = 123456;
+  value[1] = 3;
+  value[2] = 1;
+  for (size_t i = 3; i < dim; ++i) {
+    value[i] = std::sin(static_cast<float>(i)) * 0.01;
+  }
+
+  std::vector<std::pair<ValueCodec, float>> codecs = {
+      {VALUE_CODEC_NONE, 0}, {VALUE_CODEC_FP16, 1e-5},
+      {VALUE_CODEC_BF16, 1e-4}, {VALUE_CODEC_INT8, 1e-4}};
+  for (auto& codec_error : codecs) {
+    SparseValueCodec codec(codec_error.first, dim, 64);
+    std::string encoded(codec.EncodedSize(), '\0');
+    codec.Encode(value.data(), &encoded[0]);
+    std::vector<float> decoded(dim);
+    codec.Decode(encoded.data(), decoded.data());
+    // the fields before the embedx are sent as they are
+    for (size_t i = 0; i < 4; ++i) {
+      ASSERT_EQ(decoded[i], value[i]);
+    }
+    for (size_t i = 4; i < dim; ++i) {
+      ASSERT_NEAR(decoded[i], value[i], codec_error.second);
+    }
+  }
+  EXPECT_EQ(SparseValueCodec(VALUE_CODEC_NONE, dim, 64).EncodedSize(),
+            dim * sizeof(float));
+  EXPECT_EQ(SparseValueCodec(VALUE_CODEC_FP16, dim, 64).EncodedSize(),
+            4 * sizeof(float) + 64 * 2);
+  EXPECT_EQ(SparseValueCodec(VALUE_CODEC_INT8, dim, 64).EncodedSize(),
+            5 * sizeof(float) + 64);
+
+  // the codec goes with the request
+  PsRequestMessage request;
+  request.set_cmd_id(0);
+  request.add_params("num");
+  SparseValueCodec(VALUE_CODEC_INT8, dim, 64).AddToRequest(&request);
+  EXPECT_EQ(SparseValueCodec::FromRequest(request, 1, dim).EncodedSize(),
+            5 * sizeof(float) + 64);
+  EXPECT_FALSE(SparseValueCodec::FromRequest(request, 2, dim).Encoded());
+}
+
+}  // namespace distributed
+}  // namespace paddle
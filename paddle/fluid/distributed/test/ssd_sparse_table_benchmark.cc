@@ -0,0 +1,148 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Pulls of an SSDSparseTable whose values are all in rocksdb, with and
+// without prefetch. It is built as a binary and not run as a test.
+
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+DEFINE_int32(key_num, 200000, "The number of keys of a pull.");
+DEFINE_int32(pull_times, 5, "The number of pulls of each kind.");
+DEFINE_string(db_path,
+              "./ssd_sparse_table_benchmark_db",
+              "The rocksdb directory of the table.");
+
+DECLARE_bool(pserver_create_value_when_push);
+DECLARE_string(rocksdb_path);
+
+namespace paddle {
+namespace distributed {
+
+static std::unique_ptr<SSDSparseTable> CreateSSDTable(
+    const std::string &rocksdb_path, int emb_dim, int shard_num) {
+  FLAGS_rocksdb_path = rocksdb_path;
+  TableParameter table_config;
+  table_config.set_table_class("SSDSparseTable");
+  table_config.set_shard_num(shard_num);
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(emb_dim);
+  accessor_config->set_embedx_threshold(5);
+  auto *ctr_param = accessor_config->mutable_ctr_accessor_param();
+  ctr_param->set_nonclk_coeff(0.2);
+  ctr_param->set_click_coeff(1);
+  ctr_param->set_base_threshold(0.5);
+  ctr_param->set_delta_threshold(0.2);
+  ctr_param->set_delta_keep_days(16);
+  ctr_param->set_show_click_decay_rate(0.99);
+  ctr_param->set_ssd_unseenday_threshold(-1);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  FsClientParameter fs_config;
+  std::unique_ptr<SSDSparseTable> table(new SSDSparseTable());
+  Table *base_table = table.get();
+  base_table->SetShard(0, 1);
+  CHECK_EQ(base_table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+static void PullTable(Table *table,
+                      const std::vector<uint64_t> &keys,
+                      int emb_dim,
+                      std::vector<float> *pull_values) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  auto value = PullSparseValue(keys, fres, emb_dim);
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = value;
+  table_context.pull_context.values = pull_values->data();
+  table->Pull(table_context);
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+static void BenchmarkPullFromRocksDB() {
+  int emb_dim = 8;
+  size_t key_num = FLAGS_key_num;
+  auto table = CreateSSDTable(FLAGS_db_path, emb_dim, 10);
+
+  std::vector<uint64_t> keys(key_num);
+  for (size_t i = 0; i < key_num; ++i) {
+    keys[i] = i * 7919;
+  }
+  std::vector<float> pull_values(key_num * (emb_dim + 3));
+  FLAGS_pserver_create_value_when_push = false;
+  PullTable(table.get(), keys, emb_dim, &pull_values);
+  FLAGS_pserver_create_value_when_push = true;
+
+  // every pull reads all the keys from rocksdb
+  double pull_seconds = 0;
+  for (int i = 0; i < FLAGS_pull_times; ++i) {
+    table->UpdateTable();
+    auto start = std::chrono::steady_clock::now();
+    PullTable(table.get(), keys, emb_dim, &pull_values);
+    pull_seconds += Seconds(start);
+  }
+  // the pull waits for the prefetch of its keys, in training the prefetch
+  // overlaps the compute of the previous batch, which is not run here
+  double prefetch_pull_seconds = 0;
+  for (int i = 0; i < FLAGS_pull_times; ++i) {
+    table->UpdateTable();
+    auto tasks = table->PrefetchSparse(keys.data(), keys.size());
+    auto start = std::chrono::steady_clock::now();
+    for (auto &task : tasks) {
+      task.wait();
+    }
+    PullTable(table.get(), keys, emb_dim, &pull_values);
+    prefetch_pull_seconds += Seconds(start);
+  }
+  CHECK_EQ(table->LocalSize(), static_cast<int64_t>(key_num));
+  std::cout << "pull from rocksdb throughput: "
+            << key_num * FLAGS_pull_times / pull_seconds << " keys/s, "
+            << "prefetched: "
+            << key_num * FLAGS_pull_times / prefetch_pull_seconds
+            << " keys/s" << std::endl;
+}
+
+}  // namespace distributed
+}  // namespace paddle
+
+int main(int argc, char *argv[]) {
+  ::GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  paddle::distributed::BenchmarkPullFromRocksDB();
+  return 0;
+}
@@ -0,0 +1,182 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+DECLARE_bool(pserver_create_value_when_push);
+DECLARE_string(rocksdb_path);
+DECLARE_string(pserver_ssd_tiering_policy);
+DECLARE_int64(pserver_ssd_mem_limit_mb);
+DECLARE_int32(pserver_ssd_tiering_interval_ms);
+
+namespace paddle {
+namespace distributed {
+
+// A table whose UpdateTable moves every value into rocksdb.
+static std::unique_ptr<SSDSparseTable> CreateSSDTable(
+    const std::string &rocksdb_path, int emb_dim, int shard_num) {
+  FLAGS_rocksdb_path = rocksdb_path;
+  TableParameter table_config;
+  table_config.set_table_class("SSDSparseTable");
+  table_config.set_shard_num(shard_num);
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(emb_dim);
+  accessor_config->set_embedx_threshold(5);
+  auto *ctr_param = accessor_config->mutable_ctr_accessor_param();
+  ctr_param->set_nonclk_coeff(0.2);
+  ctr_param->set_click_coeff(1);
+  ctr_param->set_base_threshold(0.5);
+  ctr_param->set_delta_threshold(0.2);
+  ctr_param->set_delta_keep_days(16);
+  ctr_param->set_show_click_decay_rate(0.99);
+  ctr_param->set_ssd_unseenday_threshold(-1);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  FsClientParameter fs_config;
+  std::unique_ptr<SSDSparseTable> table(new SSDSparseTable());
+  Table *base_table = table.get();
+  base_table->SetShard(0, 1);
+  EXPECT_EQ(base_table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+static void PullTable(Table *table,
+                      const std::vector<uint64_t> &keys,
+                      int emb_dim,
+                      std::vector<float> *pull_values) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  auto value = PullSparseValue(keys, fres, emb_dim);
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = value;
+  table_context.pull_context.values = pull_values->data();
+  table->Pull(table_context);
+}
+
+TEST(SSDSparseTable, PullFromRocksDB) {
+  int emb_dim = 8;
+  size_t key_num = 1000;
+  auto table = CreateSSDTable("./ssd_sparse_table_test_db", emb_dim, 4);
+
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < key_num; ++i) {
+    keys.push_back(i * 7919);
+  }
+  // a key pulled twice in a batch
+  keys.push_back(keys[0]);
+  std::vector<float> init_values(keys.size() * (emb_dim + 3));
+  FLAGS_pserver_create_value_when_push = false;
+  PullTable(table.get(), keys, emb_dim, &init_values);
+  FLAGS_pserver_create_value_when_push = true;
+  ASSERT_EQ(table->LocalSize(), static_cast<int64_t>(key_num));
+
+  // the values moved into rocksdb are pulled back into memory
+  table->UpdateTable();
+  ASSERT_EQ(table->LocalSize(), 0);
+  std::vector<float> pull_values(init_values.size());
+  PullTable(table.get(), keys, emb_dim, &pull_values);
+  ASSERT_EQ(table->LocalSize(), static_cast<int64_t>(key_num));
+  for (size_t i = 0; i < pull_values.size(); ++i) {
+    ASSERT_FLOAT_EQ(pull_values[i], init_values[i]);
+  }
+
+  // and so are the prefetched ones
+  table->UpdateTable();
+  for (auto& task : table->PrefetchSparse(keys.data(), keys.size())) {
+    task.wait();
+  }
+  std::fill(pull_values.begin(), pull_values.end(), 0);
+  PullTable(table.get(), keys, emb_dim, &pull_values);
+  ASSERT_EQ(table->LocalSize(), static_cast<int64_t>(key_num));
+  for (size_t i = 0; i < pull_values.size(); ++i) {
+    ASSERT_FLOAT_EQ(pull_values[i], init_values[i]);
+  }
+
+  // a key in neither memory nor rocksdb is pulled as zeros
+  std::vector<uint64_t> new_keys = {1};
+  std::vector<float> new_values(emb_dim + 3, 1.0);
+  PullTable(table.get(), new_keys, emb_dim, &new_values);
+  for (float value : new_values) {
+    ASSERT_EQ(value, 0.0);
+  }
+}
+
+TEST(SSDSparseTable, TieringPolicy) {
+  int emb_dim = 8;
+  size_t key_num = 20000;
+  size_t hot_key_num = 100;
+  FLAGS_pserver_ssd_tiering_policy = "ShowClickLfuTieringPolicy";
+  FLAGS_pserver_ssd_mem_limit_mb = 1;
+  // the rounds are run by the test
+  FLAGS_pserver_ssd_tiering_interval_ms = 3600 * 1000;
+  auto table = CreateSSDTable("./ssd_sparse_table_tiering_db", emb_dim, 4);
+  FLAGS_pserver_ssd_tiering_policy = "";
+
+  std::vector<uint64_t> keys(key_num);
+  for (size_t i = 0; i < key_num; ++i) {
+    keys[i] = i * 7919;
+  }
+  std::vector<uint64_t> hot_keys(keys.begin(), keys.begin() + hot_key_num);
+  std::vector<float> init_values(key_num * (emb_dim + 3));
+  FLAGS_pserver_create_value_when_push = false;
+  PullTable(table.get(), keys, emb_dim, &init_values);
+  FLAGS_pserver_create_value_when_push = true;
+  std::vector<float> hot_values(hot_key_num * (emb_dim + 3));
+  for (int i = 0; i < 5; ++i) {
+    PullTable(table.get(), hot_keys, emb_dim, &hot_values);
+  }
+  ASSERT_EQ(table->LocalSize(), static_cast<int64_t>(key_num));
+
+  // the values over the limit are moved to rocksdb, the hot ones stay
+  table->RunTiering();
+  SSDTieringStat stat = table->GetTieringStat();
+  ASSERT_GT(stat.demoted_values, 0u);
+  ASSERT_EQ(table->LocalSize(),
+            static_cast<int64_t>(key_num - stat.demoted_values));
+  ASSERT_LE(stat.mem_bytes, 1024u * 1024u);
+  PullTable(table.get(), hot_keys, emb_dim, &hot_values);
+  ASSERT_EQ(table->GetTieringStat().mem_hit_keys,
+            stat.mem_hit_keys + hot_key_num);
+
+  // and the demoted values are pulled back unchanged
+  std::vector<float> pull_values(init_values.size());
+  PullTable(table.get(), keys, emb_dim, &pull_values);
+  for (size_t i = 0; i < pull_values.size(); ++i) {
+    ASSERT_FLOAT_EQ(pull_values[i], init_values[i]);
+  }
+  ASSERT_EQ(table->GetTieringStat().loaded_values,
+            stat.loaded_values + stat.demoted_values);
+  FLAGS_pserver_ssd_mem_limit_mb = 0;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -14,9 +14,17 @@
 
 #include "paddle/fluid/eager/backward.h"
 
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <mutex>  // NOLINT
+
 #include "paddle/fluid/eager/general_grad.h"
+#include "paddle/phi/core/flags.h"
+#include "paddle/phi/core/threadpool.h"
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
 
+PHI_DECLARE_int32(eager_backward_num_threads);
+
 namespace egr {
 
 std::unordered_map<GradNodeBase*, int> getInDegreeMap(
@@ -101,6 +109,377 @@ void DuplicateCheck(const std::vector<paddle::Tensor>& inputs, bool is_input) {
 
 GeneralGrad* GeneralGrad::general_grad_ = new GeneralGrad();
 
+// The threads of the multithreaded backward, the thread calling backward
+// runs GradNodes as well, so the pool has one thread less than the flag.
+static std::shared_ptr<phi::ThreadPool> GetBackwardThreadPool(
+    int num_workers) {
+  static std::mutex mutex;
+  static std::shared_ptr<phi::ThreadPool> pool;
+  static int pool_size = 0;
+  std::lock_guard<std::mutex> guard(mutex);
+  if (pool_size < num_workers) {
+    // A running backward keeps the smaller pool until it finishes
+    pool = std::make_shared<phi::ThreadPool>(num_workers);
+    pool_size = num_workers;
+  }
+  return pool;
+}
+
+// The thread local state of the tracer which the kernels of the GradNodes
+// depend on, copied from the thread calling backward to the worker threads.
+struct BackwardTracerState {
+  BackwardTracerState() {
+    const auto& tracer = egr::Controller::Instance().GetCurrentTracer();
+    has_grad = tracer->HasGrad();
+    use_promote = tracer->GetUsePromote();
+    amp_level = tracer->GetAmpLevel();
+    amp_dtype = tracer->GetAmpDtype();
+  }
+
+  void Apply() const {
+    const auto& tracer = egr::Controller::Instance().GetCurrentTracer();
+    tracer->SetHasGrad(has_grad);
+    tracer->SetUsePromote(use_promote);
+    tracer->SetAmpLevel(amp_level);
+    tracer->SetAmpDtype(amp_dtype);
+  }
+
+  bool has_grad;
+  bool use_promote;
+  paddle::imperative::AmpLevel amp_level;
+  std::string amp_dtype;
+};
+
+// ParallelBackward runs the ready GradNodes of a backward graph on several
+// threads. The grads of a node are summed under the lock of its
+// GradTensorHolder, and the force sequential nodes run one at a time in
+// their forward order. The threads take the nodes in no fixed order, so
+// the sum of three or more grads of a node may differ in the last bits
+// between runs.
+class ParallelBackward {
+ public:
+  ParallelBackward(
+      std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+          node_input_buffers_dict,
+      std::unordered_map<GradNodeBase*, int>&& node_in_degree_map,
+      std::deque<GradNodeBase*>&& force_sequential_nodes_queue,
+      std::set<GradNodeBase*>&& force_sequential_nodes_set,
+      bool retain_graph)
+      : node_in_degree_map_(std::move(node_in_degree_map)),
+        force_sequential_nodes_queue_(std::move(force_sequential_nodes_queue)),
+        force_sequential_nodes_set_(std::move(force_sequential_nodes_set)),
+        retain_graph_(retain_graph) {
+    for (auto& pair : *node_input_buffers_dict) {
+      node_inputs_[pair.first] =
+          std::make_unique<NodeInput>(std::move(pair.second));
+    }
+    node_input_buffers_dict->clear();
+  }
+
+  void AddStartupNode(GradNodeBase* node) {
+    // A startup node reached from another one runs after it
+    if (node_in_degree_map_[node] == 0) {
+      PushReadyNode(node);
+    }
+  }
+
+  // Runs the ready nodes until no node is running and none is ready, the
+  // calling thread and each worker thread run it.
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this] { return HasRunnableNode() || running_ == 0; });
+      if (!HasRunnableNode()) {
+        break;
+      }
+      GradNodeBase* node = nullptr;
+      bool is_force_sequential = false;
+      if (!ready_force_sequential_queue_.empty() &&
+          !force_sequential_running_) {
+        node = ready_force_sequential_queue_.front();
+        ready_force_sequential_queue_.pop_front();
+        force_sequential_running_ = true;
+        is_force_sequential = true;
+      } else {
+        node = ready_queue_.front();
+        ready_queue_.pop_front();
+      }
+      ++running_;
+      lock.unlock();
+
+      try {
+        RunNode(node, &lock);
+      } catch (...) {
+        if (!lock.owns_lock()) {
+          lock.lock();
+        }
+        if (!failed_) {
+          error_ = std::current_exception();
+          failed_ = true;
+        }
+      }
+
+      if (!lock.owns_lock()) {
+        lock.lock();
+      }
+      --running_;
+      if (is_force_sequential) {
+        force_sequential_running_ = false;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  // Rethrows the first error raised by a GradNode, the error is taken out
+  // since a late worker thread may release the ParallelBackward.
+  void CheckError() {
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      std::swap(error, error_);
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+ private:
+  struct NodeInput {
+    explicit NodeInput(std::unique_ptr<GradTensorHolder> buffer)
+        : buffer(std::move(buffer)) {}
+    std::unique_ptr<GradTensorHolder> buffer;
+    std::mutex mutex;
+  };
+
+  // A grad output of a node and the input of the next node it is summed to
+  struct PendingGrad {
+    GradNodeBase* next_node;
+    NodeInput* input;
+    size_t slot;
+    size_t rank;
+    const paddle::Tensor* tensor;
+  };
+
+  bool HasRunnableNode() const {
+    return !failed_ &&
+           (!ready_queue_.empty() || (!ready_force_sequential_queue_.empty() &&
+                                      !force_sequential_running_));
+  }
+
+  void PushReadyNode(GradNodeBase* node) {
+    if (dynamic_cast<egr::GradNodeAccumulation*>(node)) {
+      ready_queue_.push_front(node);
+    } else {
+      ready_queue_.push_back(node);
+    }
+  }
+
+  // Called with the lock held when the in degree of the node is 0.
+  void ReleaseNode(GradNodeBase* node) {
+    if (!force_sequential_nodes_set_.count(node)) {
+      PushReadyNode(node);
+      return;
+    }
+    if (force_sequential_nodes_queue_.front() != node) {
+      ready_force_sequential_nodes_.insert(node);
+      return;
+    }
+    force_sequential_nodes_queue_.pop_front();
+    ready_force_sequential_queue_.push_back(node);
+    while (!force_sequential_nodes_queue_.empty() &&
+           ready_force_sequential_nodes_.count(
+               force_sequential_nodes_queue_.front())) {
+      ready_force_sequential_nodes_.erase(
+          force_sequential_nodes_queue_.front());
+      ready_force_sequential_queue_.push_back(
+          force_sequential_nodes_queue_.front());
+      force_sequential_nodes_queue_.pop_front();
+    }
+  }
+
+  // Called without the lock held, returns with the lock held.
+  void RunNode(GradNodeBase* node, std::unique_lock<std::mutex>* lock) {
+    VLOG(3) << "Preparing GradNode:" << node->name() << " addr:" << node;
+    paddle::platform::RecordEvent node_record_event(
+        std::string((*node).name()),
+        paddle::platform::TracerEventType::Operator,
+        1);
+
+    std::unique_ptr<NodeInput> node_input;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      auto node_input_iter = node_inputs_.find(node);
+      PADDLE_ENFORCE_NE(
+          node_input_iter,
+          node_inputs_.end(),
+          paddle::platform::errors::Fatal(
+              "Unable to find next node in the GradTensorHolder \n"
+              "Trying to run Node without configuring its GradTensorHolder."));
+      node_input = std::move(node_input_iter->second);
+      node_inputs_.erase(node_input_iter);
+    }
+
+    EnforceGradNodeHasInput(node);
+    paddle::small_vector<std::vector<paddle::Tensor>, kSlotSmallVectorSize>
+        grad_output_tensors = (*node)(node_input->buffer->Buffers(),
+                                      /*create_graph=*/false,
+                                      /*is_new_grad=*/false);
+    if (!retain_graph_) {
+      node->ClearTensorWrappers();
+    }
+    node_input.reset();
+
+    const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+        metas = node->OutputMeta();
+    PADDLE_ENFORCE(metas.size() == grad_output_tensors.size() || metas.empty(),
+                   paddle::platform::errors::Fatal(
+                       "Number of edges should be either empty ( for leaf node "
+                       ") or the same as number of output grad tensors, but we "
+                       "got edges size is: %d, grad_output size is: %d",
+                       metas.size(),
+                       grad_output_tensors.size()));
+
+    // 1. Find the inputs of the next nodes
+    std::vector<PendingGrad> pending_grads;
+    lock->lock();
+    for (size_t i = 0; i < metas.size(); i++) {
+      for (size_t j = 0; j < metas[i].size(); j++) {
+        const Edge& edge = metas[i][j].GetEdge();
+        if (!edge.IsInitialized()) {
+          continue;
+        }
+        auto next_node_shared = edge.GetMutableGradNode();
+        if (!next_node_shared || !next_node_shared.get() ||
+            grad_output_tensors[i].empty()) {
+          continue;
+        }
+        PADDLE_ENFORCE_LT(
+            j,
+            grad_output_tensors[i].size(),
+            paddle::platform::errors::Fatal(
+                "Rank of grad_output_tensors should be less than "
+                "grad_output_tensors[i].size(), which is: %d. This error may "
+                "indicate autoprune or autograd api error. ",
+                grad_output_tensors.size()));
+        auto* next_node = next_node_shared.get();
+        auto& next_node_input = node_inputs_[next_node];
+        if (!next_node_input) {
+          next_node_input = std::make_unique<NodeInput>(
+              std::make_unique<GradTensorHolder>(next_node->InputMeta()));
+        }
+        auto edge_rank = edge.GetEdgeRankInfo();
+        pending_grads.push_back({next_node,
+                                 next_node_input.get(),
+                                 edge_rank.first,
+                                 edge_rank.second,
+                                 &grad_output_tensors[i][j]});
+      }
+    }
+    lock->unlock();
+
+    // 2. Sum the grads, the nodes of other inputs run meanwhile
+    for (const auto& pending_grad : pending_grads) {
+      std::lock_guard<std::mutex> guard(pending_grad.input->mutex);
+      pending_grad.input->buffer->add(
+          pending_grad.slot, pending_grad.rank, *pending_grad.tensor);
+    }
+
+    // 3. Release the next nodes which got all their grads
+    lock->lock();
+    for (const auto& pending_grad : pending_grads) {
+      GradNodeBase* next_node = pending_grad.next_node;
+      int in_degree = --node_in_degree_map_[next_node];
+      PADDLE_ENFORCE(
+          in_degree >= 0,
+          paddle::platform::errors::Fatal(
+              "Detected in-degree value smaller than zero. For Node: %s"
+              "Node's in-degree cannot be negative.",
+              next_node->name()));
+      if (in_degree == 0) {
+        ReleaseNode(next_node);
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::unordered_map<GradNodeBase*, std::unique_ptr<NodeInput>> node_inputs_;
+  std::unordered_map<GradNodeBase*, int> node_in_degree_map_;
+  std::deque<GradNodeBase*> ready_queue_;
+
+  std::deque<GradNodeBase*> force_sequential_nodes_queue_;
+  std::set<GradNodeBase*> force_sequential_nodes_set_;
+  std::set<GradNodeBase*> ready_force_sequential_nodes_;
+  std::deque<GradNodeBase*> ready_force_sequential_queue_;
+  bool force_sequential_running_{false};
+
+  int running_{0};
+  bool failed_{false};
+  std::exception_ptr error_;
+  bool retain_graph_;
+};
+
+// The reduce hooks of the accumulation nodes, e.g. those of the
+// DataParallel Reducer, change shared buckets and issue collectives in the
+// order the grads are ready, so a graph with them runs sequentially.
+bool HasReduceHooks(
+    const std::deque<GradNodeBase*>& queue,
+    const std::unordered_map<GradNodeBase*, int>& node_in_degree_map) {
+  auto has_reduce_hooks = [](GradNodeBase* node) {
+    auto* accumulation_node = dynamic_cast<egr::GradNodeAccumulation*>(node);
+    return accumulation_node != nullptr &&
+           accumulation_node->ReduceHooksRegistered();
+  };
+  for (GradNodeBase* node : queue) {
+    if (has_reduce_hooks(node)) {
+      return true;
+    }
+  }
+  for (const auto& pair : node_in_degree_map) {
+    if (has_reduce_hooks(pair.first)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Runs the backward graph from the startup nodes in the queue on
+// FLAGS_eager_backward_num_threads threads.
+void RunBackwardInParallel(
+    std::deque<GradNodeBase*>* queue,
+    std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+        node_input_buffers_dict,
+    std::unordered_map<GradNodeBase*, int>&& node_in_degree_map,
+    std::deque<GradNodeBase*>&& force_sequential_nodes_queue,
+    std::set<GradNodeBase*>&& force_sequential_nodes_set,
+    bool retain_graph) {
+  int num_threads = FLAGS_eager_backward_num_threads;
+  VLOG(3) << "Run backward on " << num_threads << " threads";
+  // The worker threads which start after the backward finished only find
+  // that there is nothing to run, so they share the ownership.
+  auto parallel_backward = std::make_shared<ParallelBackward>(
+      node_input_buffers_dict,
+      std::move(node_in_degree_map),
+      std::move(force_sequential_nodes_queue),
+      std::move(force_sequential_nodes_set),
+      retain_graph);
+  for (GradNodeBase* node : *queue) {
+    parallel_backward->AddStartupNode(node);
+  }
+  queue->clear();
+
+  auto pool = GetBackwardThreadPool(num_threads - 1);
+  BackwardTracerState tracer_state;
+  for (int i = 1; i < num_threads; ++i) {
+    pool->Run([parallel_backward, tracer_state]() {
+      tracer_state.Apply();
+      parallel_backward->Run();
+    });
+  }
+  parallel_backward->Run();
+  parallel_backward->CheckError();
+}
+
 std::vector<paddle::Tensor> RunBackward(
     const std::vector<paddle::Tensor>& tensors,  // output
     const std::vector<paddle::Tensor>& grad_tensors,
@@ -236,6 +615,23 @@ std::vector<paddle::Tensor> RunBackward(
 
   VLOG(5) << "Startup_ops's size is " << queue.size();
 
+  // The GradNodes and hooks of general grad, create_graph and reduce hooks
+  // change shared state, and those of the devices run in order on a stream
+  // anyway.
+  if (FLAGS_eager_backward_num_threads > 1 && !is_general_grad &&
+      !create_graph &&
+      paddle::platform::is_cpu_place(
+          egr::Controller::Instance().GetExpectedPlace()) &&
+      !HasReduceHooks(queue, node_in_degree_map)) {
+    // The queue is left empty
+    RunBackwardInParallel(&queue,
+                          &node_input_buffers_dict,
+                          std::move(node_in_degree_map),
+                          std::move(force_sequential_nodes_queue),
+                          std::move(force_sequential_nodes_set),
+                          retain_graph);
+  }
+
   /* --- Topological Visit --- */
   // 1. Pop queue
   // 2. Run node
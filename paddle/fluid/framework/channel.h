@@ -22,19 +22,30 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <deque>
+#include <iterator>
 #include <limits>
 #include <memory>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "paddle/fluid/framework/segmented_queue.h"
 #include "paddle/phi/core/expect.h"
 
 namespace paddle {
 namespace framework {
 
+// A blocking MPMC channel. By default it is a deque guarded by one mutex.
+// SetSegmented(true) switches it to a lock-free queue of chunks: a Write
+// pushes its data as chunks of at most BlockSize() elements built without
+// any lock, a Read pops whole chunks, and the mutex is only taken to sleep
+// when the channel is empty or full. In this mode the order is kept within a
+// chunk but not between chunks, and the capacity is approximate under
+// concurrent writers.
 template <class T>
 class ChannelObject {
  public:
@@ -45,11 +56,51 @@ class ChannelObject {
     capacity_ = (std::min)(MaxCapacity(), capacity);
   }
 
-  const std::deque<T>& GetData() const { return data_; }
+  // In the segmented mode the queued data is moved into the deque first, the
+  // following reads consume the deque before the queue.
+  const std::deque<T>& GetData() {
+    if (segments_ != nullptr) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::vector<T> chunk;
+      while (segments_->TryPop(&chunk)) {
+        segmented_size_ -= chunk.size();
+        for (auto& x : chunk) {
+          data_.push_back(std::move(x));
+        }
+      }
+      drained_ = !data_.empty();
+    }
+    return data_;
+  }
   void Clear() {
     std::unique_lock<std::mutex> lock(mutex_);
     data_.clear();
     data_.shrink_to_fit();
+    if (segments_ != nullptr) {
+      std::vector<T> chunk;
+      while (segments_->TryPop(&chunk)) {
+        segmented_size_ -= chunk.size();
+      }
+      drained_ = false;
+      segment_cond_.notify_all();
+    }
+  }
+
+  bool Segmented() { return segments_ != nullptr; }
+
+  // switch between the mutex and the segmented implementation, the channel
+  // must be empty and not in use
+  void SetSegmented(bool segmented) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(data_.empty() && segmented_size_ == 0)
+        << "channel must be empty to switch the implementation";
+    if (segmented) {
+      if (segments_ == nullptr) {
+        segments_.reset(new SegmentedQueue<std::vector<T>>());
+      }
+    } else {
+      segments_.reset();
+    }
   }
 
   size_t Capacity() {
@@ -74,9 +125,12 @@ class ChannelObject {
 
   template <class U>
   void InheritFrom(const std::shared_ptr<ChannelObject<U>>& other) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    capacity_ = other->Capacity();
-    block_size_ = other->BlockSize();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      capacity_ = other->Capacity();
+      block_size_ = other->BlockSize();
+    }
+    SetSegmented(other->Segmented());
   }
 
   bool Closed() {
@@ -99,7 +153,7 @@ class ChannelObject {
 
   size_t Size() {
     std::lock_guard<std::mutex> lock(mutex_);
-    return data_.size();
+    return data_.size() + segmented_size_;
   }
 
   bool Empty() {
@@ -116,6 +170,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (segments_ != nullptr) {
+      return SegmentedRead(n, p, false);
+    }
 
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = Read(n, p, lock);
@@ -135,6 +192,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (segments_ != nullptr) {
+      return SegmentedWrite(n, p);
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = Write(n, p, lock);
     Notify();
@@ -146,6 +206,9 @@ class ChannelObject {
     if (n == 0) {
       return 0;
     }
+    if (segments_ != nullptr) {
+      return SegmentedWrite(n, std::make_move_iterator(p));
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     size_t finished = WriteMove(n, p, lock);
     Notify();
@@ -164,6 +227,11 @@ class ChannelObject {
     if (size == 0) {
       return 0;
     }
+    if (segments_ != nullptr) {
+      p.resize(size);
+      p.resize(SegmentedRead(size, &p[0], true));
+      return p.size();
+    }
     std::unique_lock<std::mutex> lock(mutex_);
     p.resize(size);
     size_t finished = Read(size, &p[0], lock, true);
@@ -196,7 +264,7 @@ class ChannelObject {
  private:
   size_t capacity_ = MaxCapacity();
   size_t block_size_ = 1024;
-  bool closed_ = false;
+  std::atomic<bool> closed_{false};
   std::mutex mutex_;
   // use deque to store data
   std::deque<T> data_;
@@ -205,12 +273,23 @@ class ChannelObject {
   int full_waiters_ = 0;
   std::condition_variable empty_cond_;
   std::condition_variable full_cond_;
+  // segmented mode, the counters are updated without the mutex
+  std::unique_ptr<SegmentedQueue<std::vector<T>>> segments_;
+  std::atomic<size_t> segmented_size_{0};
+  std::atomic<size_t> segmented_reading_{0};
+  std::atomic<int> segmented_waiters_{0};
+  // data_ holds the data moved out of the queue by GetData()
+  std::atomic<bool> drained_{false};
+  std::condition_variable segment_cond_;
 
   static constexpr size_t MaxCapacity() {
     return (std::numeric_limits<size_t>::max)() / 2;
   }
 
   void Notify() {
+    if (segments_ != nullptr) {
+      segment_cond_.notify_all();
+    }
     if (empty_waiters_ != 0 && (!EmptyUnlocked() || closed_)) {
       empty_cond_.notify_one();
     }
@@ -219,7 +298,7 @@ class ChannelObject {
     }
   }
 
-  bool EmptyUnlocked() { return data_.empty(); }
+  bool EmptyUnlocked() { return data_.empty() && segmented_size_ == 0; }
 
   bool FullUnlocked() { return data_.size() >= capacity_ + reading_count_; }
 
@@ -304,6 +383,110 @@ class ChannelObject {
     }
     return finished;
   }
+
+  // wakes the segmented waiters, the waiters counter is read after the
+  // state change and is raised by a waiter before it checks the state, so
+  // one of the two sides always sees the other
+  void NotifySegmented() {
+    if (segmented_waiters_ != 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      segment_cond_.notify_all();
+    }
+  }
+
+  template <class Pred>
+  void WaitSegmented(Pred pred) {
+    for (int i = 0; i < 64; ++i) {
+      if (pred()) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    segmented_waiters_++;
+    segment_cond_.wait(lock, pred);
+    segmented_waiters_--;
+  }
+
+  size_t ReadDrained(size_t n, T* p) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t m = (std::min)(n, data_.size());
+    for (size_t i = 0; i < m; i++) {
+      p[i] = std::move(data_.front());
+      data_.pop_front();
+    }
+    if (data_.empty()) {
+      drained_ = false;
+    }
+    return m;
+  }
+
+  size_t SegmentedRead(size_t n, T* p, bool once) {
+    size_t finished = 0;
+    if (unlikely(drained_)) {
+      finished = ReadDrained(n, p);
+      if (finished == n || (once && finished > 0)) {
+        return finished;
+      }
+    }
+    CHECK(n <= MaxCapacity() - segmented_reading_);
+    segmented_reading_ += n - finished;
+    // a writer of a channel with no capacity may wait for this reader
+    NotifySegmented();
+    std::vector<T> chunk;
+    while (finished < n) {
+      if (segments_->TryPop(&chunk)) {
+        size_t m = (std::min)(n - finished, chunk.size());
+        std::move(chunk.begin(), chunk.begin() + m, p + finished);
+        finished += m;
+        if (m < chunk.size()) {
+          // the rest of the chunk goes back to the tail
+          chunk.erase(chunk.begin(), chunk.begin() + m);
+          segments_->Push(std::move(chunk));
+        }
+        segmented_size_ -= m;
+        segmented_reading_ -= m;
+        NotifySegmented();
+        if (once) {
+          break;
+        }
+        continue;
+      }
+      // the size also counts the rests being pushed back by other readers,
+      // so closed and zero size means nothing will come any more
+      if (closed_ && segmented_size_ == 0) {
+        break;
+      }
+      WaitSegmented([this] { return segmented_size_ != 0 || closed_; });
+    }
+    segmented_reading_ -= n - finished;
+    return finished;
+  }
+
+  template <class Iter>
+  size_t SegmentedWrite(size_t n, Iter p) {
+    size_t finished = 0;
+    while (finished < n && !closed_) {
+      size_t size = segmented_size_;
+      size_t limit = capacity_ + segmented_reading_;
+      if (size >= limit) {
+        WaitSegmented([this] {
+          return closed_ ||
+                 segmented_size_ < capacity_ + segmented_reading_;
+        });
+        continue;
+      }
+      size_t m = (std::min)({n - finished, limit - size, block_size_});
+      std::vector<T> chunk(p + finished, p + finished + m);
+      // counted before the push, a reader may pop the chunk and subtract
+      // its size right after
+      segmented_size_ += m;
+      segments_->Push(std::move(chunk));
+      finished += m;
+      NotifySegmented();
+    }
+    return finished;
+  }
 };  // NOLINT
 
 template <class T>
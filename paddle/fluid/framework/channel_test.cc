@@ -0,0 +1,168 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/channel.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+TEST(SegmentedQueue, push_pop) {
+  SegmentedQueue<std::unique_ptr<int>> queue;
+  std::unique_ptr<int> value;
+  EXPECT_FALSE(queue.TryPop(&value));
+  // cross several blocks
+  for (int i = 0; i < 1000; ++i) {
+    queue.Push(std::unique_ptr<int>(new int(i)));
+  }
+  for (int i = 0; i < 600; ++i) {
+    ASSERT_TRUE(queue.TryPop(&value));
+    EXPECT_EQ(*value, i);
+  }
+  EXPECT_FALSE(queue.Empty());
+  // the rest is freed by the destructor
+}
+
+// Writes the numbers [0, producers * per_producer) from the producers and
+// returns how many times each one is read.
+std::vector<int> RunChannel(const Channel<int>& channel,
+                            int producers,
+                            int consumers,
+                            int per_producer,
+                            double* seconds) {
+  std::vector<std::vector<int>> received(consumers);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < consumers; ++i) {
+    threads.emplace_back([&channel, &received, i] {
+      std::vector<int> buffer;
+      while (channel->Read(buffer) != 0) {
+        received[i].insert(received[i].end(), buffer.begin(), buffer.end());
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int i = 0; i < producers; ++i) {
+    writers.emplace_back([&channel, i, per_producer] {
+      ChannelWriter<int> writer(channel.get());
+      for (int j = 0; j < per_producer; ++j) {
+        writer << i * per_producer + j;
+      }
+      writer.Flush();
+    });
+  }
+  for (auto& t : writers) {
+    t.join();
+  }
+  channel->Close();
+  for (auto& t : threads) {
+    t.join();
+  }
+  *seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           start)
+                 .count();
+  std::vector<int> count(producers * per_producer, 0);
+  for (auto& vec : received) {
+    for (int x : vec) {
+      count[x]++;
+    }
+  }
+  return count;
+}
+
+TEST(Channel, segmented_read_write) {
+  for (size_t capacity : {0, 1, 100, 1 << 30}) {
+    auto channel = MakeChannel<int>(capacity);
+    channel->SetSegmented(true);
+    channel->SetBlockSize(7);
+    double seconds = 0;
+    auto count = RunChannel(channel, 8, 3, 1000, &seconds);
+    for (size_t i = 0; i < count.size(); ++i) {
+      ASSERT_EQ(count[i], 1) << "capacity " << capacity << ", value " << i;
+    }
+    EXPECT_TRUE(channel->Empty());
+  }
+
+  // the size never goes below zero while the readers pop the chunks
+  {
+    auto channel = MakeChannel<int>();
+    channel->SetSegmented(true);
+    channel->SetBlockSize(1);
+    std::atomic<bool> done{false};
+    size_t max_size = 0;
+    std::thread monitor([&] {
+      while (!done) {
+        max_size = (std::max)(max_size, channel->Size());
+      }
+    });
+    double seconds = 0;
+    RunChannel(channel, 8, 8, 2000, &seconds);
+    done = true;
+    monitor.join();
+    EXPECT_LE(max_size, 8u * 2000u);
+  }
+
+  auto channel = MakeChannel<int>();
+  channel->SetSegmented(true);
+  std::vector<int> data = {1, 2, 3, 4, 5};
+  EXPECT_EQ(channel->Write(data), 5u);
+  EXPECT_EQ(channel->Size(), 5u);
+  // GetData moves the queue into the deque, the reads still see it
+  EXPECT_EQ(channel->GetData().size(), 5u);
+  EXPECT_EQ(channel->Write(data), 5u);
+  std::vector<int> out;
+  EXPECT_EQ(channel->ReadOnce(out, 3), 3u);
+  EXPECT_EQ(out, std::vector<int>({1, 2, 3}));
+  channel->Close();
+  EXPECT_EQ(channel->Write(data), 0u);
+  EXPECT_EQ(channel->ReadAll(out), 7u);
+  EXPECT_EQ(channel->Read(out), 0u);
+  channel->Open();
+  EXPECT_TRUE(channel->Put(9));
+  channel->Clear();
+  EXPECT_TRUE(channel->Empty());
+}
+
+// 64 producers writing through ChannelWriter, as the reader threads of an
+// in memory dataset do, into the mutex and the segmented channel
+TEST(Channel, contention_benchmark) {
+  const int producers = 64;
+  const int per_producer = 20000;
+  for (int block_size : {1, 16, 1024}) {
+    for (bool segmented : {false, true}) {
+      auto channel = MakeChannel<int>();
+      channel->SetSegmented(segmented);
+      channel->SetBlockSize(block_size);
+      double seconds = 0;
+      auto count = RunChannel(channel, producers, 4, per_producer, &seconds);
+      for (size_t i = 0; i < count.size(); ++i) {
+        ASSERT_EQ(count[i], 1);
+      }
+      LOG(INFO) << (segmented ? "segmented" : "mutex") << " channel, "
+                << producers << " producers, block size " << block_size
+                << ": " << producers * per_producer / seconds / 1e6
+                << " M items/s";
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -26,6 +26,8 @@ limitations under the License. */
 #include <sys/stat.h>
 #endif
 #include "io/fs.h"
+#include "paddle/fluid/framework/io/columnar_sample.h"
+#include "paddle/fluid/framework/slot_text_parser.h"
 #include "paddle/fluid/platform/monitor.h"
 #include "paddle/fluid/platform/timer.h"
 
@@ -531,6 +533,10 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
   while (this->PickOneFile(&filename)) {
     VLOG(3) << "PickOneFile, filename=" << filename
             << ", thread_id=" << thread_id_;
+    if (IsColumnarSampleFile(filename)) {
+      LoadColumnarFile(filename);
+      continue;
+    }
 #ifdef PADDLE_WITH_BOX_PS
     if (BoxWrapper::GetInstance()->UseAfsApi()) {
       this->fp_ = BoxWrapper::GetInstance()->afs_manager->GetFile(
@@ -568,6 +574,13 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
 #endif
 }
 
+template <typename T>
+void InMemoryDataFeed<T>::LoadColumnarFile(const std::string& filename) {
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The columnar sample %s can not be loaded by this data feed.",
+      filename));
+}
+
 template <typename T>
 void InMemoryDataFeed<T>::LoadIntoMemoryFromSo() {
 #if (defined _LINUX) && (defined PADDLE_WITH_HETERPS) && \
@@ -852,7 +865,7 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
     int pos = 0;
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = slot_text::ParseInt(&str[pos], &endptr);
 
       if (num <= 0) {
         std::stringstream ss;
@@ -879,12 +892,12 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = slot_text::ParseFloat(endptr, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = slot_text::ParseUint64(endptr, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         }
@@ -913,11 +926,12 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
     instance->resize(use_slots_num);
     // parse line
     const char* str = line.c_str();
+    const char* line_end = str + line.size();
     char* endptr = const_cast<char*>(str);
     int pos = 0;
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = slot_text::ParseInt(&str[pos], &endptr);
       PADDLE_ENFORCE_NE(
           num,
           0,
@@ -939,19 +953,19 @@ bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = slot_text::ParseFloat(endptr, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = slot_text::ParseUint64(endptr, &endptr);
             (*instance)[idx].AddValue(feasign);
           }
         }
         pos = endptr - str;
       } else {
         for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
+          pos = slot_text::FindSpace(str + pos + 1, line_end) - str;
         }
       }
     }
@@ -1132,42 +1146,34 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
     return false;
   } else {
     const char* str = reader.get();
+    const char* line_end = str + reader.length();
     std::string line = std::string(str);
     // VLOG(3) << line;
     char* endptr = const_cast<char*>(str);
     int pos = 0;
     if (parse_ins_id_) {
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = slot_text::ParseInt(&str[pos], &endptr);
       CHECK(num == 1);  // NOLINT
       pos = endptr - str + 1;
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
+      size_t len = slot_text::FindSpace(str + pos, line_end) - (str + pos);
       instance->ins_id_ = std::string(str + pos, len);
       pos += len + 1;
       VLOG(3) << "ins_id " << instance->ins_id_;
     }
     if (parse_content_) {
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = slot_text::ParseInt(&str[pos], &endptr);
       CHECK(num == 1);  // NOLINT
       pos = endptr - str + 1;
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
+      size_t len = slot_text::FindSpace(str + pos, line_end) - (str + pos);
       instance->content_ = std::string(str + pos, len);
       pos += len + 1;
       VLOG(3) << "content " << instance->content_;
     }
     if (parse_logkey_) {
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = slot_text::ParseInt(&str[pos], &endptr);
       CHECK(num == 1);  // NOLINT
       pos = endptr - str + 1;
-      size_t len = 0;
-      while (str[pos + len] != ' ') {
-        ++len;
-      }
+      size_t len = slot_text::FindSpace(str + pos, line_end) - (str + pos);
       // parse_logkey
       std::string log_key = std::string(str + pos, len);
       uint64_t search_id;
@@ -1183,7 +1189,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
     }
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = slot_text::ParseInt(&str[pos], &endptr);
       PADDLE_ENFORCE_NE(
           num,
           0,
@@ -1216,10 +1222,10 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = slot_text::ParseFloat(endptr, &endptr);
             // if float feasign is equal to zero, ignore it
             // except when slot is dense
-            if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[i]) {
+            if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[idx]) {
               continue;
             }
             FeatureFeasign f;
@@ -1228,10 +1234,10 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = slot_text::ParseUint64(endptr, &endptr);
             // if uint64 feasign is equal to zero, ignore it
             // except when slot is dense
-            if (feasign == 0 && !use_slots_is_dense_[i]) {
+            if (feasign == 0 && !use_slots_is_dense_[idx]) {
               continue;
             }
             FeatureFeasign f;
@@ -1241,12 +1247,12 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
         }
         pos = endptr - str;
       } else {
-        for (int j = 0; j <= num; ++j) {
-          // pos = line.find_first_of(' ', pos + 1);
-          while (line[pos + 1] != ' ') {
-            pos++;
-          }
+        // skips the feasigns of the slot
+        for (int j = 0; j < num; ++j) {
+          endptr = const_cast<char*>(
+              slot_text::FindSpace(slot_text::SkipSpaces(endptr), line_end));
         }
+        pos = endptr - str;
       }
     }
     instance->float_feasigns_.shrink_to_fit();
@@ -1266,11 +1272,12 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
     VLOG(3) << line;
     // parse line
     const char* str = line.c_str();
+    const char* line_end = str + line.size();
     char* endptr = const_cast<char*>(str);
     int pos = 0;
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = slot_text::ParseInt(&str[pos], &endptr);
       PADDLE_ENFORCE_NE(
           num,
           0,
@@ -1291,7 +1298,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = slot_text::ParseFloat(endptr, &endptr);
             if (fabs(feasign) < 1e-6) {
               continue;
             }
@@ -1301,7 +1308,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = slot_text::ParseUint64(endptr, &endptr);
             if (feasign == 0) {
               continue;
             }
@@ -1313,7 +1320,7 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
         pos = endptr - str;
       } else {
         for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
+          pos = slot_text::FindSpace(str + pos + 1, line_end) - str;
         }
       }
     }
@@ -1327,6 +1334,141 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
   return false;
 }
 
+void MultiSlotInMemoryDataFeed::LoadColumnarFile(const std::string& filename) {
+#ifdef _LINUX
+  platform::Timer timeline;
+  timeline.Start();
+  ColumnarSampleReader reader;
+  reader.Open(filename);
+  std::unordered_map<std::string, int> file_slot_index;
+  for (size_t i = 0; i < reader.Slots().size(); ++i) {
+    file_slot_index[reader.Slots()[i].name] = i;
+  }
+  // file slot and type of each used slot
+  std::vector<int> file_slots(use_slots_.size());
+  std::vector<char> slot_types(use_slots_.size());
+  for (size_t i = 0; i < all_slots_.size(); ++i) {
+    int idx = use_slots_index_[i];
+    if (idx == -1) {
+      continue;
+    }
+    auto iter = file_slot_index.find(all_slots_[i]);
+    PADDLE_ENFORCE_EQ(
+        iter != file_slot_index.end(),
+        true,
+        platform::errors::NotFound(
+            "The used slot %s is not in %s.", all_slots_[i], filename));
+    PADDLE_ENFORCE_EQ(reader.Slots()[iter->second].type,
+                      all_slots_type_[i][0],
+                      platform::errors::InvalidArgument(
+                          "The type of slot %s in %s mismatches the "
+                          "data feed desc.",
+                          all_slots_[i],
+                          filename));
+    file_slots[idx] = iter->second;
+    slot_types[idx] = all_slots_type_[i][0];
+  }
+  uint32_t string_columns = (parse_ins_id_ ? kColumnarInsId : 0) |
+                            (parse_content_ ? kColumnarContent : 0) |
+                            (parse_logkey_ ? kColumnarLogKey : 0);
+  PADDLE_ENFORCE_EQ(
+      reader.StringColumns() & string_columns,
+      string_columns,
+      platform::errors::NotFound(
+          "The ins_id, content or log_key to parse is not in %s.", filename));
+#ifdef PADDLE_WITH_PSLIB
+  int uid_slot = -1;
+  if (parse_uid_) {
+    auto iter = file_slot_index.find(uid_slot_);
+    PADDLE_ENFORCE_EQ(
+        iter != file_slot_index.end(),
+        true,
+        platform::errors::NotFound(
+            "The uid slot %s is not in %s.", uid_slot_, filename));
+    uid_slot = iter->second;
+    PADDLE_ENFORCE_EQ(reader.Slots()[uid_slot].type,
+                      'u',
+                      platform::errors::PreconditionNotMet(
+                          "The uid has to be uint64 and single."));
+  }
+#endif
+
+  paddle::framework::ChannelWriter<Record> writer(input_channel_);
+  ColumnarSampleBlock block;
+  while (reader.Next(&block)) {
+    for (uint32_t i = 0; i < block.InsNum(); ++i) {
+      Record instance;
+      if (parse_ins_id_) {
+        instance.ins_id_ = block.String(kColumnarInsId, i);
+      }
+      if (parse_content_) {
+        instance.content_ = block.String(kColumnarContent, i);
+      }
+      if (parse_logkey_) {
+        instance.ins_id_ = block.String(kColumnarLogKey, i);
+        GetMsgFromLogKey(instance.ins_id_,
+                         &instance.search_id,
+                         &instance.cmatch,
+                         &instance.rank);
+      }
+#ifdef PADDLE_WITH_PSLIB
+      if (uid_slot != -1) {
+        const uint32_t* offsets = block.SlotOffsets(uid_slot);
+        PADDLE_ENFORCE_EQ(offsets[i + 1] - offsets[i],
+                          1U,
+                          platform::errors::PreconditionNotMet(
+                              "The uid has to be uint64 and single."));
+        // assigned as ParseOneInstanceFromPipe does
+        uint64_t feasign = block.Uint64Values(uid_slot)[offsets[i]];
+        instance.uid_ = feasign;
+      }
+#endif
+      // same filtering as ParseOneInstanceFromPipe
+      for (size_t idx = 0; idx < use_slots_.size(); ++idx) {
+        int slot = file_slots[idx];
+        const uint32_t* offsets = block.SlotOffsets(slot);
+        if (slot_types[idx] == 'f') {
+          const float* values = block.FloatValues(slot);
+          for (uint32_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+            if (fabs(values[j]) < 1e-6 && !use_slots_is_dense_[idx]) {
+              continue;
+            }
+            FeatureFeasign f;
+            f.float_feasign_ = values[j];
+            instance.float_feasigns_.push_back(FeatureItem(f, idx));
+          }
+        } else {
+          const uint64_t* values = block.Uint64Values(slot);
+          for (uint32_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+            if (values[j] == 0 && !use_slots_is_dense_[idx]) {
+              continue;
+            }
+            FeatureFeasign f;
+            f.uint64_feasign_ = values[j];
+            instance.uint64_feasigns_.push_back(FeatureItem(f, idx));
+          }
+        }
+      }
+      instance.float_feasigns_.shrink_to_fit();
+      instance.uint64_feasigns_.shrink_to_fit();
+      fea_num_ += instance.uint64_feasigns_.size();
+      writer << std::move(instance);
+    }
+  }
+  STAT_ADD(STAT_total_feasign_num_in_mem, fea_num_);
+  {
+    std::lock_guard<std::mutex> flock(*mutex_for_fea_num_);
+    *total_fea_num_ += fea_num_;
+    fea_num_ = 0;
+  }
+  writer.Flush();
+  timeline.Pause();
+  VLOG(3) << "LoadColumnarFile() file=" << filename
+          << ", cost time=" << timeline.ElapsedSec()
+          << " seconds, thread_id=" << thread_id_;
+#endif
+}
+
 void MultiSlotInMemoryDataFeed::PutToFeedVec(const Record* ins_vec, int num) {
 #ifdef _LINUX
   for (size_t i = 0; i < batch_float_feasigns_.size(); ++i) {
@@ -2342,6 +2484,10 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand() {
   while (this->PickOneFile(&filename)) {
     VLOG(3) << "PickOneFile, filename=" << filename
             << ", thread_id=" << thread_id_;
+    if (IsColumnarSampleFile(filename)) {
+      LoadColumnarFile(filename);
+      continue;
+    }
     int lines = 0;
     std::vector<SlotRecord> record_vec;
     platform::Timer timeline;
@@ -2415,6 +2561,7 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   SlotRecord& rec = (*ins);
   // parse line
   const char* str = line.c_str();
+  const char* line_end = str + line.size();
   char* endptr = const_cast<char*>(str);
   int pos = 0;
 
@@ -2424,24 +2571,18 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   slot_uint64_feasigns.resize(uint64_use_slot_size_);
 
   if (parse_ins_id_) {
-    int num = strtol(&str[pos], &endptr, 10);
+    int num = slot_text::ParseInt(&str[pos], &endptr);
     CHECK(num == 1);  // NOLINT
     pos = endptr - str + 1;
-    size_t len = 0;
-    while (str[pos + len] != ' ') {
-      ++len;
-    }
+    size_t len = slot_text::FindSpace(str + pos, line_end) - (str + pos);
     rec->ins_id_ = std::string(str + pos, len);
     pos += len + 1;
   }
   if (parse_logkey_) {
-    int num = strtol(&str[pos], &endptr, 10);
+    int num = slot_text::ParseInt(&str[pos], &endptr);
     CHECK(num == 1);  // NOLINT
     pos = endptr - str + 1;
-    size_t len = 0;
-    while (str[pos + len] != ' ') {
-      ++len;
-    }
+    size_t len = slot_text::FindSpace(str + pos, line_end) - (str + pos);
     // parse_logkey
     std::string log_key = std::string(str + pos, len);
     uint64_t search_id;
@@ -2461,7 +2602,7 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
 
   for (size_t i = 0; i < all_slots_info_.size(); ++i) {
     auto& info = all_slots_info_[i];
-    int num = strtol(&str[pos], &endptr, 10);
+    int num = slot_text::ParseInt(&str[pos], &endptr);
     PADDLE_ENFORCE(num,
                    "The number of ids can not be zero, you need padding "
                    "it in data generator; or if there is something wrong with "
@@ -2473,7 +2614,7 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         auto& slot_fea = slot_float_feasigns[info.slot_value_idx];
         slot_fea.clear();
         for (int j = 0; j < num; ++j) {
-          float feasign = strtof(endptr, &endptr);
+          float feasign = slot_text::ParseFloat(endptr, &endptr);
           if (fabs(feasign) < 1e-6 && !used_slots_info_[info.used_idx].dense) {
             continue;
           }
@@ -2484,20 +2625,19 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         auto& slot_fea = slot_uint64_feasigns[info.slot_value_idx];
         slot_fea.clear();
         for (int j = 0; j < num; ++j) {
-          uint64_t feasign =
-              static_cast<uint64_t>(strtoull(endptr, &endptr, 10));
+          uint64_t feasign = slot_text::ParseUint64(endptr, &endptr);
           slot_fea.push_back(feasign);
           ++uint64_total_slot_num;
         }
       }
       pos = endptr - str;
     } else {
-      for (int j = 0; j <= num; ++j) {
-        // pos = line.find_first_of(' ', pos + 1);
-        while (line[pos + 1] != ' ') {
-          pos++;
-        }
+      // skips the feasigns of the slot
+      for (int j = 0; j < num; ++j) {
+        endptr = const_cast<char*>(
+            slot_text::FindSpace(slot_text::SkipSpaces(endptr), line_end));
       }
+      pos = endptr - str;
     }
   }
   rec->slot_float_feasigns_.add_slot_feasigns(slot_float_feasigns,
@@ -2508,6 +2648,134 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   return (uint64_total_slot_num > 0);
 }
 
+void SlotRecordInMemoryDataFeed::LoadColumnarFile(
+    const std::string& filename) {
+#ifdef _LINUX
+  platform::Timer timeline;
+  timeline.Start();
+  ColumnarSampleReader reader;
+  reader.Open(filename);
+  std::unordered_map<std::string, int> file_slot_index;
+  for (size_t i = 0; i < reader.Slots().size(); ++i) {
+    file_slot_index[reader.Slots()[i].name] = i;
+  }
+  // used slots of the file, the others are skipped without a look
+  struct ColumnarSlotInfo {
+    int file_slot;
+    int slot_value_idx;
+    bool is_float;
+    bool dense;
+  };
+  std::vector<ColumnarSlotInfo> slots;
+  for (auto& info : all_slots_info_) {
+    if (info.used_idx == -1) {
+      continue;
+    }
+    auto iter = file_slot_index.find(info.slot);
+    PADDLE_ENFORCE_EQ(
+        iter != file_slot_index.end(),
+        true,
+        platform::errors::NotFound(
+            "The used slot %s is not in %s.", info.slot, filename));
+    PADDLE_ENFORCE_EQ(reader.Slots()[iter->second].type,
+                      info.type[0],
+                      platform::errors::InvalidArgument(
+                          "The type of slot %s in %s mismatches the "
+                          "data feed desc.",
+                          info.slot,
+                          filename));
+    slots.push_back({iter->second,
+                     info.slot_value_idx,
+                     info.type[0] == 'f',
+                     used_slots_info_[info.used_idx].dense});
+  }
+  uint32_t string_columns = (parse_ins_id_ ? kColumnarInsId : 0) |
+                            (parse_logkey_ ? kColumnarLogKey : 0);
+  PADDLE_ENFORCE_EQ(
+      reader.StringColumns() & string_columns,
+      string_columns,
+      platform::errors::NotFound(
+          "The ins_id or log_key to parse is not in %s.", filename));
+
+  std::default_random_engine random_engine(std::random_device{}());
+  std::uniform_real_distribution<float> uniform_distribution(0.0f, 1.0f);
+  bool sample = std::abs(sample_rate_ - 1.0f) >= 1e-5f;
+
+  std::vector<std::vector<float>> slot_float_feasigns(float_use_slot_size_);
+  std::vector<std::vector<uint64_t>> slot_uint64_feasigns(
+      uint64_use_slot_size_);
+  std::vector<SlotRecord> record_vec;
+  SlotRecordPool().get(&record_vec, OBJPOOL_BLOCK_SIZE);
+  int offset = 0;
+  size_t ins_num = 0;
+  ColumnarSampleBlock block;
+  while (reader.Next(&block)) {
+    for (uint32_t i = 0; i < block.InsNum(); ++i) {
+      if (sample && uniform_distribution(random_engine) >= sample_rate_) {
+        continue;
+      }
+      // same as ParseOneInstance of a text line
+      int float_total_slot_num = 0;
+      int uint64_total_slot_num = 0;
+      for (auto& slot : slots) {
+        const uint32_t* offsets = block.SlotOffsets(slot.file_slot);
+        if (slot.is_float) {
+          const float* values = block.FloatValues(slot.file_slot);
+          auto& slot_fea = slot_float_feasigns[slot.slot_value_idx];
+          slot_fea.clear();
+          for (uint32_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+            if (fabs(values[j]) < 1e-6 && !slot.dense) {
+              continue;
+            }
+            slot_fea.push_back(values[j]);
+            ++float_total_slot_num;
+          }
+        } else {
+          const uint64_t* values = block.Uint64Values(slot.file_slot);
+          auto& slot_fea = slot_uint64_feasigns[slot.slot_value_idx];
+          slot_fea.assign(values + offsets[i], values + offsets[i + 1]);
+          uint64_total_slot_num += slot_fea.size();
+        }
+      }
+      if (uint64_total_slot_num == 0) {
+        continue;
+      }
+      SlotRecord& rec = record_vec[offset];
+      if (parse_ins_id_) {
+        rec->ins_id_ = block.String(kColumnarInsId, i);
+      }
+      if (parse_logkey_) {
+        rec->ins_id_ = block.String(kColumnarLogKey, i);
+        parser_log_key(rec->ins_id_, &rec->search_id, &rec->cmatch, &rec->rank);
+      }
+      rec->slot_float_feasigns_.add_slot_feasigns(slot_float_feasigns,
+                                                  float_total_slot_num);
+      rec->slot_uint64_feasigns_.add_slot_feasigns(slot_uint64_feasigns,
+                                                   uint64_total_slot_num);
+      ++ins_num;
+      if (++offset >= OBJPOOL_BLOCK_SIZE) {
+        input_channel_->Write(std::move(record_vec));
+        record_vec.clear();
+        SlotRecordPool().get(&record_vec, OBJPOOL_BLOCK_SIZE);
+        offset = 0;
+      }
+    }
+  }
+  if (offset > 0) {
+    input_channel_->WriteMove(offset, &record_vec[0]);
+    if (offset < OBJPOOL_BLOCK_SIZE) {
+      SlotRecordPool().put(&record_vec[offset], (OBJPOOL_BLOCK_SIZE - offset));
+    }
+  } else {
+    SlotRecordPool().put(&record_vec);
+  }
+  timeline.Pause();
+  VLOG(3) << "LoadColumnarFile() file=" << filename << ", ins num=" << ins_num
+          << ", cost time=" << timeline.ElapsedSec()
+          << " seconds, thread_id=" << thread_id_;
+#endif
+}
+
 void SlotRecordInMemoryDataFeed::AssignFeedVar(const Scope& scope) {
   CheckInit();
 #if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
@@ -1428,6 +1428,8 @@ class InMemoryDataFeed : public DataFeed {
   }
   virtual void PutToFeedVec(const std::vector<T>& ins_vec) = 0;
   virtual void PutToFeedVec(const T* ins_vec, int num) = 0;
+  // loads a file in the columnar sample format, see io/columnar_sample.h
+  virtual void LoadColumnarFile(const std::string& filename);
 
   std::vector<std::vector<float>> batch_float_feasigns_;
   std::vector<std::vector<uint64_t>> batch_uint64_feasigns_;
@@ -1817,6 +1819,7 @@ class MultiSlotInMemoryDataFeed : public InMemoryDataFeed<Record> {
                                 uint32_t* cmatch,
                                 uint32_t* rank);
   virtual void PutToFeedVec(const Record* ins_vec, int num);
+  void LoadColumnarFile(const std::string& filename) override;
 };
 
 class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
@@ -1842,6 +1845,7 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   virtual void LoadIntoMemoryByLib(void);
   virtual void LoadIntoMemoryByLine(void);
   virtual void LoadIntoMemoryByFile(void);
+  void LoadColumnarFile(const std::string& filename) override;
   void SetInputChannel(void* channel) override {
     input_channel_ = static_cast<ChannelObject<SlotRecord>*>(channel);
   }
@@ -17,10 +17,14 @@
 #include <fcntl.h>
 
 #include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <random>
 #include <set>
 #include <thread>  // NOLINT
 #include <utility>
@@ -30,8 +34,10 @@
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/data_feed_factory.h"
+#include "paddle/fluid/framework/io/columnar_sample.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/slot_text_parser.h"
 
 paddle::framework::DataFeedDesc load_datafeed_param_from_file(
     const char* filename) {
@@ -40,7 +46,7 @@ paddle::framework::DataFeedDesc load_datafeed_param_from_file(
   PADDLE_ENFORCE_NE(
       file_descriptor,
       -1,
-      platform::errors::Unavailable(
+      paddle::platform::errors::Unavailable(
           "Cannot open file %s c load datafeed param from file.", filename));
   google::protobuf::io::FileInputStream fileInput(file_descriptor);
   google::protobuf::TextFormat::Parse(&fileInput, &data_feed_desc);
@@ -54,7 +60,7 @@ const std::vector<std::string> load_filelist_from_file(const char* filename) {
   PADDLE_ENFORCE_EQ(
       fin.good(),
       true,
-      platform::errors::Unavailable(
+      paddle::platform::errors::Unavailable(
           "Cannot open file %s when load filelist from file.", filename));
   std::string line;
   while (getline(fin, line)) {
@@ -203,7 +209,7 @@ void GetElemSetFromReader(std::vector<MultiTypeSet>* reader_elem_set,
                 }
               }
             } else {
-              PADDLE_THROW(platform::errors::InvalidArgument(
+              PADDLE_THROW(paddle::platform::errors::InvalidArgument(
                   "Error type in proto file."));
             }
           } else {  // sparse branch
@@ -226,7 +232,7 @@ void GetElemSetFromReader(std::vector<MultiTypeSet>* reader_elem_set,
                 }
               }
             } else {
-              PADDLE_THROW(platform::errors::InvalidArgument(
+              PADDLE_THROW(paddle::platform::errors::InvalidArgument(
                   "Error type in proto file."));
             }
           }  // end sparse branch
@@ -284,7 +290,7 @@ void GetElemSetFromFile(std::vector<MultiTypeSet>* file_elem_set,
     PADDLE_ENFORCE_EQ(
         fin.good(),
         true,
-        platform::errors::Unavailable(
+        paddle::platform::errors::Unavailable(
             "Can not open %s when get element set from file.", file.c_str()));
     while (1) {
       bool end_flag = false;
@@ -311,8 +317,8 @@ void GetElemSetFromFile(std::vector<MultiTypeSet>* file_elem_set,
               }
             }
           } else {
-            PADDLE_THROW(
-                platform::errors::InvalidArgument("Error type in proto file."));
+            PADDLE_THROW(paddle::platform::errors::InvalidArgument(
+                "Error type in proto file."));
           }
           if (slot.is_used()) {
             ++index;
@@ -344,3 +350,328 @@ TEST(DataFeed, MultiSlotUnitTest) {
   // GetElemSetFromFile(&file_elem_set, data_feed_desc, filelist);
   // CheckIsUnorderedSame(reader_elem_set, file_elem_set);
 }
+
+// MultiSlot lines of 50 uint64 slots and 10 float slots
+std::vector<std::string> GenerateSlotLines(int line_num) {
+  std::mt19937_64 rng(0);
+  std::vector<std::string> lines;
+  for (int i = 0; i < line_num; ++i) {
+    std::string line;
+    for (int slot = 0; slot < 60; ++slot) {
+      int num = 1 + rng() % 8;
+      line += std::to_string(num);
+      for (int j = 0; j < num; ++j) {
+        line += " ";
+        if (slot < 50) {
+          line += std::to_string(rng() >> (rng() % 64));
+        } else {
+          char buf[32];
+          snprintf(buf,
+                   sizeof(buf),
+                   "%.*f",
+                   static_cast<int>(rng() % 8),
+                   static_cast<double>(rng() % 2000000) / 1000 - 1000);
+          line += buf;
+        }
+      }
+      line += " ";
+    }
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+template <typename ParseInt, typename ParseUint64, typename ParseFloat>
+void ParseSlotLine(const std::string& line,
+                   ParseInt parse_int,
+                   ParseUint64 parse_uint64,
+                   ParseFloat parse_float,
+                   std::vector<uint64_t>* uint64_feasigns,
+                   std::vector<float>* float_feasigns) {
+  char* endptr = const_cast<char*>(line.c_str());
+  for (int slot = 0; slot < 60; ++slot) {
+    int num = parse_int(endptr, &endptr);
+    for (int j = 0; j < num; ++j) {
+      if (slot < 50) {
+        uint64_feasigns->push_back(parse_uint64(endptr, &endptr));
+      } else {
+        float_feasigns->push_back(parse_float(endptr, &endptr));
+      }
+    }
+  }
+}
+
+TEST(DataFeed, SlotTextParser) {
+  namespace slot_text = paddle::framework::slot_text;
+  auto libc_int = [](const char* str, char** endptr) {
+    return static_cast<int>(strtol(str, endptr, 10));
+  };
+  auto libc_uint64 = [](const char* str, char** endptr) {
+    return static_cast<uint64_t>(strtoull(str, endptr, 10));
+  };
+  auto libc_float = [](const char* str, char** endptr) {
+    return strtof(str, endptr);
+  };
+
+  std::vector<std::string> lines = GenerateSlotLines(10000);
+  size_t bytes = 0;
+  for (auto& line : lines) {
+    bytes += line.size();
+    std::vector<uint64_t> libc_uint64s, fast_uint64s;
+    std::vector<float> libc_floats, fast_floats;
+    ParseSlotLine(
+        line, libc_int, libc_uint64, libc_float, &libc_uint64s, &libc_floats);
+    ParseSlotLine(line,
+                  slot_text::ParseInt,
+                  slot_text::ParseUint64,
+                  slot_text::ParseFloat,
+                  &fast_uint64s,
+                  &fast_floats);
+    ASSERT_EQ(libc_uint64s, fast_uint64s);
+    ASSERT_EQ(libc_floats.size(), fast_floats.size());
+    ASSERT_EQ(0,
+              memcmp(libc_floats.data(),
+                     fast_floats.data(),
+                     sizeof(float) * libc_floats.size()));
+  }
+
+  // odd forms fall back to libc
+  for (const char* str :
+       {"-1", "+7", "1e", "1e40", ".5", "-0", "inf", "nan", "0x10", "1.5e-3",
+        "18446744073709551616", "123456789.123456789", "\t3"}) {
+    char *libc_end, *fast_end;
+    float libc_value = strtof(str, &libc_end);
+    float fast_value = slot_text::ParseFloat(str, &fast_end);
+    EXPECT_EQ(0, memcmp(&libc_value, &fast_value, sizeof(float))) << str;
+    EXPECT_EQ(libc_end, fast_end) << str;
+    EXPECT_EQ(strtoull(str, &libc_end, 10),
+              slot_text::ParseUint64(str, &fast_end))
+        << str;
+    EXPECT_EQ(libc_end, fast_end) << str;
+  }
+
+  // FindSpace reads no byte out of [str, end), the strings are of every
+  // length and alignment around a 16 bytes block
+  for (size_t len = 0; len < 40; ++len) {
+    for (size_t space = 0; space <= len; ++space) {
+      std::unique_ptr<char[]> buf(new char[len]);
+      memset(buf.get(), 'x', len);
+      if (space < len) {
+        buf[space] = ' ';
+      }
+      EXPECT_EQ(slot_text::FindSpace(buf.get(), buf.get() + len),
+                buf.get() + space)
+          << len << " " << space;
+    }
+  }
+
+  const int repeat = 5;
+  std::vector<uint64_t> uint64s;
+  std::vector<float> floats;
+  auto libc_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    for (auto& line : lines) {
+      uint64s.clear();
+      floats.clear();
+      ParseSlotLine(line, libc_int, libc_uint64, libc_float, &uint64s, &floats);
+    }
+  }
+  auto fast_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    for (auto& line : lines) {
+      uint64s.clear();
+      floats.clear();
+      ParseSlotLine(line,
+                    slot_text::ParseInt,
+                    slot_text::ParseUint64,
+                    slot_text::ParseFloat,
+                    &uint64s,
+                    &floats);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  double libc_sec =
+      std::chrono::duration<double>(fast_start - libc_start).count();
+  double fast_sec = std::chrono::duration<double>(end - fast_start).count();
+  double mb = static_cast<double>(bytes) * repeat / (1 << 20);
+  LOG(INFO) << "slot text parse throughput: libc " << mb / libc_sec
+            << " MB/s, slot_text " << mb / fast_sec << " MB/s";
+}
+
+// slot "skipped" is not used, the used slots after it are indexed apart from
+// all slots
+const char kSlotFeedDesc[] =
+    "batch_size: 2\n"
+    "pipe_command: \"cat\"\n"
+    "multi_slot_desc {\n"
+    "  slots { name: \"click\" type: \"uint64\" is_dense: true is_used: true"
+    "          shape: 1 }\n"
+    "  slots { name: \"skipped\" type: \"uint64\" is_used: false }\n"
+    "  slots { name: \"feasigns\" type: \"uint64\" is_used: true }\n"
+    "  slots { name: \"weights\" type: \"float\" is_used: true }\n"
+    "  slots { name: \"dense\" type: \"float\" is_dense: true is_used: true"
+    "          shape: 2 }\n"
+    "}\n";
+
+// Zero feasigns of the sparse slots are dropped, of the dense ones kept.
+void WriteSlotFeedText(const std::string& path) {
+  std::ofstream fout(path);
+  fout << "1 ins0 1 1 2 7 8 3 11 0 12 2 0.5 0 2 0 1.5\n"
+          "1 ins1 1 0 1 9 2 0 13 1 0.25 2 2.5 0\n"
+          "1 ins2 1 1 3 1 2 3 1 14 2 0 0 2 0 0\n";
+}
+
+// Loads the files with one data feed of feed_name, set up as DatasetImpl does.
+template <typename T>
+std::vector<T> LoadIntoMemoryForTest(const std::string& feed_name,
+                                     const std::vector<std::string>& files) {
+  paddle::framework::DataFeedDesc desc;
+  google::protobuf::TextFormat::ParseFromString(kSlotFeedDesc, &desc);
+  desc.set_name(feed_name);
+  auto feed = paddle::framework::DataFeedFactory::CreateDataFeed(feed_name);
+  std::mutex file_mutex;
+  std::mutex fea_num_mutex;
+  size_t file_idx = 0;
+  uint64_t fea_num = 0;
+  feed->Init(desc);
+  feed->SetThreadId(0);
+  feed->SetThreadNum(1);
+  feed->SetFileListMutex(&file_mutex);
+  feed->SetFileListIndex(&file_idx);
+  feed->SetFeaNumMutex(&fea_num_mutex);
+  feed->SetFeaNum(&fea_num);
+  feed->SetFileList(files);
+  feed->SetParseInsId(true);
+  auto channel = paddle::framework::MakeChannel<T>();
+  feed->SetInputChannel(channel.get());
+  feed->LoadIntoMemory();
+  channel->Close();
+  std::vector<T> records;
+  channel->ReadAll(records);
+  return records;
+}
+
+TEST(DataFeed, InMemoryTextFile) {
+  namespace framework = paddle::framework;
+  std::string text_path = "in_memory_feed_test.txt";
+  WriteSlotFeedText(text_path);
+
+  // (feasign, used slot) of each instance
+  std::vector<std::vector<std::pair<uint64_t, int>>> uint64s = {
+      {{1, 0}, {11, 1}, {12, 1}}, {{0, 0}, {13, 1}}, {{1, 0}, {14, 1}}};
+  std::vector<std::vector<std::pair<float, int>>> floats = {
+      {{0.5f, 2}, {0.0f, 3}, {1.5f, 3}},
+      {{0.25f, 2}, {2.5f, 3}, {0.0f, 3}},
+      {{0.0f, 3}, {0.0f, 3}}};
+  auto records = LoadIntoMemoryForTest<framework::Record>(
+      "MultiSlotInMemoryDataFeed", {text_path});
+  ASSERT_EQ(records.size(), 3UL);
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(records[i].ins_id_, "ins" + std::to_string(i));
+    ASSERT_EQ(records[i].uint64_feasigns_.size(), uint64s[i].size()) << i;
+    for (size_t j = 0; j < uint64s[i].size(); ++j) {
+      EXPECT_EQ(records[i].uint64_feasigns_[j].sign().uint64_feasign_,
+                uint64s[i][j].first);
+      EXPECT_EQ(records[i].uint64_feasigns_[j].slot(), uint64s[i][j].second);
+    }
+    ASSERT_EQ(records[i].float_feasigns_.size(), floats[i].size()) << i;
+    for (size_t j = 0; j < floats[i].size(); ++j) {
+      EXPECT_EQ(records[i].float_feasigns_[j].sign().float_feasign_,
+                floats[i][j].first);
+      EXPECT_EQ(records[i].float_feasigns_[j].slot(), floats[i][j].second);
+    }
+  }
+
+  // SlotRecords keep the zero uint64 feasigns of the sparse slots
+  std::vector<std::vector<uint64_t>> slot_uint64s = {
+      {1, 11, 0, 12}, {0, 13}, {1, 14}};
+  std::vector<std::vector<uint32_t>> slot_uint64_offsets = {
+      {0, 1, 4}, {0, 1, 2}, {0, 1, 2}};
+  std::vector<std::vector<float>> slot_floats = {
+      {0.5f, 0.0f, 1.5f}, {0.25f, 2.5f, 0.0f}, {0.0f, 0.0f}};
+  std::vector<std::vector<uint32_t>> slot_float_offsets = {
+      {0, 1, 3}, {0, 1, 3}, {0, 0, 2}};
+  auto slot_records = LoadIntoMemoryForTest<framework::SlotRecord>(
+      "SlotRecordInMemoryDataFeed", {text_path});
+  ASSERT_EQ(slot_records.size(), 3UL);
+  for (size_t i = 0; i < slot_records.size(); ++i) {
+    EXPECT_EQ(slot_records[i]->ins_id_, "ins" + std::to_string(i));
+    EXPECT_EQ(slot_records[i]->slot_uint64_feasigns_.slot_values,
+              slot_uint64s[i]);
+    EXPECT_EQ(slot_records[i]->slot_uint64_feasigns_.slot_offsets,
+              slot_uint64_offsets[i]);
+    EXPECT_EQ(slot_records[i]->slot_float_feasigns_.slot_values,
+              slot_floats[i]);
+    EXPECT_EQ(slot_records[i]->slot_float_feasigns_.slot_offsets,
+              slot_float_offsets[i]);
+  }
+  framework::SlotRecordPool().put(&slot_records);
+  remove(text_path.c_str());
+}
+
+TEST(DataFeed, ColumnarSampleFile) {
+  namespace framework = paddle::framework;
+  std::string text_path = "columnar_feed_test.txt";
+  std::string columnar_path =
+      std::string("columnar_feed_test") + framework::kColumnarSampleSuffix;
+  WriteSlotFeedText(text_path);
+  std::vector<framework::ColumnarSlot> slots = {{"click", 'u'},
+                                                {"skipped", 'u'},
+                                                {"feasigns", 'u'},
+                                                {"weights", 'f'},
+                                                {"dense", 'f'}};
+  ASSERT_EQ(framework::ConvertTextToColumnarSample(text_path,
+                                                   "cat",
+                                                   slots,
+                                                   framework::kColumnarInsId,
+                                                   columnar_path),
+            3UL);
+
+  auto text = LoadIntoMemoryForTest<framework::Record>(
+      "MultiSlotInMemoryDataFeed", {text_path});
+  auto columnar = LoadIntoMemoryForTest<framework::Record>(
+      "MultiSlotInMemoryDataFeed", {columnar_path});
+  ASSERT_EQ(text.size(), 3UL);
+  ASSERT_EQ(columnar.size(), text.size());
+  for (size_t i = 0; i < text.size(); ++i) {
+    EXPECT_EQ(columnar[i].ins_id_, text[i].ins_id_);
+    ASSERT_EQ(columnar[i].uint64_feasigns_.size(),
+              text[i].uint64_feasigns_.size());
+    for (size_t j = 0; j < text[i].uint64_feasigns_.size(); ++j) {
+      EXPECT_EQ(columnar[i].uint64_feasigns_[j].sign().uint64_feasign_,
+                text[i].uint64_feasigns_[j].sign().uint64_feasign_);
+      EXPECT_EQ(columnar[i].uint64_feasigns_[j].slot(),
+                text[i].uint64_feasigns_[j].slot());
+    }
+    ASSERT_EQ(columnar[i].float_feasigns_.size(),
+              text[i].float_feasigns_.size());
+    for (size_t j = 0; j < text[i].float_feasigns_.size(); ++j) {
+      EXPECT_EQ(columnar[i].float_feasigns_[j].sign().float_feasign_,
+                text[i].float_feasigns_[j].sign().float_feasign_);
+      EXPECT_EQ(columnar[i].float_feasigns_[j].slot(),
+                text[i].float_feasigns_[j].slot());
+    }
+  }
+
+  auto text_recs = LoadIntoMemoryForTest<framework::SlotRecord>(
+      "SlotRecordInMemoryDataFeed", {text_path});
+  auto columnar_recs = LoadIntoMemoryForTest<framework::SlotRecord>(
+      "SlotRecordInMemoryDataFeed", {columnar_path});
+  ASSERT_EQ(text_recs.size(), 3UL);
+  ASSERT_EQ(columnar_recs.size(), text_recs.size());
+  for (size_t i = 0; i < text_recs.size(); ++i) {
+    EXPECT_EQ(columnar_recs[i]->ins_id_, text_recs[i]->ins_id_);
+    EXPECT_EQ(columnar_recs[i]->slot_uint64_feasigns_.slot_offsets,
+              text_recs[i]->slot_uint64_feasigns_.slot_offsets);
+    EXPECT_EQ(columnar_recs[i]->slot_uint64_feasigns_.slot_values,
+              text_recs[i]->slot_uint64_feasigns_.slot_values);
+    EXPECT_EQ(columnar_recs[i]->slot_float_feasigns_.slot_offsets,
+              text_recs[i]->slot_float_feasigns_.slot_offsets);
+    EXPECT_EQ(columnar_recs[i]->slot_float_feasigns_.slot_values,
+              text_recs[i]->slot_float_feasigns_.slot_values);
+  }
+  framework::SlotRecordPool().put(&text_recs);
+  framework::SlotRecordPool().put(&columnar_recs);
+  remove(text_path.c_str());
+  remove(columnar_path.c_str());
+}
@@ -66,6 +66,7 @@ DatasetImpl<T>::DatasetImpl() {
   global_index_ = 0;
   shuffle_by_uid_ = false;
   parse_uid_ = false;
+  use_segmented_channel_ = false;
 }
 
 // set filelist, file_idx_ will reset to zero.
@@ -183,6 +184,11 @@ void DatasetImpl<T>::SetShuffleByUid(bool enable_shuffle_uid) {
   parse_uid_ = true;
 }
 
+template <typename T>
+void DatasetImpl<T>::SetUseSegmentedChannel(bool use_segmented_channel) {
+  use_segmented_channel_ = use_segmented_channel;
+}
+
 template <typename T>
 void DatasetImpl<T>::SetEnablePvMerge(bool enable_pv_merge) {
   enable_pv_merge_ = enable_pv_merge;
@@ -225,18 +231,18 @@ std::vector<paddle::framework::DataFeed*> DatasetImpl<T>::GetReaders() {
 template <typename T>
 void DatasetImpl<T>::CreateChannel() {
   if (input_channel_ == nullptr) {
-    input_channel_ = paddle::framework::MakeChannel<T>();
+    input_channel_ = MakeInstanceChannel();
   }
   if (multi_output_channel_.empty()) {
     multi_output_channel_.reserve(channel_num_);
     for (int i = 0; i < channel_num_; ++i) {
-      multi_output_channel_.push_back(paddle::framework::MakeChannel<T>());
+      multi_output_channel_.push_back(MakeInstanceChannel());
     }
   }
   if (multi_consume_channel_.empty()) {
     multi_consume_channel_.reserve(channel_num_);
     for (int i = 0; i < channel_num_; ++i) {
-      multi_consume_channel_.push_back(paddle::framework::MakeChannel<T>());
+      multi_consume_channel_.push_back(MakeInstanceChannel());
     }
   }
   if (input_pv_channel_ == nullptr) {
@@ -945,8 +951,8 @@ void DatasetImpl<T>::DynamicAdjustChannelNum(int channel_num,
   for (int i = 0; i < channel_num; ++i) {
     local_vec.clear();
     total_data_channel->Read(local_vec);
-    new_other_channels.push_back(paddle::framework::MakeChannel<T>());
-    new_channels.push_back(paddle::framework::MakeChannel<T>());
+    new_other_channels.push_back(MakeInstanceChannel());
+    new_channels.push_back(MakeInstanceChannel());
     new_channels[i]->Write(std::move(local_vec));
     new_other_pv_channels.push_back(
         paddle::framework::MakeChannel<PvInstance>());
@@ -1770,7 +1776,7 @@ void MultiSlotDataset::SlotsShuffle(
 template class DatasetImpl<SlotRecord>;
 void SlotRecordDataset::CreateChannel() {
   if (input_channel_ == nullptr) {
-    input_channel_ = paddle::framework::MakeChannel<SlotRecord>();
+    input_channel_ = MakeInstanceChannel();
   }
 }
 void SlotRecordDataset::CreateReaders() {
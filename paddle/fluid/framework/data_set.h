@@ -86,6 +86,9 @@ class Dataset {
   virtual bool EnablePvMerge() = 0;
   virtual void SetMergeBySid(bool is_merge) = 0;
   virtual void SetShuffleByUid(bool enable_shuffle_uid) = 0;
+  // use the lock-free segmented channels for the instances, which scale
+  // better with many reader threads but do not keep the order between blocks
+  virtual void SetUseSegmentedChannel(bool use_segmented_channel) = 0;
   // set merge by ins id
   virtual void SetMergeByInsId(int merge_size) = 0;
   virtual void SetGenerateUniqueFeasign(bool gen_uni_feasigns) = 0;
@@ -208,6 +211,7 @@ class DatasetImpl : public Dataset {
   virtual void SetEnablePvMerge(bool enable_pv_merge);
   virtual void SetMergeBySid(bool is_merge);
   virtual void SetShuffleByUid(bool enable_shuffle_uid);
+  virtual void SetUseSegmentedChannel(bool use_segmented_channel);
 
   virtual void SetMergeByInsId(int merge_size);
   virtual void SetGenerateUniqueFeasign(bool gen_uni_feasigns);
@@ -296,6 +300,13 @@ class DatasetImpl : public Dataset {
     // TODO(yaoxuefeng) for SlotRecordDataset
     return -1;
   }
+  // the pv channels always keep the order, only the instance channels follow
+  // use_segmented_channel_
+  paddle::framework::Channel<T> MakeInstanceChannel() {
+    auto channel = paddle::framework::MakeChannel<T>();
+    channel->SetSegmented(use_segmented_channel_);
+    return channel;
+  }
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> readers_;
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> preload_readers_;
   paddle::framework::Channel<T> input_channel_;
@@ -335,6 +346,7 @@ class DatasetImpl : public Dataset {
   bool merge_by_sid_;
   bool shuffle_by_uid_;
   bool parse_uid_;
+  bool use_segmented_channel_;
   bool enable_pv_merge_;  // True means to merge pv
   int current_phase_;     // 1 join, 0 update
   size_t merge_size_;
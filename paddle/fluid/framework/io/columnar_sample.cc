@@ -0,0 +1,533 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/columnar_sample.h"
+
+#include <zlib.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/io/fs.h"
+#include "paddle/fluid/framework/slot_text_parser.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/string/string_helper.h"
+
+namespace paddle {
+namespace framework {
+
+const char kColumnarSampleSuffix[] = ".slotcol";
+
+namespace {
+
+const char kFileMagic[8] = {'P', 'D', 'S', 'L', 'O', 'T', 'C', '1'};
+const uint32_t kBlockMagic = 0x42434450;  // "PDCB"
+const uint32_t kVersion = 1;
+const uint32_t kStringColumns[] = {
+    kColumnarInsId, kColumnarContent, kColumnarLogKey};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t string_columns;
+  uint32_t slot_num;
+  uint32_t reserved;
+};
+
+struct BlockHeader {
+  uint32_t magic;
+  uint32_t ins_num;
+  uint32_t codec;
+  uint32_t reserved;
+  uint64_t raw_size;
+  uint64_t stored_size;
+};
+
+inline size_t Align8(size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+inline int StringColumnIndex(uint32_t column) { return __builtin_ctz(column); }
+
+void Append(std::vector<char>* buf, const void* data, size_t size) {
+  const char* begin = reinterpret_cast<const char*>(data);
+  buf->insert(buf->end(), begin, begin + size);
+  buf->resize(Align8(buf->size()), 0);
+}
+
+void WriteAll(FILE* fp, const void* data, size_t size) {
+  PADDLE_ENFORCE_EQ(
+      fwrite(data, 1, size, fp),
+      size,
+      platform::errors::Unavailable("Failed to write the columnar sample."));
+}
+
+}  // namespace
+
+bool IsColumnarSampleFile(const std::string& path) {
+  size_t suffix_len = sizeof(kColumnarSampleSuffix) - 1;
+  return path.size() >= suffix_len &&
+         path.compare(path.size() - suffix_len,
+                      suffix_len,
+                      kColumnarSampleSuffix) == 0;
+}
+
+std::string ColumnarSampleBlock::String(uint32_t column, uint32_t ins) const {
+  int idx = StringColumnIndex(column);
+  if (string_offsets_[idx] == nullptr) {
+    return std::string();
+  }
+  const uint32_t* offsets = string_offsets_[idx];
+  return std::string(string_chars_[idx] + offsets[ins],
+                     offsets[ins + 1] - offsets[ins]);
+}
+
+ColumnarSampleReader::~ColumnarSampleReader() { Close(); }
+
+void ColumnarSampleReader::Close() {
+#ifndef _WIN32
+  if (mmap_addr_ != nullptr) {
+    munmap(mmap_addr_, size_);
+    mmap_addr_ = nullptr;
+  }
+#endif
+  file_buffer_.clear();
+  file_buffer_.shrink_to_fit();
+  data_ = nullptr;
+  size_ = 0;
+  pos_ = 0;
+}
+
+void ColumnarSampleReader::Open(const std::string& path) {
+  Close();
+  path_ = path;
+#ifndef _WIN32
+  if (fs_select_internal(path) == 0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    PADDLE_ENFORCE_GE(fd,
+                      0,
+                      platform::errors::NotFound(
+                          "Cannot open the columnar sample %s.", path));
+    struct stat st;
+    fstat(fd, &st);
+    size_ = st.st_size;
+    if (size_ > 0) {
+      mmap_addr_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mmap_addr_ == MAP_FAILED) {
+        mmap_addr_ = nullptr;
+      } else {
+        madvise(mmap_addr_, size_, MADV_SEQUENTIAL);
+      }
+    }
+    close(fd);
+    PADDLE_ENFORCE_NOT_NULL(
+        mmap_addr_,
+        platform::errors::Unavailable("Failed to mmap the columnar sample %s.",
+                                      path));
+    data_ = reinterpret_cast<const char*>(mmap_addr_);
+  }
+#endif
+  if (data_ == nullptr) {
+    int err_no = 0;
+    std::shared_ptr<FILE> fp = fs_open_read(path, &err_no, "", false);
+    PADDLE_ENFORCE_NOT_NULL(
+        fp,
+        platform::errors::NotFound("Cannot open the columnar sample %s.",
+                                   path));
+    const size_t kReadSize = 16 * 1024 * 1024;
+    size_t read_len = 0;
+    do {
+      file_buffer_.resize(size_ + kReadSize);
+      read_len = fread(file_buffer_.data() + size_, 1, kReadSize, fp.get());
+      size_ += read_len;
+    } while (read_len > 0);
+    file_buffer_.resize(size_);
+    data_ = file_buffer_.data();
+  }
+
+  FileHeader header;
+  PADDLE_ENFORCE_GE(size_,
+                    sizeof(header),
+                    platform::errors::InvalidArgument(
+                        "The columnar sample %s is truncated.", path));
+  memcpy(&header, data_, sizeof(header));
+  PADDLE_ENFORCE_EQ(memcmp(header.magic, kFileMagic, sizeof(kFileMagic)),
+                    0,
+                    platform::errors::InvalidArgument(
+                        "%s is not a columnar sample file.", path));
+  PADDLE_ENFORCE_EQ(header.version,
+                    kVersion,
+                    platform::errors::InvalidArgument(
+                        "Unsupported columnar sample version %d of %s.",
+                        header.version,
+                        path));
+  string_columns_ = header.string_columns;
+  pos_ = sizeof(header);
+  slots_.resize(header.slot_num);
+  for (auto& slot : slots_) {
+    PADDLE_ENFORCE_LE(pos_ + 4,
+                      size_,
+                      platform::errors::InvalidArgument(
+                          "The columnar sample %s is truncated.", path));
+    uint16_t name_len = 0;
+    slot.type = data_[pos_];
+    memcpy(&name_len, data_ + pos_ + 2, sizeof(name_len));
+    pos_ += 4;
+    PADDLE_ENFORCE_LE(pos_ + name_len,
+                      size_,
+                      platform::errors::InvalidArgument(
+                          "The columnar sample %s is truncated.", path));
+    slot.name.assign(data_ + pos_, name_len);
+    pos_ += name_len;
+  }
+  pos_ = Align8(pos_);
+}
+
+bool ColumnarSampleReader::Next(ColumnarSampleBlock* block) {
+  if (pos_ >= size_) {
+    return false;
+  }
+  BlockHeader header;
+  PADDLE_ENFORCE_LE(pos_ + sizeof(header),
+                    size_,
+                    platform::errors::InvalidArgument(
+                        "The columnar sample %s is truncated.", path_));
+  memcpy(&header, data_ + pos_, sizeof(header));
+  PADDLE_ENFORCE_EQ(header.magic,
+                    kBlockMagic,
+                    platform::errors::InvalidArgument(
+                        "Bad block in the columnar sample %s.", path_));
+  pos_ += sizeof(header);
+  PADDLE_ENFORCE_LE(pos_ + header.stored_size,
+                    size_,
+                    platform::errors::InvalidArgument(
+                        "The columnar sample %s is truncated.", path_));
+
+  const char* payload = data_ + pos_;
+  if (header.codec == kColumnarZlib) {
+    block->buffer_.resize(header.raw_size);
+    uLongf raw_size = header.raw_size;
+    int ret = uncompress(reinterpret_cast<Bytef*>(block->buffer_.data()),
+                         &raw_size,
+                         reinterpret_cast<const Bytef*>(payload),
+                         header.stored_size);
+    PADDLE_ENFORCE_EQ(
+        ret == Z_OK && raw_size == header.raw_size,
+        true,
+        platform::errors::InvalidArgument(
+            "Failed to decompress a block of the columnar sample %s.", path_));
+    payload = block->buffer_.data();
+  } else {
+    PADDLE_ENFORCE_EQ(header.codec,
+                      kColumnarNone,
+                      platform::errors::InvalidArgument(
+                          "Unknown codec %d in the columnar sample %s.",
+                          header.codec,
+                          path_));
+  }
+  pos_ = Align8(pos_ + header.stored_size);
+
+  size_t cursor = 0;
+  size_t offsets_size = sizeof(uint32_t) * (header.ins_num + 1);
+  auto take = [&](size_t size) {
+    PADDLE_ENFORCE_LE(cursor + size,
+                      header.raw_size,
+                      platform::errors::InvalidArgument(
+                          "Bad block in the columnar sample %s.", path_));
+    const char* ptr = payload + cursor;
+    cursor = Align8(cursor + size);
+    return ptr;
+  };
+  block->ins_num_ = header.ins_num;
+  for (uint32_t column : kStringColumns) {
+    int idx = StringColumnIndex(column);
+    if (string_columns_ & column) {
+      block->string_offsets_[idx] =
+          reinterpret_cast<const uint32_t*>(take(offsets_size));
+      block->string_chars_[idx] =
+          take(block->string_offsets_[idx][header.ins_num]);
+    } else {
+      block->string_offsets_[idx] = nullptr;
+      block->string_chars_[idx] = nullptr;
+    }
+  }
+  block->slot_offsets_.resize(slots_.size());
+  block->slot_values_.resize(slots_.size());
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    const uint32_t* offsets =
+        reinterpret_cast<const uint32_t*>(take(offsets_size));
+    size_t value_size = slots_[i].type == 'f' ? sizeof(float)
+                                              : sizeof(uint64_t);
+    block->slot_offsets_[i] = offsets;
+    block->slot_values_[i] = take(value_size * offsets[header.ins_num]);
+  }
+  return true;
+}
+
+ColumnarSampleWriter::ColumnarSampleWriter(
+    const std::string& path,
+    const std::vector<ColumnarSlot>& slots,
+    uint32_t string_columns,
+    ColumnarCodec codec,
+    uint32_t block_ins_num)
+    : slots_(slots),
+      string_columns_(string_columns),
+      codec_(codec),
+      block_ins_num_(block_ins_num),
+      string_offsets_(3, std::vector<uint32_t>(1, 0)),
+      string_chars_(3),
+      slot_offsets_(slots.size(), std::vector<uint32_t>(1, 0)),
+      uint64_values_(slots.size()),
+      float_values_(slots.size()) {
+  int err_no = 0;
+  fp_ = fs_open_write(path, &err_no, "");
+  PADDLE_ENFORCE_NOT_NULL(
+      fp_,
+      platform::errors::Unavailable("Cannot open %s to write the columnar "
+                                    "sample.",
+                                    path));
+
+  FileHeader header;
+  memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+  header.version = kVersion;
+  header.string_columns = string_columns;
+  header.slot_num = slots.size();
+  header.reserved = 0;
+  std::vector<char> buf(reinterpret_cast<const char*>(&header),
+                        reinterpret_cast<const char*>(&header) +
+                            sizeof(header));
+  for (auto& slot : slots) {
+    PADDLE_ENFORCE_EQ(
+        slot.type == 'u' || slot.type == 'f',
+        true,
+        platform::errors::InvalidArgument(
+            "The type of slot %s should be uint64 or float.", slot.name));
+    uint16_t name_len = slot.name.size();
+    char slot_header[4] = {slot.type, 0, 0, 0};
+    memcpy(slot_header + 2, &name_len, sizeof(name_len));
+    buf.insert(buf.end(), slot_header, slot_header + 4);
+    buf.insert(buf.end(), slot.name.begin(), slot.name.end());
+  }
+  buf.resize(Align8(buf.size()), 0);
+  WriteAll(fp_.get(), buf.data(), buf.size());
+}
+
+ColumnarSampleWriter::~ColumnarSampleWriter() {
+  // Close may throw, a writer destroyed without it, e.g. while unwinding
+  // from a bad line, drops the instances not flushed yet
+  if (fp_ != nullptr && (ins_num_ > 0 || in_instance_)) {
+    LOG(WARNING) << "The columnar sample writer is destroyed without Close, "
+                 << ins_num_ + in_instance_ << " instances are dropped.";
+  }
+}
+
+void ColumnarSampleWriter::AddInstance(const std::string& ins_id,
+                                       const std::string& content,
+                                       const std::string& log_key) {
+  if (in_instance_) {
+    FinishInstance();
+  }
+  const std::string* strings[] = {&ins_id, &content, &log_key};
+  for (uint32_t column : kStringColumns) {
+    if (string_columns_ & column) {
+      int idx = StringColumnIndex(column);
+      string_chars_[idx] += *strings[idx];
+      string_offsets_[idx].push_back(string_chars_[idx].size());
+    }
+  }
+  in_instance_ = true;
+}
+
+void ColumnarSampleWriter::AddUint64(int slot,
+                                     const uint64_t* values,
+                                     size_t num) {
+  uint64_values_[slot].insert(uint64_values_[slot].end(), values, values + num);
+}
+
+void ColumnarSampleWriter::AddFloat(int slot, const float* values, size_t num) {
+  float_values_[slot].insert(float_values_[slot].end(), values, values + num);
+}
+
+void ColumnarSampleWriter::FinishInstance() {
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    slot_offsets_[i].push_back(slots_[i].type == 'f'
+                                   ? float_values_[i].size()
+                                   : uint64_values_[i].size());
+  }
+  in_instance_ = false;
+  if (++ins_num_ >= block_ins_num_) {
+    Flush();
+  }
+}
+
+void ColumnarSampleWriter::Flush() {
+  if (ins_num_ == 0) {
+    return;
+  }
+  payload_.clear();
+  for (uint32_t column : kStringColumns) {
+    if (string_columns_ & column) {
+      int idx = StringColumnIndex(column);
+      Append(&payload_,
+             string_offsets_[idx].data(),
+             sizeof(uint32_t) * string_offsets_[idx].size());
+      Append(&payload_, string_chars_[idx].data(), string_chars_[idx].size());
+      string_offsets_[idx].resize(1);
+      string_chars_[idx].clear();
+    }
+  }
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    Append(&payload_,
+           slot_offsets_[i].data(),
+           sizeof(uint32_t) * slot_offsets_[i].size());
+    if (slots_[i].type == 'f') {
+      Append(&payload_,
+             float_values_[i].data(),
+             sizeof(float) * float_values_[i].size());
+    } else {
+      Append(&payload_,
+             uint64_values_[i].data(),
+             sizeof(uint64_t) * uint64_values_[i].size());
+    }
+    slot_offsets_[i].resize(1);
+    float_values_[i].clear();
+    uint64_values_[i].clear();
+  }
+
+  BlockHeader header;
+  header.magic = kBlockMagic;
+  header.ins_num = ins_num_;
+  header.codec = codec_;
+  header.reserved = 0;
+  header.raw_size = payload_.size();
+  const char* stored = payload_.data();
+  header.stored_size = payload_.size();
+  if (codec_ == kColumnarZlib) {
+    uLongf compressed_size = compressBound(payload_.size());
+    compressed_.resize(compressed_size);
+    int ret = compress2(reinterpret_cast<Bytef*>(compressed_.data()),
+                        &compressed_size,
+                        reinterpret_cast<const Bytef*>(payload_.data()),
+                        payload_.size(),
+                        Z_BEST_SPEED);
+    PADDLE_ENFORCE_EQ(ret,
+                      Z_OK,
+                      platform::errors::Fatal(
+                          "Failed to compress the columnar sample block."));
+    stored = compressed_.data();
+    header.stored_size = compressed_size;
+  }
+  WriteAll(fp_.get(), &header, sizeof(header));
+  WriteAll(fp_.get(), stored, header.stored_size);
+  const char padding[8] = {0};
+  WriteAll(fp_.get(), padding, Align8(header.stored_size) - header.stored_size);
+  ins_num_ = 0;
+}
+
+void ColumnarSampleWriter::Close() {
+  if (in_instance_) {
+    FinishInstance();
+  }
+  Flush();
+  fp_.reset();
+}
+
+size_t ConvertTextToColumnarSample(const std::string& text_path,
+                                   const std::string& pipe_command,
+                                   const std::vector<ColumnarSlot>& slots,
+                                   uint32_t string_columns,
+                                   const std::string& columnar_path,
+                                   ColumnarCodec codec) {
+#ifdef _WIN32
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "Converting to the columnar sample is not supported on Windows."));
+#else
+  int err_no = 0;
+  std::shared_ptr<FILE> fin = fs_open_read(text_path, &err_no, pipe_command, true);
+  PADDLE_ENFORCE_NOT_NULL(
+      fin,
+      platform::errors::NotFound("Cannot open the text sample %s.", text_path));
+  ColumnarSampleWriter writer(columnar_path, slots, string_columns, codec);
+
+  std::vector<uint64_t> uint64_values;
+  std::vector<float> float_values;
+  std::string strings[3];
+  // frees its buffer when a bad line throws
+  string::LineFileReader reader;
+  size_t ins_num = 0;
+  while (char* line = reader.getline(fin.get())) {
+    if (reader.length() == 0) {
+      continue;
+    }
+    char* pos = line;
+    char* endptr = line;
+    const char* line_end = line + reader.length();
+    for (uint32_t column : kStringColumns) {
+      if (string_columns & column) {
+        int num = slot_text::ParseInt(pos, &endptr);
+        PADDLE_ENFORCE_EQ(num,
+                          1,
+                          platform::errors::InvalidArgument(
+                              "Bad line %d of %s: %s",
+                              ins_num,
+                              text_path,
+                              line));
+        pos = endptr + 1;
+        const char* end = slot_text::FindSpace(pos, line_end);
+        strings[StringColumnIndex(column)].assign(pos, end - pos);
+        pos = const_cast<char*>(*end == ' ' ? end + 1 : end);
+      }
+    }
+    writer.AddInstance(strings[0], strings[1], strings[2]);
+    for (size_t i = 0; i < slots.size(); ++i) {
+      int num = slot_text::ParseInt(pos, &endptr);
+      PADDLE_ENFORCE_GT(
+          num,
+          0,
+          platform::errors::InvalidArgument(
+              "The number of ids can not be zero, please check line %d of "
+              "%s, slot %s.",
+              ins_num,
+              text_path,
+              slots[i].name));
+      pos = endptr;
+      if (slots[i].type == 'f') {
+        float_values.resize(num);
+        for (int j = 0; j < num; ++j) {
+          float_values[j] = slot_text::ParseFloat(pos, &pos);
+        }
+        writer.AddFloat(i, float_values.data(), num);
+      } else {
+        uint64_values.resize(num);
+        for (int j = 0; j < num; ++j) {
+          uint64_values[j] = slot_text::ParseUint64(pos, &pos);
+        }
+        writer.AddUint64(i, uint64_values.data(), num);
+      }
+    }
+    ++ins_num;
+  }
+  writer.Close();
+  return ins_num;
+#endif
+}
+
+}  // namespace framework
+}  // namespace paddle
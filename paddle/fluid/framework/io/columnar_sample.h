@@ -0,0 +1,163 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// Columnar binary format of the MultiSlot samples, the in memory data feeds
+// load the files ending with kColumnarSampleSuffix without parsing text.
+//
+// file   : FileHeader, SlotHeader * slot_num, padding to 8 bytes, Block ...
+// block  : BlockHeader, payload (zlib compressed if codec is kColumnarZlib)
+// payload: for each string column in flags: uint32 offsets[ins_num + 1],
+//          chars; for each slot: uint32 offsets[ins_num + 1], values
+//          (uint64 or float). Every array starts at a multiple of 8 bytes.
+//
+// All slots of the text are kept with their raw values, so the used slots
+// and the zero filtering are still decided by the data feed desc at load.
+extern const char kColumnarSampleSuffix[];
+
+enum ColumnarStringColumn : uint32_t {
+  kColumnarInsId = 1,
+  kColumnarContent = 2,
+  kColumnarLogKey = 4,
+};
+
+enum ColumnarCodec : uint32_t {
+  kColumnarNone = 0,
+  kColumnarZlib = 1,
+};
+
+struct ColumnarSlot {
+  std::string name;
+  char type;  // 'u' for uint64, 'f' for float
+};
+
+bool IsColumnarSampleFile(const std::string& path);
+
+// A decoded block, the arrays point into the mapped file or into the
+// decompressed buffer and are valid until the next block is read.
+class ColumnarSampleBlock {
+ public:
+  uint32_t InsNum() const { return ins_num_; }
+  // empty if the column is not in the file
+  std::string String(uint32_t column, uint32_t ins) const;
+  const uint32_t* SlotOffsets(int slot) const { return slot_offsets_[slot]; }
+  const uint64_t* Uint64Values(int slot) const {
+    return reinterpret_cast<const uint64_t*>(slot_values_[slot]);
+  }
+  const float* FloatValues(int slot) const {
+    return reinterpret_cast<const float*>(slot_values_[slot]);
+  }
+
+ private:
+  friend class ColumnarSampleReader;
+
+  uint32_t ins_num_ = 0;
+  // indexed by the bit of ColumnarStringColumn, nullptr if absent
+  const uint32_t* string_offsets_[3] = {nullptr, nullptr, nullptr};
+  const char* string_chars_[3] = {nullptr, nullptr, nullptr};
+  std::vector<const uint32_t*> slot_offsets_;
+  std::vector<const void*> slot_values_;
+  std::vector<char> buffer_;
+};
+
+// Reads a columnar file, local files are mmapped, the others are read by
+// fs_open_read in bulk.
+class ColumnarSampleReader {
+ public:
+  ColumnarSampleReader() {}
+  ~ColumnarSampleReader();
+  ColumnarSampleReader(const ColumnarSampleReader&) = delete;
+  ColumnarSampleReader& operator=(const ColumnarSampleReader&) = delete;
+
+  void Open(const std::string& path);
+  const std::vector<ColumnarSlot>& Slots() const { return slots_; }
+  uint32_t StringColumns() const { return string_columns_; }
+  // returns false at the end of file
+  bool Next(ColumnarSampleBlock* block);
+
+ private:
+  void Close();
+
+  std::string path_;
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  size_t pos_ = 0;
+  void* mmap_addr_ = nullptr;
+  std::vector<char> file_buffer_;
+  std::vector<ColumnarSlot> slots_;
+  uint32_t string_columns_ = 0;
+};
+
+class ColumnarSampleWriter {
+ public:
+  ColumnarSampleWriter(const std::string& path,
+                       const std::vector<ColumnarSlot>& slots,
+                       uint32_t string_columns,
+                       ColumnarCodec codec = kColumnarZlib,
+                       uint32_t block_ins_num = 8192);
+  ~ColumnarSampleWriter();
+
+  // The values of each slot follow AddInstance by AddUint64/AddFloat,
+  // slots not added are empty in this instance.
+  void AddInstance(const std::string& ins_id,
+                   const std::string& content,
+                   const std::string& log_key);
+  void AddUint64(int slot, const uint64_t* values, size_t num);
+  void AddFloat(int slot, const float* values, size_t num);
+  // Flushes the last block, the destructor does not.
+  void Close();
+
+ private:
+  void FinishInstance();
+  void Flush();
+
+  std::shared_ptr<FILE> fp_;
+  std::vector<ColumnarSlot> slots_;
+  uint32_t string_columns_;
+  ColumnarCodec codec_;
+  uint32_t block_ins_num_;
+  uint32_t ins_num_ = 0;
+  bool in_instance_ = false;
+  std::vector<std::vector<uint32_t>> string_offsets_;
+  std::vector<std::string> string_chars_;
+  std::vector<std::vector<uint32_t>> slot_offsets_;
+  std::vector<std::vector<uint64_t>> uint64_values_;
+  std::vector<std::vector<float>> float_values_;
+  std::vector<char> payload_;
+  std::vector<char> compressed_;
+};
+
+// Converts a MultiSlot text file, each line is
+//   [1 ins_id] [1 content] [1 log_key] <num> <feasign> ... for every slot
+// as read by the in memory data feeds. Returns the number of instances.
+size_t ConvertTextToColumnarSample(const std::string& text_path,
+                                   const std::string& pipe_command,
+                                   const std::vector<ColumnarSlot>& slots,
+                                   uint32_t string_columns,
+                                   const std::string& columnar_path,
+                                   ColumnarCodec codec = kColumnarZlib);
+
+}  // namespace framework
+}  // namespace paddle
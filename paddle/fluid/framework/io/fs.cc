@@ -15,8 +15,14 @@ limitations under the License. */
 #include "paddle/fluid/framework/io/fs.h"
 
 #include <sys/stat.h>
+#include <zlib.h>
 
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 
 #include "glog/logging.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -82,6 +88,213 @@ static std::shared_ptr<FILE> fs_open_internal(const std::string& path,
   return fp;
 }
 
+static bool& fs_inprocess_gzip_internal() {
+  static bool x = true;
+  return x;
+}
+
+bool fs_inprocess_gzip() { return fs_inprocess_gzip_internal(); }
+
+void fs_set_inprocess_gzip(bool x) { fs_inprocess_gzip_internal() = x; }
+
+static bool& fs_decode_zst_internal() {
+  static bool x = false;
+  return x;
+}
+
+bool fs_decode_zst() { return fs_decode_zst_internal(); }
+
+void fs_set_decode_zst(bool x) { fs_decode_zst_internal() = x; }
+
+#ifdef __linux__
+// Decodes a gzip stream read from source in a worker thread. The decoded
+// data is handed to the reader in buffers of buffer_size bytes, at most
+// kReadAhead of them are ready ahead of the reader. Concatenated gzip
+// members are decoded as one stream like zcat does.
+class GzipStreamReader {
+ public:
+  GzipStreamReader(std::shared_ptr<FILE> source,
+                   size_t buffer_size,
+                   int* err_no)
+      : source_(std::move(source)), buffer_size_(buffer_size), err_no_(err_no) {
+    worker_ = std::thread([this] { Decode(); });
+  }
+
+  ~GzipStreamReader() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    cond_.notify_all();
+    worker_.join();
+    source_ = nullptr;
+    if (failed_ && err_no_ != nullptr) {
+      *err_no_ = -1;
+    }
+  }
+
+  // returns 0 at the end of stream and -1 if the stream is broken
+  ssize_t Read(char* buf, size_t size) {
+    if (pos_ == current_.size()) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!current_.empty()) {
+        free_.push_back(std::move(current_));
+        current_.clear();
+        pos_ = 0;
+      }
+      cond_.wait(lock, [this] { return !ready_.empty() || finished_; });
+      if (ready_.empty()) {
+        return failed_ ? -1 : 0;
+      }
+      current_ = std::move(ready_.front());
+      ready_.pop_front();
+      pos_ = 0;
+      cond_.notify_all();
+    }
+    size_t n = std::min(size, current_.size() - pos_);
+    memcpy(buf, current_.data() + pos_, n);
+    pos_ += n;
+    return n;
+  }
+
+ private:
+  static constexpr size_t kReadAhead = 2;
+  static constexpr size_t kInputSize = 256 * 1024;
+
+  // hands a filled buffer to the reader, returns false if the reader is
+  // closed
+  bool Publish(std::vector<char>* out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock,
+               [this] { return ready_.size() < kReadAhead || stopped_; });
+    if (stopped_) {
+      return false;
+    }
+    ready_.push_back(std::move(*out));
+    cond_.notify_all();
+    if (free_.empty()) {
+      out->clear();
+    } else {
+      *out = std::move(free_.back());
+      free_.pop_back();
+    }
+    return true;
+  }
+
+  void Decode() {
+    std::vector<char> in(kInputSize);
+    std::vector<char> out;
+    size_t filled = 0;
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // 32 lets zlib detect the gzip header
+    bool initialized = inflateInit2(&zs, 15 + 32) == Z_OK;
+    bool in_member = false;
+    bool failed = !initialized;
+    if (failed) {
+      LOG(WARNING) << "failed to init gzip stream: "
+                   << (zs.msg != nullptr ? zs.msg : "unknown error");
+    }
+    while (!failed) {
+      if (zs.avail_in == 0) {
+        size_t n = fread(in.data(), 1, in.size(), source_.get());
+        if (n == 0) {
+          if (in_member) {
+            LOG(WARNING) << "gzip stream ends in the middle of a member";
+            failed = true;
+          }
+          break;
+        }
+        zs.next_in = reinterpret_cast<Bytef*>(in.data());
+        zs.avail_in = static_cast<uInt>(n);
+      }
+      if (!in_member) {
+        if (inflateReset(&zs) != Z_OK) {
+          LOG(WARNING) << "failed to reset gzip stream";
+          failed = true;
+          break;
+        }
+        in_member = true;
+      }
+      out.resize(buffer_size_);
+      zs.next_out = reinterpret_cast<Bytef*>(out.data() + filled);
+      zs.avail_out = static_cast<uInt>(out.size() - filled);
+      int ret = inflate(&zs, Z_NO_FLUSH);
+      filled = out.size() - zs.avail_out;
+      if (ret == Z_STREAM_END) {
+        in_member = false;
+      } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        LOG(WARNING) << "failed to decode gzip stream: "
+                     << (zs.msg != nullptr ? zs.msg : "unknown error");
+        failed = true;
+        break;
+      }
+      if (filled == out.size()) {
+        if (!Publish(&out)) {
+          break;
+        }
+        filled = 0;
+      }
+    }
+    if (initialized) {
+      inflateEnd(&zs);
+    }
+    if (filled > 0) {
+      out.resize(filled);
+      Publish(&out);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed_ = failed;
+    finished_ = true;
+    cond_.notify_all();
+  }
+
+  std::shared_ptr<FILE> source_;
+  size_t buffer_size_;
+  int* err_no_;
+  std::thread worker_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::vector<char>> ready_;
+  std::vector<std::vector<char>> free_;
+  bool stopped_ = false;
+  bool finished_ = false;
+  bool failed_ = false;
+  // owned by the reader
+  std::vector<char> current_;
+  size_t pos_ = 0;
+};
+
+static std::shared_ptr<FILE> fs_open_gzip_internal(
+    std::shared_ptr<FILE> source, size_t buffer_size, int* err_no) {
+  cookie_io_functions_t io;
+  memset(&io, 0, sizeof(io));
+  io.read = [](void* cookie, char* buf, size_t size) -> ssize_t {
+    return static_cast<GzipStreamReader*>(cookie)->Read(buf, size);
+  };
+  io.close = [](void* cookie) -> int {
+    delete static_cast<GzipStreamReader*>(cookie);
+    return 0;
+  };
+  // at least 1MB to keep the worker well ahead of the parser
+  buffer_size = std::max(buffer_size, static_cast<size_t>(1 << 20));
+  auto* reader = new GzipStreamReader(std::move(source), buffer_size, err_no);
+  FILE* fp = fopencookie(reader, "r", io);
+  if (fp == nullptr) {
+    delete reader;
+    PADDLE_THROW(platform::errors::Unavailable(
+        "Failed to create the gzip stream reader."));
+  }
+  return {fp, [](FILE* fp) { fclose(fp); }};
+}
+#endif
+
+// converters that do not change the data
+static bool fs_is_identity_converter_internal(const std::string& converter) {
+  std::string x = string::trim_spaces(converter);
+  return x.empty() || x == "cat";
+}
+
 static bool fs_begin_with_internal(const std::string& path,
                                    const std::string& str) {
   return strncmp(path.c_str(), str.c_str(), str.length()) == 0;
@@ -104,16 +317,35 @@ size_t localfs_buffer_size() { return localfs_buffer_size_internal(); }
 
 void localfs_set_buffer_size(size_t x) { localfs_buffer_size_internal() = x; }
 
-std::shared_ptr<FILE> localfs_open_read(std::string path,
-                                        const std::string& converter) {
+static std::shared_ptr<FILE> localfs_open_read_internal(
+    std::string path, const std::string& converter, int* err_no) {
   bool is_pipe = false;
 
   if (fs_end_with_internal(path, ".gz")) {
+#ifdef __linux__
+    if (fs_inprocess_gzip() && fs_is_identity_converter_internal(converter)) {
+      // a missing file goes through zcat below to keep its error handling
+      FILE* fp = fopen(path.c_str(), "r");
+      if (fp != nullptr) {
+        return fs_open_gzip_internal(
+            {fp, [](FILE* fp) { fclose(fp); }}, localfs_buffer_size(), err_no);
+      }
+    }
+#endif
     fs_add_read_converter_internal(path, is_pipe, "zcat");
+  } else if (fs_end_with_internal(path, ".zst") && fs_decode_zst() &&
+             fs_is_identity_converter_internal(converter)) {
+    // a caller passing its own converter decodes the data itself
+    fs_add_read_converter_internal(path, is_pipe, "zstd -dc");
   }
 
   fs_add_read_converter_internal(path, is_pipe, converter);
-  return fs_open_internal(path, is_pipe, "r", localfs_buffer_size());
+  return fs_open_internal(path, is_pipe, "r", localfs_buffer_size(), err_no);
+}
+
+std::shared_ptr<FILE> localfs_open_read(std::string path,
+                                        const std::string& converter) {
+  return localfs_open_read_internal(std::move(path), converter, nullptr);
 }
 
 std::shared_ptr<FILE> localfs_open_write(std::string path,
@@ -274,10 +506,25 @@ std::shared_ptr<FILE> hdfs_open_read(std::string path,
                                      int* err_no,
                                      const std::string& converter,
                                      bool read_data) {
+  // decoded like local .zst files, hadoop -text does not know zstd
+  bool is_zst = fs_end_with_internal(path, ".zst") && fs_decode_zst() &&
+                fs_is_identity_converter_internal(converter);
   if (!download_cmd().empty()) {  // use customized download command
     path = string::format_string(
         "%s \"%s\"", download_cmd().c_str(), path.c_str());
   } else {
+#ifdef __linux__
+    if (fs_end_with_internal(path, ".gz") && fs_inprocess_gzip() &&
+        fs_is_identity_converter_internal(converter)) {
+      // decode here instead of by hadoop -text
+      path = string::format_string(
+          "%s -cat \"%s\"",
+          (read_data ? dataset_hdfs_command() : hdfs_command()).c_str(),
+          path.c_str());
+      return fs_open_gzip_internal(
+          shell_popen(path, "r", err_no), hdfs_buffer_size(), err_no);
+    }
+#endif
     if (fs_end_with_internal(path, ".gz")) {
       if (read_data) {
         path = string::format_string(
@@ -298,6 +545,9 @@ std::shared_ptr<FILE> hdfs_open_read(std::string path,
   }
 
   bool is_pipe = true;
+  if (is_zst) {
+    fs_add_read_converter_internal(path, is_pipe, "zstd -dc");
+  }
   fs_add_read_converter_internal(path, is_pipe, converter);
   return fs_open_internal(path, is_pipe, "r", hdfs_buffer_size(), err_no);
 }
@@ -414,7 +664,7 @@ std::shared_ptr<FILE> fs_open_read(const std::string& path,
                                    bool read_data) {
   switch (fs_select_internal(path)) {
     case 0:
-      return localfs_open_read(path, converter);
+      return localfs_open_read_internal(path, converter, err_no);
 
     case 1:
       return hdfs_open_read(path, err_no, converter, read_data);
@@ -30,6 +30,18 @@ namespace framework {
 
 int fs_select_internal(const std::string& path);
 
+// decode the .gz inputs of fs_open_read in process instead of by zcat or
+// hadoop -text, when there is no other converter. on by default.
+extern bool fs_inprocess_gzip();
+
+extern void fs_set_inprocess_gzip(bool x);
+
+// decode the .zst inputs of fs_open_read by zstd -dc, when there is no other
+// converter. off by default, so that .zst files are read as they are.
+extern bool fs_decode_zst();
+
+extern void fs_set_decode_zst(bool x);
+
 // localfs
 extern size_t localfs_buffer_size();
 
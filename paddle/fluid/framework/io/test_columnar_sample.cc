@@ -0,0 +1,112 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/io/columnar_sample.h"
+
+namespace paddle {
+namespace framework {
+
+struct TextInstance {
+  std::string ins_id;
+  std::vector<uint64_t> click;
+  std::vector<uint64_t> feasigns;
+  std::vector<float> dense;
+};
+
+TEST(ColumnarSample, convert_and_read) {
+  std::mt19937_64 rng(0);
+  std::vector<TextInstance> instances(20000);
+  std::ofstream text("columnar_sample_test.txt");
+  for (size_t i = 0; i < instances.size(); ++i) {
+    auto& ins = instances[i];
+    ins.ins_id = "ins_" + std::to_string(i);
+    ins.click.push_back(rng() % 2);
+    ins.feasigns.resize(1 + rng() % 10);
+    for (auto& feasign : ins.feasigns) {
+      feasign = rng();
+    }
+    ins.dense = {0.5f, 0.0f, -1.25f};
+    text << "1 " << ins.ins_id << " 1 " << ins.click[0] << " "
+         << ins.feasigns.size();
+    for (auto feasign : ins.feasigns) {
+      text << " " << feasign;
+    }
+    text << " 3 0.5 0 -1.25\n";
+  }
+  text.close();
+
+  std::vector<ColumnarSlot> slots = {
+      {"click", 'u'}, {"feasigns", 'u'}, {"dense", 'f'}};
+  for (auto codec : {kColumnarNone, kColumnarZlib}) {
+    std::string path =
+        "columnar_sample_test_" + std::to_string(codec) + kColumnarSampleSuffix;
+    ASSERT_TRUE(IsColumnarSampleFile(path));
+    ASSERT_EQ(ConvertTextToColumnarSample("columnar_sample_test.txt",
+                                          "",
+                                          slots,
+                                          kColumnarInsId,
+                                          path,
+                                          codec),
+              instances.size());
+
+    ColumnarSampleReader reader;
+    reader.Open(path);
+    ASSERT_EQ(reader.Slots().size(), slots.size());
+    EXPECT_EQ(reader.Slots()[1].name, "feasigns");
+    EXPECT_EQ(reader.Slots()[2].type, 'f');
+    EXPECT_EQ(reader.StringColumns(), kColumnarInsId);
+
+    ColumnarSampleBlock block;
+    size_t ins_idx = 0;
+    while (reader.Next(&block)) {
+      for (uint32_t i = 0; i < block.InsNum(); ++i, ++ins_idx) {
+        auto& ins = instances[ins_idx];
+        EXPECT_EQ(block.String(kColumnarInsId, i), ins.ins_id);
+        EXPECT_EQ(block.String(kColumnarContent, i), "");
+        const uint32_t* offsets = block.SlotOffsets(1);
+        std::vector<uint64_t> feasigns(block.Uint64Values(1) + offsets[i],
+                                       block.Uint64Values(1) + offsets[i + 1]);
+        EXPECT_EQ(feasigns, ins.feasigns);
+        EXPECT_EQ(block.Uint64Values(0)[block.SlotOffsets(0)[i]], ins.click[0]);
+        offsets = block.SlotOffsets(2);
+        std::vector<float> dense(block.FloatValues(2) + offsets[i],
+                                 block.FloatValues(2) + offsets[i + 1]);
+        EXPECT_EQ(dense, ins.dense);
+      }
+    }
+    EXPECT_EQ(ins_idx, instances.size());
+  }
+}
+
+TEST(ColumnarSample, convert_bad_line) {
+  std::ofstream text("columnar_sample_bad.txt");
+  text << "1 7 2 3 4\n0 2 5 6\n";
+  text.close();
+  std::vector<ColumnarSlot> slots = {{"click", 'u'}, {"feasigns", 'u'}};
+  std::string path = std::string("columnar_sample_bad") + kColumnarSampleSuffix;
+  // the error of the second line is thrown, not turned into a terminate by
+  // the writer being destroyed
+  EXPECT_ANY_THROW(ConvertTextToColumnarSample(
+      "columnar_sample_bad.txt", "", slots, 0, path, kColumnarNone));
+}
+
+}  // namespace framework
+}  // namespace paddle
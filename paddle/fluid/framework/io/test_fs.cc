@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <zlib.h>
 
 #include <fstream>
+#include <string>
 
 #include "paddle/fluid/framework/io/fs.h"
 
@@ -60,3 +62,81 @@ TEST(FS, mv) {
 
 #endif
 }
+
+TEST(FS, gzip_read) {
+#ifdef _LINUX
+  std::string content;
+  for (int i = 0; i < 300000; ++i) {
+    content += "1 " + std::to_string(i) + " 3 0.5 0 -1.25\n";
+  }
+  // two gzip members, as written by appending to a .gz file
+  size_t half = content.size() / 2;
+  gzFile gz = gzopen("test_fs_read.gz", "wb");
+  gzwrite(gz, content.data(), half);
+  gzclose(gz);
+  gz = gzopen("test_fs_read.gz", "ab");
+  gzwrite(gz, content.data() + half, content.size() - half);
+  gzclose(gz);
+
+  for (bool inprocess : {true, false}) {
+    paddle::framework::fs_set_inprocess_gzip(inprocess);
+    for (std::string converter : {"", "cat"}) {
+      int err_no = 0;
+      std::string read;
+      {
+        auto fp = paddle::framework::fs_open_read(
+            "test_fs_read.gz", &err_no, converter, true);
+        char buf[4096];
+        size_t n = 0;
+        while ((n = fread(buf, 1, sizeof(buf), fp.get())) > 0) {
+          read.append(buf, n);
+        }
+      }
+      EXPECT_EQ(err_no, 0);
+      EXPECT_TRUE(read == content) << "inprocess " << inprocess;
+    }
+  }
+  paddle::framework::fs_set_inprocess_gzip(true);
+
+  // a truncated file is reported by err_no like a failed zcat
+  std::ifstream in("test_fs_read.gz", std::ios::binary);
+  std::string compressed((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+  std::ofstream out("test_fs_truncated.gz", std::ios::binary);
+  out.write(compressed.data(), compressed.size() / 3);
+  out.close();
+  int err_no = 0;
+  {
+    auto fp = paddle::framework::fs_open_read(
+        "test_fs_truncated.gz", &err_no, "", true);
+    char buf[4096];
+    while (fread(buf, 1, sizeof(buf), fp.get()) > 0) {
+    }
+  }
+  EXPECT_EQ(err_no, -1);
+#endif
+}
+
+TEST(FS, zst_read) {
+#ifdef _LINUX
+  std::string content = "1 2 3 0.5 0 -1.25\n";
+  std::ofstream out("test_fs_read.zst", std::ios::binary);
+  out << content;
+  out.close();
+  // .zst files are read as they are unless decoding is asked for
+  int err_no = 0;
+  std::string read;
+  {
+    auto fp = paddle::framework::fs_open_read(
+        "test_fs_read.zst", &err_no, "", true);
+    char buf[4096];
+    size_t n = 0;
+    while ((n = fread(buf, 1, sizeof(buf), fp.get())) > 0) {
+      read.append(buf, n);
+    }
+  }
+  EXPECT_EQ(err_no, 0);
+  EXPECT_EQ(read, content);
+  EXPECT_FALSE(paddle::framework::fs_decode_zst());
+#endif
+}
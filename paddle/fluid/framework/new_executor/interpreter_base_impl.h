@@ -42,6 +42,8 @@ DECLARE_bool(new_executor_serial_run);
 DECLARE_bool(new_executor_static_build);
 DECLARE_bool(new_executor_use_inplace);
 DECLARE_bool(new_executor_use_local_scope);
+DECLARE_bool(new_executor_cache_phi_kernel_context);
+DECLARE_bool(new_executor_reuse_static_shape);
 
 PHI_DECLARE_bool(check_nan_inf);
 DECLARE_bool(benchmark);
@@ -30,6 +30,17 @@ PADDLE_DEFINE_EXPORTED_bool(
 PADDLE_DEFINE_EXPORTED_bool(new_executor_use_inplace,
                             false,
                             "Use inplace in new executor");
+PADDLE_DEFINE_EXPORTED_bool(
+    new_executor_cache_phi_kernel_context,
+    false,
+    "Cache the phi::KernelContext of each instruction and reuse it across "
+    "steps instead of rebuilding it every time, the cached context is rebuilt "
+    "only when the variables bound into it change.");
+PADDLE_DEFINE_EXPORTED_bool(
+    new_executor_reuse_static_shape,
+    false,
+    "Skip InferShape when the shapes of feeds are the same as the previous "
+    "step, and replay the output shapes recorded by InferShape instead.");
 PADDLE_DEFINE_EXPORTED_bool(new_executor_use_local_scope,
                             true,
                             "Use local_scope in new executor(especially used "
@@ -19,11 +19,38 @@
 #include <unordered_map>
 #include <vector>
 
+#include "paddle/fluid/framework/var_type.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 
 namespace paddle {
 namespace framework {
 
+// Return the address of the tensor held by var, which is the one bound into
+// phi::KernelContext by OperatorWithKernel::BuildPhiKernelContext.
+static const void* GetBoundPhiTensor(const Variable* var) {
+  if (var == nullptr || !var->IsInitialized()) {
+    return nullptr;
+  }
+  if (var->IsType<phi::DenseTensor>()) {
+    return &(var->Get<phi::DenseTensor>());
+  } else if (var->IsType<phi::SelectedRows>()) {
+    return &(var->Get<phi::SelectedRows>());
+  } else if (var->IsType<phi::SparseCooTensor>()) {
+    return &(var->Get<phi::SparseCooTensor>());
+  } else if (var->IsType<LoDTensorArray>()) {
+    return &(var->Get<LoDTensorArray>());
+  } else if (var->IsType<Vocab>()) {
+    return &(var->Get<Vocab>());
+  } else if (var->IsType<FeedList>()) {
+    return &(var->Get<FeedList>());
+  } else if (var->IsType<Strings>()) {
+    return &(var->Get<Strings>());
+  } else if (var->IsType<RawTensor>()) {
+    return &(var->Get<RawTensor>());
+  }
+  return nullptr;
+}
+
 VariableScope::VariableScope(Scope* scope) {
   // for @EMPTY@ variable
   name2id_[kEmptyVarName] = kEmptyVarIndex;
@@ -238,6 +265,9 @@ const std::vector<size_t>& Instruction::GCCheckVars() const {
 
 void Instruction::ResetContext(const VariableValueMap& in_vars,
                                const VariableValueMap& out_vars) {
+  phi_kernel_ctx_.reset();
+  phi_kernel_ctx_bindings_.clear();
+  ClearInferShapeRecord();
   runtime_ctx_.reset(new RuntimeContext(in_vars, out_vars));
   infershape_ctx_.reset(
       new RuntimeInferShapeContext(*OpBase(), *runtime_ctx_.get()));
@@ -251,6 +281,9 @@ void Instruction::ResetContext(const VariableValueMap& in_vars,
 void Instruction::ResetContextWithScope(const VariableValueMap& in_vars,
                                         const VariableValueMap& out_vars,
                                         const framework::Scope& scope) {
+  phi_kernel_ctx_.reset();
+  phi_kernel_ctx_bindings_.clear();
+  ClearInferShapeRecord();
   runtime_ctx_.reset(new RuntimeContext(in_vars, out_vars));
   infershape_ctx_.reset(
       new RuntimeInferShapeContext(*OpBase(), *runtime_ctx_.get()));
@@ -271,6 +304,143 @@ std::shared_ptr<ExecutionContext> Instruction::InnerExecutionContext() const {
   return execution_ctx_;
 }
 
+std::shared_ptr<phi::KernelContext> Instruction::InnerPhiKernelContext()
+    const {
+  if (phi_kernel_ctx_ == nullptr) {
+    return nullptr;
+  }
+  for (auto& binding : phi_kernel_ctx_bindings_) {
+    if (GetBoundPhiTensor(binding.first) != binding.second) {
+      VLOG(4) << "Variables of " << OpBase()->Type()
+              << " are rebound, drop the cached phi::KernelContext";
+      phi_kernel_ctx_.reset();
+      phi_kernel_ctx_bindings_.clear();
+      return nullptr;
+    }
+  }
+  return phi_kernel_ctx_;
+}
+
+void Instruction::CachePhiKernelContext(
+    std::shared_ptr<phi::KernelContext> phi_kernel_ctx) const {
+  phi_kernel_ctx_bindings_.clear();
+  for (auto* var_map : {&runtime_ctx_->inputs, &runtime_ctx_->outputs}) {
+    for (auto& pair : *var_map) {
+      for (auto* var : pair.second) {
+        if (var != nullptr) {
+          phi_kernel_ctx_bindings_.emplace_back(var, GetBoundPhiTensor(var));
+        }
+      }
+    }
+  }
+  phi_kernel_ctx_ = std::move(phi_kernel_ctx);
+}
+
+// Record the meta of the DenseTensors in vars, return false if some of them
+// are not DenseTensor.
+static bool RecordTensorMeta(
+    const VariableValueMap& vars,
+    std::vector<std::tuple<phi::DDim, phi::DataType, phi::DataLayout, LoD>>*
+        record) {
+  record->clear();
+  for (auto& pair : vars) {
+    for (auto* var : pair.second) {
+      if (var == nullptr) {
+        continue;
+      }
+      if (!var->IsType<phi::DenseTensor>()) {
+        record->clear();
+        return false;
+      }
+      const auto& tensor = var->Get<phi::DenseTensor>();
+      record->emplace_back(
+          tensor.dims(), tensor.dtype(), tensor.layout(), tensor.lod());
+    }
+  }
+  return true;
+}
+
+bool Instruction::RecordInferShapeInputs() const {
+  ClearInferShapeRecord();
+  return RecordTensorMeta(runtime_ctx_->inputs, &infer_shape_input_record_);
+}
+
+bool Instruction::RecordInferShape() const {
+  has_infer_shape_record_ =
+      RecordTensorMeta(runtime_ctx_->outputs, &infer_shape_record_);
+  return has_infer_shape_record_;
+}
+
+bool Instruction::MatchInferShapeInputs() const {
+  size_t idx = 0;
+  for (auto& pair : runtime_ctx_->inputs) {
+    for (auto* var : pair.second) {
+      if (var == nullptr) {
+        continue;
+      }
+      if (idx >= infer_shape_input_record_.size() ||
+          !var->IsType<phi::DenseTensor>()) {
+        return false;
+      }
+      const auto& tensor = var->Get<phi::DenseTensor>();
+      const auto& record = infer_shape_input_record_[idx++];
+      if (tensor.dims() != std::get<0>(record) ||
+          tensor.dtype() != std::get<1>(record) ||
+          tensor.layout() != std::get<2>(record) ||
+          tensor.lod() != std::get<3>(record)) {
+        return false;
+      }
+    }
+  }
+  return idx == infer_shape_input_record_.size();
+}
+
+void Instruction::ReplayInferShape() const {
+  size_t idx = 0;
+  for (auto& pair : runtime_ctx_->outputs) {
+    for (auto* var : pair.second) {
+      if (var == nullptr) {
+        continue;
+      }
+      auto& record = infer_shape_record_[idx++];
+      auto* tensor = var->GetMutable<phi::DenseTensor>();
+      tensor->Resize(std::get<0>(record));
+      if (tensor->dtype() != std::get<1>(record)) {
+        tensor->set_type(std::get<1>(record));
+      }
+      if (tensor->layout() != std::get<2>(record)) {
+        tensor->set_layout(std::get<2>(record));
+      }
+      if (tensor->lod() != std::get<3>(record)) {
+        tensor->set_lod(std::get<3>(record));
+      }
+    }
+  }
+}
+
+bool Instruction::CheckInferShapeRecord() const {
+  size_t idx = 0;
+  for (auto& pair : runtime_ctx_->outputs) {
+    for (auto* var : pair.second) {
+      if (var == nullptr) {
+        continue;
+      }
+      if (!var->IsType<phi::DenseTensor>() ||
+          var->Get<phi::DenseTensor>().dims() !=
+              std::get<0>(infer_shape_record_[idx++])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void Instruction::ClearInferShapeRecord() const {
+  infer_shape_input_record_.clear();
+  infer_shape_record_.clear();
+  has_infer_shape_record_ = false;
+}
+
 const platform::DeviceContext& Instruction::DeviceContext() const {
   return dev_ctx_;
 }
@@ -15,6 +15,7 @@
 
 #include <map>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -263,6 +264,36 @@ class Instruction {
 
   std::shared_ptr<ExecutionContext> InnerExecutionContext() const;
 
+  // Return the cached phi::KernelContext if all the variables bound into it
+  // still hold the same tensors as when it was cached, otherwise drop the
+  // cache and return nullptr.
+  std::shared_ptr<phi::KernelContext> InnerPhiKernelContext() const;
+
+  void CachePhiKernelContext(
+      std::shared_ptr<phi::KernelContext> phi_kernel_ctx) const;
+
+  // Record the meta of inputs before InferShape, return false if the inputs
+  // can not be recorded (e.g. not all of them are DenseTensor).
+  bool RecordInferShapeInputs() const;
+
+  // Record the meta of outputs set by InferShape, return false if the outputs
+  // can not be recorded (e.g. not all of them are DenseTensor).
+  bool RecordInferShape() const;
+
+  // Whether the meta of inputs is the same as the recorded one, so that the
+  // recorded outputs can be replayed.
+  bool MatchInferShapeInputs() const;
+
+  // Set the recorded meta to outputs instead of running InferShape.
+  void ReplayInferShape() const;
+
+  // Whether the meta of outputs is still the same as the recorded one.
+  bool CheckInferShapeRecord() const;
+
+  bool HasInferShapeRecord() const { return has_infer_shape_record_; }
+
+  void ClearInferShapeRecord() const;
+
   const platform::DeviceContext& DeviceContext() const;
 
   const std::vector<std::pair<Variable*, Variable*>>& InplaceInfo() const;
@@ -298,6 +329,25 @@ class Instruction {
   std::shared_ptr<RuntimeInferShapeContext> infershape_ctx_;
   std::shared_ptr<ExecutionContext> execution_ctx_;
 
+  // NOTE: The phi::KernelContext is built lazily when running and reused by
+  // the following steps, see FLAGS_new_executor_cache_phi_kernel_context.
+  // phi_kernel_ctx_bindings_ records the tensor each variable held when the
+  // context was cached, which is used to detect rebinding.
+  mutable std::shared_ptr<phi::KernelContext> phi_kernel_ctx_;
+  mutable std::vector<std::pair<const Variable*, const void*>>
+      phi_kernel_ctx_bindings_;
+
+  // NOTE: The meta of outputs recorded after InferShape, which is replayed
+  // when the shapes of feeds and the meta of inputs are unchanged, see
+  // FLAGS_new_executor_reuse_static_shape.
+  mutable std::vector<
+      std::tuple<phi::DDim, phi::DataType, phi::DataLayout, LoD>>
+      infer_shape_input_record_;
+  mutable std::vector<
+      std::tuple<phi::DDim, phi::DataType, phi::DataLayout, LoD>>
+      infer_shape_record_;
+  mutable bool has_infer_shape_record_{false};
+
   std::vector<size_t> gc_check_vars_;
 
   std::vector<std::pair<Variable*, Variable*>> vec_inplace_in_to_out_;
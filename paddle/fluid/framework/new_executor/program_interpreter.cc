@@ -135,6 +135,16 @@ FetchList ProgramInterpreter::Run(
   Prepare(feed_names, feed_tensors, is_build);
 
   if (is_build) {
+    if (FLAGS_new_executor_reuse_static_shape) {
+      std::vector<const phi::DenseTensor*> feeds;
+      feeds.reserve(feed_tensors.size());
+      for (auto& feed_tensor : feed_tensors) {
+        feeds.push_back(&feed_tensor);
+      }
+      UpdateFeedShapeSignature(feeds);
+    } else {
+      reuse_static_shape_ = false;
+    }
     RunImpl();
   }
 
@@ -195,6 +205,11 @@ FetchList ProgramInterpreter::Run(const std::vector<std::string>& feed_names,
     is_build_ = true;
     is_shared_results_build_ = true;
   } else {
+    if (FLAGS_new_executor_reuse_static_shape) {
+      UpdateFeedShapeSignature(GetFeedTensorsOfFeedOps());
+    } else {
+      reuse_static_shape_ = false;
+    }
     RunImpl();
   }
 
@@ -849,8 +864,27 @@ void ProgramInterpreter::RunOperator(const Instruction& instr_node) {
       // see OperatorWithKernel::RunImpl in operator.cc for why
       if (!(op_with_kernel->HasAttr(kAllKernelsMustComputeRuntimeShape) &&
             op_with_kernel->Attr<bool>(kAllKernelsMustComputeRuntimeShape))) {
-        op_with_kernel->Info().infer_shape_(
-            instr_node.InnerInferShapeContext().get());
+        // NOTE: Inputs from the scope (e.g. persistable vars or the vars of
+        // while) may change their shapes while the feeds do not, so the
+        // record is only replayed if the meta of inputs is unchanged.
+        if (reuse_static_shape_ && !static_shape_unsafe_ &&
+            instr_node.HasInferShapeRecord() &&
+            instr_node.MatchInferShapeInputs()) {
+          instr_node.ReplayInferShape();
+        } else {
+          // NOTE: Only phi kernels whose KernelContext does not depend on the
+          // data of inputs are recorded, since the output shapes of others
+          // may change even if the shapes of inputs are the same.
+          phi::Kernel* kernel = instr_node.PhiKernel();
+          bool record = reuse_static_shape_ && kernel && kernel->IsValid() &&
+                        !op_with_kernel->NeedPreparePhiData() &&
+                        instr_node.RecordInferShapeInputs();
+          op_with_kernel->Info().infer_shape_(
+              instr_node.InnerInferShapeContext().get());
+          if (record) {
+            instr_node.RecordInferShape();
+          }
+        }
       }
       infershape_event.End();
       platform::RecordOpInfoSupplement(op->Type(),
@@ -888,13 +922,39 @@ void ProgramInterpreter::RunOperator(const Instruction& instr_node) {
           VLOG(4) << "Run function kernel: " << op->Type();
           VLOG(4) << instr_node.InnerRuntimeContext().get() << " "
                   << &instr_node.DeviceContext();
-          phi::KernelContext phi_kernel_context;
-          op_with_kernel->BuildPhiKernelContext(
-              *instr_node.InnerRuntimeContext().get(),
-              const_cast<platform::DeviceContext*>(&instr_node.DeviceContext()),
-              &phi_kernel_context);
-
-          (*kernel)(&phi_kernel_context);
+          if (FLAGS_new_executor_cache_phi_kernel_context) {
+            std::shared_ptr<phi::KernelContext> phi_kernel_context =
+                instr_node.InnerPhiKernelContext();
+            if (phi_kernel_context == nullptr) {
+              auto* dev_ctx = const_cast<platform::DeviceContext*>(
+                  &instr_node.DeviceContext());
+              phi_kernel_context = std::make_shared<phi::KernelContext>();
+              op_with_kernel->BuildPhiKernelContext(
+                  *instr_node.InnerRuntimeContext().get(),
+                  dev_ctx,
+                  phi_kernel_context.get());
+              // NOTE: The context can not be reused if it depends on the data
+              // of inputs, or if it sets per-op state on a shared onednn
+              // context.
+              bool can_cache = !op_with_kernel->NeedPreparePhiData();
+#ifdef PADDLE_WITH_MKLDNN
+              can_cache = can_cache && !phi::OneDNNContext::classof(dev_ctx);
+#endif
+              if (can_cache) {
+                instr_node.CachePhiKernelContext(phi_kernel_context);
+              }
+            }
+            (*kernel)(phi_kernel_context.get());
+          } else {
+            phi::KernelContext phi_kernel_context;
+            op_with_kernel->BuildPhiKernelContext(
+                *instr_node.InnerRuntimeContext().get(),
+                const_cast<platform::DeviceContext*>(
+                    &instr_node.DeviceContext()),
+                &phi_kernel_context);
+
+            (*kernel)(&phi_kernel_context);
+          }
         } else {
           VLOG(4) << "Run structure kernel: " << op->Type();
           (*kernel)(instr_node.InnerExecutionContext().get());
@@ -905,6 +965,13 @@ void ProgramInterpreter::RunOperator(const Instruction& instr_node) {
     }
   }
 
+  if (reuse_static_shape_ && instr_node.HasInferShapeRecord() &&
+      !instr_node.CheckInferShapeRecord()) {
+    VLOG(4) << "Output shapes of " << op->Type()
+            << " are changed by its kernel, disable reusing static shape";
+    static_shape_unsafe_ = true;
+  }
+
   VLOG(4) << "End run " << place << " " << op->DebugStringEx(local_scope);
 
   if (!instr_node.InplaceBackMap().empty()) {
@@ -1430,6 +1497,76 @@ void ProgramInterpreter::TraceInstructionList(
   }
 }
 
+void ProgramInterpreter::UpdateFeedShapeSignature(
+    const std::vector<const phi::DenseTensor*>& feed_tensors) {
+  // Without feeds the inputs of the program come from the scope, e.g. the
+  // sub-blocks of while and conditional_block, or from a reader, and an empty
+  // signature would match every step whatever their shapes are.
+  if (static_shape_unsafe_ || feed_tensors.empty()) {
+    if (reuse_static_shape_) {
+      for (auto& instr : vec_instruction_) {
+        instr.ClearInferShapeRecord();
+      }
+      reuse_static_shape_ = false;
+    }
+    return;
+  }
+
+  bool is_same = feed_shape_signature_.size() == feed_tensors.size();
+  for (size_t i = 0; is_same && i < feed_tensors.size(); ++i) {
+    const phi::DenseTensor* tensor = feed_tensors[i];
+    const auto& signature = feed_shape_signature_[i];
+    is_same = tensor != nullptr && std::get<0>(signature) == tensor->dims() &&
+              std::get<1>(signature) == tensor->dtype() &&
+              std::get<2>(signature) == tensor->lod();
+  }
+  if (is_same && reuse_static_shape_) {
+    return;
+  }
+
+  VLOG(4) << "Shapes of feeds are changed, record shapes by InferShape";
+  feed_shape_signature_.clear();
+  for (auto* tensor : feed_tensors) {
+    if (tensor == nullptr) {
+      // Non-DenseTensor feed, the signature is never matched
+      feed_shape_signature_.clear();
+      break;
+    }
+    feed_shape_signature_.emplace_back(
+        tensor->dims(), tensor->dtype(), tensor->lod());
+  }
+  for (auto& instr : vec_instruction_) {
+    instr.ClearInferShapeRecord();
+  }
+  reuse_static_shape_ = feed_shape_signature_.size() == feed_tensors.size();
+}
+
+std::vector<const phi::DenseTensor*>
+ProgramInterpreter::GetFeedTensorsOfFeedOps() const {
+  std::vector<const phi::DenseTensor*> feed_tensors;
+  std::unordered_set<const Variable*> visited;
+  for (auto& instr : vec_instruction_) {
+    if (instr.OpBase()->Type() != kFeedOpType) {
+      continue;
+    }
+    for (auto* var : instr.InnerRuntimeContext()->inputs.at("X")) {
+      if (var == nullptr || !var->IsType<FeedList>() ||
+          !visited.insert(var).second) {
+        continue;
+      }
+      for (auto& feed_item : var->Get<FeedList>()) {
+        if (feed_item.type() == typeid(phi::DenseTensor)) {
+          feed_tensors.push_back(
+              &PADDLE_GET_CONST(phi::DenseTensor, feed_item));
+        } else {
+          feed_tensors.push_back(nullptr);
+        }
+      }
+    }
+  }
+  return feed_tensors;
+}
+
 void ProgramInterpreter::RecordMemcpyD2H(const Instruction& instr_node) {
   // NOTE(zhiqiu): hot fix for jit input var
   if (instr_node.OpBase()->Type() == interpreter::kMemcpyD2H) {
@@ -122,6 +122,11 @@ class ProgramInterpreter : public InterpreterBaseImpl {
 
   void RecordMemcpyD2H(const Instruction& instr_node);
 
+  // static shape
+  void UpdateFeedShapeSignature(
+      const std::vector<const phi::DenseTensor*>& feed_tensors);
+  std::vector<const phi::DenseTensor*> GetFeedTensorsOfFeedOps() const;
+
   // gc
   void RecordStreamForGC(const Instruction& instr);
   void CheckGC(const Instruction& instr);
@@ -194,6 +199,16 @@ class ProgramInterpreter : public InterpreterBaseImpl {
   InstructionSchedulingPriorityLess instruction_scheduling_priority_less;
 
   std::vector<HookFunc> hookfuncs_;
+
+  // Shape signature of the feeds of the last step. If it is unchanged, the
+  // output meta recorded by InferShape is replayed instead of running
+  // InferShape again, for the ops whose inputs keep their meta.
+  // static_shape_unsafe_ is set once a kernel changes the shape inferred for
+  // its outputs, which means the shapes of the program depend on data and can
+  // not be replayed. A program without feeds is never replayed.
+  std::vector<std::tuple<phi::DDim, phi::DataType, LoD>> feed_shape_signature_;
+  bool reuse_static_shape_{false};
+  std::atomic<bool> static_shape_unsafe_{false};
 };
 
 }  // namespace framework
@@ -837,6 +837,11 @@ class OperatorWithKernel : public OperatorBase {
 
   phi::Kernel* PhiKernel() const { return phi_kernel_.get(); }
 
+  // Whether the phi::KernelContext of this op depends on the data of its
+  // inputs (e.g. Scalar/IntArray attributes given by tensors), which means
+  // the context must be rebuilt before every run.
+  bool NeedPreparePhiData() const { return need_prepare_phi_data_; }
+
   void ResetPhiKernel(phi::Kernel* kernel) const {
     return phi_kernel_.reset(kernel);
   }
@@ -0,0 +1,278 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <utility>
+
+namespace paddle {
+namespace framework {
+
+// Unbounded lock-free MPMC queue made of linked blocks of slots, the same
+// algorithm as crossbeam's SegQueue. Push and TryPop never block each other:
+// a thread claims a slot by a CAS on the tail / head index, and the slot
+// state tells the reader when the value is written. A block is freed by the
+// last thread that leaves it.
+//
+// The index is (position << kShift) | flags, the position kBlockCap of each
+// lap of kLap positions is never a slot, it marks that the next block is
+// being installed.
+template <class T>
+class SegmentedQueue {
+ public:
+  SegmentedQueue() {}
+  SegmentedQueue(const SegmentedQueue&) = delete;
+  SegmentedQueue& operator=(const SegmentedQueue&) = delete;
+
+  ~SegmentedQueue() {
+    size_t head = head_.index.load(std::memory_order_relaxed) & ~kHasNext;
+    size_t tail = tail_.index.load(std::memory_order_relaxed) & ~kHasNext;
+    Block* block = head_.block.load(std::memory_order_relaxed);
+    for (; head != tail; head += 1 << kShift) {
+      size_t offset = (head >> kShift) % kLap;
+      if (offset < kBlockCap) {
+        block->slots[offset].Get()->~T();
+      } else {
+        Block* next = block->next.load(std::memory_order_relaxed);
+        delete block;
+        block = next;
+      }
+    }
+    delete block;
+  }
+
+  void Push(T&& value) {
+    Backoff backoff;
+    size_t tail = tail_.index.load(std::memory_order_acquire);
+    Block* block = tail_.block.load(std::memory_order_acquire);
+    std::unique_ptr<Block> next_block;
+    for (;;) {
+      size_t offset = (tail >> kShift) % kLap;
+      // another thread is installing the next block
+      if (offset == kBlockCap) {
+        backoff.Snooze();
+        tail = tail_.index.load(std::memory_order_acquire);
+        block = tail_.block.load(std::memory_order_acquire);
+        continue;
+      }
+      // allocate the next block before taking the last slot, so the
+      // window in which the others wait for it is short
+      if (offset + 1 == kBlockCap && next_block == nullptr) {
+        next_block.reset(new Block());
+      }
+      // the first push installs the first block
+      if (block == nullptr) {
+        Block* first = new Block();
+        if (tail_.block.compare_exchange_strong(
+                block, first, std::memory_order_release)) {
+          head_.block.store(first, std::memory_order_release);
+          block = first;
+        } else {
+          next_block.reset(first);
+          tail = tail_.index.load(std::memory_order_acquire);
+          block = tail_.block.load(std::memory_order_acquire);
+          continue;
+        }
+      }
+      size_t new_tail = tail + (1 << kShift);
+      if (tail_.index.compare_exchange_weak(tail,
+                                            new_tail,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_acquire)) {
+        if (offset + 1 == kBlockCap) {
+          Block* next = next_block.release();
+          tail_.block.store(next, std::memory_order_release);
+          tail_.index.store(new_tail + (1 << kShift),
+                            std::memory_order_release);
+          block->next.store(next, std::memory_order_release);
+        }
+        Slot& slot = block->slots[offset];
+        new (slot.Get()) T(std::move(value));
+        slot.state.fetch_or(kWrite, std::memory_order_release);
+        return;
+      }
+      block = tail_.block.load(std::memory_order_acquire);
+      backoff.Spin();
+    }
+  }
+
+  // returns false if the queue is empty
+  bool TryPop(T* value) {
+    Backoff backoff;
+    size_t head = head_.index.load(std::memory_order_acquire);
+    Block* block = head_.block.load(std::memory_order_acquire);
+    for (;;) {
+      size_t offset = (head >> kShift) % kLap;
+      // another thread is moving the head to the next block
+      if (offset == kBlockCap) {
+        backoff.Snooze();
+        head = head_.index.load(std::memory_order_acquire);
+        block = head_.block.load(std::memory_order_acquire);
+        continue;
+      }
+      size_t new_head = head + (1 << kShift);
+      if ((new_head & kHasNext) == 0) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_t tail = tail_.index.load(std::memory_order_relaxed);
+        if (head >> kShift == tail >> kShift) {
+          return false;
+        }
+        // head and tail are in different blocks, so the next block exists
+        if ((head >> kShift) / kLap != (tail >> kShift) / kLap) {
+          new_head |= kHasNext;
+        }
+      }
+      // the first push is still installing the first block
+      if (block == nullptr) {
+        backoff.Snooze();
+        head = head_.index.load(std::memory_order_acquire);
+        block = head_.block.load(std::memory_order_acquire);
+        continue;
+      }
+      if (head_.index.compare_exchange_weak(head,
+                                            new_head,
+                                            std::memory_order_seq_cst,
+                                            std::memory_order_acquire)) {
+        if (offset + 1 == kBlockCap) {
+          Block* next = block->WaitNext();
+          size_t next_index = (new_head & ~kHasNext) + (1 << kShift);
+          if (next->next.load(std::memory_order_relaxed) != nullptr) {
+            next_index |= kHasNext;
+          }
+          head_.block.store(next, std::memory_order_release);
+          head_.index.store(next_index, std::memory_order_release);
+        }
+        Slot& slot = block->slots[offset];
+        slot.WaitWrite();
+        *value = std::move(*slot.Get());
+        slot.Get()->~T();
+        // the reader of the last slot frees the block, or continues the
+        // free of a thread that found this slot still being read
+        if (offset + 1 == kBlockCap) {
+          Block::Destroy(block, 0);
+        } else if (slot.state.fetch_or(kRead, std::memory_order_acq_rel) &
+                   kDestroy) {
+          Block::Destroy(block, offset + 1);
+        }
+        return true;
+      }
+      block = head_.block.load(std::memory_order_acquire);
+      backoff.Spin();
+    }
+  }
+
+  bool Empty() const {
+    size_t head = head_.index.load(std::memory_order_seq_cst);
+    size_t tail = tail_.index.load(std::memory_order_seq_cst);
+    return head >> kShift == tail >> kShift;
+  }
+
+ private:
+  static constexpr size_t kShift = 1;
+  static constexpr size_t kHasNext = 1;
+  static constexpr size_t kLap = 64;
+  static constexpr size_t kBlockCap = kLap - 1;
+
+  static constexpr uint8_t kWrite = 1;
+  static constexpr uint8_t kRead = 2;
+  static constexpr uint8_t kDestroy = 4;
+
+  class Backoff {
+   public:
+    void Spin() {
+      for (int i = 0; i < (1 << (std::min)(step_, 6)); ++i) {
+        CpuRelax();
+      }
+      ++step_;
+    }
+    void Snooze() {
+      if (step_ <= 6) {
+        Spin();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+
+   private:
+    static void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    }
+    int step_ = 0;
+  };
+
+  struct Slot {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+    std::atomic<uint8_t> state{0};
+
+    T* Get() { return reinterpret_cast<T*>(&value); }
+    void WaitWrite() {
+      Backoff backoff;
+      while ((state.load(std::memory_order_acquire) & kWrite) == 0) {
+        backoff.Snooze();
+      }
+    }
+  };
+
+  struct Block {
+    std::atomic<Block*> next{nullptr};
+    Slot slots[kBlockCap];
+
+    Block* WaitNext() {
+      Backoff backoff;
+      for (;;) {
+        Block* next_block = next.load(std::memory_order_acquire);
+        if (next_block != nullptr) {
+          return next_block;
+        }
+        backoff.Snooze();
+      }
+    }
+
+    // The last slot needs no mark, its reader is the one starting this.
+    static void Destroy(Block* block, size_t start) {
+      for (size_t i = start; i + 1 < kBlockCap; ++i) {
+        std::atomic<uint8_t>& state = block->slots[i].state;
+        // the reader of a slot still in use continues the destroy
+        if ((state.load(std::memory_order_acquire) & kRead) == 0 &&
+            (state.fetch_or(kDestroy, std::memory_order_acq_rel) & kRead) ==
+                0) {
+          return;
+        }
+      }
+      delete block;
+    }
+  };
+
+  struct alignas(64) Position {
+    std::atomic<size_t> index{0};
+    std::atomic<Block*> block{nullptr};
+  };
+
+  Position head_;
+  Position tail_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,189 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+// Tokenizer of the MultiSlot text lines:
+//   <num> <feasign> ... <num> <feasign> ...
+// The numbers are converted in place of strtol/strtoull/strtof. The common
+// decimal forms are converted inline and give the same value and end
+// pointer as the libc functions; any other form (sign of an integer,
+// overflow, inf/nan, hex, long mantissa, ...) falls back to libc.
+
+#include <float.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace paddle {
+namespace framework {
+namespace slot_text {
+
+// digits of a uint64 that can never overflow
+constexpr int kMaxSafeUint64Digits = 19;
+
+inline bool IsDigit(char c) { return static_cast<unsigned>(c - '0') < 10; }
+
+// Returns the first ' ' or '\0' in [str, end), or end if there is none.
+inline const char* FindSpace(const char* str, const char* end) {
+#ifdef __SSE2__
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i zero = _mm_setzero_si128();
+  for (; end - str >= 16; str += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+    unsigned mask = _mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, zero)));
+    if (mask != 0) {
+      return str + __builtin_ctz(mask);
+    }
+  }
+#endif
+  while (str < end && *str != ' ' && *str != '\0') {
+    ++str;
+  }
+  return str;
+}
+
+// Skips the leading spaces the same way as strto*, except that the other
+// whitespaces are left to the libc fallback.
+inline const char* SkipSpaces(const char* str) {
+  while (*str == ' ') {
+    ++str;
+  }
+  return str;
+}
+
+inline uint64_t ParseUint64(const char* str, char** endptr) {
+  const char* p = SkipSpaces(str);
+  const char* begin = p;
+  uint64_t value = 0;
+  while (IsDigit(*p) && p - begin < kMaxSafeUint64Digits) {
+    value = value * 10 + (*p - '0');
+    ++p;
+  }
+  if (p == begin || IsDigit(*p)) {
+    return strtoull(str, endptr, 10);
+  }
+  *endptr = const_cast<char*>(p);
+  return value;
+}
+
+inline int ParseInt(const char* str, char** endptr) {
+  const char* p = SkipSpaces(str);
+  const char* begin = p;
+  int value = 0;
+  // 9 digits always fit in an int
+  while (IsDigit(*p) && p - begin < 9) {
+    value = value * 10 + (*p - '0');
+    ++p;
+  }
+  if (p == begin || IsDigit(*p)) {
+    return static_cast<int>(strtol(str, endptr, 10));
+  }
+  *endptr = const_cast<char*>(p);
+  return value;
+}
+
+// The value is exact when the decimal mantissa is at most 2^24 and the
+// power of ten is at most 10^10, both are then exactly representable and
+// one float multiply or divide rounds the same as strtof.
+inline float ParseFloat(const char* str, char** endptr) {
+  static const float kPow10[] = {1e0f,
+                                 1e1f,
+                                 1e2f,
+                                 1e3f,
+                                 1e4f,
+                                 1e5f,
+                                 1e6f,
+                                 1e7f,
+                                 1e8f,
+                                 1e9f,
+                                 1e10f};
+  const char* p = SkipSpaces(str);
+  bool negative = false;
+  if (*p == '-' || *p == '+') {
+    negative = *p == '-';
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exp10 = 0;
+  bool has_digit = false;
+  for (; IsDigit(*p); ++p) {
+    has_digit = true;
+    if (mantissa != 0 || *p != '0') {
+      mantissa = mantissa * 10 + (*p - '0');
+      ++digits;
+    }
+    if (digits > kMaxSafeUint64Digits) {
+      return strtof(str, endptr);
+    }
+  }
+  if (*p == '.') {
+    ++p;
+    for (; IsDigit(*p); ++p) {
+      has_digit = true;
+      if (mantissa != 0 || *p != '0') {
+        mantissa = mantissa * 10 + (*p - '0');
+        ++digits;
+      }
+      --exp10;
+      if (digits > kMaxSafeUint64Digits) {
+        return strtof(str, endptr);
+      }
+    }
+  }
+  // "x" of the hex form and "n" of inf/nan are left to strtof
+  if (!has_digit || *p == 'x' || *p == 'X') {
+    return strtof(str, endptr);
+  }
+  if (*p == 'e' || *p == 'E') {
+    const char* q = p + 1;
+    bool exp_negative = false;
+    if (*q == '-' || *q == '+') {
+      exp_negative = *q == '-';
+      ++q;
+    }
+    if (!IsDigit(*q)) {
+      return strtof(str, endptr);
+    }
+    int exp = 0;
+    for (; IsDigit(*q); ++q) {
+      if (exp > 10000) {
+        return strtof(str, endptr);
+      }
+      exp = exp * 10 + (*q - '0');
+    }
+    exp10 += exp_negative ? -exp : exp;
+    p = q;
+  }
+  float value = 0;
+  if (mantissa != 0) {
+    if (FLT_EVAL_METHOD != 0 || mantissa > (1ull << 24) || exp10 < -10 ||
+        exp10 > 10) {
+      return strtof(str, endptr);
+    }
+    value = static_cast<float>(mantissa);
+    value = exp10 < 0 ? value / kPow10[-exp10] : value * kPow10[exp10];
+  }
+  *endptr = const_cast<char*>(p);
+  return negative ? -value : value;
+}
+
+}  // namespace slot_text
+}  // namespace framework
+}  // namespace paddle
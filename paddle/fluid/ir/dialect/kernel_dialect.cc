@@ -26,6 +26,7 @@
 #include "paddle/fluid/ir/dialect/pd_op.h"
 #include "paddle/fluid/ir/dialect/utils.h"
 #include "paddle/fluid/platform/init_phi.h"
+#include "paddle/ir/core/bytecode.h"
 #include "paddle/ir/core/dialect_interface.h"
 #include "paddle/phi/core/dense_tensor.h"
 
@@ -69,6 +70,69 @@ void PaddleKernelDialect::PrintAttribute(ir::Attribute attr,
      << "|dtype:" << kernel.dtype() << ">";
 }
 
+// The place is written as a PlaceAttribute and the tensor type as a type of
+// the paddle dialect.
+void PaddleKernelDialect::SerializeType(ir::Type type,
+                                        ir::BytecodeWriter &writer) const {
+  ir::IrContext *ctx = ir_context();
+  if (auto tensor_type = type.dyn_cast<AllocatedDenseTensorType>()) {
+    writer.WriteVarInt(0);
+    writer.WriteAttribute(PlaceAttribute::get(ctx, tensor_type.place()));
+    writer.WriteType(DenseTensorType::get(ctx,
+                                          tensor_type.dtype(),
+                                          tensor_type.dims(),
+                                          tensor_type.data_layout(),
+                                          tensor_type.lod(),
+                                          tensor_type.offset()));
+  } else if (auto rows_type = type.dyn_cast<AllocatedSelectedRowsType>()) {
+    writer.WriteVarInt(1);
+    writer.WriteAttribute(PlaceAttribute::get(ctx, rows_type.place()));
+    writer.WriteType(SelectedRowsType::get(ctx,
+                                           rows_type.dtype(),
+                                           rows_type.dims(),
+                                           rows_type.data_layout(),
+                                           rows_type.lod(),
+                                           rows_type.offset()));
+  } else {
+    IR_THROW("Unknown type of the paddle kernel dialect.");
+  }
+}
+
+ir::Type PaddleKernelDialect::DeserializeType(
+    ir::BytecodeReader &reader) const {
+  uint64_t kind = reader.ReadVarInt();
+  auto place_attr = reader.ReadAttribute().dyn_cast<PlaceAttribute>();
+  ir::Type type = reader.ReadType();
+  IR_ENFORCE(place_attr, "The place of a kernel type is not a place.");
+  if (kind == 0 && type.isa<DenseTensorType>()) {
+    return AllocatedDenseTensorType::get(
+        ir_context(), place_attr.data(), type.dyn_cast<DenseTensorType>());
+  } else if (kind == 1 && type.isa<SelectedRowsType>()) {
+    return AllocatedSelectedRowsType::get(
+        ir_context(), place_attr.data(), type.dyn_cast<SelectedRowsType>());
+  }
+  IR_THROW("Invalid type of the paddle kernel dialect.");
+}
+
+void PaddleKernelDialect::SerializeAttribute(
+    ir::Attribute attr, ir::BytecodeWriter &writer) const {
+  auto kernel_attr = attr.dyn_cast<KernelAttribute>();
+  IR_ENFORCE(kernel_attr, "Unknown attribute of the paddle kernel dialect.");
+  phi::KernelKey kernel = kernel_attr.data();
+  writer.WriteVarInt(static_cast<uint64_t>(kernel.backend()));
+  writer.WriteVarInt(static_cast<uint64_t>(kernel.layout()));
+  writer.WriteVarInt(static_cast<uint64_t>(kernel.dtype()));
+}
+
+ir::Attribute PaddleKernelDialect::DeserializeAttribute(
+    ir::BytecodeReader &reader) const {
+  auto backend = static_cast<phi::Backend>(reader.ReadVarInt());
+  auto layout = static_cast<phi::DataLayout>(reader.ReadVarInt());
+  auto dtype = static_cast<phi::DataType>(reader.ReadVarInt());
+  return KernelAttribute::get(ir_context(),
+                              phi::KernelKey(backend, layout, dtype));
+}
+
 }  // namespace dialect
 }  // namespace paddle
 
@@ -31,6 +31,14 @@ class PaddleKernelDialect : public ir::Dialect {
 
   void PrintAttribute(ir::Attribute attr, std::ostream& os) const override;
 
+  void SerializeType(ir::Type type,
+                     ir::BytecodeWriter& writer) const override;
+  ir::Type DeserializeType(ir::BytecodeReader& reader) const override;
+  void SerializeAttribute(ir::Attribute attr,
+                          ir::BytecodeWriter& writer) const override;
+  ir::Attribute DeserializeAttribute(
+      ir::BytecodeReader& reader) const override;
+
  private:
   void initialize();
 };
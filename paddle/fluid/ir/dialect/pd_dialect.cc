@@ -22,6 +22,7 @@
 #include "paddle/fluid/ir/dialect/pd_type.h"
 #include "paddle/fluid/ir/dialect/pd_type_storage.h"
 #include "paddle/fluid/ir/dialect/utils.h"
+#include "paddle/ir/core/bytecode.h"
 #include "paddle/ir/core/dialect_interface.h"
 #include "paddle/ir/core/utils.h"
 #include "paddle/phi/common/data_type.h"
@@ -29,6 +30,58 @@
 
 namespace paddle {
 namespace dialect {
+namespace {
+// The kinds are stored in the bytecode, only append to them.
+enum class TypeKind : uint8_t { kDenseTensor = 0, kSelectedRows };
+
+enum class AttributeKind : uint8_t {
+  kIntArray = 0,
+  kDataType,
+  kPlace,
+  kDataLayout,
+};
+
+template <typename TensorType>
+void WriteTensorType(TensorType type, ir::BytecodeWriter &writer) {  // NOLINT
+  writer.WriteType(type.dtype());
+  auto dims = phi::vectorize(type.dims());
+  writer.WriteVarInt(dims.size());
+  for (auto d : dims) {
+    writer.WriteSignedVarInt(d);
+  }
+  writer.WriteVarInt(static_cast<uint64_t>(type.data_layout()));
+  writer.WriteVarInt(type.lod().size());
+  for (auto &level : type.lod()) {
+    writer.WriteVarInt(level.size());
+    for (auto offset : level) {
+      writer.WriteVarInt(offset);
+    }
+  }
+  writer.WriteVarInt(type.offset());
+}
+
+template <typename TensorType>
+TensorType ReadTensorType(ir::IrContext *ctx,
+                          ir::BytecodeReader &reader) {  // NOLINT
+  ir::Type dtype = reader.ReadType();
+  std::vector<int64_t> dims(reader.ReadVarInt());
+  for (auto &d : dims) {
+    d = reader.ReadSignedVarInt();
+  }
+  auto layout = static_cast<phi::DataLayout>(reader.ReadVarInt());
+  phi::LoD lod(reader.ReadVarInt());
+  for (auto &level : lod) {
+    level.resize(reader.ReadVarInt());
+    for (auto &offset : level) {
+      offset = reader.ReadVarInt();
+    }
+  }
+  size_t offset = reader.ReadVarInt();
+  return TensorType::get(
+      ctx, dtype, phi::make_ddim(dims), layout, lod, offset);
+}
+}  // namespace
+
 std::shared_ptr<paddle::framework::Variable>
 ParameterConvertInterface::ParameterToVariable(ir::Parameter *parameter) {
   if (parameter->type().isa<DenseTensorType>()) {
@@ -152,6 +205,93 @@ void PaddleDialect::PrintAttribute(ir::Attribute attr, std::ostream &os) const {
   }
 }
 
+void PaddleDialect::SerializeType(ir::Type type,
+                                  ir::BytecodeWriter &writer) const {
+  if (auto tensor_type = type.dyn_cast<DenseTensorType>()) {
+    writer.WriteVarInt(static_cast<uint64_t>(TypeKind::kDenseTensor));
+    WriteTensorType(tensor_type, writer);
+  } else if (auto selected_rows_type = type.dyn_cast<SelectedRowsType>()) {
+    writer.WriteVarInt(static_cast<uint64_t>(TypeKind::kSelectedRows));
+    WriteTensorType(selected_rows_type, writer);
+  } else {
+    IR_THROW("Unknown type of the paddle dialect.");
+  }
+}
+
+ir::Type PaddleDialect::DeserializeType(ir::BytecodeReader &reader) const {
+  auto kind = static_cast<TypeKind>(reader.ReadVarInt());
+  switch (kind) {
+    case TypeKind::kDenseTensor:
+      return ReadTensorType<DenseTensorType>(ir_context(), reader);
+    case TypeKind::kSelectedRows:
+      return ReadTensorType<SelectedRowsType>(ir_context(), reader);
+  }
+  IR_THROW("Unknown type kind %d of the paddle dialect.",
+           static_cast<int>(kind));
+}
+
+void PaddleDialect::SerializeAttribute(ir::Attribute attr,
+                                       ir::BytecodeWriter &writer) const {
+  if (auto int_array_attr = attr.dyn_cast<IntArrayAttribute>()) {
+    writer.WriteVarInt(static_cast<uint64_t>(AttributeKind::kIntArray));
+    const phi::IntArray &data = int_array_attr.data();
+    writer.WriteVarInt(data.FromTensor());
+    writer.WriteVarInt(data.GetData().size());
+    for (auto i : data.GetData()) {
+      writer.WriteSignedVarInt(i);
+    }
+  } else if (auto data_type_attr = attr.dyn_cast<DataTypeAttribute>()) {
+    writer.WriteVarInt(static_cast<uint64_t>(AttributeKind::kDataType));
+    writer.WriteVarInt(static_cast<uint64_t>(data_type_attr.data()));
+  } else if (auto place_attr = attr.dyn_cast<PlaceAttribute>()) {
+    writer.WriteVarInt(static_cast<uint64_t>(AttributeKind::kPlace));
+    phi::Place place = place_attr.data();
+    writer.WriteVarInt(static_cast<uint64_t>(place.GetType()));
+    writer.WriteSignedVarInt(place.GetDeviceId());
+    writer.WriteString(place.GetType() == phi::AllocationType::CUSTOM
+                           ? place.GetDeviceType()
+                           : "");
+  } else if (auto data_layout_attr = attr.dyn_cast<DataLayoutAttribute>()) {
+    writer.WriteVarInt(static_cast<uint64_t>(AttributeKind::kDataLayout));
+    writer.WriteVarInt(static_cast<uint64_t>(data_layout_attr.data()));
+  } else {
+    IR_THROW("Unknown attribute of the paddle dialect.");
+  }
+}
+
+ir::Attribute PaddleDialect::DeserializeAttribute(
+    ir::BytecodeReader &reader) const {
+  ir::IrContext *ctx = ir_context();
+  auto kind = static_cast<AttributeKind>(reader.ReadVarInt());
+  switch (kind) {
+    case AttributeKind::kIntArray: {
+      bool from_tensor = reader.ReadVarInt() != 0;
+      std::vector<int64_t> data(reader.ReadVarInt());
+      for (auto &i : data) {
+        i = reader.ReadSignedVarInt();
+      }
+      phi::IntArray int_array(data);
+      int_array.SetFromTensor(from_tensor);
+      return IntArrayAttribute::get(ctx, int_array);
+    }
+    case AttributeKind::kDataType:
+      return DataTypeAttribute::get(
+          ctx, static_cast<phi::DataType>(reader.ReadVarInt()));
+    case AttributeKind::kPlace: {
+      auto type = static_cast<phi::AllocationType>(reader.ReadVarInt());
+      auto device_id = static_cast<int8_t>(reader.ReadSignedVarInt());
+      const std::string &device_type = reader.ReadString();
+      return PlaceAttribute::get(ctx,
+                                 phi::Place(type, device_id, device_type));
+    }
+    case AttributeKind::kDataLayout:
+      return DataLayoutAttribute::get(
+          ctx, static_cast<phi::DataLayout>(reader.ReadVarInt()));
+  }
+  IR_THROW("Unknown attribute kind %d of the paddle dialect.",
+           static_cast<int>(kind));
+}
+
 }  // namespace dialect
 }  // namespace paddle
 
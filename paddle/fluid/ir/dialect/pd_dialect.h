@@ -42,6 +42,14 @@ class PaddleDialect : public ir::Dialect {
   void PrintType(ir::Type type, std::ostream& os) const;
   void PrintAttribute(ir::Attribute type, std::ostream& os) const;
 
+  void SerializeType(ir::Type type,
+                     ir::BytecodeWriter& writer) const override;
+  ir::Type DeserializeType(ir::BytecodeReader& reader) const override;
+  void SerializeAttribute(ir::Attribute attr,
+                          ir::BytecodeWriter& writer) const override;
+  ir::Attribute DeserializeAttribute(
+      ir::BytecodeReader& reader) const override;
+
  private:
   void initialize();
 };
@@ -32,6 +32,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_feed.pb.h"
 #include "paddle/fluid/framework/data_set.h"
 #include "paddle/fluid/framework/dataset_factory.h"
+#include "paddle/fluid/framework/io/columnar_sample.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/io.h"
 #include "paddle/fluid/platform/place.h"
@@ -317,6 +318,9 @@ void BindDataset(py::module *m) {
       .def("set_shuffle_by_uid",
            &framework::Dataset::SetShuffleByUid,
            py::call_guard<py::gil_scoped_release>())
+      .def("set_use_segmented_channel",
+           &framework::Dataset::SetUseSegmentedChannel,
+           py::call_guard<py::gil_scoped_release>())
       .def("preprocess_instance",
            &framework::Dataset::PreprocessInstance,
            py::call_guard<py::gil_scoped_release>())
@@ -390,6 +394,51 @@ void BindDataset(py::module *m) {
                     bool>())
       .def("_start", &IterableDatasetWrapper::Start)
       .def("_next", &IterableDatasetWrapper::Next);
+
+  // Converts a MultiSlot text file of the data feed desc to the columnar
+  // sample format, which the in memory datasets load without parsing.
+  m->def(
+      "convert_to_columnar_sample",
+      [](const std::string &data_feed_desc_str,
+         const std::string &text_path,
+         const std::string &columnar_path,
+         const std::string &pipe_command,
+         bool parse_ins_id,
+         bool parse_content,
+         bool parse_logkey,
+         bool compress) {
+        framework::DataFeedDesc data_feed_desc;
+        PADDLE_ENFORCE_EQ(
+            google::protobuf::TextFormat::ParseFromString(data_feed_desc_str,
+                                                          &data_feed_desc),
+            true,
+            platform::errors::InvalidArgument("Failed to parse the data "
+                                              "feed desc."));
+        std::vector<framework::ColumnarSlot> slots;
+        for (auto &slot : data_feed_desc.multi_slot_desc().slots()) {
+          slots.push_back({slot.name(), slot.type()[0]});
+        }
+        uint32_t string_columns =
+            (parse_ins_id ? framework::kColumnarInsId : 0) |
+            (parse_content ? framework::kColumnarContent : 0) |
+            (parse_logkey ? framework::kColumnarLogKey : 0);
+        return framework::ConvertTextToColumnarSample(
+            text_path,
+            pipe_command,
+            slots,
+            string_columns,
+            columnar_path,
+            compress ? framework::kColumnarZlib : framework::kColumnarNone);
+      },
+      py::arg("data_feed_desc"),
+      py::arg("text_path"),
+      py::arg("columnar_path"),
+      py::arg("pipe_command") = "",
+      py::arg("parse_ins_id") = false,
+      py::arg("parse_content") = false,
+      py::arg("parse_logkey") = false,
+      py::arg("compress") = true,
+      py::call_guard<py::gil_scoped_release>());
 }
 
 }  // namespace pybind
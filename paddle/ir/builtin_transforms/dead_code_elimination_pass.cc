@@ -65,6 +65,10 @@ class DeadCodeEliminationPass : public ir::Pass {
   bool CanApplyOn(ir::Operation *op) const override {
     return op->name() == "builtin.module" && op->num_regions() > 0;
   }
+
+  std::unique_ptr<ir::Pass> Clone() const override {
+    return std::make_unique<DeadCodeEliminationPass>();
+  }
 };
 
 }  // namespace
@@ -15,13 +15,14 @@
 #include "paddle/ir/core/builder.h"
 #include "paddle/ir/core/builtin_attribute.h"
 #include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/program.h"
 #include "paddle/ir/core/region.h"
 #include "paddle/ir/core/value.h"
 
 namespace ir {
 /// Create an operation given the fields represented as an OperationState.
 Operation *Builder::Build(OperationArgument &&argument) {
-  return Insert(Operation::Create(std::move(argument)));
+  return Insert(Operation::Create(std::move(argument), arena_));
 }
 
 /// Creates an operation with the given fields.
@@ -32,6 +33,12 @@ Operation *Builder::Build(const std::vector<OpResult> &inputs,
   return Build(OperationArgument(inputs, attribute, output_types, op_info));
 }
 
+OperationArena *Builder::GetArena(Block *block) {
+  Operation *parent_op = block ? block->GetParentOp() : nullptr;
+  Program *program = parent_op ? parent_op->GetParentProgram() : nullptr;
+  return program ? program->arena() : nullptr;
+}
+
 Operation *Builder::Insert(Operation *op) {
   if (block_) {
     block_->insert(insert_point_, op);
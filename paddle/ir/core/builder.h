@@ -64,6 +64,7 @@ class Builder {
     // block.
     this->block_ = block;
     this->insert_point_ = insert_point;
+    this->arena_ = GetArena(block);
   }
 
   /// Set the insertion point to the specified operation, which will cause
@@ -133,10 +134,14 @@ class Builder {
  private:
   Operation *Insert(Operation *op);
 
+  /// The arena of the program of the block, the operations are built in it.
+  IR_API static OperationArena *GetArena(Block *block);
+
   IrContext *context_;
   Block *block_;
   // The insertion point within the list that this builder is inserting before.
   Block::iterator insert_point_;
+  OperationArena *arena_{nullptr};  // not owned
 };
 
 }  // namespace ir
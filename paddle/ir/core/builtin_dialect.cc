@@ -16,8 +16,47 @@
 #include "paddle/ir/core/builtin_attribute.h"
 #include "paddle/ir/core/builtin_op.h"
 #include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/bytecode.h"
 
 namespace ir {
+namespace {
+// The kinds are stored in the bytecode, only append to them.
+enum class BuiltinTypeKind : uint8_t {
+  kBFloat16 = 0,
+  kFloat16,
+  kFloat32,
+  kFloat64,
+  kInt8,
+  kUInt8,
+  kInt16,
+  kInt32,
+  kInt64,
+  kBool,
+  kComplex64,
+  kComplex128,
+  kVector,
+};
+
+enum class BuiltinAttributeKind : uint8_t {
+  kStr = 0,
+  kBool,
+  kFloat,
+  kDouble,
+  kInt32,
+  kInt64,
+  kArray,
+  kType,
+};
+
+void WriteKind(BytecodeWriter &writer, BuiltinTypeKind kind) {  // NOLINT
+  writer.WriteVarInt(static_cast<uint64_t>(kind));
+}
+
+void WriteKind(BytecodeWriter &writer, BuiltinAttributeKind kind) {  // NOLINT
+  writer.WriteVarInt(static_cast<uint64_t>(kind));
+}
+}  // namespace
+
 BuiltinDialect::BuiltinDialect(IrContext *context)
     : Dialect(name(), context, TypeId::get<BuiltinDialect>()) {
   initialize();
@@ -57,6 +96,146 @@ void BuiltinDialect::initialize() {
               ConstantOp>();
 }
 
+void BuiltinDialect::SerializeType(Type type, BytecodeWriter &writer) const {
+  if (type.isa<BFloat16Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kBFloat16);
+  } else if (type.isa<Float16Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kFloat16);
+  } else if (type.isa<Float32Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kFloat32);
+  } else if (type.isa<Float64Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kFloat64);
+  } else if (type.isa<Int8Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kInt8);
+  } else if (type.isa<UInt8Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kUInt8);
+  } else if (type.isa<Int16Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kInt16);
+  } else if (type.isa<Int32Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kInt32);
+  } else if (type.isa<Int64Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kInt64);
+  } else if (type.isa<BoolType>()) {
+    WriteKind(writer, BuiltinTypeKind::kBool);
+  } else if (type.isa<Complex64Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kComplex64);
+  } else if (type.isa<Complex128Type>()) {
+    WriteKind(writer, BuiltinTypeKind::kComplex128);
+  } else if (auto vector_type = type.dyn_cast<VectorType>()) {
+    WriteKind(writer, BuiltinTypeKind::kVector);
+    writer.WriteVarInt(vector_type.size());
+    for (auto inner_type : vector_type.data()) {
+      writer.WriteType(inner_type);
+    }
+  } else {
+    IR_THROW("Unknown builtin type.");
+  }
+}
+
+Type BuiltinDialect::DeserializeType(BytecodeReader &reader) const {
+  IrContext *ctx = ir_context();
+  auto kind = static_cast<BuiltinTypeKind>(reader.ReadVarInt());
+  switch (kind) {
+    case BuiltinTypeKind::kBFloat16:
+      return BFloat16Type::get(ctx);
+    case BuiltinTypeKind::kFloat16:
+      return Float16Type::get(ctx);
+    case BuiltinTypeKind::kFloat32:
+      return Float32Type::get(ctx);
+    case BuiltinTypeKind::kFloat64:
+      return Float64Type::get(ctx);
+    case BuiltinTypeKind::kInt8:
+      return Int8Type::get(ctx);
+    case BuiltinTypeKind::kUInt8:
+      return UInt8Type::get(ctx);
+    case BuiltinTypeKind::kInt16:
+      return Int16Type::get(ctx);
+    case BuiltinTypeKind::kInt32:
+      return Int32Type::get(ctx);
+    case BuiltinTypeKind::kInt64:
+      return Int64Type::get(ctx);
+    case BuiltinTypeKind::kBool:
+      return BoolType::get(ctx);
+    case BuiltinTypeKind::kComplex64:
+      return Complex64Type::get(ctx);
+    case BuiltinTypeKind::kComplex128:
+      return Complex128Type::get(ctx);
+    case BuiltinTypeKind::kVector: {
+      std::vector<Type> types(reader.ReadVarInt());
+      for (auto &type : types) {
+        type = reader.ReadType();
+      }
+      return VectorType::get(ctx, types);
+    }
+  }
+  IR_THROW("Unknown builtin type kind %d.", static_cast<int>(kind));
+}
+
+void BuiltinDialect::SerializeAttribute(Attribute attr,
+                                        BytecodeWriter &writer) const {
+  if (auto str = attr.dyn_cast<StrAttribute>()) {
+    WriteKind(writer, BuiltinAttributeKind::kStr);
+    writer.WriteString(str.AsString());
+  } else if (auto b = attr.dyn_cast<BoolAttribute>()) {
+    WriteKind(writer, BuiltinAttributeKind::kBool);
+    writer.WriteVarInt(b.data());
+  } else if (auto f = attr.dyn_cast<FloatAttribute>()) {
+    WriteKind(writer, BuiltinAttributeKind::kFloat);
+    writer.WriteFloat(f.data());
+  } else if (auto d = attr.dyn_cast<DoubleAttribute>()) {
+    WriteKind(writer, BuiltinAttributeKind::kDouble);
+    writer.WriteDouble(d.data());
+  } else if (auto i = attr.dyn_cast<Int32Attribute>()) {
+    WriteKind(writer, BuiltinAttributeKind::kInt32);
+    writer.WriteSignedVarInt(i.data());
+  } else if (auto i = attr.dyn_cast<Int64Attribute>()) {
+    WriteKind(writer, BuiltinAttributeKind::kInt64);
+    writer.WriteSignedVarInt(i.data());
+  } else if (auto arr = attr.dyn_cast<ArrayAttribute>()) {
+    WriteKind(writer, BuiltinAttributeKind::kArray);
+    writer.WriteVarInt(arr.size());
+    for (size_t idx = 0; idx < arr.size(); ++idx) {
+      writer.WriteAttribute(arr.at(idx));
+    }
+  } else if (auto type = attr.dyn_cast<TypeAttribute>()) {
+    WriteKind(writer, BuiltinAttributeKind::kType);
+    writer.WriteType(type.data());
+  } else {
+    // PointerAttribute is an address of this process
+    IR_THROW("The builtin attribute can not be serialized.");
+  }
+}
+
+Attribute BuiltinDialect::DeserializeAttribute(BytecodeReader &reader) const {
+  IrContext *ctx = ir_context();
+  auto kind = static_cast<BuiltinAttributeKind>(reader.ReadVarInt());
+  switch (kind) {
+    case BuiltinAttributeKind::kStr:
+      return StrAttribute::get(ctx, reader.ReadString());
+    case BuiltinAttributeKind::kBool:
+      return BoolAttribute::get(ctx, reader.ReadVarInt() != 0);
+    case BuiltinAttributeKind::kFloat:
+      return FloatAttribute::get(ctx, reader.ReadFloat());
+    case BuiltinAttributeKind::kDouble:
+      return DoubleAttribute::get(ctx, reader.ReadDouble());
+    case BuiltinAttributeKind::kInt32:
+      return Int32Attribute::get(
+          ctx, static_cast<int32_t>(reader.ReadSignedVarInt()));
+    case BuiltinAttributeKind::kInt64:
+      return Int64Attribute::get(ctx, reader.ReadSignedVarInt());
+    case BuiltinAttributeKind::kArray: {
+      std::vector<Attribute> attrs(reader.ReadVarInt());
+      for (auto &attr : attrs) {
+        attr = reader.ReadAttribute();
+      }
+      return ArrayAttribute::get(ctx, attrs);
+    }
+    case BuiltinAttributeKind::kType:
+      return TypeAttribute::get(ctx, reader.ReadType());
+  }
+  IR_THROW("Unknown builtin attribute kind %d.", static_cast<int>(kind));
+}
+
 }  // namespace ir
 
 IR_DEFINE_EXPLICIT_TYPE_ID(ir::BuiltinDialect)
@@ -33,6 +33,12 @@ class IR_API BuiltinDialect : public ir::Dialect {
   ///
   static const char *name() { return "builtin"; }
 
+  void SerializeType(Type type, BytecodeWriter &writer) const override;
+  Type DeserializeType(BytecodeReader &reader) const override;
+  void SerializeAttribute(Attribute attr,
+                          BytecodeWriter &writer) const override;
+  Attribute DeserializeAttribute(BytecodeReader &reader) const override;
+
  private:
   void initialize();
 };
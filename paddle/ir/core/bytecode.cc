@@ -0,0 +1,572 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/core/bytecode.h"
+
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/ir/core/block.h"
+#include "paddle/ir/core/dialect.h"
+#include "paddle/ir/core/enforce.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/operation.h"
+#include "paddle/ir/core/parameter.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/core/region.h"
+#include "paddle/ir/core/value.h"
+
+namespace ir {
+
+namespace {
+constexpr char kMagic[] = "PDIR";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+constexpr uint64_t kVersion = 1;
+
+enum EntryKind : uint8_t { kTypeEntry = 0, kAttributeEntry = 1 };
+}  // namespace
+
+namespace detail {
+
+class BytecodeWriterImpl {
+ public:
+  BytecodeWriter Writer(std::string *buffer) {
+    return BytecodeWriter(this, buffer);
+  }
+
+  uint64_t InternString(const std::string &str) {
+    auto it = string_ids_.find(str);
+    if (it != string_ids_.end()) {
+      return it->second;
+    }
+    strings_.push_back(str);
+    string_ids_.emplace(str, strings_.size() - 1);
+    return strings_.size() - 1;
+  }
+
+  // 0 for null, the entries a type refers to are added before it
+  uint64_t InternType(Type type) {
+    if (!type) {
+      return 0;
+    }
+    auto it = type_ids_.find(type);
+    if (it != type_ids_.end()) {
+      return it->second;
+    }
+    std::string payload;
+    BytecodeWriter writer = Writer(&payload);
+    type.dialect().SerializeType(type, writer);
+    uint64_t id = AddEntry(kTypeEntry, type.dialect(), std::move(payload));
+    type_ids_.emplace(type, id);
+    return id;
+  }
+
+  uint64_t InternAttribute(Attribute attr) {
+    if (!attr) {
+      return 0;
+    }
+    auto it = attribute_ids_.find(attr);
+    if (it != attribute_ids_.end()) {
+      return it->second;
+    }
+    std::string payload;
+    BytecodeWriter writer = Writer(&payload);
+    attr.dialect().SerializeAttribute(attr, writer);
+    uint64_t id = AddEntry(kAttributeEntry, attr.dialect(), std::move(payload));
+    attribute_ids_.emplace(attr, id);
+    return id;
+  }
+
+  void WriteParameters(const Program &program, BytecodeWriter &writer) {
+    // sorted, the same program is always written the same way
+    std::map<std::string, const Parameter *> sorted;
+    for (auto &it : program.parameters()) {
+      sorted.emplace(it.first, it.second.get());
+    }
+    writer.WriteVarInt(sorted.size());
+    for (auto &it : sorted) {
+      writer.WriteString(it.first);
+      writer.WriteType(it.second->type());
+      writer.WriteVarInt(it.second->is_mutable());
+      writer.WriteVarInt(it.second->size());
+      writer.WriteBytes(it.second->data(), it.second->size());
+    }
+  }
+
+  void WriteBlock(const Block &block, BytecodeWriter &writer) {
+    writer.WriteVarInt(block.size());
+    for (auto *op : block) {
+      WriteOperation(*op, writer);
+    }
+  }
+
+  void WriteOperation(const Operation &op, BytecodeWriter &writer) {
+    writer.WriteString(op.name());
+    writer.WriteVarInt(op.num_operands());
+    for (uint32_t i = 0; i < op.num_operands(); ++i) {
+      Value value = op.operand(i);
+      if (!value) {
+        writer.WriteVarInt(0);
+        continue;
+      }
+      auto it = value_ids_.find(value);
+      IR_ENFORCE(it != value_ids_.end(),
+                 "The operand %d of op %s is not defined before it.",
+                 i,
+                 op.name());
+      writer.WriteVarInt(it->second);
+    }
+    writer.WriteVarInt(op.num_results());
+    for (uint32_t i = 0; i < op.num_results(); ++i) {
+      OpResult result = op.result(i);
+      writer.WriteType(result.type());
+      value_ids_.emplace(result, ++num_values_);
+    }
+    std::map<std::string, Attribute> attributes(op.attributes().begin(),
+                                                op.attributes().end());
+    writer.WriteVarInt(attributes.size());
+    for (auto &it : attributes) {
+      writer.WriteString(it.first);
+      writer.WriteAttribute(it.second);
+    }
+    writer.WriteVarInt(op.num_regions());
+    for (uint32_t i = 0; i < op.num_regions(); ++i) {
+      WriteRegion(op.region(i), writer);
+    }
+  }
+
+  // size | number of values defined in it | blocks
+  void WriteRegion(const Region &region, BytecodeWriter &writer) {
+    uint64_t first_value = num_values_;
+    std::string body;
+    BytecodeWriter body_writer = Writer(&body);
+    body_writer.WriteVarInt(region.size());
+    for (auto *block : region) {
+      WriteBlock(*block, body_writer);
+    }
+    writer.WriteVarInt(body.size());
+    writer.WriteVarInt(num_values_ - first_value);
+    writer.WriteBytes(body.data(), body.size());
+  }
+
+  std::string Finish(const std::string &body) {
+    std::string bytecode(kMagic, kMagicSize);
+    BytecodeWriter writer = Writer(&bytecode);
+    writer.WriteVarInt(kVersion);
+    writer.WriteVarInt(num_values_);
+    writer.WriteVarInt(strings_.size());
+    for (auto &str : strings_) {
+      writer.WriteVarInt(str.size());
+      writer.WriteBytes(str.data(), str.size());
+    }
+    writer.WriteVarInt(entries_.size());
+    for (auto &entry : entries_) {
+      writer.WriteVarInt(entry.kind);
+      writer.WriteVarInt(entry.dialect);
+      writer.WriteVarInt(entry.payload.size());
+      writer.WriteBytes(entry.payload.data(), entry.payload.size());
+    }
+    bytecode += body;
+    return bytecode;
+  }
+
+ private:
+  struct Entry {
+    uint8_t kind;
+    uint64_t dialect;
+    std::string payload;
+  };
+
+  uint64_t AddEntry(uint8_t kind, const Dialect &dialect, std::string payload) {
+    entries_.push_back(
+        Entry{kind, InternString(dialect.name()), std::move(payload)});
+    return entries_.size();
+  }
+
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, uint64_t> string_ids_;
+  std::vector<Entry> entries_;
+  std::unordered_map<Type, uint64_t> type_ids_;
+  std::unordered_map<Attribute, uint64_t> attribute_ids_;
+  // 0 for null
+  std::unordered_map<Value, uint64_t> value_ids_;
+  uint64_t num_values_{0};
+};
+
+class BytecodeReaderImpl {
+ public:
+  BytecodeReaderImpl(IrContext *ctx, std::string bytecode)
+      : ctx_(ctx), bytecode_(std::move(bytecode)) {}
+
+  IrContext *ir_context() const { return ctx_; }
+
+  const std::string &GetString(uint64_t id) const {
+    IR_ENFORCE(id < strings_.size(), "Invalid string index %d.", id);
+    return strings_[id];
+  }
+
+  Type GetType(uint64_t id) const {
+    if (id == 0) {
+      return Type();
+    }
+    IR_ENFORCE(id <= entries_.size() && entries_[id - 1].type,
+               "Invalid type index %d.",
+               id);
+    return entries_[id - 1].type;
+  }
+
+  Attribute GetAttribute(uint64_t id) const {
+    if (id == 0) {
+      return Attribute();
+    }
+    IR_ENFORCE(id <= entries_.size() && entries_[id - 1].attr,
+               "Invalid attribute index %d.",
+               id);
+    return entries_[id - 1].attr;
+  }
+
+  std::unique_ptr<Program> Load(bool lazy) {
+    IR_ENFORCE(!loaded_, "The bytecode can only be loaded once.");
+    loaded_ = true;
+    lazy_ = lazy;
+    IR_ENFORCE(bytecode_.compare(0, kMagicSize, kMagic) == 0,
+               "The data is not the bytecode of a program.");
+    BytecodeReader reader(this,
+                          bytecode_.data() + kMagicSize,
+                          bytecode_.data() + bytecode_.size());
+    uint64_t version = reader.ReadVarInt();
+    IR_ENFORCE(version == kVersion,
+               "The bytecode version %d is not supported, expect %d.",
+               version,
+               kVersion);
+    values_.resize(reader.ReadVarInt());
+    ReadStrings(reader);
+    ReadEntries(reader);
+
+    auto program = std::make_unique<Program>(ctx_);
+    ReadParameters(reader, program.get());
+    ReadBlock(reader, program->block());
+    IR_ENFORCE(reader.empty(), "Unexpected data after the program.");
+    return program;
+  }
+
+  bool IsMaterialized(const Operation *op) const {
+    return lazy_regions_.count(const_cast<Operation *>(op)) == 0;
+  }
+
+  void Materialize(Operation *op) {
+    auto it = lazy_regions_.find(op);
+    if (it == lazy_regions_.end()) {
+      return;
+    }
+    std::vector<LazyRegion> regions = std::move(it->second);
+    lazy_regions_.erase(it);
+    for (auto &lazy_region : regions) {
+      BytecodeReader reader(this, lazy_region.begin, lazy_region.end);
+      next_value_ = lazy_region.first_value;
+      ReadRegion(reader, &op->region(lazy_region.index));
+      IR_ENFORCE(next_value_ == lazy_region.first_value +
+                                    lazy_region.num_values &&
+                     reader.empty(),
+                 "The region %d of op %s is broken.",
+                 lazy_region.index,
+                 op->name());
+    }
+  }
+
+  void MaterializeAll() {
+    while (!lazy_regions_.empty()) {
+      Materialize(lazy_regions_.begin()->first);
+    }
+  }
+
+ private:
+  struct Entry {
+    Type type;
+    Attribute attr;
+  };
+
+  struct LazyRegion {
+    uint32_t index;
+    const char *begin;
+    const char *end;
+    uint64_t first_value;
+    uint64_t num_values;
+  };
+
+  void ReadStrings(BytecodeReader &reader) {
+    strings_.resize(reader.ReadVarInt());
+    for (auto &str : strings_) {
+      uint64_t size = reader.ReadVarInt();
+      const char *data = reader.Skip(size);
+      str.assign(data, size);
+    }
+  }
+
+  void ReadEntries(BytecodeReader &reader) {
+    uint64_t num_entries = reader.ReadVarInt();
+    entries_.reserve(num_entries);
+    for (uint64_t i = 0; i < num_entries; ++i) {
+      uint64_t kind = reader.ReadVarInt();
+      const std::string &dialect_name = GetString(reader.ReadVarInt());
+      Dialect *dialect = ctx_->GetRegisteredDialect(dialect_name);
+      IR_ENFORCE(dialect != nullptr,
+                 "The dialect %s is not registered.",
+                 dialect_name);
+      uint64_t size = reader.ReadVarInt();
+      const char *payload = reader.Skip(size);
+      BytecodeReader payload_reader(this, payload, payload + size);
+      Entry entry;
+      if (kind == kTypeEntry) {
+        entry.type = dialect->DeserializeType(payload_reader);
+        IR_ENFORCE(entry.type, "Failed to read a type of %s.", dialect_name);
+      } else {
+        IR_ENFORCE(kind == kAttributeEntry, "Invalid entry kind %d.", kind);
+        entry.attr = dialect->DeserializeAttribute(payload_reader);
+        IR_ENFORCE(
+            entry.attr, "Failed to read an attribute of %s.", dialect_name);
+      }
+      IR_ENFORCE(payload_reader.empty(),
+                 "The payload of a %s entry is not fully read.",
+                 dialect_name);
+      entries_.push_back(entry);
+    }
+  }
+
+  void ReadParameters(BytecodeReader &reader, Program *program) {
+    uint64_t num_parameters = reader.ReadVarInt();
+    for (uint64_t i = 0; i < num_parameters; ++i) {
+      std::string name = reader.ReadString();
+      Type type = reader.ReadType();
+      bool is_mutable = reader.ReadVarInt() != 0;
+      uint64_t size = reader.ReadVarInt();
+      const char *data = reader.Skip(size);
+      auto parameter =
+          std::make_unique<Parameter>(const_cast<char *>(data), size, type);
+      if (is_mutable) {
+        parameter->set_mutable();
+      }
+      program->SetParameter(name, std::move(parameter));
+    }
+  }
+
+  void ReadBlock(BytecodeReader &reader, Block *block) {
+    uint64_t num_ops = reader.ReadVarInt();
+    for (uint64_t i = 0; i < num_ops; ++i) {
+      block->push_back(ReadOperation(reader));
+    }
+  }
+
+  void ReadRegion(BytecodeReader &reader, Region *region) {
+    uint64_t num_blocks = reader.ReadVarInt();
+    for (uint64_t i = 0; i < num_blocks; ++i) {
+      region->emplace_back();
+      ReadBlock(reader, region->back());
+    }
+  }
+
+  Operation *ReadOperation(BytecodeReader &reader) {
+    const std::string &name = reader.ReadString();
+    OpInfo info;
+    if (!name.empty()) {
+      info = ctx_->GetRegisteredOpInfo(name);
+      IR_ENFORCE(info, "The op %s is not registered.", name);
+    }
+    std::vector<OpResult> inputs(reader.ReadVarInt());
+    for (auto &input : inputs) {
+      uint64_t id = reader.ReadVarInt();
+      if (id == 0) {
+        continue;
+      }
+      IR_ENFORCE(id <= values_.size() && values_[id - 1],
+                 "The operand of op %s refers to an unknown value.",
+                 name);
+      input = values_[id - 1];
+    }
+    std::vector<Type> output_types(reader.ReadVarInt());
+    for (auto &type : output_types) {
+      type = reader.ReadType();
+    }
+    AttributeMap attributes;
+    uint64_t num_attributes = reader.ReadVarInt();
+    for (uint64_t i = 0; i < num_attributes; ++i) {
+      const std::string &key = reader.ReadString();
+      attributes[key] = reader.ReadAttribute();
+    }
+    uint64_t num_regions = reader.ReadVarInt();
+    Operation *op =
+        Operation::Create(inputs, attributes, output_types, info, num_regions);
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      IR_ENFORCE(next_value_ < values_.size(), "Too many values.");
+      values_[next_value_++] = op->result(i);
+    }
+    for (uint32_t i = 0; i < num_regions; ++i) {
+      uint64_t size = reader.ReadVarInt();
+      uint64_t num_values = reader.ReadVarInt();
+      const char *body = reader.Skip(size);
+      if (lazy_) {
+        lazy_regions_[op].push_back(
+            LazyRegion{i, body, body + size, next_value_, num_values});
+        next_value_ += num_values;
+        continue;
+      }
+      BytecodeReader body_reader(this, body, body + size);
+      uint64_t first_value = next_value_;
+      ReadRegion(body_reader, &op->region(i));
+      IR_ENFORCE(next_value_ == first_value + num_values && body_reader.empty(),
+                 "The region %d of op %s is broken.",
+                 i,
+                 name);
+    }
+    return op;
+  }
+
+  IrContext *ctx_;
+  std::string bytecode_;
+  bool loaded_{false};
+  bool lazy_{false};
+  std::vector<std::string> strings_;
+  std::vector<Entry> entries_;
+  std::vector<OpResult> values_;
+  uint64_t next_value_{0};
+  std::unordered_map<Operation *, std::vector<LazyRegion>> lazy_regions_;
+};
+
+}  // namespace detail
+
+void BytecodeWriter::WriteVarInt(uint64_t value) {
+  while (value >= 0x80) {
+    buffer_->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  buffer_->push_back(static_cast<char>(value));
+}
+
+void BytecodeWriter::WriteSignedVarInt(int64_t value) {
+  WriteVarInt((static_cast<uint64_t>(value) << 1) ^
+              static_cast<uint64_t>(value >> 63));
+}
+
+void BytecodeWriter::WriteFloat(float value) {
+  WriteBytes(&value, sizeof(value));
+}
+
+void BytecodeWriter::WriteDouble(double value) {
+  WriteBytes(&value, sizeof(value));
+}
+
+void BytecodeWriter::WriteBytes(const void *data, size_t size) {
+  buffer_->append(reinterpret_cast<const char *>(data), size);
+}
+
+void BytecodeWriter::WriteString(const std::string &str) {
+  WriteVarInt(impl_->InternString(str));
+}
+
+void BytecodeWriter::WriteType(Type type) {
+  WriteVarInt(impl_->InternType(type));
+}
+
+void BytecodeWriter::WriteAttribute(Attribute attr) {
+  WriteVarInt(impl_->InternAttribute(attr));
+}
+
+IrContext *BytecodeReader::ir_context() const { return impl_->ir_context(); }
+
+const char *BytecodeReader::Skip(size_t size) {
+  IR_ENFORCE(static_cast<size_t>(end_ - pos_) >= size,
+             "The bytecode is truncated.");
+  const char *data = pos_;
+  pos_ += size;
+  return data;
+}
+
+uint64_t BytecodeReader::ReadVarInt() {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(*Skip(1));
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  IR_THROW("Invalid varint in the bytecode.");
+}
+
+int64_t BytecodeReader::ReadSignedVarInt() {
+  uint64_t value = ReadVarInt();
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+float BytecodeReader::ReadFloat() {
+  float value;
+  ReadBytes(&value, sizeof(value));
+  return value;
+}
+
+double BytecodeReader::ReadDouble() {
+  double value;
+  ReadBytes(&value, sizeof(value));
+  return value;
+}
+
+void BytecodeReader::ReadBytes(void *data, size_t size) {
+  memcpy(data, Skip(size), size);
+}
+
+const std::string &BytecodeReader::ReadString() {
+  return impl_->GetString(ReadVarInt());
+}
+
+Type BytecodeReader::ReadType() { return impl_->GetType(ReadVarInt()); }
+
+Attribute BytecodeReader::ReadAttribute() {
+  return impl_->GetAttribute(ReadVarInt());
+}
+
+std::string SerializeProgram(const Program &program) {
+  detail::BytecodeWriterImpl impl;
+  std::string body;
+  BytecodeWriter writer = impl.Writer(&body);
+  impl.WriteParameters(program, writer);
+  impl.WriteBlock(*program.block(), writer);
+  return impl.Finish(body);
+}
+
+BytecodeLoader::BytecodeLoader(IrContext *ctx, std::string bytecode)
+    : impl_(new detail::BytecodeReaderImpl(ctx, std::move(bytecode))) {}
+
+BytecodeLoader::~BytecodeLoader() = default;
+
+std::unique_ptr<Program> BytecodeLoader::Load(bool lazy) {
+  return impl_->Load(lazy);
+}
+
+bool BytecodeLoader::IsMaterialized(const Operation *op) const {
+  return impl_->IsMaterialized(op);
+}
+
+void BytecodeLoader::Materialize(Operation *op) { impl_->Materialize(op); }
+
+void BytecodeLoader::MaterializeAll() { impl_->MaterializeAll(); }
+
+std::unique_ptr<Program> DeserializeProgram(IrContext *ctx,
+                                            std::string bytecode) {
+  BytecodeLoader loader(ctx, std::move(bytecode));
+  return loader.Load();
+}
+
+}  // namespace ir
@@ -0,0 +1,160 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "paddle/ir/core/attribute.h"
+#include "paddle/ir/core/dll_decl.h"
+#include "paddle/ir/core/type.h"
+
+namespace ir {
+class IrContext;
+class Operation;
+class Program;
+
+namespace detail {
+class BytecodeWriterImpl;
+class BytecodeReaderImpl;
+}  // namespace detail
+
+///
+/// \brief The bytecode is a compact binary form of a Program. It holds:
+///  - a table of the strings, so each op name, attribute name and string
+///    is stored once;
+///  - a table of the types and attributes, each one stored once by the
+///    serialization hooks of its dialect, after the ones it refers to;
+///  - the parameters;
+///  - the ops of the program block, which refer to the strings, types,
+///    attributes and values by their index in the tables.
+/// Each region is prefixed by its size, so the loader can skip it and
+/// materialize it later.
+///
+
+///
+/// \brief Writes the payload of a type or an attribute, used by the
+/// serialization hooks of the dialects.
+///
+class IR_API BytecodeWriter {
+ public:
+  void WriteVarInt(uint64_t value);
+  ///
+  /// \brief Zigzag encoded, small negative numbers take few bytes too.
+  ///
+  void WriteSignedVarInt(int64_t value);
+  void WriteFloat(float value);
+  void WriteDouble(double value);
+  void WriteBytes(const void *data, size_t size);
+  ///
+  /// \brief Writes the index of the string in the string table.
+  ///
+  void WriteString(const std::string &str);
+  ///
+  /// \brief Writes the index of the type in the type and attribute table, a
+  /// null type is allowed.
+  ///
+  void WriteType(Type type);
+  void WriteAttribute(Attribute attr);
+
+ private:
+  friend class detail::BytecodeWriterImpl;
+  BytecodeWriter(detail::BytecodeWriterImpl *impl, std::string *buffer)
+      : impl_(impl), buffer_(buffer) {}
+
+  detail::BytecodeWriterImpl *impl_;  // not owned
+  std::string *buffer_;               // not owned
+};
+
+///
+/// \brief Reads what a BytecodeWriter wrote, in the same order.
+///
+class IR_API BytecodeReader {
+ public:
+  IrContext *ir_context() const;
+
+  uint64_t ReadVarInt();
+  int64_t ReadSignedVarInt();
+  float ReadFloat();
+  double ReadDouble();
+  void ReadBytes(void *data, size_t size);
+  const std::string &ReadString();
+  Type ReadType();
+  Attribute ReadAttribute();
+
+  bool empty() const { return pos_ == end_; }
+
+ private:
+  friend class detail::BytecodeReaderImpl;
+  BytecodeReader(detail::BytecodeReaderImpl *impl,
+                 const char *begin,
+                 const char *end)
+      : impl_(impl), pos_(begin), end_(end) {}
+
+  const char *Skip(size_t size);
+
+  detail::BytecodeReaderImpl *impl_;  // not owned
+  const char *pos_;
+  const char *end_;
+};
+
+///
+/// \brief Serializes the program, parameters included. The ops, types and
+/// attributes of the program must be serializable by their dialects.
+///
+IR_API std::string SerializeProgram(const Program &program);
+
+///
+/// \brief Loads a program from the bytecode. In the lazy mode the regions of
+/// the ops are left empty until they are materialized, so a program can be
+/// loaded without decoding the bodies it does not use.
+/// NOTE: The loader must outlive the materialization of the regions, and an
+/// op must not be destroyed or moved to another program before its regions
+/// are materialized.
+///
+class IR_API BytecodeLoader {
+ public:
+  BytecodeLoader(IrContext *ctx, std::string bytecode);
+  ~BytecodeLoader();
+  BytecodeLoader(const BytecodeLoader &) = delete;
+  BytecodeLoader &operator=(const BytecodeLoader &) = delete;
+
+  ///
+  /// \brief Creates the program, it can only be called once.
+  ///
+  std::unique_ptr<Program> Load(bool lazy = false);
+
+  ///
+  /// \brief Whether the regions of the op are loaded.
+  ///
+  bool IsMaterialized(const Operation *op) const;
+
+  ///
+  /// \brief Loads the regions of the op, the regions of the ops in them are
+  /// still lazy.
+  ///
+  void Materialize(Operation *op);
+
+  void MaterializeAll();
+
+ private:
+  std::unique_ptr<detail::BytecodeReaderImpl> impl_;
+};
+
+IR_API std::unique_ptr<Program> DeserializeProgram(IrContext *ctx,
+                                                   std::string bytecode);
+
+}  // namespace ir
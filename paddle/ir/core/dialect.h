@@ -29,6 +29,8 @@ namespace ir {
 
 class Operation;
 class IrPrinter;
+class BytecodeWriter;
+class BytecodeReader;
 
 class DialectInterface;
 ///
@@ -148,6 +150,27 @@ class IR_API Dialect {
   virtual void PrintOperation(const Operation *op,
                               IrPrinter &printer) const;  // NOLINT
 
+  ///
+  /// \brief Serialization hooks of the bytecode, a type or an attribute is
+  /// read back by the hook of the dialect that wrote it.
+  ///
+  virtual void SerializeType(Type type, BytecodeWriter &writer) const {
+    IR_THROW("dialect has no registered type serialization hook");
+  }
+
+  virtual Type DeserializeType(BytecodeReader &reader) const {
+    IR_THROW("dialect has no registered type deserialization hook");
+  }
+
+  virtual void SerializeAttribute(Attribute attr,
+                                  BytecodeWriter &writer) const {
+    IR_THROW("dialect has no registered attribute serialization hook");
+  }
+
+  virtual Attribute DeserializeAttribute(BytecodeReader &reader) const {
+    IR_THROW("dialect has no registered attribute deserialization hook");
+  }
+
  private:
   Dialect(const Dialect &) = delete;
 
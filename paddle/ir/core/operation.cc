@@ -19,18 +19,41 @@
 #include "paddle/ir/core/enforce.h"
 #include "paddle/ir/core/op_info.h"
 #include "paddle/ir/core/operation.h"
+#include "paddle/ir/core/operation_arena.h"
 #include "paddle/ir/core/program.h"
 #include "paddle/ir/core/region.h"
 #include "paddle/ir/core/utils.h"
 #include "paddle/ir/core/value_impl.h"
 
 namespace ir {
-Operation *Operation::Create(OperationArgument &&argument) {
+namespace {
+size_t ResultMemSize(uint32_t num_results) {
+  uint32_t max_inline_result_num =
+      detail::OpResultImpl::GetMaxInlineResultIndex() + 1;
+  return num_results > max_inline_result_num
+             ? sizeof(detail::OpOutlineResultImpl) *
+                       (num_results - max_inline_result_num) +
+                   sizeof(detail::OpInlineResultImpl) * max_inline_result_num
+             : sizeof(detail::OpInlineResultImpl) * num_results;
+}
+
+size_t OperationMemSize(uint32_t num_results,
+                        uint32_t num_operands,
+                        uint32_t num_regions) {
+  return ResultMemSize(num_results) + sizeof(Operation) +
+         sizeof(detail::OpOperandImpl) * num_operands +
+         sizeof(Region) * num_regions;
+}
+}  // namespace
+
+Operation *Operation::Create(OperationArgument &&argument,
+                             OperationArena *arena) {
   Operation *op = Create(argument.inputs,
                          argument.attributes,
                          argument.output_types,
                          argument.info,
-                         argument.regions.size());
+                         argument.regions.size(),
+                         arena);
 
   for (size_t index = 0; index < argument.regions.size(); ++index) {
     op->region(index).TakeBody(std::move(*argument.regions[index]));
@@ -45,26 +68,19 @@ Operation *Operation::Create(const std::vector<ir::OpResult> &inputs,
                              const AttributeMap &attributes,
                              const std::vector<ir::Type> &output_types,
                              ir::OpInfo op_info,
-                             size_t num_regions) {
+                             size_t num_regions,
+                             OperationArena *arena) {
   // 1. Calculate the required memory size for OpResults + Operation +
   // OpOperands.
   uint32_t num_results = output_types.size();
   uint32_t num_operands = inputs.size();
   uint32_t max_inline_result_num =
       detail::OpResultImpl::GetMaxInlineResultIndex() + 1;
-  size_t result_mem_size =
-      num_results > max_inline_result_num
-          ? sizeof(detail::OpOutlineResultImpl) *
-                    (num_results - max_inline_result_num) +
-                sizeof(detail::OpInlineResultImpl) * max_inline_result_num
-          : sizeof(detail::OpInlineResultImpl) * num_results;
-  size_t operand_mem_size = sizeof(detail::OpOperandImpl) * num_operands;
-  size_t op_mem_size = sizeof(Operation);
-  size_t region_mem_size = num_regions * sizeof(Region);
-  size_t base_size =
-      result_mem_size + op_mem_size + operand_mem_size + region_mem_size;
+  size_t base_size = OperationMemSize(num_results, num_operands, num_regions);
   // 2. Malloc memory.
-  char *base_ptr = reinterpret_cast<char *>(aligned_malloc(base_size, 8));
+  char *base_ptr =
+      reinterpret_cast<char *>(arena ? arena->Allocate(base_size)
+                                     : aligned_malloc(base_size, 8));
   // 3.1. Construct OpResults.
   for (size_t idx = num_results; idx > 0; idx--) {
     if (idx > max_inline_result_num) {
@@ -79,6 +95,7 @@ Operation *Operation::Create(const std::vector<ir::OpResult> &inputs,
   // 3.2. Construct Operation.
   Operation *op = new (base_ptr)
       Operation(attributes, op_info, num_results, num_operands, num_regions);
+  op->arena_ = arena;
   base_ptr += sizeof(Operation);
   // 3.3. Construct OpOperands.
   if ((reinterpret_cast<uintptr_t>(base_ptr) & 0x7) != 0) {
@@ -135,19 +152,18 @@ void Operation::Destroy() {
     op_operand(idx).impl()->~OpOperandImpl();
   }
   // 5. Free memory.
-  uint32_t max_inline_result_num =
-      detail::OpResultImpl::GetMaxInlineResultIndex() + 1;
-  size_t result_mem_size =
-      num_results_ > max_inline_result_num
-          ? sizeof(detail::OpOutlineResultImpl) *
-                    (num_results_ - max_inline_result_num) +
-                sizeof(detail::OpInlineResultImpl) * max_inline_result_num
-          : sizeof(detail::OpInlineResultImpl) * num_results_;
+  size_t result_mem_size = ResultMemSize(num_results_);
   void *aligned_ptr = reinterpret_cast<char *>(this) - result_mem_size;
 
   VLOG(6) << "Destroy Operation [" << name() << "]: {ptr = " << aligned_ptr
           << ", size = " << result_mem_size << "} done.";
-  aligned_free(aligned_ptr);
+  if (arena_) {
+    arena_->Deallocate(
+        aligned_ptr,
+        OperationMemSize(num_results_, num_operands_, num_regions_));
+  } else {
+    aligned_free(aligned_ptr);
+  }
 }
 
 IrContext *Operation::ir_context() const { return info_.ir_context(); }
@@ -25,6 +25,7 @@
 
 namespace ir {
 class OpBase;
+class OperationArena;
 class Program;
 class OpOperand;
 class OpResult;
@@ -36,13 +37,17 @@ class IR_API alignas(8) Operation final {
   /// OpResultImpls|Operation|OpOperandImpls.
   /// NOTE: Similar to new and delete, the destroy() and the create() need to be
   /// used in conjunction.
+  /// The memory is taken from the arena if it is not null, and the operation
+  /// must be destroyed before the arena.
   ///
   static Operation *Create(const std::vector<ir::OpResult> &inputs,
                            const AttributeMap &attributes,
                            const std::vector<ir::Type> &output_types,
                            ir::OpInfo op_info,
-                           size_t num_regions = 0);
-  static Operation *Create(OperationArgument &&op_argument);
+                           size_t num_regions = 0,
+                           OperationArena *arena = nullptr);
+  static Operation *Create(OperationArgument &&op_argument,
+                           OperationArena *arena = nullptr);
 
   ///
   /// \brief Destroy the operation objects and free memory by create().
@@ -167,6 +172,8 @@ class IR_API alignas(8) Operation final {
   const uint32_t num_regions_ = 0;
 
   Region *regions_{nullptr};
+  // the arena of the memory, null for the heap
+  OperationArena *arena_{nullptr};
   Block *parent_{nullptr};
   Block::iterator position_;
 };
@@ -0,0 +1,93 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/ir/core/operation_arena.h"
+
+#include <algorithm>
+#include <new>
+
+#include "paddle/ir/core/enforce.h"
+#include "paddle/ir/core/utils.h"
+
+namespace ir {
+OperationArena::~OperationArena() {
+  for (void *chunk : chunks_) {
+    aligned_free(chunk);
+  }
+}
+
+void *OperationArena::Allocate(size_t size) {
+  size = (std::max(size, sizeof(FreeNode)) + kAlignment - 1) / kAlignment *
+         kAlignment;
+  std::lock_guard<SpinLock> guard(lock_);
+  FreeNode **head = nullptr;
+  if (size <= kMaxSmallSize) {
+    if (size / kAlignment < small_free_lists_.size()) {
+      head = &small_free_lists_[size / kAlignment];
+    }
+  } else {
+    auto it = large_free_lists_.find(size);
+    if (it != large_free_lists_.end()) {
+      head = &it->second;
+    }
+  }
+  if (head && *head) {
+    FreeNode *node = *head;
+    *head = node->next;
+    return node;
+  }
+  if (static_cast<size_t>(end_ - cursor_) < size) {
+    // a large op takes a chunk of its own, the current chunk is kept
+    if (size > next_chunk_size_ / 4) {
+      return AllocateChunk(size);
+    }
+    cursor_ = reinterpret_cast<char *>(AllocateChunk(next_chunk_size_));
+    end_ = cursor_ + next_chunk_size_;
+    next_chunk_size_ = std::min(next_chunk_size_ * 2, kMaxChunkSize);
+  }
+  void *ptr = cursor_;
+  cursor_ += size;
+  return ptr;
+}
+
+void OperationArena::Deallocate(void *ptr, size_t size) {
+  if (!reuse_) {
+    return;
+  }
+  size = (std::max(size, sizeof(FreeNode)) + kAlignment - 1) / kAlignment *
+         kAlignment;
+  std::lock_guard<SpinLock> guard(lock_);
+  if (size <= kMaxSmallSize) {
+    if (size / kAlignment >= small_free_lists_.size()) {
+      small_free_lists_.resize(size / kAlignment + 1, nullptr);
+    }
+    FreeNode *&head = small_free_lists_[size / kAlignment];
+    head = new (ptr) FreeNode{head};
+  } else {
+    FreeNode *&head = large_free_lists_[size];
+    head = new (ptr) FreeNode{head};
+  }
+}
+
+void *OperationArena::AllocateChunk(size_t size) {
+  void *chunk = aligned_malloc(size, kAlignment);
+  IR_ENFORCE(chunk != nullptr,
+             "Failed to allocate %d bytes for the operation arena.",
+             size);
+  chunks_.push_back(chunk);
+  reserved_size_ += size;
+  return chunk;
+}
+
+}  // namespace ir
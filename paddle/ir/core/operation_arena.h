@@ -0,0 +1,85 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/ir/core/dll_decl.h"
+#include "paddle/ir/core/spin_lock.h"
+
+namespace ir {
+///
+/// \brief A bump allocator of the memory of the operations of a program, an
+/// operation packs its results, operands and regions in one allocation. The
+/// memory of a destroyed operation is kept for the next operation of the
+/// same size, all of it is released at once with the arena.
+///
+class IR_API OperationArena {
+ public:
+  OperationArena() = default;
+  ~OperationArena();
+  OperationArena(const OperationArena &) = delete;
+  OperationArena &operator=(const OperationArena &) = delete;
+
+  ///
+  /// \brief Allocates size bytes aligned to 8 bytes.
+  ///
+  void *Allocate(size_t size);
+
+  ///
+  /// \brief Returns the memory to the arena, the size must be the one it was
+  /// allocated with.
+  ///
+  void Deallocate(void *ptr, size_t size);
+
+  ///
+  /// \brief The freed memory is not kept any more, used before the arena is
+  /// released at once.
+  ///
+  void DisableReuse() { reuse_ = false; }
+
+  ///
+  /// \brief Bytes reserved from the system.
+  ///
+  size_t reserved_size() const { return reserved_size_; }
+
+ private:
+  static constexpr size_t kAlignment = 8;
+  static constexpr size_t kMinChunkSize = 64 * 1024;
+  static constexpr size_t kMaxChunkSize = 4 * 1024 * 1024;
+  // the free lists of the larger sizes are kept in a map
+  static constexpr size_t kMaxSmallSize = 4 * 1024;
+
+  struct FreeNode {
+    FreeNode *next;
+  };
+
+  void *AllocateChunk(size_t size);
+
+  std::vector<void *> chunks_;
+  char *cursor_{nullptr};
+  char *end_{nullptr};
+  size_t next_chunk_size_{kMinChunkSize};
+  size_t reserved_size_{0};
+  bool reuse_{true};
+  // the freed memory by size / kAlignment
+  std::vector<FreeNode *> small_free_lists_;
+  std::unordered_map<size_t, FreeNode *> large_free_lists_;
+  SpinLock lock_;
+};
+
+}  // namespace ir
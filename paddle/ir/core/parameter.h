@@ -50,6 +50,8 @@ class IR_API Parameter {
 
   void* data() const { return data_; }
 
+  size_t size() const { return size_; }
+
   bool is_mutable() const { return is_mutable_; }
 
   void set_mutable() { is_mutable_ = true; }
@@ -17,11 +17,18 @@
 
 namespace ir {
 
-Program::Program(IrContext* context) {
+Program::Program(IrContext* context, bool use_arena) {
+  if (use_arena) {
+    arena_ = std::make_unique<OperationArena>();
+  }
   module_ = ModuleOp::Create(context, this);
 }
 
 Program::~Program() {
+  if (arena_) {
+    // the memory of the ops is released with the arena
+    arena_->DisableReuse();
+  }
   if (module_) {
     module_.Destroy();
   }
@@ -23,6 +23,7 @@
 #include "paddle/ir/core/builtin_attribute.h"
 #include "paddle/ir/core/builtin_op.h"
 #include "paddle/ir/core/operation.h"
+#include "paddle/ir/core/operation_arena.h"
 #include "paddle/ir/core/parameter.h"
 
 namespace ir {
@@ -40,7 +41,12 @@ class IR_API Program {
  public:
   using ParameterMap =
       std::unordered_map<std::string, std::unique_ptr<Parameter>>;
-  explicit Program(IrContext* context);
+  ///
+  /// \brief With use_arena, the operations built into the program are
+  /// allocated from an arena owned by the program and released with it.
+  /// NOTE: Such an operation must not be moved to another program.
+  ///
+  explicit Program(IrContext* context, bool use_arena = false);
   Program(Program&&) = delete;
   Program(const Program& program) = delete;
   Program& operator=(const Program&) = delete;
@@ -50,6 +56,11 @@ class IR_API Program {
 
   ModuleOp module_op() const { return module_; }
 
+  ///
+  /// \brief The arena of the operations, null if the program has none.
+  ///
+  OperationArena* arena() const { return arena_.get(); }
+
   void Print(std::ostream& os) const;
 
   Block* block() { return module_.block(); }
@@ -60,11 +71,13 @@ class IR_API Program {
                     std::unique_ptr<Parameter>&& parameter);
 
   ParameterMap& parameters() { return parameters_; }
+  const ParameterMap& parameters() const { return parameters_; }
   void set_parameters(ParameterMap&& parameters) {
     parameters_ = std::move(parameters);
   }
 
  private:
+  std::unique_ptr<OperationArena> arena_;
   // computation graph
   ModuleOp module_;
   // weight
@@ -14,6 +14,14 @@
 
 #include "paddle/ir/pass/pass.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
 #include "paddle/ir/core/ir_context.h"
 #include "paddle/ir/core/operation.h"
 #include "paddle/ir/core/program.h"
@@ -25,6 +33,93 @@
 
 namespace ir {
 
+//===----------------------------------------------------------------------===//
+// PassThreadPool
+//===----------------------------------------------------------------------===//
+namespace detail {
+// The threads running the pipelines of the nested ops, the caller of Run is
+// the thread 0 and takes tasks too.
+class PassThreadPool {
+ public:
+  using Task = std::function<void(size_t task_id, int thread_id)>;
+
+  explicit PassThreadPool(int num_threads) : num_threads_(num_threads) {
+    for (int i = 1; i < num_threads; ++i) {
+      threads_.emplace_back([this, i] { WorkerLoop(i); });
+    }
+  }
+
+  ~PassThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  int num_threads() const { return num_threads_; }
+
+  // Runs task(task_id, thread_id) for all the task_id in [0, num_tasks) and
+  // returns when they are done.
+  void Run(size_t num_tasks, const Task& task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    busy_threads_ = num_threads_ - 1;
+    ++generation_;
+    lock.unlock();
+    cv_.notify_all();
+
+    RunTasks(0);
+
+    lock.lock();
+    done_cv_.wait(lock, [this] { return busy_threads_ == 0; });
+    task_ = nullptr;
+  }
+
+ private:
+  void RunTasks(int thread_id) {
+    for (size_t id = next_task_++; id < num_tasks_; id = next_task_++) {
+      (*task_)(id, thread_id);
+    }
+  }
+
+  void WorkerLoop(int thread_id) {
+    uint64_t seen = 0;
+    for (;;) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+      lock.unlock();
+
+      RunTasks(thread_id);
+
+      lock.lock();
+      if (--busy_threads_ == 0) {
+        done_cv_.notify_one();
+      }
+    }
+  }
+
+  const int num_threads_;
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  const Task* task_{nullptr};
+  size_t num_tasks_{0};
+  std::atomic<size_t> next_task_{0};
+  int busy_threads_{0};
+  uint64_t generation_{0};
+  bool stop_{false};
+};
+}  // namespace detail
+
 //===----------------------------------------------------------------------===//
 // Pass
 //===----------------------------------------------------------------------===//
@@ -44,6 +139,19 @@ void detail::PassAdaptor::RunImpl(Operation* op,
                                   bool verify) {
   auto last_am = analysis_manager();
 
+  if (!pm_->thread_pipelines_.empty()) {
+    std::vector<Operation*> ops;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (auto* block : op->region(i)) {
+        ops.insert(ops.end(), block->begin(), block->end());
+      }
+    }
+    if (ops.size() > 1) {
+      return RunParallel(
+          ops, last_am.GetPassInstrumentor(), opt_level, verify);
+    }
+  }
+
   for (size_t i = 0; i < op->num_regions(); ++i) {
     auto& region = op->region(i);
     for (auto it = region.begin(); it != region.end(); ++it) {
@@ -59,6 +167,37 @@ void detail::PassAdaptor::RunImpl(Operation* op,
   return;
 }
 
+void detail::PassAdaptor::RunParallel(const std::vector<Operation*>& ops,
+                                      PassInstrumentor* instrumentor,
+                                      uint8_t opt_level,
+                                      bool verify) {
+  // The failures are reported in the order of the ops, so they do not depend
+  // on the threads either.
+  std::vector<char> succeeded(ops.size(), false);
+  std::vector<std::exception_ptr> errors(ops.size());
+  pm_->thread_pool_->Run(ops.size(), [&](size_t task_id, int thread_id) {
+    try {
+      // The analyses of an op are cached by the thread running it.
+      AnalysisManagerHolder am(ops[task_id], instrumentor);
+      succeeded[task_id] = RunPipeline(*pm_->thread_pipelines_[thread_id],
+                                       ops[task_id],
+                                       am,
+                                       opt_level,
+                                       verify);
+    } catch (...) {
+      errors[task_id] = std::current_exception();
+    }
+  });
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (errors[i]) {
+      std::rethrow_exception(errors[i]);
+    }
+    if (!succeeded[i]) {
+      return SignalPassFailure();
+    }
+  }
+}
+
 bool detail::PassAdaptor::RunPipeline(const PassManager& pm,
                                       Operation* op,
                                       AnalysisManager am,
@@ -126,11 +265,18 @@ PassManager::PassManager(IrContext* context, uint8_t opt_level)
   pass_adaptor_ = std::make_unique<detail::PassAdaptor>(this);
 }
 
+PassManager::~PassManager() = default;
+
 bool PassManager::Run(Program* program) {
   if (!Initialize(context_)) {
     return false;
   }
-  return Run(program->module_op());
+  if (thread_pool_ && !InitializeThreadPipelines()) {
+    return false;
+  }
+  bool succeeded = Run(program->module_op());
+  thread_pipelines_.clear();
+  return succeeded;
 }
 
 bool PassManager::Run(Operation* op) {
@@ -148,6 +294,37 @@ bool PassManager::Initialize(IrContext* context) {
   return true;
 }
 
+void PassManager::EnableMultiThreading(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+  }
+  thread_pool_ = num_threads > 1
+                     ? std::make_unique<detail::PassThreadPool>(num_threads)
+                     : nullptr;
+}
+
+bool PassManager::InitializeThreadPipelines() {
+  thread_pipelines_.clear();
+  std::vector<std::unique_ptr<PassManager>> pipelines;
+  for (int i = 0; i < thread_pool_->num_threads(); ++i) {
+    auto pm = std::make_unique<PassManager>(context_, opt_level_);
+    pm->verify_ = verify_;
+    for (auto& pass : passes()) {
+      std::unique_ptr<Pass> clone = pass->Clone();
+      if (!clone) {
+        VLOG(3) << "The pass " << pass->name()
+                << " can not be cloned, run the nested ops on one thread.";
+        return true;
+      }
+      pm->AddPass(std::move(clone));
+    }
+    if (!pm->Initialize(context_)) return false;
+    pipelines.emplace_back(std::move(pm));
+  }
+  thread_pipelines_ = std::move(pipelines);
+  return true;
+}
+
 void PassManager::AddInstrumentation(std::unique_ptr<PassInstrumentation> pi) {
   if (!instrumentor_) instrumentor_ = std::make_unique<PassInstrumentor>();
 
@@ -159,7 +336,9 @@ void PassManager::AddInstrumentation(std::unique_ptr<PassInstrumentation> pi) {
 //----------------------------------------------------------------------------------------------//
 namespace detail {
 struct PassInstrumentorImpl {
-  // TODO(wilber): Support multi-thread.
+  // The callbacks from the threads of a multithreaded PassManager are run
+  // one at a time.
+  std::mutex mutex;
   std::vector<std::unique_ptr<PassInstrumentation>> instrumentations;
 };
 }  // namespace detail
@@ -171,6 +350,7 @@ PassInstrumentor::~PassInstrumentor() = default;
 
 void PassInstrumentor::RunBeforePipeline(Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforePipeline(op);
   }
@@ -178,6 +358,7 @@ void PassInstrumentor::RunBeforePipeline(Operation* op) {
 
 void PassInstrumentor::RunAfterPipeline(Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
@@ -187,6 +368,7 @@ void PassInstrumentor::RunAfterPipeline(Operation* op) {
 
 void PassInstrumentor::RunBeforePass(Pass* pass, Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforePass(pass, op);
   }
@@ -194,6 +376,7 @@ void PassInstrumentor::RunBeforePass(Pass* pass, Operation* op) {
 
 void PassInstrumentor::RunAfterPass(Pass* pass, Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
@@ -205,6 +388,7 @@ void PassInstrumentor::RunBeforeAnalysis(const std::string& name,
                                          TypeId id,
                                          Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   for (auto& instr : impl_->instrumentations) {
     instr->RunBeforeAnalysis(name, id, op);
   }
@@ -214,6 +398,7 @@ void PassInstrumentor::RunAfterAnalysis(const std::string& name,
                                         TypeId id,
                                         Operation* op) {
   if (op->num_regions() == 0) return;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   for (auto it = impl_->instrumentations.rbegin();
        it != impl_->instrumentations.rend();
        ++it) {
@@ -223,6 +408,7 @@ void PassInstrumentor::RunAfterAnalysis(const std::string& name,
 
 void PassInstrumentor::AddInstrumentation(
     std::unique_ptr<PassInstrumentation> pi) {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->instrumentations.emplace_back(std::move(pi));
 }
 
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -88,6 +89,10 @@ class IR_API Pass {
 
   virtual bool Initialize(IrContext* context) { return true; }
 
+  /// Returns a new instance of the pass for another thread of a multithreaded
+  /// PassManager, or nullptr if the pass can only run on one thread.
+  virtual std::unique_ptr<Pass> Clone() const { return nullptr; }
+
   AnalysisManager analysis_manager() { return pass_state().am; }
 
   detail::PassExecutionState& pass_state() {
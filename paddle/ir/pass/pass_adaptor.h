@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "paddle/ir/pass/pass.h"
 
 namespace ir {
@@ -34,6 +36,12 @@ class PassAdaptor final : public Pass {
  private:
   void RunImpl(Operation* op, uint8_t opt_level, bool verify);
 
+  // Runs the pipelines of the ops on the threads of the pass manager.
+  void RunParallel(const std::vector<Operation*>& ops,
+                   PassInstrumentor* instrumentor,
+                   uint8_t opt_level,
+                   bool verify);
+
   static bool RunPass(Pass* pass,
                       Operation* op,
                       AnalysisManager am,
@@ -32,13 +32,14 @@ class PassInstrumentor;
 
 namespace detail {
 class PassAdaptor;
-}
+class PassThreadPool;
+}  // namespace detail
 
 class IR_API PassManager {
  public:
   explicit PassManager(IrContext *context, uint8_t opt_level = 2);
 
-  ~PassManager() = default;
+  ~PassManager();
 
   const std::vector<std::unique_ptr<Pass>> &passes() const { return passes_; }
 
@@ -117,9 +118,24 @@ class IR_API PassManager {
 
   void AddInstrumentation(std::unique_ptr<PassInstrumentation> pi);
 
+  ///
+  /// \brief Runs the pipelines of the ops nested in an op on num_threads
+  /// threads, all the cores if num_threads is 0. Each thread runs a clone of
+  /// the passes, so all the passes must implement Clone, otherwise the ops
+  /// are run one by one. The pipeline of a nested op must only change the op
+  /// itself, not the uses of the values defined out of it, then the result
+  /// does not depend on the number of threads. Only the dialects with
+  /// function-like ops gain from it, no op of the builtin and paddle
+  /// dialects but the module has regions yet.
+  ///
+  void EnableMultiThreading(int num_threads = 0);
+
  private:
   bool Initialize(IrContext *context);
 
+  // Clones the pipeline for each thread, false if a pass can not be cloned.
+  bool InitializeThreadPipelines();
+
   bool Run(Operation *op);
 
  private:
@@ -135,6 +151,11 @@ class IR_API PassManager {
 
   std::unique_ptr<PassInstrumentor> instrumentor_;
 
+  std::unique_ptr<detail::PassThreadPool> thread_pool_;
+
+  // The pipeline run by each thread of the thread pool.
+  std::vector<std::unique_ptr<PassManager>> thread_pipelines_;
+
   // For access member of pass_adaptor_.
   friend class detail::PassAdaptor;
 };
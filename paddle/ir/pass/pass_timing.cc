@@ -14,6 +14,7 @@
 
 #include <chrono>
 #include <iomanip>
+#include <map>
 #include <ostream>
 #include <string>
 #include <unordered_map>
@@ -36,6 +37,8 @@ class Timer {
 
   void Stop() { walk_time += std::chrono::steady_clock::now() - start_time_; }
 
+  void Add(const Timer& other) { walk_time += other.walk_time; }
+
   double GetTimePerSecond() const {
     return std::chrono::duration_cast<std::chrono::duration<double>>(walk_time)
         .count();
@@ -51,15 +54,26 @@ class Timer {
 class PassTimer : public PassInstrumentation {
  public:
   explicit PassTimer(bool print_module) : print_module_(print_module) {}
-  ~PassTimer() override = default;
+  ~PassTimer() override { PrintNestedTime(std::cout); }
 
   void RunBeforePipeline(ir::Operation* op) override {
+    if (!op->GetParentOp()) PrintNestedTime(std::cout);
     pipeline_timers_[op] = Timer();
     pipeline_timers_[op].Start();
   }
 
   void RunAfterPipeline(Operation* op) override {
     pipeline_timers_[op].Stop();
+    if (op->GetParentOp()) {
+      nested_pipeline_timer_.Add(pipeline_timers_[op]);
+      ++num_nested_pipelines_;
+      nested_wall_timer_.Stop();
+      nested_wall_timer_.Start();
+    } else {
+      // The pipelines of the nested ops run right after.
+      nested_wall_timer_ = Timer();
+      nested_wall_timer_.Start();
+    }
     PrintTime(op, std::cout);
   }
 
@@ -73,6 +87,9 @@ class PassTimer : public PassInstrumentation {
 
   void RunAfterPass(Pass* pass, Operation* op) override {
     pass_timers_[op][pass->name()].Stop();
+    if (op->GetParentOp()) {
+      nested_pass_timers_[pass->name()].Add(pass_timers_[op][pass->name()]);
+    }
   }
 
  private:
@@ -107,6 +124,33 @@ class PassTimer : public PassInstrumentation {
     }
   }
 
+  // The pipelines of the nested ops of a top-level op run after its own
+  // pipeline, maybe on several threads. Their summed time against the time
+  // from the end of the top-level pipeline to the last of them shows the
+  // speedup.
+  void PrintNestedTime(std::ostream& os) {
+    if (num_nested_pipelines_ == 0) return;
+
+    detail::PrintHeader("PassTiming on nested ops", os);
+    os << "  Total Execution Time: " << std::fixed << std::setprecision(3)
+       << nested_wall_timer_.GetTimePerSecond() << " seconds\n";
+    os << "  Pipelines Time: " << nested_pipeline_timer_.GetTimePerSecond()
+       << " seconds on " << num_nested_pipelines_ << " ops ("
+       << std::setprecision(2)
+       << nested_pipeline_timer_.GetTimePerSecond() /
+              nested_wall_timer_.GetTimePerSecond()
+       << "x the total time)\n\n";
+    os << "  ----Walk Time----  ----Name----\n";
+    for (auto& v : nested_pass_timers_) {
+      os << "  " << std::fixed << std::setw(8) << std::setprecision(3)
+         << v.second.GetTimePerSecond() << "  " << v.first << "\n";
+    }
+    nested_wall_timer_ = Timer();
+    nested_pipeline_timer_ = Timer();
+    num_nested_pipelines_ = 0;
+    nested_pass_timers_.clear();
+  }
+
  private:
   bool print_module_;
 
@@ -115,6 +159,13 @@ class PassTimer : public PassInstrumentation {
   std::unordered_map<Operation*,
                      std::unordered_map<std::string /*pass name*/, Timer>>
       pass_timers_;
+
+  // The times of the pipelines and passes on the nested ops, summed, and the
+  // time they take all together.
+  Timer nested_wall_timer_;
+  Timer nested_pipeline_timer_;
+  size_t num_nested_pipelines_{0};
+  std::map<std::string /*pass name*/, Timer> nested_pass_timers_;
 };
 
 void PassManager::EnablePassTiming(bool print_module) {
@@ -1140,6 +1140,19 @@ PHI_DEFINE_EXPORTED_bool(nccl_blocking_wait, false, "nccl blocking wait");
  */
 PHI_DEFINE_EXPORTED_bool(use_autotune, false, "Whether enable autotune.");
 
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_cpu_autotune_cache_file
+ * Since Version: 2.5.0
+ * Value Range: string, default=""
+ * Example: FLAGS_cpu_autotune_cache_file=/path/to/autotune_cache
+ * Note: The algorithms tuned on cpu are loaded from and saved to this file,
+ * so that they are not tuned again after the process restarts.
+ */
+PHI_DEFINE_EXPORTED_string(cpu_autotune_cache_file,
+                           "",
+                           "The file to keep the algorithms tuned on cpu.");
+
 /**
  * Conv Search cache max number related FLAG
  * Name: FLAGS_search_cache_max_number
@@ -1268,3 +1281,18 @@ PHI_DEFINE_EXPORTED_string(tensor_operants_mode,
 PHI_DEFINE_EXPORTED_bool(enable_new_ir_in_executor,
                          false,
                          "Enable new IR in executor");
+
+/**
+ * Eager backward related FLAG
+ * Name: eager_backward_num_threads
+ * Since Version: 2.6.0
+ * Value Range: int32, default=1
+ * Example: FLAGS_eager_backward_num_threads=8 would run the ready GradNodes
+ *          of a backward pass on 8 threads.
+ * Note: Only the backward on CPU without create_graph and inputs runs on
+ *       several threads, the hooks of its GradNodes must be thread safe.
+ */
+PHI_DEFINE_EXPORTED_int32(eager_backward_num_threads,
+                          1,
+                          "The number of threads running the GradNodes of "
+                          "the backward on CPU, 1 runs them in order.");
@@ -14,10 +14,15 @@
 
 #pragma once
 
+#include <chrono>
+#include <limits>
 #include <type_traits>
 #include "glog/logging.h"
-#include "paddle/phi/kernels/autotune/gpu_timer.h"
+#include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/kernels/autotune/gpu_timer.h"
+#endif
 
 namespace phi {
 namespace autotune {
@@ -69,6 +74,10 @@ class AutoTuneBase {
            Args&&... args) {
     is_init_ = true;
     CheckKernelSize();
+    constexpr bool is_cpu = std::is_same<Context, phi::CPUContext>::value;
+    if (is_cpu) {
+      AutoTuneCache::Instance().LoadCpuCache();
+    }
     auto& cache = AutoTuneCache::Instance().Get(algo);
     if (cache.Find(key)) {
       auto best_idx = cache.Get(key);
@@ -80,6 +89,9 @@ class AutoTuneBase {
         // so there may be no need for another kernel run.
         auto best_idx = PickBestKernel(ctx, args...);
         cache.Set(key, best_idx);
+        if (is_cpu) {
+          AutoTuneCache::Instance().UpdateCpuCache();
+        }
       } else {
         kernels_[0].Run(args...);
       }
@@ -122,20 +134,36 @@ class AutoTuneBase {
     // Regard 1st run as warmup, judge the compare result by the time cost
     // of rest cycles.
     constexpr int repeats = 11;
-    phi::GpuTimer timer;
     float time_cost = 0;
-    const auto& stream = ctx.stream();
-
-    ctx.Wait();
-    for (int i = 0; i < repeats; ++i) {
-      timer.Start(stream);
-      kernels_[idx].Run(args...);
-      timer.Stop(stream);
-      auto time = timer.ElapsedTime();
-      if (i > 0) {
-        time_cost += time;
+    if constexpr (std::is_same<Context, phi::CPUContext>::value) {
+      for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        kernels_[idx].Run(args...);
+        std::chrono::duration<float, std::milli> time =
+            std::chrono::steady_clock::now() - start;
+        if (i > 0) {
+          time_cost += time.count();
+        }
+        VLOG(3) << "kernel[" << idx << "][" << i << "th time cost is "
+                << time.count();
+      }
+    } else {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+      phi::GpuTimer timer;
+      const auto& stream = ctx.stream();
+
+      ctx.Wait();
+      for (int i = 0; i < repeats; ++i) {
+        timer.Start(stream);
+        kernels_[idx].Run(args...);
+        timer.Stop(stream);
+        auto time = timer.ElapsedTime();
+        if (i > 0) {
+          time_cost += time;
+        }
+        VLOG(3) << "kernel[" << idx << "][" << i << "th time cost is " << time;
       }
-      VLOG(3) << "kernel[" << idx << "][" << i << "th time cost is " << time;
+#endif
     }
     return time_cost;
   }
@@ -177,6 +205,7 @@ class MatmulAutoTuner
   }
 };
 
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 template <bool TransposeA,
           bool TransposeB,
           typename T,
@@ -284,6 +313,7 @@ MakeGatherGemmScatterTuner(ReturnType (*func)(T, T, Args...)) {
                                     ReturnType,
                                     Args...>::Instance(func);
 }
+#endif
 
 // Define the auto_tuner inital object.
 #define DEFINE_AUTOTUNER_COMMON_OBJ(name)                                \
@@ -319,6 +349,8 @@ MakeGatherGemmScatterTuner(ReturnType (*func)(T, T, Args...)) {
 
 DEFINE_AUTOTUNER(Transpose)
 DEFINE_AUTOTUNER_FN(Matmul)
+DEFINE_AUTOTUNER(CpuMatmul)
+DEFINE_AUTOTUNER(CpuSoftmax)
 
 #undef DEFINE_AUTOTUNER_COMMON_OBJECT
 #undef DEFINE_AUTOTUNER_FN
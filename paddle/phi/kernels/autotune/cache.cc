@@ -14,13 +14,25 @@
 
 #include "paddle/phi/kernels/autotune/cache.h"
 
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iomanip>
+#include <sstream>
 
 #include "glog/logging.h"
 
+PHI_DECLARE_string(cpu_autotune_cache_file);
+
 namespace phi {
 namespace autotune {
 
+// Only the algorithms tuned on cpu are saved, their keys are hashed from
+// the shapes and dtype and are stable between processes of the same build.
+static const AlgorithmType kCpuAlgorithmTypes[] = {AlgorithmType::kCpuMatmul,
+                                                   AlgorithmType::kCpuSoftmax};
+static const char kCpuCacheVersion[] = "paddle_cpu_autotune_cache_v1";
+
 size_t TransposeKey(const std::vector<int64_t>& x_dims,
                     const std::vector<int32_t>& perm,
                     phi::DataType dtype) {
@@ -28,6 +40,20 @@ size_t TransposeKey(const std::vector<int64_t>& x_dims,
   return GenKey(x_dims, perm, rank, static_cast<int>(dtype));
 }
 
+size_t CpuMatmulKey(const std::vector<int64_t>& x_dims,
+                    const std::vector<int64_t>& y_dims,
+                    bool trans_x,
+                    bool trans_y,
+                    phi::DataType dtype) {
+  return GenKey(x_dims, y_dims, trans_x, trans_y, static_cast<int>(dtype));
+}
+
+size_t CpuSoftmaxKey(int64_t batch_size,
+                     int64_t num_classes,
+                     phi::DataType dtype) {
+  return GenKey(batch_size, num_classes, static_cast<int>(dtype));
+}
+
 std::string AlgorithmTypeString(int64_t algo_type) {
   if (algo_type == static_cast<int64_t>(AlgorithmType::kConvForward)) {
     return "conv_forward";
@@ -37,6 +63,10 @@ std::string AlgorithmTypeString(int64_t algo_type) {
   } else if (algo_type ==
              static_cast<int64_t>(AlgorithmType::kConvBackwardFilter)) {
     return "conv_backward_filter";
+  } else if (algo_type == static_cast<int64_t>(AlgorithmType::kCpuMatmul)) {
+    return "cpu_matmul";
+  } else if (algo_type == static_cast<int64_t>(AlgorithmType::kCpuSoftmax)) {
+    return "cpu_softmax";
   }
 #ifdef PADDLE_WITH_CUDNN_FRONTEND
   if (algo_type == static_cast<int64_t>(AlgorithmType::kConvForwardV8)) {
@@ -101,5 +131,113 @@ void AutoTuneCache::UpdateStatus() {
   total_cache_misses_ = cache_misses;
 }
 
+// The cpu model is read from /proc/cpuinfo, the tuned algorithms are not
+// reused on other cpus.
+static std::string CpuModelName() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      auto pos = line.find(':');
+      if (pos != std::string::npos) {
+        auto begin = line.find_first_not_of(' ', pos + 1);
+        return begin == std::string::npos ? "" : line.substr(begin);
+      }
+    }
+  }
+  return "unknown";
+}
+
+void AutoTuneCache::LoadCpuCache() {
+  std::call_once(cpu_cache_load_flag_, [this] {
+    // the results tuned since the last save are written at exit
+    std::atexit([] { AutoTuneCache::Instance().SaveCpuCache(); });
+    const std::string& path = FLAGS_cpu_autotune_cache_file;
+    if (path.empty()) {
+      return;
+    }
+    std::ifstream fin(path);
+    if (!fin) {
+      VLOG(3) << "No cpu autotune cache in " << path;
+      return;
+    }
+    std::string version, cpu_model;
+    if (!std::getline(fin, version) || version != kCpuCacheVersion ||
+        !std::getline(fin, cpu_model) || cpu_model != CpuModelName()) {
+      LOG(WARNING) << "Skip the cpu autotune cache " << path
+                   << ", which is saved by another version or cpu model.";
+      return;
+    }
+    int64_t algo_type = 0;
+    size_t key = 0;
+    int64_t algo = 0;
+    int64_t count = 0;
+    while (fin >> algo_type >> key >> algo) {
+      bool is_cpu_type = false;
+      for (auto cpu_type : kCpuAlgorithmTypes) {
+        is_cpu_type |= algo_type == static_cast<int64_t>(cpu_type);
+      }
+      if (!is_cpu_type) {
+        continue;
+      }
+      Get(static_cast<AlgorithmType>(algo_type)).Set(key, algo);
+      ++count;
+    }
+    VLOG(3) << "Load " << count << " cpu autotune results from " << path;
+    std::lock_guard<std::mutex> lock(cpu_cache_mutex_);
+    cpu_cache_saved_ = count;
+  });
+}
+
+void AutoTuneCache::UpdateCpuCache() {
+  if (FLAGS_cpu_autotune_cache_file.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(cpu_cache_mutex_);
+    if (++cpu_cache_unsaved_ < cpu_cache_saved_) {
+      return;
+    }
+  }
+  SaveCpuCache();
+}
+
+void AutoTuneCache::SaveCpuCache() {
+  const std::string& path = FLAGS_cpu_autotune_cache_file;
+  if (path.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cpu_cache_mutex_);
+  if (cpu_cache_unsaved_ == 0) {
+    return;
+  }
+  std::ostringstream out;
+  out << kCpuCacheVersion << "\n" << CpuModelName() << "\n";
+  int64_t count = 0;
+  for (auto cpu_type : kCpuAlgorithmTypes) {
+    for (auto& item : Get(cpu_type).Items()) {
+      out << static_cast<int64_t>(cpu_type) << " " << item.first << " "
+          << item.second << "\n";
+      ++count;
+    }
+  }
+  cpu_cache_saved_ = count;
+  cpu_cache_unsaved_ = 0;
+  // write a temporary file and rename it, so that a reader never sees a
+  // partial cache
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream fout(tmp_path, std::ios::trunc);
+    fout << out.str();
+    if (!fout) {
+      LOG(WARNING) << "Failed to write the cpu autotune cache " << tmp_path;
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to save the cpu autotune cache " << path;
+  }
+}
+
 }  // namespace autotune
 }  // namespace phi
@@ -15,7 +15,9 @@
 #pragma once
 
 #include <algorithm>
+#include <mutex>
 #include <numeric>
+#include <string>
 
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/kernels/autotune/cache_base.h"
@@ -50,15 +52,29 @@ enum class AlgorithmType {
   kGatherGemmScatterFP32TN = 8,
   kGatherGemmScatterFP32NT = 9,
 #if !defined(PADDLE_WITH_CUDNN_FRONTEND)
-  kAlgorithmCount = 10
+  kCpuMatmul = 10,
+  kCpuSoftmax = 11,
+  kAlgorithmCount = 12
 #else
   kConvForwardV8 = 10,
   kConvBackwardDataV8 = 11,
   kConvBackwardFilterV8 = 12,
-  kAlgorithmCount = 13
+  kCpuMatmul = 13,
+  kCpuSoftmax = 14,
+  kAlgorithmCount = 15
 #endif
 };
 
+size_t CpuMatmulKey(const std::vector<int64_t>& x_dims,
+                    const std::vector<int64_t>& y_dims,
+                    bool trans_x,
+                    bool trans_y,
+                    phi::DataType dtype);
+
+size_t CpuSoftmaxKey(int64_t batch_size,
+                     int64_t num_classes,
+                     phi::DataType dtype);
+
 // AlgorithmsConfigKey -> AlgorithmsID
 // AlgorithmType -> AlgorithmsCache
 using AlgorithmsCacheMap = AlgorithmsCache<size_t, int64_t>;
@@ -143,6 +159,17 @@ class AutoTuneCache {
 
   void UpdateStatus();
 
+  // The algorithms tuned on cpu (kCpuMatmul, kCpuSoftmax) are kept in
+  // FLAGS_cpu_autotune_cache_file if it is set, so that they survive the
+  // restart of process. The file is only loaded on the same cpu model.
+  void LoadCpuCache();
+  // Called after an algorithm is tuned on cpu. The file is only rewritten
+  // once the unsaved results are as many as the saved ones, so that the
+  // writes stay linear in the number of results.
+  void UpdateCpuCache();
+  // Writes the unsaved results, it is called at exit.
+  void SaveCpuCache();
+
   // The number of total config cached
   int64_t Size() const { return total_size_; }
 
@@ -203,6 +230,10 @@ class AutoTuneCache {
   CudnnV8AlgorithmsTypeMap cudnn_v8_auto_tune_map_;
 #endif
   std::shared_ptr<std::mutex> autotune_cache_mutex_;
+  std::once_flag cpu_cache_load_flag_;
+  std::mutex cpu_cache_mutex_;
+  int64_t cpu_cache_saved_{0};
+  int64_t cpu_cache_unsaved_{0};
   int64_t total_cache_hits_{0};
   int64_t total_cache_misses_{0};
   int64_t total_size_{0};
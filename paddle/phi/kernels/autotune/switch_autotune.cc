@@ -18,6 +18,7 @@
 #include "glog/logging.h"
 
 DECLARE_bool(use_autotune);
+DECLARE_string(cpu_autotune_cache_file);
 
 namespace phi {
 namespace autotune {
@@ -33,6 +34,10 @@ void AutoTuneStatus::DisableAutoTune() {
   Init();
 }
 
+bool AutoTuneStatus::UseCpuAutoTune() {
+  return FLAGS_use_autotune || !FLAGS_cpu_autotune_cache_file.empty();
+}
+
 void AutoTuneStatus::Update() {
   current_steps_id_ += 1;
   if (!FLAGS_use_autotune) {
@@ -30,6 +30,10 @@ class AutoTuneStatus {
 
   bool UseAutoTune() { return use_autotune_; }
 
+  // The cpu tuners are only worth their lookups if autotune is enabled or
+  // the cpu algorithms are cached in FLAGS_cpu_autotune_cache_file.
+  bool UseCpuAutoTune();
+
   // EnableAutoTune and DisableAutoTune should be used for debug only.
   void EnableAutoTune();
   void DisableAutoTune();
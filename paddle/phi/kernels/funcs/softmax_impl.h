@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <vector>
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
@@ -21,6 +22,7 @@ limitations under the License. */
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/autotune/auto_tune_base.h"
 #include "paddle/phi/kernels/funcs/cpu_vec.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 
@@ -230,6 +232,44 @@ template <class DeviceContext>
 using enable_if_CPU = typename std::enable_if<
     std::is_same<DeviceContext, phi::CPUContext>::value>::type;
 
+// softmax along the last dim with the avx vector functions
+template <typename T>
+void SoftmaxLastDimVec(const phi::CPUContext& context UNUSED,
+                       const int axis_dim UNUSED,
+                       const phi::DenseTensor* X,
+                       phi::DenseTensor* Y) {
+  const auto& in_dims = X->dims();
+  const int num_classes = in_dims[1];
+  const int batch_size = in_dims[0];
+  const T* in_data = X->data<T>();
+  T* out_data = Y->data<T>();
+  for (int bs = 0; bs < batch_size; ++bs) {
+    T max_val = *std::max_element(in_data, in_data + num_classes);
+    max_val *= static_cast<T>(-1);
+    vec_add_bias<T, phi::backends::cpu::avx>(
+        num_classes, max_val, in_data, out_data);
+    vec_clip<T, phi::backends::cpu::avx>(
+        num_classes, static_cast<T>(-64), out_data, out_data);
+    vec_exp<T>(num_classes, out_data, out_data);
+
+    T sum = 0;
+    vec_sum<T, phi::backends::cpu::avx>(num_classes, out_data, &sum);
+    sum = static_cast<T>(1) / sum;
+    vec_scal<T, phi::backends::cpu::avx>(num_classes, sum, out_data, out_data);
+
+    in_data += num_classes;
+    out_data += num_classes;
+  }
+}
+
+template <typename T>
+void SoftmaxLastDimEigen(const phi::CPUContext& context,
+                         const int axis_dim,
+                         const phi::DenseTensor* X,
+                         phi::DenseTensor* Y) {
+  SoftmaxEigen<phi::CPUContext, T>()(context, axis_dim, X, Y);
+}
+
 template <typename DeviceContext, typename T>
 class SoftmaxFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
  public:
@@ -247,25 +287,34 @@ class SoftmaxFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
 
     if (num_remain == 1 &&
         phi::backends::cpu::MayIUse(phi::backends::cpu::avx)) {
-      const T* in_data = X->data<T>();
-      T* out_data = Y->data<T>();
-      for (int bs = 0; bs < batch_size; ++bs) {
-        T max_val = *std::max_element(in_data, in_data + num_classes);
-        max_val *= static_cast<T>(-1);
-        vec_add_bias<T, phi::backends::cpu::avx>(
-            num_classes, max_val, in_data, out_data);
-        vec_clip<T, phi::backends::cpu::avx>(
-            num_classes, static_cast<T>(-64), out_data, out_data);
-        vec_exp<T>(num_classes, out_data, out_data);
-
-        T sum = 0;
-        vec_sum<T, phi::backends::cpu::avx>(num_classes, out_data, &sum);
-        sum = static_cast<T>(1) / sum;
-        vec_scal<T, phi::backends::cpu::avx>(
-            num_classes, sum, out_data, out_data);
-
-        in_data += num_classes;
-        out_data += num_classes;
+      if (phi::autotune::AutoTuneStatus::Instance().UseCpuAutoTune()) {
+        // the vector functions win on long rows, eigen may win on many
+        // short rows
+        auto* tuner =
+            phi::autotune::MakeCpuSoftmaxTuner<T>(SoftmaxLastDimVec<T>);
+        tuner->AddCallBack(SoftmaxLastDimEigen<T>);
+        size_t key = phi::autotune::CpuSoftmaxKey(
+            batch_size, num_classes, phi::CppTypeToDataType<T>::Type());
+        // tuning runs every candidate several times, an inplace softmax
+        // would read its own output from the second run on
+        phi::DenseTensor x_copy;
+        const phi::DenseTensor* tune_x = X;
+        if (X->data<T>() == Y->data<T>() &&
+            phi::autotune::AutoTuneStatus::Instance().UseAutoTune()) {
+          x_copy.Resize(X->dims());
+          T* x_copy_data = context.template Alloc<T>(&x_copy);
+          std::copy(X->data<T>(), X->data<T>() + X->numel(), x_copy_data);
+          tune_x = &x_copy;
+        }
+        tuner->Run(context,
+                   phi::autotune::AlgorithmType::kCpuSoftmax,
+                   key,
+                   context,
+                   axis_dim,
+                   tune_x,
+                   Y);
+      } else {
+        SoftmaxLastDimVec<T>(context, axis_dim, X, Y);
       }
     } else {
       SoftmaxEigen<DeviceContext, T>()(context, axis_dim, X, Y);
@@ -94,6 +94,9 @@ inline SparseBlasT<DeviceContext, T> GetSparseBlas(
 }  // namespace funcs
 }  // namespace phi
 
+#if !defined(__NVCC__) && !defined(__HIPCC__)
+#include "paddle/phi/kernels/funcs/sparse/sparse_blas_impl.h"
+#endif
 #if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 11000
 #include "paddle/phi/kernels/funcs/sparse/sparse_blas_impl.cu.h"
 #endif
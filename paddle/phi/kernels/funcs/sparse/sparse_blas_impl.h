@@ -0,0 +1,411 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/ddim.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/macros.h"
+#include "paddle/phi/core/sparse_coo_tensor.h"
+#include "paddle/phi/core/sparse_csr_tensor.h"
+#include "paddle/phi/core/visit_type.h"
+
+namespace phi {
+namespace funcs {
+namespace sparse {
+
+// CPU implementation of SparseBlas on SparseCsrTensor. 2-D matrices and
+// batches of 3-D matrices are supported, the batches are computed
+// independently and rows are spread over the omp threads.
+
+// Columns of the dense operands are processed in blocks of kCpuSpmmBlockN
+// so that the block of the output row stays in L1 while all non-zeros of
+// the sparse row are accumulated into it.
+constexpr int64_t kCpuSpmmBlockN = 256;
+
+struct CsrMatrixShape {
+  int64_t batch = 1;
+  int64_t rows = 0;
+  int64_t cols = 0;
+};
+
+inline CsrMatrixShape GetCsrMatrixShape(const DDim& dims) {
+  int rank = dims.size();
+  PADDLE_ENFORCE_EQ(
+      rank == 2 || rank == 3,
+      true,
+      phi::errors::InvalidArgument(
+          "the dims size of SparseBlas operands must be 2 or 3, but got %d.",
+          rank));
+  CsrMatrixShape shape;
+  shape.batch = rank == 3 ? dims[0] : 1;
+  shape.rows = dims[rank - 2];
+  shape.cols = dims[rank - 1];
+  return shape;
+}
+
+// offsets of the non-zeros of each batch in cols and values of a 3-D csr,
+// the crows of every batch start from 0
+template <typename IntT>
+std::vector<int64_t> GetCsrBatchOffsets(const IntT* crows,
+                                        const CsrMatrixShape& shape) {
+  std::vector<int64_t> offsets(shape.batch + 1, 0);
+  for (int64_t b = 0; b < shape.batch; ++b) {
+    offsets[b + 1] =
+        offsets[b] +
+        static_cast<int64_t>(crows[b * (shape.rows + 1) + shape.rows]);
+  }
+  return offsets;
+}
+
+// dst[b] = src[b]' for each [rows, cols] matrix of the batch
+template <typename T>
+void TransposeBatchMatrix(
+    const T* src, int64_t batch, int64_t rows, int64_t cols, T* dst) {
+  constexpr int64_t kTile = 32;
+  int64_t row_tiles = (rows + kTile - 1) / kTile;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t t = 0; t < batch * row_tiles; ++t) {
+    int64_t b = t / row_tiles;
+    int64_t r0 = (t % row_tiles) * kTile;
+    int64_t r1 = std::min(r0 + kTile, rows);
+    const T* src_b = src + b * rows * cols;
+    T* dst_b = dst + b * rows * cols;
+    for (int64_t c0 = 0; c0 < cols; c0 += kTile) {
+      int64_t c1 = std::min(c0 + kTile, cols);
+      for (int64_t r = r0; r < r1; ++r) {
+        for (int64_t c = c0; c < c1; ++c) {
+          dst_b[c * rows + r] = src_b[r * cols + c];
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+inline void ScaleRow(T beta, int64_t n, T* out) {
+  if (beta == static_cast<T>(0)) {
+    std::fill(out, out + n, static_cast<T>(0));
+  } else if (beta != static_cast<T>(1)) {
+    for (int64_t i = 0; i < n; ++i) {
+      out[i] *= beta;
+    }
+  }
+}
+
+// out = alpha * a @ b + beta * out, where a is [M, K] csr, b is [K, N]
+template <typename T, typename IntT>
+void CpuCsrSpmm(const CsrMatrixShape& a_shape,
+                const IntT* crows,
+                const IntT* cols,
+                const T* values,
+                const T* b,
+                int64_t n,
+                T alpha,
+                T beta,
+                T* out) {
+  const int64_t m = a_shape.rows;
+  const int64_t k = a_shape.cols;
+  std::vector<int64_t> offsets = GetCsrBatchOffsets(crows, a_shape);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+  for (int64_t r = 0; r < a_shape.batch * m; ++r) {
+    int64_t batch = r / m;
+    int64_t row = r % m;
+    const IntT* row_crows = crows + batch * (m + 1) + row;
+    int64_t begin = offsets[batch] + static_cast<int64_t>(row_crows[0]);
+    int64_t end = offsets[batch] + static_cast<int64_t>(row_crows[1]);
+    const T* b_batch = b + batch * k * n;
+    T* out_row = out + r * n;
+    ScaleRow(beta, n, out_row);
+    for (int64_t n0 = 0; n0 < n; n0 += kCpuSpmmBlockN) {
+      int64_t block_n = std::min(kCpuSpmmBlockN, n - n0);
+      T* out_block = out_row + n0;
+      for (int64_t j = begin; j < end; ++j) {
+        T v = alpha * values[j];
+        const T* b_block = b_batch + static_cast<int64_t>(cols[j]) * n + n0;
+        for (int64_t i = 0; i < block_n; ++i) {
+          out_block[i] += v * b_block[i];
+        }
+      }
+    }
+  }
+}
+
+// t = a', where a is [M, K] csr and t is [K, M] csr. The non-zeros of each
+// batch keep their offsets, and the columns of each row of t stay sorted.
+template <typename T, typename IntT>
+void TransposeCsr(const CsrMatrixShape& shape,
+                  const IntT* crows,
+                  const IntT* cols,
+                  const T* values,
+                  std::vector<IntT>* t_crows,
+                  std::vector<IntT>* t_cols,
+                  std::vector<T>* t_values) {
+  const int64_t m = shape.rows;
+  const int64_t k = shape.cols;
+  std::vector<int64_t> offsets = GetCsrBatchOffsets(crows, shape);
+  t_crows->assign(shape.batch * (k + 1), 0);
+  t_cols->resize(offsets[shape.batch]);
+  t_values->resize(offsets[shape.batch]);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t batch = 0; batch < shape.batch; ++batch) {
+    const IntT* batch_crows = crows + batch * (m + 1);
+    const IntT* batch_cols = cols + offsets[batch];
+    const T* batch_values = values + offsets[batch];
+    IntT* out_crows = t_crows->data() + batch * (k + 1);
+    IntT* out_cols = t_cols->data() + offsets[batch];
+    T* out_values = t_values->data() + offsets[batch];
+    int64_t nnz = offsets[batch + 1] - offsets[batch];
+    for (int64_t j = 0; j < nnz; ++j) {
+      ++out_crows[static_cast<int64_t>(batch_cols[j]) + 1];
+    }
+    for (int64_t i = 0; i < k; ++i) {
+      out_crows[i + 1] += out_crows[i];
+    }
+    std::vector<IntT> next(out_crows, out_crows + k);
+    for (int64_t row = 0; row < m; ++row) {
+      for (int64_t j = static_cast<int64_t>(batch_crows[row]);
+           j < static_cast<int64_t>(batch_crows[row + 1]);
+           ++j) {
+        IntT pos = next[static_cast<int64_t>(batch_cols[j])]++;
+        out_cols[pos] = static_cast<IntT>(row);
+        out_values[pos] = batch_values[j];
+      }
+    }
+  }
+}
+
+// out.values = alpha * (a @ bt')[out.pattern] + beta * out.values, where a
+// is [M, K] and bt is [N, K], so both operands of every dot are contiguous.
+template <typename T, typename IntT>
+void CpuCsrSddmm(const CsrMatrixShape& out_shape,
+                 const IntT* crows,
+                 const IntT* cols,
+                 const T* a,
+                 const T* bt,
+                 int64_t k,
+                 T alpha,
+                 T beta,
+                 T* values) {
+  const int64_t m = out_shape.rows;
+  const int64_t n = out_shape.cols;
+  std::vector<int64_t> offsets = GetCsrBatchOffsets(crows, out_shape);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+  for (int64_t r = 0; r < out_shape.batch * m; ++r) {
+    int64_t batch = r / m;
+    int64_t row = r % m;
+    const IntT* row_crows = crows + batch * (m + 1) + row;
+    int64_t begin = offsets[batch] + static_cast<int64_t>(row_crows[0]);
+    int64_t end = offsets[batch] + static_cast<int64_t>(row_crows[1]);
+    const T* a_row = a + r * k;
+    const T* bt_batch = bt + batch * n * k;
+    for (int64_t j = begin; j < end; ++j) {
+      const T* bt_row = bt_batch + static_cast<int64_t>(cols[j]) * k;
+      T sum = 0;
+      for (int64_t i = 0; i < k; ++i) {
+        sum += a_row[i] * bt_row[i];
+      }
+      values[j] = beta == static_cast<T>(0)
+                      ? alpha * sum
+                      : alpha * sum + beta * values[j];
+    }
+  }
+}
+
+template <typename T>
+void CpuSparseBlasSPMM(bool transa,
+                       bool transb,
+                       T alpha,
+                       const phi::SparseCsrTensor& mat_a,
+                       const phi::DenseTensor& mat_b,
+                       T beta,
+                       phi::DenseTensor* mat_out) {
+  CsrMatrixShape a_shape = GetCsrMatrixShape(mat_a.dims());
+  CsrMatrixShape b_shape = GetCsrMatrixShape(mat_b.dims());
+  int64_t inner = transa ? a_shape.rows : a_shape.cols;
+  int64_t b_inner = transb ? b_shape.cols : b_shape.rows;
+  int64_t n = transb ? b_shape.rows : b_shape.cols;
+  PADDLE_ENFORCE_EQ(
+      a_shape.batch == b_shape.batch && inner == b_inner,
+      true,
+      phi::errors::InvalidArgument(
+          "The shape of sparse [%s] and dense [%s] operands of SPMM do not "
+          "match.",
+          mat_a.dims(),
+          mat_b.dims()));
+  PADDLE_ENFORCE_EQ(
+      mat_out->numel(),
+      a_shape.batch * (transa ? a_shape.cols : a_shape.rows) * n,
+      phi::errors::InvalidArgument("The output of SPMM has wrong numel %d.",
+                                   mat_out->numel()));
+
+  const T* b_data = mat_b.data<T>();
+  std::vector<T> b_trans;
+  if (transb) {
+    b_trans.resize(mat_b.numel());
+    TransposeBatchMatrix(
+        b_data, b_shape.batch, b_shape.rows, b_shape.cols, b_trans.data());
+    b_data = b_trans.data();
+  }
+
+  const T* values = mat_a.non_zero_elements().data<T>();
+  T* out_data = mat_out->data<T>();
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      mat_a.non_zero_crows().dtype(), "CpuSparseBlasSPMM", ([&] {
+        const data_t* crows = mat_a.non_zero_crows().data<data_t>();
+        const data_t* cols = mat_a.non_zero_cols().data<data_t>();
+        if (transa) {
+          // a' is built as a csr, so that the rows of out are computed by
+          // different threads
+          std::vector<data_t> t_crows, t_cols;
+          std::vector<T> t_values;
+          TransposeCsr(
+              a_shape, crows, cols, values, &t_crows, &t_cols, &t_values);
+          CsrMatrixShape t_shape = {a_shape.batch, a_shape.cols, a_shape.rows};
+          CpuCsrSpmm(t_shape,
+                     t_crows.data(),
+                     t_cols.data(),
+                     t_values.data(),
+                     b_data,
+                     n,
+                     alpha,
+                     beta,
+                     out_data);
+        } else {
+          CpuCsrSpmm(
+              a_shape, crows, cols, values, b_data, n, alpha, beta, out_data);
+        }
+      }));
+}
+
+template <typename T>
+void CpuSparseBlasSPMM(bool transa UNUSED,
+                       bool transb UNUSED,
+                       T alpha UNUSED,
+                       const phi::SparseCooTensor& mat_a UNUSED,
+                       const phi::DenseTensor& mat_b UNUSED,
+                       T beta UNUSED,
+                       phi::DenseTensor* mat_out UNUSED) {
+  PADDLE_THROW(phi::errors::Unimplemented(
+      "CPU SparseBlas only supports SparseCsrTensor in SPMM."));
+}
+
+template <typename T>
+void CpuSparseBlasSDDMM(bool transa,
+                        bool transb,
+                        T alpha,
+                        const phi::DenseTensor& mat_a,
+                        const phi::DenseTensor& mat_b,
+                        T beta,
+                        phi::SparseCsrTensor* mat_out) {
+  CsrMatrixShape a_shape = GetCsrMatrixShape(mat_a.dims());
+  CsrMatrixShape b_shape = GetCsrMatrixShape(mat_b.dims());
+  CsrMatrixShape out_shape = GetCsrMatrixShape(mat_out->dims());
+  int64_t m = transa ? a_shape.cols : a_shape.rows;
+  int64_t k = transa ? a_shape.rows : a_shape.cols;
+  int64_t b_inner = transb ? b_shape.cols : b_shape.rows;
+  int64_t n = transb ? b_shape.rows : b_shape.cols;
+  PADDLE_ENFORCE_EQ(
+      a_shape.batch == b_shape.batch && a_shape.batch == out_shape.batch &&
+          k == b_inner && m == out_shape.rows && n == out_shape.cols,
+      true,
+      phi::errors::InvalidArgument(
+          "The shape of dense [%s], [%s] and sparse [%s] operands of SDDMM do "
+          "not match.",
+          mat_a.dims(),
+          mat_b.dims(),
+          mat_out->dims()));
+
+  // a is needed as [M, K] and b as [N, K]
+  const T* a_data = mat_a.data<T>();
+  std::vector<T> a_trans;
+  if (transa) {
+    a_trans.resize(mat_a.numel());
+    TransposeBatchMatrix(
+        a_data, a_shape.batch, a_shape.rows, a_shape.cols, a_trans.data());
+    a_data = a_trans.data();
+  }
+  const T* bt_data = mat_b.data<T>();
+  std::vector<T> b_trans;
+  if (!transb) {
+    b_trans.resize(mat_b.numel());
+    TransposeBatchMatrix(
+        bt_data, b_shape.batch, b_shape.rows, b_shape.cols, b_trans.data());
+    bt_data = b_trans.data();
+  }
+
+  T* values = mat_out->mutable_non_zero_elements()->data<T>();
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      mat_out->non_zero_crows().dtype(), "CpuSparseBlasSDDMM", ([&] {
+        const data_t* crows = mat_out->non_zero_crows().data<data_t>();
+        const data_t* cols = mat_out->non_zero_cols().data<data_t>();
+        CpuCsrSddmm(
+            out_shape, crows, cols, a_data, bt_data, k, alpha, beta, values);
+      }));
+}
+
+template <typename T>
+void CpuSparseBlasSDDMM(bool transa UNUSED,
+                        bool transb UNUSED,
+                        T alpha UNUSED,
+                        const phi::DenseTensor& mat_a UNUSED,
+                        const phi::DenseTensor& mat_b UNUSED,
+                        T beta UNUSED,
+                        phi::SparseCooTensor* mat_out UNUSED) {
+  PADDLE_THROW(phi::errors::Unimplemented(
+      "CPU SparseBlas only supports SparseCsrTensor in SDDMM."));
+}
+
+/************* SPARSE*DENSE->DENSE MATMUL ************/
+template <>
+template <typename T, typename TensorType>
+void SparseBlas<phi::CPUContext>::SPMM(bool transa,
+                                       bool transb,
+                                       T alpha,
+                                       const TensorType& mat_a,
+                                       const phi::DenseTensor& mat_b,
+                                       T beta,
+                                       phi::DenseTensor* mat_out) const {
+  CpuSparseBlasSPMM<T>(transa, transb, alpha, mat_a, mat_b, beta, mat_out);
+}
+
+/************* DENSE*DENSE->SPARSE MATMUL ************/
+template <>
+template <typename T, typename TensorType>
+void SparseBlas<phi::CPUContext>::SDDMM(bool transa,
+                                        bool transb,
+                                        T alpha,
+                                        const phi::DenseTensor& mat_a,
+                                        const phi::DenseTensor& mat_b,
+                                        T beta,
+                                        TensorType* mat_out) const {
+  CpuSparseBlasSDDMM<T>(transa, transb, alpha, mat_a, mat_b, beta, mat_out);
+}
+
+}  // namespace sparse
+}  // namespace funcs
+}  // namespace phi
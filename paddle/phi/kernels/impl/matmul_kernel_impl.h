@@ -23,12 +23,11 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/blas/blaslt_impl.cu.h"
 #include "paddle/phi/kernels/funcs/complex_functors.h"
+#include "paddle/phi/kernels/funcs/eigen/common.h"
 #if defined(PADDLE_WITH_CUDA)
 #include "paddle/phi/kernels/funcs/cublaslt.h"
 #endif
-#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 11060
 #include "paddle/phi/kernels/autotune/auto_tune_base.h"
-#endif
 
 namespace phi {
 
@@ -909,6 +908,101 @@ struct MatMulDispatcher {
   }
 };
 
+// Eigen contraction of 2-D matrices, which may be faster than the blas gemm
+// for small shapes. The other cases are computed by blas.
+template <typename Context, typename T>
+void MatMulFunctionImplWithEigen(
+    const Context& dev_ctx,
+    const DenseTensor& X,
+    const DenseTensor& Y,
+    const std::vector<std::int64_t>& x_dims,
+    const std::vector<std::int64_t>& y_dims,
+    DenseTensor* Out,
+    bool trans_x,
+    bool trans_y,
+    bool flag = false,
+    phi::funcs::MatmulPlanner* matmul_planner = nullptr) {
+  if (x_dims.size() != 2 || y_dims.size() != 2 || flag) {
+    MatMulFunctionImplWithBlas<Context, T>(dev_ctx,
+                                           X,
+                                           Y,
+                                           x_dims,
+                                           y_dims,
+                                           Out,
+                                           trans_x,
+                                           trans_y,
+                                           flag,
+                                           matmul_planner);
+    return;
+  }
+  const int64_t M = trans_x ? x_dims[1] : x_dims[0];
+  const int64_t K = trans_x ? x_dims[0] : x_dims[1];
+  const int64_t N = trans_y ? y_dims[0] : y_dims[1];
+  PADDLE_ENFORCE_EQ(
+      trans_y ? y_dims[1] : y_dims[0],
+      K,
+      phi::errors::InvalidArgument("Input(X) has %d columns but Input(Y) has "
+                                   "%d rows after transpose.",
+                                   K,
+                                   trans_y ? y_dims[1] : y_dims[0]));
+  Out->ResizeAndAllocate(phi::make_ddim({M, N}));
+  dev_ctx.template Alloc<T>(Out);
+
+  auto x = EigenMatrix<T>::From(X, phi::make_ddim(x_dims));
+  auto y = EigenMatrix<T>::From(Y, phi::make_ddim(y_dims));
+  auto out = EigenMatrix<T>::From(*Out);
+  Eigen::array<Eigen::IndexPair<int>, 1> contract_dims = {
+      Eigen::IndexPair<int>(trans_x ? 0 : 1, trans_y ? 1 : 0)};
+  out.device(*dev_ctx.eigen_device()) = x.contract(y, contract_dims);
+}
+
+template <typename T>
+struct MatMulDispatcher<phi::CPUContext, T> {
+  void operator()(const phi::CPUContext& ctx,
+                  const DenseTensor& x,
+                  const DenseTensor& y,
+                  const std::vector<std::int64_t>& x_dims,
+                  const std::vector<std::int64_t>& y_dims,
+                  DenseTensor* out,
+                  bool trans_x,
+                  bool trans_y,
+                  bool flag = false) {
+    // The tuner runs the candidates repeatedly, which is only safe if out
+    // is not accumulated.
+    if constexpr (std::is_same<T, float>::value ||
+                  std::is_same<T, double>::value) {
+      if (x_dims.size() == 2 && y_dims.size() == 2 && !flag &&
+          phi::autotune::AutoTuneStatus::Instance().UseCpuAutoTune()) {
+        auto* tuner = phi::autotune::MakeCpuMatmulTuner<T>(
+            MatMulFunctionImplWithBlas<phi::CPUContext, T>);
+        tuner->AddCallBack(MatMulFunctionImplWithEigen<phi::CPUContext, T>);
+        size_t key =
+            phi::autotune::CpuMatmulKey(x_dims,
+                                        y_dims,
+                                        trans_x,
+                                        trans_y,
+                                        phi::CppTypeToDataType<T>::Type());
+        tuner->Run(ctx,
+                   phi::autotune::AlgorithmType::kCpuMatmul,
+                   key,
+                   ctx,
+                   x,
+                   y,
+                   x_dims,
+                   y_dims,
+                   out,
+                   trans_x,
+                   trans_y,
+                   flag,
+                   nullptr);
+        return;
+      }
+    }
+    MatMulFunctionImplWithBlas<phi::CPUContext, T>(
+        ctx, x, y, x_dims, y_dims, out, trans_x, trans_y, flag);
+  }
+};
+
 #ifdef PADDLE_WITH_CUDA
 template <typename T>
 struct MatMulDispatcher<phi::GPUContext, T> {
@@ -787,6 +787,26 @@ class InMemoryDataset(DatasetBase):
         """
         self.dataset.set_shuffle_by_uid(enable_shuffle_uid)
 
+    def _set_use_segmented_channel(self, use_segmented_channel):
+        """
+        Set if Dataset uses the lock-free segmented channels to hold the
+        instances. They scale better when many threads read files at the
+        same time, but the order of the instances is only kept within a
+        block. It should be set before load_into_memory.
+
+        Args:
+            use_segmented_channel(bool): if use segmented channels or not
+
+        Examples:
+            .. code-block:: python
+
+              import paddle
+              paddle.enable_static()
+              dataset = paddle.distributed.InMemoryDataset()
+              dataset._set_use_segmented_channel(True)
+        """
+        self.dataset.set_use_segmented_channel(use_segmented_channel)
+
     def _set_generate_unique_feasigns(self, generate_uni_feasigns, shard_num):
         self.dataset.set_generate_unique_feasigns(generate_uni_feasigns)
         self.gen_uni_feasigns = generate_uni_feasigns
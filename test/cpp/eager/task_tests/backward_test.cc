@@ -15,6 +15,7 @@
 #include "paddle/fluid/eager/backward.h"
 
 #include <sstream>
+#include <thread>  // NOLINT
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
@@ -24,6 +25,7 @@
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/grad_node_info.h"
 #include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/flags.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_meta.h"
 #include "test/cpp/eager/test_utils.h"
@@ -31,6 +33,8 @@
 PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
 
+PHI_DECLARE_int32(eager_backward_num_threads);
+
 namespace egr {
 
 TEST(Backward, SingleNodeEmptyGrad) {
@@ -342,4 +346,95 @@ TEST(Backward, WithAccumulation) {
   eager_test::CompareGradTensorWithValue<float>(leaf_tensor, 2500.0);
 }
 
+/*
+            inp
+     ________|________
+     |       |       |
+   Node0   Node1 .. Node15   (chains of scale nodes)
+     |       |       |
+   out0    out1 .. out15
+*/
+TEST(Backward, MultiThreading) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  paddle::framework::DDim ddim = phi::make_ddim({4, 16, 16, 32});
+  paddle::Tensor tensor =
+      eager_test::CreateTensorWithValue(ddim,
+                                        paddle::platform::CPUPlace(),
+                                        phi::DataType::FLOAT32,
+                                        phi::DataLayout::NCHW,
+                                        1.0 /*value*/,
+                                        true /*is_leaf*/);
+  egr_utils_api::RetainGradForTensor(tensor);
+
+  const int num_branches = 16;
+  std::vector<paddle::Tensor> outs;
+  for (int i = 0; i < num_branches; i++) {
+    paddle::Tensor out = egr::scale(
+        tensor, 2.0, 0.0, true /*bias_after_scale*/, true /*trace_backward*/);
+    for (int j = 0; j < 4; j++) {
+      out = egr::scale(
+          out, 1.0, 1.0, true /*bias_after_scale*/, true /*trace_backward*/);
+    }
+    outs.emplace_back(egr::scale(out,
+                                 static_cast<float>(i + 1),
+                                 0.0,
+                                 true /*bias_after_scale*/,
+                                 true /*trace_backward*/));
+  }
+
+  // The grads of the branches are summed into inp by several threads
+  int num_threads = FLAGS_eager_backward_num_threads;
+  FLAGS_eager_backward_num_threads = 4;
+  Backward(outs, {});
+  FLAGS_eager_backward_num_threads = num_threads;
+
+  // sum of 2 * (i + 1) for i in [0, 16)
+  eager_test::CompareGradTensorWithValue<float>(tensor, 272.0);
+}
+
+// The reduce hooks of the leaves run in order on the thread calling
+// backward, the same as without worker threads.
+TEST(Backward, MultiThreadingWithReduceHooks) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  paddle::framework::DDim ddim = phi::make_ddim({4, 16, 16, 32});
+  const int num_branches = 16;
+  std::vector<paddle::Tensor> leaves;
+  std::vector<paddle::Tensor> outs;
+  std::vector<std::thread::id> hook_thread_ids;
+  for (int i = 0; i < num_branches; i++) {
+    paddle::Tensor leaf =
+        eager_test::CreateTensorWithValue(ddim,
+                                          paddle::platform::CPUPlace(),
+                                          phi::DataType::FLOAT32,
+                                          phi::DataLayout::NCHW,
+                                          1.0 /*value*/,
+                                          true /*is_leaf*/);
+    egr_utils_api::RetainGradForTensor(leaf);
+    egr_utils_api::RegisterReduceHookForTensor(leaf, [&hook_thread_ids]() {
+      hook_thread_ids.push_back(std::this_thread::get_id());
+    });
+    outs.emplace_back(egr::scale(leaf,
+                                 static_cast<float>(i + 1),
+                                 0.0,
+                                 true /*bias_after_scale*/,
+                                 true /*trace_backward*/));
+    leaves.push_back(leaf);
+  }
+
+  int num_threads = FLAGS_eager_backward_num_threads;
+  FLAGS_eager_backward_num_threads = 4;
+  Backward(outs, {});
+  FLAGS_eager_backward_num_threads = num_threads;
+
+  ASSERT_EQ(hook_thread_ids.size(), static_cast<size_t>(num_branches));
+  for (const auto& thread_id : hook_thread_ids) {
+    ASSERT_EQ(thread_id, std::this_thread::get_id());
+  }
+  for (int i = 0; i < num_branches; i++) {
+    eager_test::CompareGradTensorWithValue<float>(leaves[i], i + 1.0);
+  }
+}
+
 }  // namespace egr
@@ -0,0 +1,269 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <sstream>
+
+#include "paddle/fluid/ir/dialect/pd_attribute.h"
+#include "paddle/fluid/ir/dialect/pd_dialect.h"
+#include "paddle/fluid/ir/dialect/pd_type.h"
+#include "paddle/ir/core/block.h"
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/bytecode.h"
+#include "paddle/ir/core/dialect.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/op_base.h"
+#include "paddle/ir/core/program.h"
+#include "paddle/ir/core/region.h"
+
+// An op holding a region, the body of a control flow op.
+class RegionOp : public ir::Op<RegionOp> {
+ public:
+  using Op::Op;
+  static const char *name() { return "test.region"; }
+  static constexpr uint32_t attributes_num = 0;
+  static constexpr const char **attributes_name = nullptr;
+  void Verify() const {}
+};
+IR_DECLARE_EXPLICIT_TYPE_ID(RegionOp)
+IR_DEFINE_EXPLICIT_TYPE_ID(RegionOp)
+
+class TestDialect : public ir::Dialect {
+ public:
+  explicit TestDialect(ir::IrContext *context)
+      : ir::Dialect(name(), context, ir::TypeId::get<TestDialect>()) {
+    RegisterOps<RegionOp>();
+  }
+  static const char *name() { return "test"; }
+};
+IR_DECLARE_EXPLICIT_TYPE_ID(TestDialect)
+IR_DEFINE_EXPLICIT_TYPE_ID(TestDialect)
+
+std::string ToString(const ir::Program &program) {
+  std::stringstream ss;
+  program.Print(ss);
+  return ss.str();
+}
+
+ir::Operation *BuildRegionOp(ir::Block *block,
+                             const std::vector<ir::OpResult> &inputs,
+                             ir::Type output_type) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Operation *op =
+      ir::Operation::Create(inputs,
+                            {},
+                            {output_type},
+                            ctx->GetRegisteredOpInfo(RegionOp::name()),
+                            1);
+  op->region(0).push_back(new ir::Block());
+  block->push_back(op);
+  return op;
+}
+
+TEST(ir_bytecode_test, round_trip) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+
+  ir::Type dense_tensor_type =
+      paddle::dialect::DenseTensorType::get(ctx,
+                                            ir::Float32Type::get(ctx),
+                                            phi::make_ddim({-1, 4}),
+                                            phi::DataLayout::NCHW,
+                                            {{0, 2, 5}},
+                                            3);
+  std::vector<float> data = {1.0, -2.5, 3.0, 0.0};
+  auto parameter = std::make_unique<ir::Parameter>(
+      data.data(), data.size() * sizeof(float), dense_tensor_type);
+  parameter->set_mutable();
+  program.SetParameter("w", std::move(parameter));
+
+  ir::OpResult w =
+      builder.Build<ir::GetParameterOp>("w", dense_tensor_type)->result(0);
+  ir::OpResult a = builder
+                       .Build<ir::ConstantOp>(ir::FloatAttribute::get(ctx, 2.5),
+                                              ir::Float32Type::get(ctx))
+                       ->result(0);
+  ir::Attribute array_attr = ir::ArrayAttribute::get(
+      ctx,
+      {ir::Int64Attribute::get(ctx, -7),
+       ir::StrAttribute::get(ctx, "str"),
+       ir::DoubleAttribute::get(ctx, 0.125),
+       paddle::dialect::IntArrayAttribute::get(ctx,
+                                               phi::IntArray({1, -2, 3})),
+       paddle::dialect::PlaceAttribute::get(ctx, phi::GPUPlace(1)),
+       paddle::dialect::DataTypeAttribute::get(ctx, phi::DataType::INT8),
+       paddle::dialect::DataLayoutAttribute::get(ctx, phi::DataLayout::NHWC),
+       ir::TypeAttribute::get(ctx, dense_tensor_type)});
+  ir::OpResult b = builder
+                       .Build<ir::ConstantOp>(
+                           array_attr, ir::Int32Type::get(ctx))
+                       ->result(0);
+  builder.Build<ir::CombineOp>(std::vector<ir::OpResult>{w, a, b, w});
+
+  std::string bytecode = ir::SerializeProgram(program);
+  std::unique_ptr<ir::Program> loaded = ir::DeserializeProgram(ctx, bytecode);
+
+  EXPECT_EQ(ToString(*loaded), ToString(program));
+  EXPECT_EQ(ir::SerializeProgram(*loaded), bytecode);
+  ir::Parameter *loaded_w = loaded->GetParameter("w");
+  ASSERT_NE(loaded_w, nullptr);
+  EXPECT_EQ(loaded_w->type(), dense_tensor_type);
+  EXPECT_TRUE(loaded_w->is_mutable());
+  EXPECT_EQ(std::memcmp(loaded_w->data(), data.data(), loaded_w->size()), 0);
+
+  // (1) A type or an attribute is stored once.
+  ir::Program repeated(ctx);
+  ir::Builder repeated_builder(ctx, repeated.block());
+  for (int i = 0; i < 10; ++i) {
+    repeated_builder.Build<ir::ConstantOp>(array_attr,
+                                           ir::Int32Type::get(ctx));
+  }
+  EXPECT_LT(ir::SerializeProgram(repeated).size(), 2 * bytecode.size());
+
+  // (2) A broken bytecode is rejected.
+  EXPECT_THROW(ir::DeserializeProgram(ctx, "not a program"),
+               ir::IrNotMetException);
+  EXPECT_THROW(ir::DeserializeProgram(ctx, bytecode.substr(0, 40)),
+               ir::IrNotMetException);
+}
+
+TEST(ir_bytecode_test, lazy_region) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+  ir::Type f32_type = ir::Float32Type::get(ctx);
+
+  // a = constant; b = region { c = combine(a, a); region { combine(a, c) } }
+  ir::OpResult a = builder
+                       .Build<ir::ConstantOp>(ir::Int32Attribute::get(ctx, 1),
+                                              ir::Int32Type::get(ctx))
+                       ->result(0);
+  ir::Operation *outer = BuildRegionOp(program.block(), {a}, f32_type);
+  ir::Block *outer_body = outer->region(0).front();
+  ir::Builder body_builder(ctx, outer_body);
+  ir::OpResult c =
+      body_builder.Build<ir::CombineOp>(std::vector<ir::OpResult>{a, a})
+          ->result(0);
+  ir::Operation *inner = BuildRegionOp(outer_body, {c}, f32_type);
+  ir::Builder inner_builder(ctx, inner->region(0).front());
+  inner_builder.Build<ir::CombineOp>(std::vector<ir::OpResult>{a, c});
+  builder.Build<ir::CombineOp>(
+      std::vector<ir::OpResult>{a, outer->result(0)});
+
+  ir::BytecodeLoader loader(ctx, ir::SerializeProgram(program));
+  std::unique_ptr<ir::Program> loaded = loader.Load(/*lazy=*/true);
+  ASSERT_EQ(loaded->block()->size(), 3u);
+  ir::Operation *loaded_outer = *std::next(loaded->block()->begin());
+  EXPECT_FALSE(loader.IsMaterialized(loaded_outer));
+  EXPECT_TRUE(loaded_outer->region(0).empty());
+  // the ops after a lazy region still use the values before it
+  ir::Operation *last = loaded->block()->back();
+  EXPECT_EQ(last->operand(1), loaded_outer->result(0));
+
+  loader.Materialize(loaded_outer);
+  EXPECT_TRUE(loader.IsMaterialized(loaded_outer));
+  ASSERT_EQ(loaded_outer->region(0).size(), 1u);
+  ir::Block *loaded_body = loaded_outer->region(0).front();
+  ASSERT_EQ(loaded_body->size(), 2u);
+  ir::Operation *loaded_inner = loaded_body->back();
+  EXPECT_FALSE(loader.IsMaterialized(loaded_inner));
+  EXPECT_EQ(loaded_body->front()->operand(0),
+            loaded->block()->front()->result(0));
+
+  loader.MaterializeAll();
+  EXPECT_TRUE(loader.IsMaterialized(loaded_inner));
+  EXPECT_EQ(ToString(*loaded), ToString(program));
+  EXPECT_THROW(loader.Load(), ir::IrNotMetException);
+}
+
+// Loads a program of the size of a large model, eagerly and lazily, and
+// prints the time of each against the size of the bytecode.
+TEST(ir_bytecode_test, load_benchmark) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::PaddleDialect>();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  const int num_layers = 200;
+  const int ops_per_layer = 100;
+
+  ir::Program program(ctx);
+  ir::Builder builder(ctx, program.block());
+  ir::Type hidden_type =
+      paddle::dialect::DenseTensorType::get(ctx,
+                                            ir::Float32Type::get(ctx),
+                                            phi::make_ddim({-1, 128, 768}),
+                                            phi::DataLayout::NCHW,
+                                            {},
+                                            0);
+  ir::OpResult x =
+      builder.Build<ir::GetParameterOp>("x", hidden_type)->result(0);
+  for (int layer = 0; layer < num_layers; ++layer) {
+    // each layer is the body of an op, the loader can skip it
+    ir::Operation *layer_op =
+        BuildRegionOp(program.block(), {x}, hidden_type);
+    ir::Builder layer_builder(ctx, layer_op->region(0).front());
+    ir::OpResult h = x;
+    for (int i = 0; i < ops_per_layer; ++i) {
+      ir::OpResult scale =
+          layer_builder
+              .Build<ir::ConstantOp>(ir::FloatAttribute::get(ctx, i * 0.5f),
+                                     hidden_type)
+              ->result(0);
+      ir::OpResult pair =
+          layer_builder
+              .Build<ir::CombineOp>(std::vector<ir::OpResult>{h, scale})
+              ->result(0);
+      ir::Operation *slice = ir::Operation::Create(
+          {pair},
+          {{"index", ir::Int32Attribute::get(ctx, 0)}},
+          {hidden_type},
+          ctx->GetRegisteredOpInfo(ir::SliceOp::name()));
+      layer_op->region(0).front()->push_back(slice);
+      h = slice->result(0);
+    }
+    x = layer_op->result(0);
+  }
+
+  auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  };
+  auto start = std::chrono::steady_clock::now();
+  std::string bytecode = ir::SerializeProgram(program);
+  double serialize_seconds = seconds_since(start);
+
+  start = std::chrono::steady_clock::now();
+  std::unique_ptr<ir::Program> loaded = ir::DeserializeProgram(ctx, bytecode);
+  double load_seconds = seconds_since(start);
+  EXPECT_EQ(loaded->block()->size(), program.block()->size());
+
+  start = std::chrono::steady_clock::now();
+  ir::BytecodeLoader loader(ctx, bytecode);
+  std::unique_ptr<ir::Program> lazy_loaded = loader.Load(/*lazy=*/true);
+  double lazy_load_seconds = seconds_since(start);
+  EXPECT_EQ(lazy_loaded->block()->size(), program.block()->size());
+
+  LOG(INFO) << "bytecode of " << num_layers * ops_per_layer * 3
+            << " ops: " << bytecode.size() << " bytes, serialize "
+            << serialize_seconds * 1e3 << " ms, load " << load_seconds * 1e3
+            << " ms, lazy load " << lazy_load_seconds * 1e3 << " ms";
+}
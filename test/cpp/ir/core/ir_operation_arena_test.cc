@@ -0,0 +1,110 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <chrono>  // NOLINT
+#include <memory>
+
+#include "paddle/ir/core/block.h"
+#include "paddle/ir/core/builder.h"
+#include "paddle/ir/core/builtin_attribute.h"
+#include "paddle/ir/core/builtin_op.h"
+#include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/ir_context.h"
+#include "paddle/ir/core/operation_arena.h"
+#include "paddle/ir/core/program.h"
+
+TEST(operation_arena, allocate) {
+  ir::OperationArena arena;
+  void *a = arena.Allocate(20);
+  void *b = arena.Allocate(3);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % 8, 0u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0u);
+  EXPECT_EQ(reinterpret_cast<char *>(b) - reinterpret_cast<char *>(a), 24);
+
+  // the freed memory is reused by the next allocation of the same size
+  arena.Deallocate(a, 20);
+  EXPECT_EQ(arena.Allocate(24), a);
+  EXPECT_NE(arena.Allocate(24), a);
+
+  // a large allocation takes a chunk of its own
+  size_t reserved_size = arena.reserved_size();
+  void *large = arena.Allocate(1 << 20);
+  EXPECT_EQ(arena.reserved_size(), reserved_size + (1 << 20));
+  EXPECT_EQ(reinterpret_cast<char *>(arena.Allocate(8)),
+            reinterpret_cast<char *>(b) + 8 + 24);
+  arena.Deallocate(large, 1 << 20);
+}
+
+TEST(operation_arena, program) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx, /*use_arena=*/true);
+  ASSERT_NE(program.arena(), nullptr);
+  ir::Builder builder(ctx, program.block());
+
+  ir::OpResult a = builder
+                       .Build<ir::ConstantOp>(builder.float_attr(1.0f),
+                                              builder.float32_type())
+                       ->result(0);
+  for (int i = 0; i < 100; ++i) {
+    builder.Build<ir::CombineOp>(std::vector<ir::OpResult>{a, a});
+  }
+  size_t reserved_size = program.arena()->reserved_size();
+  EXPECT_GT(reserved_size, 0u);
+
+  // the rewritten ops take the memory of the erased ones
+  ir::Block *block = program.block();
+  for (int i = 0; i < 100; ++i) {
+    block->erase(*block->back());
+    builder.Build<ir::CombineOp>(std::vector<ir::OpResult>{a, a});
+  }
+  EXPECT_EQ(program.arena()->reserved_size(), reserved_size);
+  EXPECT_EQ(block->size(), 101u);
+  EXPECT_EQ(a.use_empty(), false);
+
+  ir::Program heap_program(ctx);
+  EXPECT_EQ(heap_program.arena(), nullptr);
+}
+
+// Builds and destroys a program of many small ops, with and without the
+// arena, and prints the time of each.
+TEST(operation_arena, build_destroy_benchmark) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  const int num_ops = 200000;
+  for (bool use_arena : {false, true}) {
+    auto start = std::chrono::steady_clock::now();
+    auto program = std::make_unique<ir::Program>(ctx, use_arena);
+    ir::Builder builder(ctx, program->block());
+    ir::OpResult x = builder
+                         .Build<ir::ConstantOp>(builder.float_attr(1.0f),
+                                                builder.float32_type())
+                         ->result(0);
+    for (int i = 1; i < num_ops; ++i) {
+      builder.Build<ir::CombineOp>(std::vector<ir::OpResult>{x});
+    }
+    double build_seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    EXPECT_EQ(program->block()->size(), static_cast<size_t>(num_ops));
+
+    start = std::chrono::steady_clock::now();
+    program.reset();
+    double destroy_seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+    LOG(INFO) << (use_arena ? "arena" : "heap") << " program of " << num_ops
+              << " ops: build " << build_seconds * 1e3 << " ms, destroy "
+              << destroy_seconds * 1e3 << " ms";
+  }
+}
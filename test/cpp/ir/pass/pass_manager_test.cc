@@ -13,6 +13,12 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "glog/logging.h"
 
 // NOTE(zhangbo9674): File pd_op.h is generated by op_gen.py, see details in
@@ -31,6 +37,7 @@
 #include "paddle/ir/core/op_base.h"
 #include "paddle/ir/core/operation.h"
 #include "paddle/ir/pass/pass.h"
+#include "paddle/ir/pass/pass_instrumentation.h"
 #include "paddle/ir/pass/pass_manager.h"
 #include "paddle/phi/kernels/elementwise_add_kernel.h"
 
@@ -233,3 +240,207 @@ TEST(pass_manager, PassManager) {
 
   CHECK_EQ(pm.Run(&program), true);
 }
+
+// An isolated function, the passes on functions can run in parallel.
+class FuncOp : public ir::Op<FuncOp> {
+ public:
+  using Op::Op;
+  static const char *name() { return "test.func"; }
+  static constexpr const char **attributes_name = nullptr;
+  static constexpr uint32_t attributes_num = 0;
+  void Verify() {}
+};
+IR_DECLARE_EXPLICIT_TYPE_ID(FuncOp)
+IR_DEFINE_EXPLICIT_TYPE_ID(FuncOp)
+
+class TestDialect : public ir::Dialect {
+ public:
+  explicit TestDialect(ir::IrContext *context)
+      : ir::Dialect(name(), context, ir::TypeId::get<TestDialect>()) {
+    RegisterOps<AddOp, FuncOp>();
+  }
+  static const char *name() { return "test"; }
+};
+IR_DECLARE_EXPLICIT_TYPE_ID(TestDialect)
+IR_DEFINE_EXPLICIT_TYPE_ID(TestDialect)
+
+struct CountAddOpAnalysis {
+  explicit CountAddOpAnalysis(ir::Operation *func_op) {
+    for (auto *op : *func_op->region(0).front()) {
+      count += op->name() == AddOp::name();
+    }
+  }
+
+  int count = 0;
+};
+IR_DECLARE_EXPLICIT_TYPE_ID(CountAddOpAnalysis)
+IR_DEFINE_EXPLICIT_TYPE_ID(CountAddOpAnalysis)
+
+// Erases the unused adds of a function.
+class FuncDcePass : public ir::Pass {
+ public:
+  FuncDcePass() : ir::Pass("FuncDcePass", 1) {}
+
+  void Run(ir::Operation *op) override {
+    int num_adds = analysis_manager().GetAnalysis<CountAddOpAnalysis>().count;
+    ir::Block *block = op->region(0).front();
+    std::vector<ir::Operation *> ops(block->begin(), block->end());
+    for (auto it = ops.rbegin(); it != ops.rend(); ++it) {
+      if ((*it)->name() == AddOp::name() && (*it)->result(0).use_empty()) {
+        block->erase(**it);
+        --num_adds;
+      }
+    }
+    CHECK_EQ(num_adds, CountAddOpAnalysis(op).count);
+  }
+
+  bool CanApplyOn(ir::Operation *op) const override {
+    return op->name() == FuncOp::name();
+  }
+
+  std::unique_ptr<ir::Pass> Clone() const override {
+    return std::make_unique<FuncDcePass>();
+  }
+};
+
+class SequentialFuncDcePass : public FuncDcePass {
+ public:
+  std::unique_ptr<ir::Pass> Clone() const override { return nullptr; }
+};
+
+// Each function adds c to itself num_adds times, with an unused add after
+// each live one.
+void BuildFuncs(ir::Program *program, int num_funcs, int num_adds) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Builder builder(ctx, program->block());
+  for (int i = 0; i < num_funcs; ++i) {
+    ir::OperationArgument argument(ctx->GetRegisteredOpInfo(FuncOp::name()));
+    argument.AddRegion()->push_back(new ir::Block());
+    ir::Operation *func = builder.Build(std::move(argument));
+    ir::Builder func_builder(ctx, func->region(0).front());
+    ir::OpResult c = func_builder
+                         .Build<ir::ConstantOp>(func_builder.float_attr(i),
+                                                func_builder.float32_type())
+                         ->result(0);
+    ir::OpResult x = c;
+    for (int j = 0; j < num_adds; ++j) {
+      func_builder.Build<AddOp>(x, c, func_builder.float32_type());
+      x = func_builder.Build<AddOp>(x, c, func_builder.float32_type())
+              ->result(0);
+    }
+    func_builder.Build<ir::CombineOp>(std::vector<ir::OpResult>{x});
+  }
+}
+
+// The ops of the functions, each operand by the index of its defining op.
+std::string DumpFuncs(const ir::Program &program) {
+  std::stringstream ss;
+  for (auto *func : *program.block()) {
+    std::unordered_map<ir::Operation *, int> index;
+    for (auto *op : *func->region(0).front()) {
+      index.emplace(op, index.size());
+      ss << op->name() << "(";
+      for (uint32_t i = 0; i < op->num_operands(); ++i) {
+        ss << index.at(op->operand(i).GetDefiningOp()) << ",";
+      }
+      ss << ") ";
+    }
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+std::string RunFuncDce(int num_threads, int num_funcs, int num_adds) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx);
+  BuildFuncs(&program, num_funcs, num_adds);
+
+  ir::PassManager pm(ctx);
+  pm.AddPass(std::make_unique<FuncDcePass>());
+  pm.EnableMultiThreading(num_threads);
+  pm.EnablePassTiming(true);
+  CHECK_EQ(pm.Run(&program), true);
+  return DumpFuncs(program);
+}
+
+TEST(pass_manager, MultiThreading) {
+  ir::IrContext::Instance()->GetOrRegisterDialect<TestDialect>();
+  std::string expected = RunFuncDce(1, 16, 8);
+  size_t num_adds = 0;
+  for (size_t pos = expected.find("test.add"); pos != std::string::npos;
+       pos = expected.find("test.add", pos + 1)) {
+    ++num_adds;
+  }
+  EXPECT_EQ(num_adds, 16u * 8u);
+  for (int num_threads : {2, 4, 7}) {
+    EXPECT_EQ(RunFuncDce(num_threads, 16, 8), expected) << num_threads;
+  }
+
+  // The pass which can not be cloned runs on one thread.
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ir::Program program(ctx);
+  BuildFuncs(&program, 16, 8);
+  ir::PassManager pm(ctx);
+  pm.AddPass(std::make_unique<SequentialFuncDcePass>());
+  pm.EnableMultiThreading(4);
+  CHECK_EQ(pm.Run(&program), true);
+  EXPECT_EQ(DumpFuncs(program), expected);
+}
+
+// Records the pipelines in the order they begin and end.
+class PipelineOrderInstrumentation : public ir::PassInstrumentation {
+ public:
+  explicit PipelineOrderInstrumentation(std::vector<std::string> *events)
+      : events_(events) {}
+
+  void RunBeforePipeline(ir::Operation *op) override {
+    events_->push_back("before " + op->name());
+  }
+
+  void RunAfterPipeline(ir::Operation *op) override {
+    events_->push_back("after " + op->name());
+  }
+
+ private:
+  std::vector<std::string> *events_;
+};
+
+// The pipeline of an op ends before the pipelines of its nested ops begin,
+// on one thread and on several.
+TEST(pass_manager, PipelineOrder) {
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<TestDialect>();
+  for (int num_threads : {1, 4}) {
+    ir::Program program(ctx);
+    BuildFuncs(&program, 2, 1);
+    std::vector<std::string> events;
+    ir::PassManager pm(ctx);
+    pm.AddPass(std::make_unique<FuncDcePass>());
+    pm.EnableMultiThreading(num_threads);
+    pm.AddInstrumentation(
+        std::make_unique<PipelineOrderInstrumentation>(&events));
+    CHECK_EQ(pm.Run(&program), true);
+    ASSERT_EQ(events.size(), 6u) << num_threads;
+    EXPECT_EQ(events[0], "before builtin.module");
+    EXPECT_EQ(events[1], "after builtin.module");
+    // the functions may run at the same time
+    EXPECT_EQ(std::count(events.begin(), events.end(), "before test.func"), 2);
+    EXPECT_EQ(std::count(events.begin(), events.end(), "after test.func"), 2);
+  }
+}
+
+// The pass timing of a program of many functions on one thread and on all the
+// cores.
+TEST(pass_manager, MultiThreadingBenchmark) {
+  ir::IrContext::Instance()->GetOrRegisterDialect<TestDialect>();
+  for (int num_threads : {1, 0}) {
+    auto start = std::chrono::steady_clock::now();
+    RunFuncDce(num_threads, 256, 500);
+    LOG(INFO) << "FuncDcePass on " << (num_threads ? "one thread" : "all cores")
+              << ": "
+              << std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count()
+              << " seconds";
+  }
+}
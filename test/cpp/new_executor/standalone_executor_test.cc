@@ -63,8 +63,10 @@ USE_OP_ITSELF(squared_l2_norm);
 USE_OP_ITSELF(memcpy_h2d);
 USE_OP_ITSELF(memcpy_d2h);
 USE_OP_ITSELF(fetch_v2);
+USE_NO_KERNEL_OP(while);
 
 PD_DECLARE_KERNEL(full, GPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(full, CPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(uniform_raw, GPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(uniform, GPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(transpose, GPU, ALL_LAYOUT);
@@ -105,6 +107,9 @@ PD_DECLARE_KERNEL(cross_entropy_with_softmax_grad, GPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(sqrt, GPU, ALL_LAYOUT);
 PD_DECLARE_KERNEL(add_n, GPU, ALL_LAYOUT);
 
+DECLARE_bool(new_executor_cache_phi_kernel_context);
+DECLARE_bool(new_executor_reuse_static_shape);
+
 namespace paddle {
 namespace framework {
 
@@ -299,5 +304,241 @@ TEST(InterpreterCore, workqueue_multiplexing) {
       program, {"a", "b"}, {tensor_a, tensor_b}, {"c"}, {0.0, 1.1, 2.2, 3.3});
 }
 
+ProgramDesc GetElementwiseAddChainProgram(int op_num) {
+  ProgramDesc program;
+  BlockDesc* main_block = program.MutableBlock(0);
+  VarDesc* var_x = main_block->Var("x");
+  VarDesc* var_y = main_block->Var("y");
+  var_x->SetType(proto::VarType::LOD_TENSOR);
+  var_y->SetType(proto::VarType::LOD_TENSOR);
+
+  std::string in_name = "x";
+  for (int i = 0; i < op_num; ++i) {
+    std::string out_name = "out_" + std::to_string(i);
+    main_block->Var(out_name)->SetType(proto::VarType::LOD_TENSOR);
+    OpDesc* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {in_name});
+    add->SetInput("Y", {"y"});
+    add->SetOutput("Out", {out_name});
+    in_name = out_name;
+  }
+  return program;
+}
+
+TEST(InterpreterCore, cache_phi_kernel_context) {
+  const int op_num = 20;
+  const int step_num = 10;
+  ProgramDesc program = GetElementwiseAddChainProgram(op_num);
+  const platform::CPUPlace place = platform::CPUPlace();
+
+  phi::DDim dims = phi::make_ddim({1, 4});
+  phi::DenseTensor tensor_x = phi::DenseTensor();
+  phi::DenseTensor tensor_y = phi::DenseTensor();
+  std::fill_n(tensor_x.mutable_data<float>(dims, place), 4, 0.0f);
+  std::fill_n(tensor_y.mutable_data<float>(dims, place), 4, 1.0f);
+  std::string fetch_name = "out_" + std::to_string(op_num - 1);
+
+  auto run = [&](bool cache_phi_kernel_context) {
+    FLAGS_new_executor_cache_phi_kernel_context = cache_phi_kernel_context;
+    Scope scope;
+    interpreter::ExecutionConfig execution_config;
+    execution_config.skip_gc_vars = {fetch_name};
+    InterpreterCore core(place, program.Block(0), &scope, execution_config);
+    // the first step builds the instructions
+    core.Run({"x", "y"}, {tensor_x, tensor_y});
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < step_num; ++i) {
+      core.Run({"x", "y"}, {tensor_x, tensor_y});
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::micro> diff = end - start;
+    VLOG(3) << "cache_phi_kernel_context=" << cache_phi_kernel_context
+            << ", time cost per op "
+            << diff.count() / (static_cast<double>(step_num) * op_num)
+            << " us";
+
+    const phi::DenseTensor& out =
+        scope.kids().back()->FindVar(fetch_name)->Get<phi::DenseTensor>();
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_FLOAT_EQ(out.data<float>()[i], static_cast<float>(op_num));
+    }
+  };
+
+  run(false);
+  run(true);
+  FLAGS_new_executor_cache_phi_kernel_context = false;
+}
+
+TEST(InterpreterCore, reuse_static_shape) {
+  const int op_num = 10;
+  ProgramDesc program = GetElementwiseAddChainProgram(op_num);
+  const platform::CPUPlace place = platform::CPUPlace();
+  std::string fetch_name = "out_" + std::to_string(op_num - 1);
+
+  FLAGS_new_executor_reuse_static_shape = true;
+  Scope scope;
+  interpreter::ExecutionConfig execution_config;
+  execution_config.skip_gc_vars = {fetch_name};
+  InterpreterCore core(place, program.Block(0), &scope, execution_config);
+
+  auto run_and_check = [&](int64_t batch_size) {
+    phi::DDim dims = phi::make_ddim({batch_size, 4});
+    phi::DenseTensor tensor_x = phi::DenseTensor();
+    phi::DenseTensor tensor_y = phi::DenseTensor();
+    std::fill_n(
+        tensor_x.mutable_data<float>(dims, place), batch_size * 4, 0.0f);
+    std::fill_n(
+        tensor_y.mutable_data<float>(dims, place), batch_size * 4, 1.0f);
+    core.Run({"x", "y"}, {tensor_x, tensor_y});
+
+    const phi::DenseTensor& out =
+        scope.kids().back()->FindVar(fetch_name)->Get<phi::DenseTensor>();
+    ASSERT_EQ(out.dims(), dims);
+    for (int64_t i = 0; i < batch_size * 4; ++i) {
+      ASSERT_FLOAT_EQ(out.data<float>()[i], static_cast<float>(op_num));
+    }
+  };
+
+  // build, record, replay, then fall back when the shapes change
+  run_and_check(1);
+  run_and_check(1);
+  run_and_check(1);
+  run_and_check(3);
+  run_and_check(3);
+  run_and_check(1);
+  FLAGS_new_executor_reuse_static_shape = false;
+}
+
+// A while op whose sub-block adds x and y once. The InterpreterCore of the
+// sub-block runs without feeds, its inputs are found in the scope.
+ProgramDesc GetWhileAddProgram() {
+  ProgramDesc program;
+  BlockDesc* main_block = program.MutableBlock(0);
+  for (const char* name : {"x", "y", "out", "cond"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  main_block->Var("step_scopes")->SetType(proto::VarType::STEP_SCOPES);
+
+  auto append_fill_cond = [](BlockDesc* block, bool value) {
+    OpDesc* fill = block->AppendOp();
+    fill->SetType("fill_constant");
+    fill->SetOutput("Out", {"cond"});
+    fill->SetAttr("shape", std::vector<int64_t>{1});
+    fill->SetAttr("value", value ? 1.0f : 0.0f);
+    fill->SetAttr("dtype", static_cast<int>(proto::VarType::BOOL));
+  };
+  append_fill_cond(main_block, true);
+
+  BlockDesc* sub_block = program.AppendBlock(*main_block);
+  OpDesc* add = sub_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"x"});
+  add->SetInput("Y", {"y"});
+  add->SetOutput("Out", {"out"});
+  append_fill_cond(sub_block, false);
+
+  OpDesc* while_op = main_block->AppendOp();
+  while_op->SetType("while");
+  while_op->SetInput("X", {"x", "y"});
+  while_op->SetInput("Condition", {"cond"});
+  while_op->SetOutput("Out", {"out", "cond"});
+  while_op->SetOutput("StepScopes", {"step_scopes"});
+  while_op->SetBlockAttr("sub_block", sub_block);
+  while_op->SetAttr("is_test", true);
+  while_op->SetAttr("skip_eager_deletion_vars",
+                    std::vector<std::string>{"out"});
+  return program;
+}
+
+TEST(InterpreterCore, reuse_static_shape_in_while) {
+  ProgramDesc program = GetWhileAddProgram();
+  const platform::CPUPlace place = platform::CPUPlace();
+
+  FLAGS_new_executor_reuse_static_shape = true;
+  Scope scope;
+  interpreter::ExecutionConfig execution_config;
+  execution_config.skip_gc_vars = {"out"};
+  InterpreterCore core(place, program.Block(0), &scope, execution_config);
+
+  auto run_and_check = [&](int64_t batch_size) {
+    phi::DDim dims = phi::make_ddim({batch_size, 4});
+    phi::DenseTensor tensor_x = phi::DenseTensor();
+    phi::DenseTensor tensor_y = phi::DenseTensor();
+    std::fill_n(
+        tensor_x.mutable_data<float>(dims, place), batch_size * 4, 1.0f);
+    std::fill_n(
+        tensor_y.mutable_data<float>(dims, place), batch_size * 4, 2.0f);
+    core.Run({"x", "y"}, {tensor_x, tensor_y});
+
+    const phi::DenseTensor& out =
+        scope.kids().back()->FindVar("out")->Get<phi::DenseTensor>();
+    ASSERT_EQ(out.dims(), dims);
+    for (int64_t i = 0; i < batch_size * 4; ++i) {
+      ASSERT_FLOAT_EQ(out.data<float>()[i], 3.0f);
+    }
+  };
+
+  // the sub-block has no feeds, so it runs InferShape in every step
+  run_and_check(1);
+  run_and_check(1);
+  run_and_check(1);
+  run_and_check(3);
+  run_and_check(2);
+  FLAGS_new_executor_reuse_static_shape = false;
+}
+
+TEST(InterpreterCore, reuse_static_shape_with_scope_input) {
+  // out = w + w, w is a persistable var in the scope which changes its shape
+  // between the steps while the shape of the feed x does not.
+  ProgramDesc program;
+  BlockDesc* main_block = program.MutableBlock(0);
+  for (const char* name : {"x", "w", "out"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  main_block->Var("w")->SetPersistable(true);
+  OpDesc* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"w"});
+  add->SetInput("Y", {"w"});
+  add->SetOutput("Out", {"out"});
+  const platform::CPUPlace place = platform::CPUPlace();
+
+  FLAGS_new_executor_reuse_static_shape = true;
+  Scope scope;
+  auto* tensor_w = scope.Var("w")->GetMutable<phi::DenseTensor>();
+  interpreter::ExecutionConfig execution_config;
+  execution_config.skip_gc_vars = {"out"};
+  InterpreterCore core(place, program.Block(0), &scope, execution_config);
+
+  auto run_and_check = [&](int64_t batch_size) {
+    phi::DDim dims = phi::make_ddim({batch_size, 4});
+    std::fill_n(
+        tensor_w->mutable_data<float>(dims, place), batch_size * 4, 1.0f);
+    phi::DenseTensor tensor_x = phi::DenseTensor();
+    std::fill_n(tensor_x.mutable_data<float>(phi::make_ddim({1, 4}), place),
+                4,
+                0.0f);
+    core.Run({"x"}, {tensor_x});
+
+    const phi::DenseTensor& out =
+        scope.kids().back()->FindVar("out")->Get<phi::DenseTensor>();
+    ASSERT_EQ(out.dims(), dims);
+    for (int64_t i = 0; i < batch_size * 4; ++i) {
+      ASSERT_FLOAT_EQ(out.data<float>()[i], 2.0f);
+    }
+  };
+
+  // the record of out is replayed only while w keeps its shape
+  run_and_check(1);
+  run_and_check(1);
+  run_and_check(1);
+  run_and_check(3);
+  run_and_check(3);
+  run_and_check(2);
+  FLAGS_new_executor_reuse_static_shape = false;
+}
+
 }  // namespace framework
 }  // namespace paddle
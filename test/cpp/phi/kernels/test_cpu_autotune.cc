@@ -0,0 +1,146 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "glog/logging.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/core/flags.h"
+#include "paddle/phi/kernels/autotune/auto_tune_base.h"
+#include "paddle/phi/kernels/funcs/softmax.h"
+
+PHI_DECLARE_string(cpu_autotune_cache_file);
+
+namespace tune = phi::autotune;
+
+void SlowAlgo(const phi::CPUContext& ctx UNUSED, int* out) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  *out = 0;
+}
+
+void FastAlgo(const phi::CPUContext& ctx UNUSED, int* out) { *out = 1; }
+
+int SavedResults(const std::string& path) {
+  std::ifstream fin(path);
+  std::string line;
+  int lines = 0;
+  while (std::getline(fin, line)) {
+    ++lines;
+  }
+  // the version and the cpu model come first
+  return lines - 2;
+}
+
+TEST(CpuAutoTune, save_and_load) {
+  std::string path = "/tmp/cpu_autotune_cache_" + std::to_string(getpid());
+  FLAGS_cpu_autotune_cache_file = path;
+  std::remove(path.c_str());
+
+  auto* ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  tune::AutoTuneStatus::Instance().EnableAutoTune();
+  tune::AutoTuneStatus::Instance().Update();
+  EXPECT_TRUE(tune::AutoTuneStatus::Instance().UseCpuAutoTune());
+
+  // 1. The fast kernel is picked and saved in the cache file.
+  auto* tuner = tune::MakeCpuMatmulTuner<float>(SlowAlgo);
+  tuner->AddCallBack(FastAlgo);
+  size_t key = tune::CpuMatmulKey(
+      {64, 32}, {32, 16}, false, false, phi::DataType::FLOAT32);
+  int out = -1;
+  tuner->Run(*ctx, tune::AlgorithmType::kCpuMatmul, key, *ctx, &out);
+  auto& cache = tune::AutoTuneCache::Instance().Get(
+      tune::AlgorithmType::kCpuMatmul);
+  EXPECT_TRUE(cache.Find(key));
+  EXPECT_EQ(cache.Get(key), 1);
+
+  std::ifstream fin(path);
+  ASSERT_TRUE(static_cast<bool>(fin));
+  std::string version, cpu_model;
+  std::getline(fin, version);
+  std::getline(fin, cpu_model);
+  int64_t algo_type = 0, algo = 0;
+  size_t saved_key = 0;
+  ASSERT_TRUE(static_cast<bool>(fin >> algo_type >> saved_key >> algo));
+  EXPECT_EQ(algo_type, static_cast<int64_t>(tune::AlgorithmType::kCpuMatmul));
+  EXPECT_EQ(saved_key, key);
+  EXPECT_EQ(algo, 1);
+
+  // 2. Without autotune, the cached kernel is still used.
+  tune::AutoTuneStatus::Instance().DisableAutoTune();
+  tune::AutoTuneCache::Instance().Get(tune::AlgorithmType::kCpuMatmul)
+      .Set(key, 1);
+  out = -1;
+  tuner->Run(*ctx, tune::AlgorithmType::kCpuMatmul, key, *ctx, &out);
+  EXPECT_EQ(out, 1);
+
+  // 3. The file is rewritten once the unsaved results are as many as the
+  // saved ones, the others are saved by SaveCpuCache at exit.
+  tune::AutoTuneStatus::Instance().EnableAutoTune();
+  tune::AutoTuneStatus::Instance().Update();
+  for (int64_t m : {16, 8}) {
+    size_t other_key = tune::CpuMatmulKey(
+        {m, 32}, {32, 16}, false, false, phi::DataType::FLOAT32);
+    tuner->Run(*ctx, tune::AlgorithmType::kCpuMatmul, other_key, *ctx, &out);
+  }
+  EXPECT_EQ(SavedResults(path), 2);
+  tune::AutoTuneCache::Instance().SaveCpuCache();
+  EXPECT_EQ(SavedResults(path), 3);
+  tune::AutoTuneStatus::Instance().DisableAutoTune();
+
+  FLAGS_cpu_autotune_cache_file = "";
+  std::remove(path.c_str());
+}
+
+TEST(CpuAutoTune, inplace_softmax) {
+  FLAGS_cpu_autotune_cache_file = "";
+  auto* ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  tune::AutoTuneStatus::Instance().EnableAutoTune();
+  tune::AutoTuneStatus::Instance().Update();
+  tune::AutoTuneCache::Instance().Get(tune::AlgorithmType::kCpuSoftmax)
+      .Clean();
+
+  const int batch_size = 8;
+  const int num_classes = 100;
+  phi::DenseTensor x, out, inplace;
+  for (auto* t : {&x, &out, &inplace}) {
+    t->Resize({batch_size, num_classes});
+    ctx->Alloc<float>(t);
+  }
+  for (int i = 0; i < batch_size * num_classes; ++i) {
+    x.data<float>()[i] = static_cast<float>(i % 17) / 4;
+  }
+  std::copy(x.data<float>(),
+            x.data<float>() + x.numel(),
+            inplace.data<float>());
+
+  // The candidates are timed on the input, not on the output of each other.
+  phi::funcs::SoftmaxFunctor<phi::CPUContext, float>()(
+      *ctx, num_classes, &inplace, &inplace);
+  tune::AutoTuneStatus::Instance().DisableAutoTune();
+  phi::funcs::SoftmaxFunctor<phi::CPUContext, float>()(
+      *ctx, num_classes, &x, &out);
+  for (int i = 0; i < batch_size * num_classes; ++i) {
+    EXPECT_NEAR(inplace.data<float>()[i], out.data<float>()[i], 1e-5);
+  }
+}
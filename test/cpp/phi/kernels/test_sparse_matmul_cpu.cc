@@ -0,0 +1,174 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <sys/time.h>
+
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/sparse/matmul_grad_kernel.h"
+#include "paddle/phi/kernels/sparse/matmul_kernel.h"
+#include "paddle/phi/kernels/sparse/sparse_utils_kernel.h"
+
+namespace phi {
+namespace tests {
+
+inline double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, NULL);
+  return 1e+6 * time.tv_sec + time.tv_usec;
+}
+
+const phi::CPUContext& GetCPUContext() {
+  return *static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+}
+
+// random dense tensor, elements are zeroed with the probability of sparsity
+phi::DenseTensor RandomDense(const std::vector<int64_t>& dims,
+                             double sparsity) {
+  static unsigned int seed = 100;
+  std::mt19937 rng(seed++);
+  std::uniform_real_distribution<float> uniform_dist(0, 1);
+  phi::DenseTensor x;
+  x.Resize(phi::make_ddim(dims));
+  float* data = GetCPUContext().template Alloc<float>(&x);
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    data[i] = uniform_dist(rng) < sparsity ? 0 : uniform_dist(rng) - 0.5;
+  }
+  return x;
+}
+
+void DenseMatmul(const phi::DenseTensor& x,
+                 const phi::DenseTensor& y,
+                 phi::DenseTensor* out) {
+  int m = x.dims()[0];
+  int k = x.dims()[1];
+  int n = y.dims()[1];
+  out->Resize({m, n});
+  float* out_data = GetCPUContext().template Alloc<float>(out);
+  phi::funcs::GetBlas<phi::CPUContext, float>(GetCPUContext())
+      .MatMul(m, n, k, x.data<float>(), y.data<float>(), out_data);
+}
+
+void ExpectNear(const phi::DenseTensor& x, const phi::DenseTensor& y) {
+  ASSERT_EQ(x.numel(), y.numel());
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    ASSERT_NEAR(x.data<float>()[i], y.data<float>()[i], 1e-4) << i;
+  }
+}
+
+TEST(SparseMatmulCPU, csr_dense_and_grad) {
+  const auto& dev_ctx = GetCPUContext();
+  for (int64_t n : {1, 10, 300}) {
+    phi::DenseTensor x = RandomDense({33, 40}, 0.7);
+    phi::DenseTensor y = RandomDense({40, n}, 0);
+    phi::DenseTensor dout = RandomDense({33, n}, 0);
+    auto csr_x = phi::sparse::DenseToCsr<float>(dev_ctx, x);
+
+    phi::DenseTensor out, dense_out;
+    phi::sparse::MatmulCsrDenseKernel<float>(dev_ctx, csr_x, y, &out);
+    DenseMatmul(x, y, &dense_out);
+    ExpectNear(out, dense_out);
+
+    phi::SparseCsrTensor dx;
+    phi::DenseTensor dy;
+    phi::sparse::MatmulCsrDenseGradKernel<float>(
+        dev_ctx, csr_x, y, dout, &dx, &dy);
+    // dx is dout @ y' at the non-zeros of x
+    const float* x_data = x.data<float>();
+    const float* dx_values = dx.non_zero_elements().data<float>();
+    int64_t nnz = 0;
+    for (int64_t i = 0; i < 33; ++i) {
+      for (int64_t j = 0; j < 40; ++j) {
+        if (x_data[i * 40 + j] == 0) {
+          continue;
+        }
+        float expect = 0;
+        for (int64_t c = 0; c < n; ++c) {
+          expect += dout.data<float>()[i * n + c] * y.data<float>()[j * n + c];
+        }
+        ASSERT_NEAR(dx_values[nnz++], expect, 1e-4);
+      }
+    }
+    ASSERT_EQ(nnz, dx.nnz());
+    // dy is x' @ dout
+    for (int64_t j = 0; j < 40; ++j) {
+      for (int64_t c = 0; c < n; ++c) {
+        float expect = 0;
+        for (int64_t i = 0; i < 33; ++i) {
+          expect += x_data[i * 40 + j] * dout.data<float>()[i * n + c];
+        }
+        ASSERT_NEAR(dy.data<float>()[j * n + c], expect, 1e-4);
+      }
+    }
+  }
+}
+
+TEST(SparseMatmulCPU, masked_matmul) {
+  const auto& dev_ctx = GetCPUContext();
+  phi::DenseTensor x = RandomDense({17, 24}, 0);
+  phi::DenseTensor y = RandomDense({24, 30}, 0);
+  phi::DenseTensor mask = RandomDense({17, 30}, 0.8);
+  auto csr_mask = phi::sparse::DenseToCsr<float>(dev_ctx, mask);
+
+  phi::SparseCsrTensor out;
+  phi::sparse::MaskedMatmulCsrKernel<float>(dev_ctx, x, y, csr_mask, &out);
+  phi::DenseTensor dense_out;
+  DenseMatmul(x, y, &dense_out);
+
+  const float* out_values = out.non_zero_elements().data<float>();
+  int64_t nnz = 0;
+  for (int64_t i = 0; i < mask.numel(); ++i) {
+    if (mask.data<float>()[i] != 0) {
+      ASSERT_NEAR(out_values[nnz++], dense_out.data<float>()[i], 1e-4);
+    }
+  }
+  ASSERT_EQ(nnz, out.nnz());
+}
+
+// CSR @ DENSE against the dense gemm on the same matrices
+TEST(SparseMatmulCPU, benchmark) {
+  const auto& dev_ctx = GetCPUContext();
+  const int repeat = 10;
+  const int64_t m = 1024, k = 1024, n = 128;
+  phi::DenseTensor y = RandomDense({k, n}, 0);
+  for (double sparsity : {0.5, 0.9, 0.99, 0.999}) {
+    phi::DenseTensor x = RandomDense({m, k}, sparsity);
+    auto csr_x = phi::sparse::DenseToCsr<float>(dev_ctx, x);
+    phi::DenseTensor out, dense_out;
+
+    auto st = GetCurrentUS();
+    for (int i = 0; i < repeat; ++i) {
+      DenseMatmul(x, y, &dense_out);
+    }
+    auto mt = GetCurrentUS();
+    for (int i = 0; i < repeat; ++i) {
+      phi::sparse::MatmulCsrDenseKernel<float>(dev_ctx, csr_x, y, &out);
+    }
+    auto et = GetCurrentUS();
+    ExpectNear(out, dense_out);
+    LOG(INFO) << "[" << m << ", " << k << "] @ [" << k << ", " << n
+              << "], sparsity " << sparsity << ": dense matmul "
+              << (mt - st) / repeat << " us, csr matmul "
+              << (et - mt) / repeat << " us";
+  }
+}
+
+}  // namespace tests
+}  // namespace phi